@@ -0,0 +1,69 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Compares building and destroying a request-scoped map with
+// elements allocated from the heap and from an arena.
+
+#include <b/arena.h>
+#include <b/map.h>
+
+#include "benchmark.h"
+
+#define ELEMENT_COUNT 1000
+
+static void fill_map(b::map<int, int>* m)
+{
+	for (int i = 0; i < ELEMENT_COUNT; ++i)
+		m->insert((int) ((i * 2654435761U) % ELEMENT_COUNT), i);
+
+	b::benchmark_sink += m->size();
+}
+
+B_BENCHMARK(map_heap_elements)
+{
+	while (iterations-- > 0)
+	{
+		b::map<int, int> m;
+
+		fill_map(&m);
+	}
+}
+
+B_BENCHMARK(map_arena_elements)
+{
+	b::arena request_arena;
+
+	while (iterations-- > 0)
+	{
+		{
+			b::map<int, int> m(&request_arena);
+
+			fill_map(&m);
+		}
+
+		request_arena.reset();
+	}
+}
+
+B_BENCHMARK(malloc_free_64)
+{
+	while (iterations-- > 0)
+	{
+		void* block = b::memory::alloc(64);
+		b::benchmark_sink += (size_t) block;
+		b::memory::free(block);
+	}
+}
+
+B_BENCHMARK(scratch_arena_64)
+{
+	b::arena* scratch = b::arena::scratch();
+
+	while (iterations-- > 0)
+	{
+		b::arena_scope scope(scratch);
+
+		b::benchmark_sink += (size_t) scratch->allocate(64);
+	}
+}
@@ -0,0 +1,48 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Measures uncontended atomic operations with different memory
+// orders. On most processors, sequentially consistent stores
+// cost considerably more than release stores, while relaxed and
+// acquire loads are as cheap as plain ones.
+
+#include <b/atomic.h>
+
+#include "benchmark.h"
+
+static b::atomic_value<size_t> value;
+
+B_BENCHMARK(atomic_store_release)
+{
+	while (iterations-- > 0)
+		value.store(iterations, b::memory_order_release);
+}
+
+B_BENCHMARK(atomic_store_seq_cst)
+{
+	while (iterations-- > 0)
+		value.store(iterations);
+}
+
+B_BENCHMARK(atomic_load_acquire)
+{
+	while (iterations-- > 0)
+		b::benchmark_sink += value.load(b::memory_order_acquire);
+}
+
+B_BENCHMARK(atomic_fetch_add)
+{
+	while (iterations-- > 0)
+		value.fetch_add(1, b::memory_order_relaxed);
+}
+
+B_BENCHMARK(atomic_compare_exchange)
+{
+	size_t expected = value.load(b::memory_order_relaxed);
+
+	while (iterations-- > 0)
+		while (!value.compare_exchange(&expected, expected + 1,
+				b::memory_order_acq_rel))
+			;
+}
@@ -0,0 +1,138 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Compares the ways of sharing a reference to a configuration object
+// that is replaced from time to time: atomic_ref, a ref protected by
+// a mutex, and a ref protected by a reader-writer lock. Four threads
+// copy the reference and read the object; one in sixty-four
+// operations replaces it.
+
+#include <b/atomic_ref.h>
+#include <b/mutex.h>
+
+#include "benchmark.h"
+
+#define THREAD_COUNT 4
+#define UPDATE_INTERVAL 64
+
+class configuration : public b::shared_object
+{
+public:
+	configuration(size_t v) : value(v)
+	{
+	}
+
+	size_t value;
+};
+
+class atomic_holder
+{
+public:
+	b::ref<configuration> get() const
+	{
+		return current.load();
+	}
+
+	void set(const b::ref<configuration>& c)
+	{
+		current.store(c);
+	}
+
+private:
+	b::atomic_ref<configuration> current;
+};
+
+template <class Mutex, class Reader_lock, class Writer_lock>
+class locked_holder
+{
+public:
+	b::ref<configuration> get() const
+	{
+		Reader_lock lock(m);
+
+		return current;
+	}
+
+	void set(const b::ref<configuration>& c)
+	{
+		b::ref<configuration> replaced;
+
+		{
+			Writer_lock lock(m);
+
+			replaced = current;
+			current = c;
+		}
+	}
+
+private:
+	mutable Mutex m;
+	b::ref<configuration> current;
+};
+
+typedef locked_holder<b::mutex, b::mutex_lock, b::mutex_lock> mutex_holder;
+typedef locked_holder<b::shared_mutex, b::read_lock, b::write_lock>
+	shared_mutex_holder;
+
+template <class Holder>
+struct shared_state
+{
+	Holder holder;
+	size_t iterations;
+};
+
+template <class Holder>
+static void* read_configuration(void* arg)
+{
+	shared_state<Holder>* s = static_cast<shared_state<Holder>*>(arg);
+
+	size_t sum = 0;
+
+	for (size_t i = 1; i <= s->iterations; ++i)
+		if (i % UPDATE_INTERVAL == 0)
+			s->holder.set(new configuration(i));
+		else
+			sum += s->holder.get()->value;
+
+	return (void*) sum;
+}
+
+template <class Holder>
+static void read_mostly(size_t iterations)
+{
+	shared_state<Holder> s;
+
+	s.holder.set(new configuration(0));
+	s.iterations = iterations / THREAD_COUNT + 1;
+
+	pthread_t threads[THREAD_COUNT];
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		pthread_create(threads + i, NULL,
+			read_configuration<Holder>, &s);
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+	{
+		void* sum;
+
+		pthread_join(threads[i], &sum);
+
+		b::benchmark_sink += (size_t) sum;
+	}
+}
+
+B_BENCHMARK(atomic_ref_read_mostly)
+{
+	read_mostly<atomic_holder>(iterations);
+}
+
+B_BENCHMARK(mutex_ref_read_mostly)
+{
+	read_mostly<mutex_holder>(iterations);
+}
+
+B_BENCHMARK(shared_mutex_ref_read_mostly)
+{
+	read_mostly<shared_mutex_holder>(iterations);
+}
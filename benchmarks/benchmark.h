@@ -0,0 +1,137 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_BENCHMARK_H
+#define B_BENCHMARK_H
+
+#include <b/string.h>
+#include <b/linked_list.h>
+#include <b/node_access_via_cast.h>
+
+#include <time.h>
+
+B_BEGIN_NAMESPACE
+
+class benchmark
+{
+public:
+	virtual ~benchmark() {}
+
+	benchmark(const char* name) : benchmark_name(name)
+	{
+		benchmark::benchmark_list.append(this);
+	}
+
+	// Performs the measured operation 'iterations' times.
+	virtual void run(size_t iterations) const = 0;
+
+	const char* const benchmark_name;
+
+	typedef b::linked_list_node<benchmark> list_node_type;
+
+	list_node_type list_node;
+
+	operator list_node_type&()
+	{
+		return list_node;
+	}
+
+	typedef node_access_via_cast<list_node_type> node_access;
+
+	static linked_list<node_access> benchmark_list;
+};
+
+linked_list<benchmark::node_access> benchmark::benchmark_list =
+	benchmark::node_access();
+
+// Results of the measured computations are stored here to keep
+// the compiler from optimizing the computations away.
+volatile size_t benchmark_sink;
+
+// Returns the value of a monotonic clock in nanoseconds.
+inline double benchmark_clock()
+{
+	struct timespec ts;
+
+	::clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+double benchmark_elapsed_time;
+double benchmark_start_time;
+
+// Excludes the time spent on preparing input data
+// from the measurement.
+inline void pause_timing()
+{
+	benchmark_elapsed_time += benchmark_clock() - benchmark_start_time;
+}
+
+// Resumes time measurement after a call to pause_timing().
+inline void resume_timing()
+{
+	benchmark_start_time = benchmark_clock();
+}
+
+B_END_NAMESPACE
+
+#define B_BENCHMARK(class_name) \
+	class benchmark_##class_name : public b::benchmark \
+	{ \
+	public: \
+		benchmark_##class_name(const char* name) : \
+			b::benchmark(name) \
+		{ \
+		} \
+		virtual void run(size_t iterations) const; \
+	} static benchmark_##class_name##_instance(#class_name); \
+	void benchmark_##class_name::run(size_t iterations) const
+
+// The minimum amount of time, in nanoseconds, to run each benchmark for.
+#define B_BENCHMARK_MIN_TIME 5e8
+
+// Runs all benchmarks or only those whose names match
+// one of the wildcard patterns given on the command line.
+int main(int argc, char* argv[])
+{
+	for (b::benchmark* bm = b::benchmark::benchmark_list.first();
+		bm != NULL; bm = b::benchmark::benchmark_list.next(bm))
+	{
+		if (argc > 1)
+		{
+			int i = 1;
+
+			while (!b::match_pattern(bm->benchmark_name, argv[i]))
+				if (++i == argc)
+					break;
+
+			if (i == argc)
+				continue;
+		}
+
+		size_t iterations = 1;
+
+		for (;;)
+		{
+			b::benchmark_elapsed_time = 0;
+			b::resume_timing();
+			bm->run(iterations);
+			b::pause_timing();
+
+			if (b::benchmark_elapsed_time >= B_BENCHMARK_MIN_TIME)
+				break;
+
+			iterations <<= 1;
+		}
+
+		printf("%-40s %12lu %14.1f ns/op\n", bm->benchmark_name,
+			(unsigned long) iterations,
+			b::benchmark_elapsed_time / iterations);
+	}
+
+	return 0;
+}
+
+#endif /* !defined(B_BENCHMARK_H) */
@@ -0,0 +1,125 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Compares b::map with b::btree_map holding a million integer
+// keys: random insertion, bulk loading, random lookups, and a full
+// scan in key order.
+
+#include <b/btree_map.h>
+
+#include "benchmark.h"
+
+#define ELEMENT_COUNT (1024 * 1024)
+#define LOOKUP_COUNT 100000
+
+typedef b::kv_pair<int, int> int_pair;
+
+struct btree_map_input
+{
+	btree_map_input()
+	{
+		b::pseudorandom prng(42);
+
+		keys.alloc_and_copy(ELEMENT_COUNT);
+		sorted.alloc_and_copy(ELEMENT_COUNT);
+
+		for (int i = 0; i < ELEMENT_COUNT; ++i)
+		{
+			keys.append(i * 2);
+			sorted.append(int_pair(i * 2, i));
+		}
+
+		keys.shuffle(prng);
+
+		lookups.alloc_and_copy(LOOKUP_COUNT);
+
+		for (int i = 0; i < LOOKUP_COUNT; ++i)
+			lookups.append((int) prng.next(ELEMENT_COUNT * 2));
+
+		for (int i = 0; i < ELEMENT_COUNT; ++i)
+			tree_map.insert(keys[i], i);
+
+		btree.assign_sorted(sorted.data(), ELEMENT_COUNT);
+	}
+
+	b::array<int> keys;
+	b::array<int_pair> sorted;
+	b::array<int> lookups;
+	b::map<int, int> tree_map;
+	b::btree_map<int, int> btree;
+};
+
+static const btree_map_input input;
+
+B_BENCHMARK(map_insert)
+{
+	while (iterations-- > 0)
+	{
+		b::map<int, int> m;
+
+		for (int i = 0; i < ELEMENT_COUNT; ++i)
+			m.insert(input.keys[i], i);
+
+		b::benchmark_sink += m.size();
+	}
+}
+
+B_BENCHMARK(btree_map_insert)
+{
+	while (iterations-- > 0)
+	{
+		b::btree_map<int, int> m;
+
+		for (int i = 0; i < ELEMENT_COUNT; ++i)
+			m.insert(input.keys[i], i);
+
+		b::benchmark_sink += m.size();
+	}
+}
+
+B_BENCHMARK(btree_map_assign_sorted)
+{
+	while (iterations-- > 0)
+	{
+		b::btree_map<int, int> m;
+
+		m.assign_sorted(input.sorted.data(), ELEMENT_COUNT);
+
+		b::benchmark_sink += m.size();
+	}
+}
+
+B_BENCHMARK(map_find)
+{
+	while (iterations-- > 0)
+		for (int i = 0; i < LOOKUP_COUNT; ++i)
+			b::benchmark_sink += (size_t)
+				input.tree_map.find(input.lookups[i]);
+}
+
+B_BENCHMARK(btree_map_find)
+{
+	while (iterations-- > 0)
+		for (int i = 0; i < LOOKUP_COUNT; ++i)
+			b::benchmark_sink += (size_t)
+				input.btree.find(input.lookups[i]);
+}
+
+B_BENCHMARK(map_scan)
+{
+	while (iterations-- > 0)
+		for (b::map<int, int>::const_iterator it =
+					input.tree_map.begin();
+				it != input.tree_map.end(); ++it)
+			b::benchmark_sink += (size_t) it->value;
+}
+
+B_BENCHMARK(btree_map_scan)
+{
+	while (iterations-- > 0)
+		for (b::btree_map<int, int>::const_iterator it =
+					input.btree.begin();
+				it != input.btree.end(); ++it)
+			b::benchmark_sink += (size_t) it->value;
+}
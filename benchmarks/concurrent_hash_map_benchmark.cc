@@ -0,0 +1,188 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Measures how lookups in a shared string-to-object table scale
+// with the number of reader threads, from one to sixty-four. The
+// striped concurrent_hash_map is compared with a map protected by
+// a single mutex and with a map protected by a single reader-writer
+// lock. Every lookup copies the found reference, as a reader that
+// uses the object after the lookup would. The reported time is per
+// lookup; it only goes down with more threads on a machine with
+// as many processors.
+
+#include <b/concurrent_hash_map.h>
+#include <b/shared_object.h>
+#include <b/map.h>
+#include <b/pseudorandom.h>
+
+#include "benchmark.h"
+
+#include <pthread.h>
+
+#define KEY_COUNT 4096
+#define LOOKUP_SEQUENCE_LENGTH 65536
+
+class entry : public b::shared_object
+{
+public:
+	explicit entry(size_t n) : id(n)
+	{
+	}
+
+	const size_t id;
+};
+
+typedef b::ref<entry> entry_ref;
+
+struct lookup_input
+{
+	lookup_input()
+	{
+		b::pseudorandom prng(42);
+
+		for (size_t i = 0; i < KEY_COUNT; ++i)
+			keys[i] = b::string::formatted("/config/section%lu/key",
+				(unsigned long) i);
+
+		for (size_t i = 0; i < LOOKUP_SEQUENCE_LENGTH; ++i)
+			sequence[i] = prng.next(KEY_COUNT);
+	}
+
+	b::string keys[KEY_COUNT];
+	size_t sequence[LOOKUP_SEQUENCE_LENGTH];
+};
+
+static const lookup_input input;
+
+class striped_table
+{
+public:
+	striped_table()
+	{
+		for (size_t i = 0; i < KEY_COUNT; ++i)
+			map.insert(input.keys[i], new entry(i));
+	}
+
+	bool find(const b::string& key, entry_ref* value) const
+	{
+		return map.find(b::string_view(key), value);
+	}
+
+private:
+	b::concurrent_hash_map<b::string, entry_ref> map;
+};
+
+template <class Mutex, class Read_lock>
+class locked_table
+{
+public:
+	locked_table()
+	{
+		for (size_t i = 0; i < KEY_COUNT; ++i)
+			map.insert(input.keys[i], new entry(i));
+	}
+
+	bool find(const b::string& key, entry_ref* value) const
+	{
+		Read_lock lock(table_mutex);
+
+		entry_ref* found = map.find(key);
+
+		if (found == NULL)
+			return false;
+
+		*value = *found;
+
+		return true;
+	}
+
+private:
+	mutable Mutex table_mutex;
+	b::map<b::string, entry_ref> map;
+};
+
+typedef locked_table<b::mutex, b::mutex_lock> mutex_table;
+typedef locked_table<b::shared_mutex, b::read_lock> shared_mutex_table;
+
+static const striped_table striped;
+static const shared_mutex_table shared_mutex_protected;
+static const mutex_table mutex_protected;
+
+template <class Table>
+struct reader
+{
+	const Table* table;
+	size_t first_lookup;
+	size_t lookup_count;
+};
+
+template <class Table>
+static void* look_up(void* arg)
+{
+	reader<Table>* r = static_cast<reader<Table>*>(arg);
+
+	size_t found = 0;
+
+	for (size_t i = 0; i < r->lookup_count; ++i)
+	{
+		size_t key = input.sequence[(r->first_lookup + i) %
+			LOOKUP_SEQUENCE_LENGTH];
+
+		entry_ref value;
+
+		if (r->table->find(input.keys[key], &value))
+			found += value->id == key;
+	}
+
+	return (void*) found;
+}
+
+template <class Table>
+static void read_scaling(const Table* table, size_t thread_count,
+	size_t iterations)
+{
+	pthread_t threads[64];
+	reader<Table> readers[64];
+
+	for (size_t i = 0; i < thread_count; ++i)
+	{
+		readers[i].table = table;
+		readers[i].first_lookup = i * (LOOKUP_SEQUENCE_LENGTH /
+			thread_count);
+		readers[i].lookup_count = iterations / thread_count + 1;
+
+		pthread_create(threads + i, NULL, look_up<Table>, readers + i);
+	}
+
+	for (size_t i = 0; i < thread_count; ++i)
+	{
+		void* found;
+
+		pthread_join(threads[i], &found);
+
+		b::benchmark_sink += (size_t) found;
+	}
+}
+
+#define B_READ_SCALING_BENCHMARKS(table, name) \
+	B_BENCHMARK(name##_1_thread) \
+	{ \
+		read_scaling(&table, 1, iterations); \
+	} \
+	B_BENCHMARK(name##_4_threads) \
+	{ \
+		read_scaling(&table, 4, iterations); \
+	} \
+	B_BENCHMARK(name##_16_threads) \
+	{ \
+		read_scaling(&table, 16, iterations); \
+	} \
+	B_BENCHMARK(name##_64_threads) \
+	{ \
+		read_scaling(&table, 64, iterations); \
+	}
+
+B_READ_SCALING_BENCHMARKS(striped, concurrent_hash_map)
+B_READ_SCALING_BENCHMARKS(shared_mutex_protected, shared_mutex_map)
+B_READ_SCALING_BENCHMARKS(mutex_protected, mutex_map)
@@ -0,0 +1,145 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Compares the ways of reading a configuration object that is
+// replaced from time to time: inside an epoch critical section,
+// with the replaced objects retired to the epoch domain, and under
+// a reader-writer lock, with the replaced objects deleted by the
+// writer. Four threads read the object; one in sixty-four
+// operations replaces it.
+
+#include <b/epoch.h>
+#include <b/mutex.h>
+
+#include "benchmark.h"
+
+#define THREAD_COUNT 4
+#define UPDATE_INTERVAL 64
+
+struct configuration
+{
+	size_t values[8];
+};
+
+static void delete_configuration(void* block)
+{
+	delete static_cast<configuration*>(block);
+}
+
+static configuration* new_configuration(size_t value)
+{
+	configuration* c = new configuration;
+
+	for (size_t i = 0; i < B_COUNTOF(c->values); ++i)
+		c->values[i] = value;
+
+	return c;
+}
+
+struct epoch_protected
+{
+	b::epoch_domain domain;
+	b::atomic_value<configuration*> current;
+	size_t iterations;
+};
+
+static void* read_in_epochs(void* arg)
+{
+	epoch_protected* p = static_cast<epoch_protected*>(arg);
+
+	size_t sum = 0;
+
+	for (size_t i = 1; i <= p->iterations; ++i)
+		if (i % UPDATE_INTERVAL == 0)
+			p->domain.retire(p->current.exchange(
+				new_configuration(i), b::memory_order_acq_rel),
+				delete_configuration);
+		else
+		{
+			b::epoch_guard guard(p->domain);
+
+			sum += p->current.load(
+				b::memory_order_acquire)->values[i & 7];
+		}
+
+	return (void*) sum;
+}
+
+struct lock_protected
+{
+	b::shared_mutex lock;
+	configuration* current;
+	size_t iterations;
+};
+
+static void* read_under_lock(void* arg)
+{
+	lock_protected* p = static_cast<lock_protected*>(arg);
+
+	size_t sum = 0;
+
+	for (size_t i = 1; i <= p->iterations; ++i)
+		if (i % UPDATE_INTERVAL == 0)
+		{
+			configuration* replaced;
+
+			{
+				b::write_lock lock(p->lock);
+
+				replaced = p->current;
+				p->current = new_configuration(i);
+			}
+
+			delete replaced;
+		}
+		else
+		{
+			b::read_lock lock(p->lock);
+
+			sum += p->current->values[i & 7];
+		}
+
+	return (void*) sum;
+}
+
+static void run_readers(void* (*reader)(void*), void* arg)
+{
+	pthread_t threads[THREAD_COUNT];
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		pthread_create(threads + i, NULL, reader, arg);
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+	{
+		void* sum;
+
+		pthread_join(threads[i], &sum);
+
+		b::benchmark_sink += (size_t) sum;
+	}
+}
+
+B_BENCHMARK(epoch_reads)
+{
+	epoch_protected p;
+
+	p.current.store(new_configuration(0), b::memory_order_relaxed);
+	p.iterations = iterations / THREAD_COUNT + 1;
+
+	run_readers(read_in_epochs, &p);
+
+	delete p.current.load(b::memory_order_relaxed);
+}
+
+B_BENCHMARK(shared_mutex_reads)
+{
+	lock_protected p;
+
+	p.current = new_configuration(0);
+	p.iterations = iterations / THREAD_COUNT + 1;
+
+	run_readers(read_under_lock, &p);
+
+	delete p.current;
+}
@@ -0,0 +1,128 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Compares memory::fixed_alloc() with malloc() for small blocks:
+// a thread that allocates and frees its own blocks, and a pair of
+// threads where one allocates the blocks and the other frees them.
+
+#include <b/memory.h>
+#include <b/mpmc_queue.h>
+
+#include "benchmark.h"
+
+#include <sched.h>
+
+#define BLOCK_SIZE 48
+#define BATCH_SIZE 64
+
+struct fixed_allocator
+{
+	static void* alloc()
+	{
+		return b::memory::fixed_alloc(BLOCK_SIZE);
+	}
+
+	static void free(void* block)
+	{
+		b::memory::fixed_free(block, BLOCK_SIZE);
+	}
+};
+
+struct malloc_allocator
+{
+	static void* alloc()
+	{
+		return malloc(BLOCK_SIZE);
+	}
+
+	static void free(void* block)
+	{
+		::free(block);
+	}
+};
+
+template <class Allocator>
+static void same_thread(size_t iterations)
+{
+	void* blocks[BATCH_SIZE];
+
+	for (size_t i = 0; i < iterations; i += BATCH_SIZE)
+	{
+		for (size_t j = 0; j < BATCH_SIZE; ++j)
+			blocks[j] = Allocator::alloc();
+
+		for (size_t j = 0; j < BATCH_SIZE; ++j)
+			Allocator::free(blocks[j]);
+	}
+}
+
+B_BENCHMARK(fixed_alloc_same_thread)
+{
+	same_thread<fixed_allocator>(iterations);
+}
+
+B_BENCHMARK(malloc_same_thread)
+{
+	same_thread<malloc_allocator>(iterations);
+}
+
+struct handoff
+{
+	handoff() : queue(1024)
+	{
+	}
+
+	b::mpmc_queue<void*> queue;
+	size_t iterations;
+};
+
+template <class Allocator>
+static void* free_blocks(void* arg)
+{
+	handoff* h = static_cast<handoff*>(arg);
+
+	for (size_t i = 0; i < h->iterations; ++i)
+	{
+		void* block;
+
+		while (!h->queue.try_pop(&block))
+			sched_yield();
+
+		Allocator::free(block);
+	}
+
+	return NULL;
+}
+
+template <class Allocator>
+static void other_thread(size_t iterations)
+{
+	handoff h;
+
+	h.iterations = iterations;
+
+	pthread_t consumer;
+
+	pthread_create(&consumer, NULL, free_blocks<Allocator>, &h);
+
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		void* block = Allocator::alloc();
+
+		while (!h.queue.try_push(block))
+			sched_yield();
+	}
+
+	pthread_join(consumer, NULL);
+}
+
+B_BENCHMARK(fixed_alloc_other_thread)
+{
+	other_thread<fixed_allocator>(iterations);
+}
+
+B_BENCHMARK(malloc_other_thread)
+{
+	other_thread<malloc_allocator>(iterations);
+}
@@ -0,0 +1,105 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Compares b::set with b::flat_set holding ten thousand integers:
+// building the container, looking up random keys, and iterating
+// over the elements. A set element carries three tree pointers and
+// a heap block header in addition to the value, while a flat set
+// stores the values alone in one contiguous block.
+
+#include <b/flat_set.h>
+#include <b/set.h>
+
+#include "benchmark.h"
+
+#define ELEMENT_COUNT 10000
+#define LOOKUP_COUNT 1000
+
+struct flat_set_input
+{
+	flat_set_input()
+	{
+		b::pseudorandom prng(42);
+
+		values.alloc_and_copy(ELEMENT_COUNT);
+
+		for (int i = 0; i < ELEMENT_COUNT; ++i)
+			values.append((int) prng.next(ELEMENT_COUNT * 4));
+
+		keys.alloc_and_copy(LOOKUP_COUNT);
+
+		for (int i = 0; i < LOOKUP_COUNT; ++i)
+			keys.append((int) prng.next(ELEMENT_COUNT * 4));
+
+		for (int i = 0; i < ELEMENT_COUNT; ++i)
+			tree_set.insert(values[i]);
+
+		flat_set.assign(values.data(), ELEMENT_COUNT);
+	}
+
+	b::array<int> values;
+	b::array<int> keys;
+	b::set<int> tree_set;
+	b::flat_set<int> flat_set;
+};
+
+static const flat_set_input input;
+
+B_BENCHMARK(set_build)
+{
+	while (iterations-- > 0)
+	{
+		b::set<int> s;
+
+		for (int i = 0; i < ELEMENT_COUNT; ++i)
+			s.insert(input.values[i]);
+
+		b::benchmark_sink += s.size();
+	}
+}
+
+B_BENCHMARK(flat_set_build)
+{
+	while (iterations-- > 0)
+	{
+		b::flat_set<int> s;
+
+		s.assign(input.values.data(), ELEMENT_COUNT);
+
+		b::benchmark_sink += s.size();
+	}
+}
+
+B_BENCHMARK(set_find)
+{
+	while (iterations-- > 0)
+		for (int i = 0; i < LOOKUP_COUNT; ++i)
+			b::benchmark_sink += (size_t)
+				input.tree_set.find(input.keys[i]);
+}
+
+B_BENCHMARK(flat_set_find)
+{
+	while (iterations-- > 0)
+		for (int i = 0; i < LOOKUP_COUNT; ++i)
+			b::benchmark_sink += (size_t)
+				input.flat_set.find(input.keys[i]);
+}
+
+B_BENCHMARK(set_iterate)
+{
+	while (iterations-- > 0)
+		for (b::set<int>::const_iterator it = input.tree_set.begin();
+				it != input.tree_set.end(); ++it)
+			b::benchmark_sink += (size_t) *it;
+}
+
+B_BENCHMARK(flat_set_iterate)
+{
+	while (iterations-- > 0)
+		for (b::flat_set<int>::const_iterator it =
+					input.flat_set.begin();
+				it != input.flat_set.end(); ++it)
+			b::benchmark_sink += (size_t) *it;
+}
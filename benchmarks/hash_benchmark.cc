@@ -0,0 +1,32 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/string.h>
+
+#include "benchmark.h"
+
+static const b::string input(4096, 'x');
+
+#define B_HASH_BYTES_BENCHMARK(length) \
+	B_BENCHMARK(hash_bytes_##length) \
+	{ \
+		while (iterations-- > 0) \
+			b::benchmark_sink += b::hash_bytes( \
+				input.data() + (iterations & 7), length); \
+	}
+
+B_HASH_BYTES_BENCHMARK(8)
+B_HASH_BYTES_BENCHMARK(16)
+B_HASH_BYTES_BENCHMARK(32)
+B_HASH_BYTES_BENCHMARK(100)
+B_HASH_BYTES_BENCHMARK(1000)
+B_HASH_BYTES_BENCHMARK(4000)
+
+// With B_STRING_HASH_CACHE enabled, only the first
+// call computes the hash value of the string.
+B_BENCHMARK(string_hash_4096)
+{
+	while (iterations-- > 0)
+		b::benchmark_sink += input.hash();
+}
@@ -0,0 +1,188 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Compares the intrusive lock-free stack and MPSC queue with
+// a linked list protected by a mutex. The queue benchmarks report
+// the time per element passed from four producer threads to one
+// consumer; the stack benchmarks report the time of a push and
+// a pop in a single thread.
+
+#include <b/lock_free_list.h>
+#include <b/linked_list.h>
+#include <b/node_access_via_cast.h>
+#include <b/mutex.h>
+
+#include "benchmark.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define PRODUCER_COUNT 4
+
+class work_item;
+
+class list_node : public b::linked_list_node<work_item>
+{
+};
+
+class concurrent_node : public b::concurrent_list_node<work_item>
+{
+};
+
+class work_item : public list_node, public concurrent_node
+{
+public:
+	size_t value;
+};
+
+typedef b::lock_free_stack<b::node_access_via_cast<concurrent_node> >
+	item_stack;
+typedef b::intrusive_mpsc_queue<b::node_access_via_cast<concurrent_node> >
+	item_queue;
+
+// Baseline: a linked list made safe for any number of threads
+// by a mutex.
+class locked_list
+{
+public:
+	void push(work_item* item)
+	{
+		b::mutex_lock lock(list_mutex);
+
+		list.append(item);
+	}
+
+	void push_front(work_item* item)
+	{
+		b::mutex_lock lock(list_mutex);
+
+		list.insert_first(item);
+	}
+
+	work_item* pop()
+	{
+		b::mutex_lock lock(list_mutex);
+
+		work_item* item = list.first();
+
+		if (item != NULL)
+			list.remove_first();
+
+		return item;
+	}
+
+private:
+	b::mutex list_mutex;
+	b::linked_list<b::node_access_via_cast<list_node> > list;
+};
+
+template <class Queue>
+struct producer_slice
+{
+	Queue* queue;
+	work_item* items;
+	size_t count;
+};
+
+template <class Queue>
+static void* produce(void* arg)
+{
+	producer_slice<Queue>* slice = static_cast<producer_slice<Queue>*>(arg);
+
+	for (size_t i = 0; i < slice->count; ++i)
+		slice->queue->push(slice->items + i);
+
+	return NULL;
+}
+
+template <class Queue>
+static void transfer(size_t iterations)
+{
+	b::pause_timing();
+
+	work_item* items = new work_item[iterations];
+
+	for (size_t i = 0; i < iterations; ++i)
+		items[i].value = i;
+
+	Queue queue;
+
+	b::resume_timing();
+
+	pthread_t threads[PRODUCER_COUNT];
+	producer_slice<Queue> slices[PRODUCER_COUNT];
+
+	size_t start = 0;
+
+	for (size_t i = 0; i < PRODUCER_COUNT; ++i)
+	{
+		size_t end = iterations * (i + 1) / PRODUCER_COUNT;
+
+		slices[i].queue = &queue;
+		slices[i].items = items + start;
+		slices[i].count = end - start;
+
+		pthread_create(threads + i, NULL, produce<Queue>, slices + i);
+
+		start = end;
+	}
+
+	for (size_t received = 0; received < iterations; )
+	{
+		work_item* item = queue.pop();
+
+		if (item == NULL)
+			sched_yield();
+		else
+		{
+			b::benchmark_sink += item->value;
+			++received;
+		}
+	}
+
+	for (size_t i = 0; i < PRODUCER_COUNT; ++i)
+		pthread_join(threads[i], NULL);
+
+	b::pause_timing();
+	delete[] items;
+	b::resume_timing();
+}
+
+B_BENCHMARK(intrusive_mpsc_queue_4_producers)
+{
+	transfer<item_queue>(iterations);
+}
+
+B_BENCHMARK(locked_list_4_producers)
+{
+	transfer<locked_list>(iterations);
+}
+
+B_BENCHMARK(lock_free_stack_push_pop)
+{
+	item_stack stack;
+	work_item item;
+
+	item.value = 1;
+
+	while (iterations-- > 0)
+	{
+		stack.push(&item);
+		b::benchmark_sink += stack.pop()->value;
+	}
+}
+
+B_BENCHMARK(locked_list_push_pop)
+{
+	locked_list list;
+	work_item item;
+
+	item.value = 1;
+
+	while (iterations-- > 0)
+	{
+		list.push_front(&item);
+		b::benchmark_sink += list.pop()->value;
+	}
+}
@@ -0,0 +1,95 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Looks up a million random keys in a sorted table of four
+// million integers, which does not fit in the cache, using
+// the classic, branchless, and batched binary searches and
+// the Eytzinger layout.
+
+#include <b/eytzinger_array.h>
+
+#include "benchmark.h"
+
+#define TABLE_SIZE (4 * 1024 * 1024)
+#define KEY_COUNT (1024 * 1024)
+
+struct lower_bound_input
+{
+	lower_bound_input()
+	{
+		b::pseudorandom prng(42);
+
+		sorted.alloc_and_copy(TABLE_SIZE);
+
+		for (int i = 0; i < TABLE_SIZE; ++i)
+			sorted.append(i * 2);
+
+		keys.alloc_and_copy(KEY_COUNT);
+
+		for (int i = 0; i < KEY_COUNT; ++i)
+			keys.append((int) prng.next(TABLE_SIZE * 2));
+
+		eytzinger = b::eytzinger_array<int>(sorted);
+	}
+
+	b::array<int> sorted;
+	b::array<int> keys;
+	b::eytzinger_array<int> eytzinger;
+};
+
+static const lower_bound_input input;
+
+static size_t positions[KEY_COUNT];
+static const int* results[KEY_COUNT];
+
+B_BENCHMARK(find_lower_bound)
+{
+	const int* table = input.sorted.data();
+
+	while (iterations-- > 0)
+		for (size_t i = 0; i < KEY_COUNT; ++i)
+			b::benchmark_sink += (size_t) b::find_lower_bound(
+				table, TABLE_SIZE, input.keys[i]);
+}
+
+B_BENCHMARK(find_lower_bound_branchless)
+{
+	const int* table = input.sorted.data();
+
+	while (iterations-- > 0)
+		for (size_t i = 0; i < KEY_COUNT; ++i)
+			b::benchmark_sink += (size_t)
+				b::find_lower_bound_branchless(
+					table, TABLE_SIZE, input.keys[i]);
+}
+
+B_BENCHMARK(find_lower_bound_batch)
+{
+	while (iterations-- > 0)
+	{
+		b::find_lower_bound_batch(input.sorted.data(), TABLE_SIZE,
+			input.keys.data(), KEY_COUNT, positions);
+
+		b::benchmark_sink += positions[KEY_COUNT - 1];
+	}
+}
+
+B_BENCHMARK(eytzinger_find_lower_bound)
+{
+	while (iterations-- > 0)
+		for (size_t i = 0; i < KEY_COUNT; ++i)
+			b::benchmark_sink += (size_t)
+				input.eytzinger.find_lower_bound(input.keys[i]);
+}
+
+B_BENCHMARK(eytzinger_find_lower_bound_batch)
+{
+	while (iterations-- > 0)
+	{
+		input.eytzinger.find_lower_bound(input.keys.data(),
+			KEY_COUNT, results);
+
+		b::benchmark_sink += (size_t) results[KEY_COUNT - 1];
+	}
+}
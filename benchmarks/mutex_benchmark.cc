@@ -0,0 +1,230 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Compares the locks of the library with the POSIX ones: the cost
+// of an uncontended lock and unlock, and the time per critical
+// section when four threads compete for the same lock. The
+// read-mostly benchmarks protect map lookups with a reader-writer
+// lock and with a plain mutex; one in sixteen operations is an
+// update.
+
+#include <b/mutex.h>
+#include <b/map.h>
+#include <b/pseudorandom.h>
+
+#include "benchmark.h"
+
+#define THREAD_COUNT 4
+#define MAP_SIZE 1024
+
+class posix_mutex
+{
+public:
+	posix_mutex()
+	{
+		pthread_mutex_init(&handle, NULL);
+	}
+
+	void lock()
+	{
+		pthread_mutex_lock(&handle);
+	}
+
+	void unlock()
+	{
+		pthread_mutex_unlock(&handle);
+	}
+
+	~posix_mutex()
+	{
+		pthread_mutex_destroy(&handle);
+	}
+
+private:
+	pthread_mutex_t handle;
+};
+
+static void* do_nothing(void*)
+{
+	return NULL;
+}
+
+template <class Mutex>
+static void uncontended(size_t iterations)
+{
+	// glibc skips the atomic instructions in its mutexes until
+	// the process starts a second thread, which is not what
+	// a lock shared between threads costs.
+	b::pause_timing();
+
+	pthread_t thread;
+
+	pthread_create(&thread, NULL, do_nothing, NULL);
+	pthread_join(thread, NULL);
+
+	b::resume_timing();
+
+	Mutex m;
+
+	while (iterations-- > 0)
+	{
+		m.lock();
+		++b::benchmark_sink;
+		m.unlock();
+	}
+}
+
+B_BENCHMARK(mutex_uncontended)
+{
+	uncontended<b::mutex>(iterations);
+}
+
+B_BENCHMARK(posix_mutex_uncontended)
+{
+	uncontended<posix_mutex>(iterations);
+}
+
+template <class Mutex>
+struct contention
+{
+	Mutex m;
+	size_t iterations;
+	size_t counter;
+};
+
+template <class Mutex>
+static void* increment(void* arg)
+{
+	contention<Mutex>* c = static_cast<contention<Mutex>*>(arg);
+
+	for (size_t i = 0; i < c->iterations; ++i)
+	{
+		c->m.lock();
+		++c->counter;
+		c->m.unlock();
+	}
+
+	return NULL;
+}
+
+template <class Mutex>
+static void contended(size_t iterations)
+{
+	contention<Mutex> c;
+
+	c.iterations = iterations / THREAD_COUNT + 1;
+	c.counter = 0;
+
+	pthread_t threads[THREAD_COUNT];
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		pthread_create(threads + i, NULL, increment<Mutex>, &c);
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		pthread_join(threads[i], NULL);
+
+	b::benchmark_sink += c.counter;
+}
+
+B_BENCHMARK(mutex_4_threads)
+{
+	contended<b::mutex>(iterations);
+}
+
+B_BENCHMARK(posix_mutex_4_threads)
+{
+	contended<posix_mutex>(iterations);
+}
+
+// Adapts 'mutex' to the interface of 'shared_mutex'.
+class exclusive_only_mutex : public b::mutex
+{
+public:
+	void lock_shared()
+	{
+		lock();
+	}
+
+	void unlock_shared()
+	{
+		unlock();
+	}
+};
+
+template <class Mutex>
+struct shared_map
+{
+	Mutex m;
+	b::map<int, int> map;
+	size_t iterations;
+};
+
+template <class Mutex>
+static void* look_up(void* arg)
+{
+	shared_map<Mutex>* s = static_cast<shared_map<Mutex>*>(arg);
+
+	b::pseudorandom prng;
+
+	size_t found = 0;
+
+	for (size_t i = 0; i < s->iterations; ++i)
+	{
+		int key = (int) prng.next(MAP_SIZE);
+
+		if (i % 16 == 0)
+		{
+			s->m.lock();
+			s->map.insert(key, (int) i);
+			s->m.unlock();
+		}
+		else
+		{
+			s->m.lock_shared();
+			found += s->map.find(key) != NULL;
+			s->m.unlock_shared();
+		}
+	}
+
+	return (void*) found;
+}
+
+template <class Mutex>
+static void read_mostly(size_t iterations)
+{
+	b::pause_timing();
+
+	shared_map<Mutex> s;
+
+	for (int key = 0; key < MAP_SIZE; ++key)
+		s.map.insert(key, key);
+
+	s.iterations = iterations / THREAD_COUNT + 1;
+
+	b::resume_timing();
+
+	pthread_t threads[THREAD_COUNT];
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		pthread_create(threads + i, NULL, look_up<Mutex>, &s);
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+	{
+		void* found;
+
+		pthread_join(threads[i], &found);
+
+		b::benchmark_sink += (size_t) found;
+	}
+}
+
+B_BENCHMARK(shared_mutex_read_mostly_map)
+{
+	read_mostly<b::shared_mutex>(iterations);
+}
+
+B_BENCHMARK(mutex_read_mostly_map)
+{
+	read_mostly<exclusive_only_mutex>(iterations);
+}
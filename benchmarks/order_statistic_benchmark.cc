@@ -0,0 +1,109 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Compares rank and select queries on a set of sixty-four thousand
+// integers with and without the subtree sizes maintained by
+// b::order_statistic_tree_base, as well as the cost of maintaining
+// the sizes during insertion.
+
+#include <b/order_statistic_tree.h>
+#include <b/set.h>
+
+#include "benchmark.h"
+
+#define ELEMENT_COUNT (64 * 1024)
+#define QUERY_COUNT 1024
+
+typedef b::set<int, b::order_statistic_tree_base> order_statistic_set;
+
+struct order_statistic_input
+{
+	order_statistic_input()
+	{
+		b::pseudorandom prng(42);
+
+		shuffled.alloc_and_copy(ELEMENT_COUNT);
+
+		for (int i = 0; i < ELEMENT_COUNT; ++i)
+			shuffled.append(i * 2);
+
+		shuffled.shuffle(prng);
+
+		for (int i = 0; i < ELEMENT_COUNT; ++i)
+		{
+			plain.insert(shuffled[i]);
+			augmented.insert(shuffled[i]);
+		}
+
+		for (int i = 0; i < QUERY_COUNT; ++i)
+			indices[i] = prng.next(ELEMENT_COUNT);
+	}
+
+	b::array<int> shuffled;
+	b::set<int> plain;
+	order_statistic_set augmented;
+	size_t indices[QUERY_COUNT];
+};
+
+static const order_statistic_input input;
+
+template <class Set>
+static void insert(size_t iterations)
+{
+	while (iterations-- > 0)
+	{
+		Set s;
+
+		for (int i = 0; i < ELEMENT_COUNT; ++i)
+			s.insert(input.shuffled[i]);
+
+		b::benchmark_sink += s.size();
+	}
+}
+
+template <class Set>
+static void select(const Set& s, size_t iterations)
+{
+	while (iterations-- > 0)
+		for (int i = 0; i < QUERY_COUNT; ++i)
+			b::benchmark_sink += (size_t) *s.select(input.indices[i]);
+}
+
+template <class Set>
+static void rank(const Set& s, size_t iterations)
+{
+	while (iterations-- > 0)
+		for (int i = 0; i < QUERY_COUNT; ++i)
+			b::benchmark_sink += s.rank((int) input.indices[i]);
+}
+
+B_BENCHMARK(plain_set_insert)
+{
+	insert<b::set<int> >(iterations);
+}
+
+B_BENCHMARK(order_statistic_set_insert)
+{
+	insert<order_statistic_set>(iterations);
+}
+
+B_BENCHMARK(plain_set_select)
+{
+	select(input.plain, iterations);
+}
+
+B_BENCHMARK(order_statistic_set_select)
+{
+	select(input.augmented, iterations);
+}
+
+B_BENCHMARK(plain_set_rank)
+{
+	rank(input.plain, iterations);
+}
+
+B_BENCHMARK(order_statistic_set_rank)
+{
+	rank(input.augmented, iterations);
+}
@@ -0,0 +1,106 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Sorts and reduces ten million integers using thread pools of
+// one to eight threads to show how the parallel algorithms scale.
+// Concurrency above the number of processors of the machine only
+// adds overhead.
+
+#include <b/parallel.h>
+
+#include "benchmark.h"
+
+#define ELEMENT_COUNT 10000000
+
+struct parallel_input
+{
+	parallel_input()
+	{
+		b::pseudorandom prng(42);
+
+		numbers.alloc_and_copy(ELEMENT_COUNT);
+
+		for (size_t i = 0; i < ELEMENT_COUNT; ++i)
+			numbers.append((int) prng.next());
+	}
+
+	b::array<int> numbers;
+};
+
+static const parallel_input input;
+
+static int buffer[ELEMENT_COUNT];
+
+static void sort(size_t concurrency, size_t iterations)
+{
+	b::thread_pool pool(concurrency);
+
+	while (iterations-- > 0)
+	{
+		b::pause_timing();
+		b::memory::copy(buffer, input.numbers.data(), sizeof(buffer));
+		b::resume_timing();
+
+		b::parallel_sort(&pool, buffer, ELEMENT_COUNT);
+	}
+}
+
+static size_t add(size_t sum, const int& value)
+{
+	return sum + (size_t) value;
+}
+
+static size_t combine(size_t lhs, size_t rhs)
+{
+	return lhs + rhs;
+}
+
+static void reduce(size_t concurrency, size_t iterations)
+{
+	b::thread_pool pool(concurrency);
+
+	while (iterations-- > 0)
+		b::benchmark_sink += b::parallel_reduce(&pool, input.numbers,
+			(size_t) 0, add, combine);
+}
+
+B_BENCHMARK(parallel_sort_1_thread)
+{
+	sort(1, iterations);
+}
+
+B_BENCHMARK(parallel_sort_2_threads)
+{
+	sort(2, iterations);
+}
+
+B_BENCHMARK(parallel_sort_4_threads)
+{
+	sort(4, iterations);
+}
+
+B_BENCHMARK(parallel_sort_8_threads)
+{
+	sort(8, iterations);
+}
+
+B_BENCHMARK(parallel_reduce_1_thread)
+{
+	reduce(1, iterations);
+}
+
+B_BENCHMARK(parallel_reduce_2_threads)
+{
+	reduce(2, iterations);
+}
+
+B_BENCHMARK(parallel_reduce_4_threads)
+{
+	reduce(4, iterations);
+}
+
+B_BENCHMARK(parallel_reduce_8_threads)
+{
+	reduce(8, iterations);
+}
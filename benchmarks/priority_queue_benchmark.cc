@@ -0,0 +1,158 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Pushes a million random keys into a priority queue and pops
+// them all. The swap-based binary heap that priority_queue used
+// before the switch to hole-based d-ary heaps serves as the
+// baseline.
+
+#include <b/priority_queue.h>
+
+#include "benchmark.h"
+
+#define KEY_COUNT 1000000
+
+struct random_keys
+{
+	random_keys()
+	{
+		b::pseudorandom rand(42);
+
+		for (size_t i = 0; i < KEY_COUNT; ++i)
+			keys.append(rand.next());
+	}
+
+	b::array<size_t> keys;
+};
+
+static const random_keys data;
+
+// The original swap-based binary heap.
+struct swap_based_queue
+{
+	void reserve(size_t capacity)
+	{
+		heap.alloc_and_copy(capacity);
+	}
+
+	void push(size_t key)
+	{
+		heap.append(key);
+
+		size_t* h = heap.lock();
+		size_t child = heap.length() - 1, parent;
+
+		while (child > 0 && h[parent = child >> 1] < h[child])
+		{
+			b::swap(h[parent], h[child]);
+			child = parent;
+		}
+
+		heap.unlock();
+	}
+
+	size_t pop()
+	{
+		size_t size = heap.length();
+		size_t* h = heap.lock();
+
+		if (size > 1)
+		{
+			size_t child = 0, parent = size - 1;
+
+			size = parent - 1;
+
+			do
+			{
+				b::swap(h[parent], h[child]);
+				parent = child;
+				child <<= 1;
+
+				if (child > size)
+					break;
+
+				if (child < size && h[child] < h[child + 1])
+					++child;
+			}
+			while (h[parent] < h[child]);
+
+			size += 2;
+		}
+
+		size_t result = h[--size];
+
+		heap.unlock();
+		heap.remove(size);
+
+		return result;
+	}
+
+	b::array<size_t> heap;
+};
+
+template <class Queue>
+static void push_pop(Queue& queue)
+{
+	queue.reserve(KEY_COUNT);
+
+	for (size_t i = 0; i < KEY_COUNT; ++i)
+		queue.push(data.keys[i]);
+
+	for (size_t i = 0; i < KEY_COUNT; ++i)
+		b::benchmark_sink += queue.pop();
+}
+
+B_BENCHMARK(swap_based_binary_heap)
+{
+	while (iterations-- > 0)
+	{
+		swap_based_queue queue;
+
+		push_pop(queue);
+	}
+}
+
+B_BENCHMARK(priority_queue_binary)
+{
+	while (iterations-- > 0)
+	{
+		b::priority_queue<size_t> queue;
+
+		push_pop(queue);
+	}
+}
+
+B_BENCHMARK(priority_queue_4_ary)
+{
+	while (iterations-- > 0)
+	{
+		b::priority_queue<size_t, 4> queue;
+
+		push_pop(queue);
+	}
+}
+
+B_BENCHMARK(priority_queue_4_ary_push_all)
+{
+	while (iterations-- > 0)
+	{
+		b::priority_queue<size_t, 4> queue;
+
+		queue.reserve(KEY_COUNT);
+		queue.push_all(data.keys.data(), KEY_COUNT);
+
+		for (size_t i = 0; i < KEY_COUNT; ++i)
+			b::benchmark_sink += queue.pop();
+	}
+}
+
+B_BENCHMARK(indexed_priority_queue)
+{
+	while (iterations-- > 0)
+	{
+		b::indexed_priority_queue<size_t> queue;
+
+		push_pop(queue);
+	}
+}
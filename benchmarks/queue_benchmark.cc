@@ -0,0 +1,233 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Passes integers between threads through the lock-free queues and,
+// as the baseline, through a ring buffer protected by a mutex. The
+// throughput benchmarks report the time per element for one-to-one,
+// many-to-one, and many-to-many layouts of producers and consumers;
+// the latency benchmarks report the time of a round trip between
+// two threads. Threads yield the processor when the queue is full
+// or empty. The numbers are only meaningful on a machine with at
+// least eight processors.
+
+#include <b/mpmc_queue.h>
+#include <b/spsc_queue.h>
+#include <b/mutex.h>
+
+#include "benchmark.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define QUEUE_CAPACITY 1024
+#define MAX_THREADS 8
+
+// Baseline: the single-producer single-consumer ring buffer
+// made safe for any number of threads by a mutex.
+class locked_queue
+{
+public:
+	explicit locked_queue(size_t min_capacity) : queue(min_capacity)
+	{
+	}
+
+	bool try_push(const size_t& value)
+	{
+		b::mutex_lock lock(queue_mutex);
+
+		return queue.try_push(value);
+	}
+
+	bool try_pop(size_t* value)
+	{
+		b::mutex_lock lock(queue_mutex);
+
+		return queue.try_pop(value);
+	}
+
+private:
+	b::mutex queue_mutex;
+	b::spsc_queue<size_t> queue;
+};
+
+template <class Queue>
+struct transfer
+{
+	Queue* queue;
+	size_t count;
+	size_t sum;
+};
+
+template <class Queue>
+static void* produce(void* arg)
+{
+	transfer<Queue>* t = static_cast<transfer<Queue>*>(arg);
+
+	for (size_t i = 0; i < t->count; ++i)
+		while (!t->queue->try_push(i))
+			sched_yield();
+
+	return NULL;
+}
+
+template <class Queue>
+static void* consume(void* arg)
+{
+	transfer<Queue>* t = static_cast<transfer<Queue>*>(arg);
+
+	size_t value;
+
+	for (size_t i = 0; i < t->count; ++i)
+	{
+		while (!t->queue->try_pop(&value))
+			sched_yield();
+
+		t->sum += value;
+	}
+
+	return NULL;
+}
+
+template <class Queue>
+static void throughput(size_t producers, size_t consumers,
+	size_t iterations)
+{
+	// Make the total divisible by both thread counts.
+	size_t total = (iterations + MAX_THREADS - 1) /
+		MAX_THREADS * MAX_THREADS;
+
+	Queue queue(QUEUE_CAPACITY);
+
+	transfer<Queue> transfers[MAX_THREADS * 2];
+	pthread_t threads[MAX_THREADS * 2];
+
+	size_t thread_count = producers + consumers;
+
+	for (size_t i = 0; i < thread_count; ++i)
+	{
+		transfers[i].queue = &queue;
+		transfers[i].count = total / (i < producers ?
+			producers : consumers);
+		transfers[i].sum = 0;
+
+		pthread_create(threads + i, NULL, i < producers ?
+			produce<Queue> : consume<Queue>, transfers + i);
+	}
+
+	for (size_t i = 0; i < thread_count; ++i)
+	{
+		pthread_join(threads[i], NULL);
+
+		b::benchmark_sink += transfers[i].sum;
+	}
+}
+
+template <class Queue>
+struct round_trip
+{
+	Queue requests;
+	Queue responses;
+	size_t count;
+
+	round_trip(size_t n) :
+		requests(QUEUE_CAPACITY),
+		responses(QUEUE_CAPACITY),
+		count(n)
+	{
+	}
+};
+
+template <class Queue>
+static void* echo(void* arg)
+{
+	round_trip<Queue>* rt = static_cast<round_trip<Queue>*>(arg);
+
+	size_t value;
+
+	for (size_t i = 0; i < rt->count; ++i)
+	{
+		while (!rt->requests.try_pop(&value))
+			sched_yield();
+
+		while (!rt->responses.try_push(value))
+			sched_yield();
+	}
+
+	return NULL;
+}
+
+template <class Queue>
+static void latency(size_t iterations)
+{
+	round_trip<Queue> rt(iterations);
+
+	pthread_t echo_thread;
+
+	pthread_create(&echo_thread, NULL, echo<Queue>, &rt);
+
+	size_t value;
+
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		while (!rt.requests.try_push(i))
+			sched_yield();
+
+		while (!rt.responses.try_pop(&value))
+			sched_yield();
+
+		b::benchmark_sink += value;
+	}
+
+	pthread_join(echo_thread, NULL);
+}
+
+B_BENCHMARK(spsc_queue_1_to_1)
+{
+	throughput<b::spsc_queue<size_t> >(1, 1, iterations);
+}
+
+B_BENCHMARK(mpmc_queue_1_to_1)
+{
+	throughput<b::mpmc_queue<size_t> >(1, 1, iterations);
+}
+
+B_BENCHMARK(locked_queue_1_to_1)
+{
+	throughput<locked_queue>(1, 1, iterations);
+}
+
+B_BENCHMARK(mpmc_queue_4_to_1)
+{
+	throughput<b::mpmc_queue<size_t> >(4, 1, iterations);
+}
+
+B_BENCHMARK(locked_queue_4_to_1)
+{
+	throughput<locked_queue>(4, 1, iterations);
+}
+
+B_BENCHMARK(mpmc_queue_4_to_4)
+{
+	throughput<b::mpmc_queue<size_t> >(4, 4, iterations);
+}
+
+B_BENCHMARK(locked_queue_4_to_4)
+{
+	throughput<locked_queue>(4, 4, iterations);
+}
+
+B_BENCHMARK(spsc_queue_round_trip)
+{
+	latency<b::spsc_queue<size_t> >(iterations);
+}
+
+B_BENCHMARK(mpmc_queue_round_trip)
+{
+	latency<b::mpmc_queue<size_t> >(iterations);
+}
+
+B_BENCHMARK(locked_queue_round_trip)
+{
+	latency<locked_queue>(iterations);
+}
@@ -0,0 +1,126 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Builds, updates, and tears down sets of a quarter million integers
+// whose elements come from the pool owned by the set and, as the
+// baseline, from the heap one element at a time.
+
+#include <b/set.h>
+
+#include "benchmark.h"
+
+#define ELEMENT_COUNT (256 * 1024)
+
+class heap_allocator : public b::allocator
+{
+public:
+	virtual void* allocate(size_t size)
+	{
+		return b::memory::alloc(size);
+	}
+
+	virtual void deallocate(void* block, size_t /*size*/)
+	{
+		b::memory::free(block);
+	}
+};
+
+static heap_allocator heap;
+
+struct set_allocation_input
+{
+	set_allocation_input()
+	{
+		b::pseudorandom prng(42);
+
+		shuffled.alloc_and_copy(ELEMENT_COUNT);
+
+		for (int i = 0; i < ELEMENT_COUNT; ++i)
+			shuffled.append(i);
+
+		shuffled.shuffle(prng);
+	}
+
+	b::array<int> shuffled;
+};
+
+static const set_allocation_input input;
+
+static void build(b::set<int>* s)
+{
+	for (int i = 0; i < ELEMENT_COUNT; ++i)
+		s->insert(input.shuffled[i]);
+}
+
+// Removes and reinserts every element.
+static void churn(b::set<int>* s)
+{
+	for (int i = 0; i < ELEMENT_COUNT; ++i)
+	{
+		s->remove(input.shuffled[i]);
+		s->insert(input.shuffled[i]);
+	}
+}
+
+B_BENCHMARK(heap_set_build_and_destroy)
+{
+	while (iterations-- > 0)
+	{
+		b::set<int> s(&heap);
+
+		build(&s);
+
+		b::benchmark_sink += s.size();
+	}
+}
+
+B_BENCHMARK(pooled_set_build_and_destroy)
+{
+	while (iterations-- > 0)
+	{
+		b::set<int> s;
+
+		build(&s);
+
+		b::benchmark_sink += s.size();
+	}
+}
+
+B_BENCHMARK(pooled_set_reserve_build_and_destroy)
+{
+	while (iterations-- > 0)
+	{
+		b::set<int> s;
+
+		s.reserve(ELEMENT_COUNT);
+
+		build(&s);
+
+		b::benchmark_sink += s.size();
+	}
+}
+
+B_BENCHMARK(heap_set_churn)
+{
+	b::set<int> s(&heap);
+
+	build(&s);
+
+	while (iterations-- > 0)
+		churn(&s);
+
+	b::benchmark_sink += s.size();
+}
+
+B_BENCHMARK(pooled_set_churn)
+{
+	b::set<int> s;
+
+	build(&s);
+
+	while (iterations-- > 0)
+		churn(&s);
+
+	b::benchmark_sink += s.size();
+}
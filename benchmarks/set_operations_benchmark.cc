@@ -0,0 +1,152 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Builds and merges sets of half a million integers with the
+// bulk operations of b::set and, as the baseline, with insertion
+// of one element at a time.
+
+#include <b/set.h>
+
+#include "benchmark.h"
+
+#define ELEMENT_COUNT (512 * 1024)
+
+struct set_operations_input
+{
+	set_operations_input()
+	{
+		b::pseudorandom prng(42);
+
+		even.alloc_and_copy(ELEMENT_COUNT);
+		multiples_of_three.alloc_and_copy(ELEMENT_COUNT);
+		shuffled.alloc_and_copy(ELEMENT_COUNT);
+
+		for (int i = 0; i < ELEMENT_COUNT; ++i)
+		{
+			even.append(i * 2);
+			multiples_of_three.append(i * 3);
+			shuffled.append(i * 3);
+		}
+
+		shuffled.shuffle(prng);
+
+		lhs.assign_sorted(even.data(), ELEMENT_COUNT);
+		rhs.assign_sorted(multiples_of_three.data(), ELEMENT_COUNT);
+	}
+
+	b::array<int> even;
+	b::array<int> multiples_of_three;
+	b::array<int> shuffled;
+	b::set<int> lhs;
+	b::set<int> rhs;
+};
+
+static const set_operations_input input;
+
+B_BENCHMARK(set_build_by_insert)
+{
+	while (iterations-- > 0)
+	{
+		b::set<int> s;
+
+		for (int i = 0; i < ELEMENT_COUNT; ++i)
+			s.insert(input.shuffled[i]);
+
+		b::benchmark_sink += s.size();
+	}
+}
+
+B_BENCHMARK(set_insert_range)
+{
+	while (iterations-- > 0)
+	{
+		b::set<int> s;
+
+		s.insert_range(input.shuffled.data(), ELEMENT_COUNT);
+
+		b::benchmark_sink += s.size();
+	}
+}
+
+B_BENCHMARK(set_assign_sorted)
+{
+	while (iterations-- > 0)
+	{
+		b::set<int> s;
+
+		s.assign_sorted(input.multiples_of_three.data(),
+			ELEMENT_COUNT);
+
+		b::benchmark_sink += s.size();
+	}
+}
+
+B_BENCHMARK(set_union_by_insert)
+{
+	while (iterations-- > 0)
+	{
+		b::pause_timing();
+		b::set<int> s;
+		s.assign_sorted(input.even.data(), ELEMENT_COUNT);
+		b::resume_timing();
+
+		// Random order keeps the non-balancing tree shallow.
+		for (int i = 0; i < ELEMENT_COUNT; ++i)
+		{
+			int value = input.shuffled[i];
+
+			b::set<int>::search_result sr = s.search(value);
+
+			if (sr.match() == NULL)
+				s.insert_new(value, sr);
+		}
+
+		b::benchmark_sink += s.size();
+	}
+}
+
+B_BENCHMARK(set_unite)
+{
+	while (iterations-- > 0)
+	{
+		b::pause_timing();
+		b::set<int> s;
+		s.assign_sorted(input.even.data(), ELEMENT_COUNT);
+		b::resume_timing();
+
+		s.unite(input.rhs);
+
+		b::benchmark_sink += s.size();
+	}
+}
+
+B_BENCHMARK(set_intersect)
+{
+	while (iterations-- > 0)
+	{
+		b::pause_timing();
+		b::set<int> s;
+		s.assign_sorted(input.even.data(), ELEMENT_COUNT);
+		b::resume_timing();
+
+		s.intersect(input.rhs);
+
+		b::benchmark_sink += s.size();
+	}
+}
+
+B_BENCHMARK(set_subtract)
+{
+	while (iterations-- > 0)
+	{
+		b::pause_timing();
+		b::set<int> s;
+		s.assign_sorted(input.even.data(), ELEMENT_COUNT);
+		b::resume_timing();
+
+		s.subtract(input.rhs);
+
+		b::benchmark_sink += s.size();
+	}
+}
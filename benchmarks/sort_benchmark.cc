@@ -0,0 +1,91 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Sorts a million integers arranged in random, ascending,
+// descending, and many-duplicate order using b::sort(),
+// b::stable_sort(), and heapsort() as the baseline.
+
+#include <b/array.h>
+#include <b/heap.h>
+
+#include "benchmark.h"
+
+#define ELEMENT_COUNT 1000000
+
+struct sort_input
+{
+	sort_input()
+	{
+		b::pseudorandom prng(42);
+
+		random.alloc_and_copy(ELEMENT_COUNT);
+		ascending.alloc_and_copy(ELEMENT_COUNT);
+		descending.alloc_and_copy(ELEMENT_COUNT);
+		duplicates.alloc_and_copy(ELEMENT_COUNT);
+
+		for (int i = 0; i < ELEMENT_COUNT; ++i)
+		{
+			random.append((int) prng.next());
+			ascending.append(i);
+			descending.append(ELEMENT_COUNT - i);
+			duplicates.append((int) prng.next(16));
+		}
+	}
+
+	b::array<int> random;
+	b::array<int> ascending;
+	b::array<int> descending;
+	b::array<int> duplicates;
+};
+
+static const sort_input input;
+
+static int buffer[ELEMENT_COUNT];
+
+// Copies the input into the buffer without
+// counting the time spent on copying.
+static void prepare(const b::array<int>& source)
+{
+	b::pause_timing();
+	b::memory::copy(buffer, source.data(), sizeof(buffer));
+	b::resume_timing();
+}
+
+#define SORT_BENCHMARKS(algorithm, call) \
+	B_BENCHMARK(algorithm##_random) \
+	{ \
+		while (iterations-- > 0) \
+		{ \
+			prepare(input.random); \
+			call; \
+		} \
+	} \
+	B_BENCHMARK(algorithm##_ascending) \
+	{ \
+		while (iterations-- > 0) \
+		{ \
+			prepare(input.ascending); \
+			call; \
+		} \
+	} \
+	B_BENCHMARK(algorithm##_descending) \
+	{ \
+		while (iterations-- > 0) \
+		{ \
+			prepare(input.descending); \
+			call; \
+		} \
+	} \
+	B_BENCHMARK(algorithm##_duplicates) \
+	{ \
+		while (iterations-- > 0) \
+		{ \
+			prepare(input.duplicates); \
+			call; \
+		} \
+	}
+
+SORT_BENCHMARKS(sort, b::sort(buffer, ELEMENT_COUNT))
+SORT_BENCHMARKS(stable_sort, b::stable_sort(buffer, ELEMENT_COUNT))
+SORT_BENCHMARKS(heapsort, b::heapsort(buffer, ELEMENT_COUNT))
@@ -0,0 +1,80 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Compares map lookups keyed by strings with lookups keyed by atoms.
+
+#include <b/string_pool.h>
+#include <b/array.h>
+#include <b/map.h>
+
+#include "benchmark.h"
+
+#define KEY_COUNT 4096
+
+static b::string key(int i)
+{
+	return b::string::formatted("configuration.section.key%d", i);
+}
+
+static b::string_pool pool;
+
+struct lookup_data
+{
+	lookup_data()
+	{
+		for (int i = 0; i < KEY_COUNT; ++i)
+		{
+			keys.append(key(i));
+			atoms.append(pool.intern(keys[i]));
+		}
+
+		// Atoms allocated in a row have ascending addresses;
+		// insert them in a shuffled order to keep the
+		// non-balancing tree from degenerating.
+		for (int i = 0; i < KEY_COUNT; ++i)
+		{
+			int j = (int) ((i * 2654435761U) % KEY_COUNT);
+
+			string_map.insert(keys[j], j);
+			atom_map.insert(atoms[j], j);
+		}
+	}
+
+	b::array<b::string> keys;
+	b::array<b::atom> atoms;
+	b::map<b::string, int> string_map;
+	b::map<b::atom, int> atom_map;
+};
+
+static const lookup_data data;
+
+B_BENCHMARK(string_key_lookup)
+{
+	while (iterations-- > 0)
+		b::benchmark_sink += (size_t) *data.string_map.find(
+			data.keys[iterations % KEY_COUNT]);
+}
+
+B_BENCHMARK(atom_key_lookup)
+{
+	while (iterations-- > 0)
+		b::benchmark_sink += (size_t) *data.atom_map.find(
+			data.atoms[iterations % KEY_COUNT]);
+}
+
+B_BENCHMARK(intern_existing)
+{
+	while (iterations-- > 0)
+		b::benchmark_sink += pool.intern(
+			data.keys[iterations % KEY_COUNT]).length();
+}
+
+static b::concurrent_string_pool concurrent_pool;
+
+B_BENCHMARK(concurrent_intern_existing)
+{
+	while (iterations-- > 0)
+		b::benchmark_sink += concurrent_pool.intern(
+			data.keys[iterations % KEY_COUNT]).length();
+}
@@ -0,0 +1,115 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Measures the scheduling overhead of the thread pool with tasks
+// that do almost no work: a recursive Fibonacci computation that
+// spawns a task for each call, and a flat loop that spawns many
+// independent function objects from one thread.
+
+#include <b/thread_pool.h>
+
+#include "benchmark.h"
+
+#define FIBONACCI_ARG 20
+#define FLAT_TASK_COUNT 10000
+
+class fibonacci_task : public b::task
+{
+public:
+	fibonacci_task(b::thread_pool* p, int arg) : pool(p), n(arg), result(0)
+	{
+	}
+
+	virtual void run()
+	{
+		if (n < 2)
+			result = n;
+		else
+		{
+			fibonacci_task t1(pool, n - 1);
+			fibonacci_task t2(pool, n - 2);
+
+			b::task_group group(pool);
+
+			group.run(&t1);
+			t2.run();
+			group.wait();
+
+			result = t1.result + t2.result;
+		}
+	}
+
+	b::thread_pool* pool;
+	int n;
+	int result;
+};
+
+static void fibonacci(size_t concurrency, size_t iterations)
+{
+	b::thread_pool pool(concurrency);
+
+	while (iterations-- > 0)
+	{
+		fibonacci_task fib(&pool, FIBONACCI_ARG);
+
+		b::task_group group(&pool);
+
+		group.run(&fib);
+		group.wait();
+
+		b::benchmark_sink += (size_t) fib.result;
+	}
+}
+
+struct add_one
+{
+	void operator()() const
+	{
+		++*counter;
+	}
+
+	b::atomic* counter;
+};
+
+static void flat_spawn(size_t concurrency, size_t iterations)
+{
+	b::thread_pool pool(concurrency);
+
+	b::atomic counter;
+	counter = 0;
+
+	add_one function = {&counter};
+
+	while (iterations-- > 0)
+	{
+		b::task_group group(&pool);
+
+		for (size_t i = 0; i < FLAT_TASK_COUNT; ++i)
+			group.spawn(function);
+
+		group.wait();
+	}
+
+	b::benchmark_sink += (size_t) (int) counter;
+}
+
+B_BENCHMARK(fibonacci_tasks_1_thread)
+{
+	fibonacci(1, iterations);
+}
+
+B_BENCHMARK(fibonacci_tasks_4_threads)
+{
+	fibonacci(4, iterations);
+}
+
+B_BENCHMARK(flat_spawn_1_thread)
+{
+	flat_spawn(1, iterations);
+}
+
+B_BENCHMARK(flat_spawn_4_threads)
+{
+	flat_spawn(4, iterations);
+}
@@ -0,0 +1,151 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Keeps a million timeouts active. Each operation advances time
+// by one tick, reschedules the timeouts that expired, and resets
+// sixteen random timeouts as if activity was detected on their
+// connections. The timer wheel is compared with an indexed
+// priority queue.
+
+#include <b/timer_wheel.h>
+#include <b/priority_queue.h>
+#include <b/node_access_via_cast.h>
+
+#include "benchmark.h"
+
+#define TIMER_COUNT 1000000
+#define TIME_SPAN 65536
+#define RESETS_PER_TICK 16
+
+struct timer : public b::timer_wheel_node<timer>
+{
+	size_t fire_count;
+};
+
+typedef b::timer_wheel<b::node_access_via_cast<
+	b::timer_wheel_node<timer> > > wheel_type;
+
+static timer timers[TIMER_COUNT];
+
+static b::pseudorandom rand_gen(42);
+
+static size_t random_timeout()
+{
+	return 1 + rand_gen.next(TIME_SPAN);
+}
+
+struct wheel_state
+{
+	wheel_state() : now(0)
+	{
+		for (size_t i = 0; i < TIMER_COUNT; ++i)
+			wheel.schedule(timers + i, random_timeout());
+	}
+
+	wheel_type wheel;
+	size_t now;
+};
+
+B_BENCHMARK(timer_wheel)
+{
+	// Exclude the initial scheduling from the measurement.
+	b::pause_timing();
+	static wheel_state state;
+	b::resume_timing();
+
+	wheel_type::list_type expired;
+
+	while (iterations-- > 0)
+	{
+		size_t now = ++state.now;
+
+		state.wheel.advance(now, &expired);
+
+		timer* t = expired.first();
+
+		expired.empty();
+
+		while (t != NULL)
+		{
+			timer* next = wheel_type::list_type::next(t);
+
+			++t->fire_count;
+			state.wheel.schedule(t, now + random_timeout());
+
+			t = next;
+		}
+
+		for (size_t i = 0; i < RESETS_PER_TICK; ++i)
+			state.wheel.schedule(timers + rand_gen.next(TIMER_COUNT),
+				now + random_timeout());
+	}
+}
+
+// Priority queue entry ordered so that the
+// earliest expiry time has the greatest value.
+struct timeout
+{
+	size_t expiry;
+	timer* t;
+
+	bool operator <(const timeout& rhs) const
+	{
+		return expiry > rhs.expiry;
+	}
+};
+
+typedef b::indexed_priority_queue<timeout> queue_type;
+
+struct queue_state
+{
+	queue_state() : now(0)
+	{
+		queue.reserve(TIMER_COUNT);
+		handles.alloc_and_copy(TIMER_COUNT);
+
+		for (size_t i = 0; i < TIMER_COUNT; ++i)
+		{
+			timeout entry = {random_timeout(), timers + i};
+
+			handles.append(queue.push(entry));
+		}
+	}
+
+	queue_type queue;
+	b::array<queue_type::handle> handles;
+	size_t now;
+};
+
+B_BENCHMARK(indexed_priority_queue)
+{
+	// Exclude the initial scheduling from the measurement.
+	b::pause_timing();
+	static queue_state state;
+	b::resume_timing();
+
+	while (iterations-- > 0)
+	{
+		size_t now = ++state.now;
+
+		while (state.queue.top().expiry <= now)
+		{
+			timeout entry = state.queue.pop();
+
+			++entry.t->fire_count;
+			entry.expiry = now + random_timeout();
+
+			state.handles[entry.t - timers] =
+				state.queue.push(entry);
+		}
+
+		for (size_t i = 0; i < RESETS_PER_TICK; ++i)
+		{
+			size_t index = rand_gen.next(TIMER_COUNT);
+
+			timeout entry = {now + random_timeout(), timers + index};
+
+			state.queue.update(state.handles[index], entry);
+		}
+	}
+}
@@ -0,0 +1,95 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Compares the locale-independent UTF-8 transcoding functions
+// with string::to_wstring() and string::from_wstring(), which
+// rely on the C library and the current locale.
+
+#include <b/string.h>
+
+#include <locale.h>
+
+#include "benchmark.h"
+
+static const char ascii_sample[] =
+	"The quick brown fox jumps over the lazy dog. ";
+
+static const char cyrillic_sample[] =
+	"\xD0\xA1\xD1\x8A\xD0\xB5\xD1\x88\xD1\x8C \xD0\xB6\xD0\xB5 "
+	"\xD0\xB5\xD1\x89\xD1\x91 \xD1\x8D\xD1\x82\xD0\xB8\xD1\x85 "
+	"\xD0\xBC\xD1\x8F\xD0\xB3\xD0\xBA\xD0\xB8\xD1\x85 "
+	"\xD0\xB1\xD1\x83\xD0\xBB\xD0\xBE\xD0\xBA. ";
+
+static const char cjk_sample[] =
+	"\xE6\xBC\xA2\xE5\xAD\x97\xE3\x81\xAF\xE4\xB8\xAD\xE5\x9B\xBD"
+	"\xE3\x81\xA7\xE7\x94\x9F\xE3\x81\xBE\xE3\x82\x8C\xE3\x81\x9F"
+	"\xE6\x96\x87\xE5\xAD\x97\xE3\x81\xA7\xE3\x81\x99\xE3\x80\x82";
+
+static const char mixed_sample[] =
+	"Mixed ASCII, "
+	"\xD0\x9A\xD0\xB8\xD1\x80\xD0\xB8\xD0\xBB\xD0\xBB\xD0\xB8\xD1\x86"
+	"\xD0\xB0, \xE6\xBC\xA2\xE5\xAD\x97 and \xF0\x9F\x98\x80. ";
+
+// Builds a corpus of about 64K bytes by repeating a sample.
+static b::string make_corpus(const char* sample)
+{
+	static const struct utf8_locale
+	{
+		utf8_locale()
+		{
+			setlocale(LC_ALL, "C.UTF-8");
+		}
+	} locale_setter;
+
+	b::string_view sample_view(sample, b::calc_length(sample));
+
+	b::string corpus;
+
+	while (corpus.length() < 65536)
+		corpus.append(sample_view);
+
+	return corpus;
+}
+
+static const b::string ascii_corpus = make_corpus(ascii_sample);
+static const b::string cyrillic_corpus = make_corpus(cyrillic_sample);
+static const b::string cjk_corpus = make_corpus(cjk_sample);
+static const b::string mixed_corpus = make_corpus(mixed_sample);
+
+#define B_UTF8_BENCHMARKS(corpus) \
+	B_BENCHMARK(corpus##_utf8_to_wstring) \
+	{ \
+		while (iterations-- > 0) \
+			b::benchmark_sink += \
+				b::utf8_to_wstring(corpus##_corpus).length(); \
+	} \
+	B_BENCHMARK(corpus##_string_to_wstring) \
+	{ \
+		while (iterations-- > 0) \
+			b::benchmark_sink += \
+				corpus##_corpus.to_wstring().length(); \
+	} \
+	B_BENCHMARK(corpus##_wstring_to_utf8) \
+	{ \
+		b::pause_timing(); \
+		b::wstring wide = b::utf8_to_wstring(corpus##_corpus); \
+		b::resume_timing(); \
+		while (iterations-- > 0) \
+			b::benchmark_sink += \
+				b::wstring_to_utf8(wide).length(); \
+	} \
+	B_BENCHMARK(corpus##_string_from_wstring) \
+	{ \
+		b::pause_timing(); \
+		b::wstring wide = b::utf8_to_wstring(corpus##_corpus); \
+		b::resume_timing(); \
+		while (iterations-- > 0) \
+			b::benchmark_sink += \
+				b::string::from_wstring(wide).length(); \
+	}
+
+B_UTF8_BENCHMARKS(ascii)
+B_UTF8_BENCHMARKS(cyrillic)
+B_UTF8_BENCHMARKS(cjk)
+B_UTF8_BENCHMARKS(mixed)
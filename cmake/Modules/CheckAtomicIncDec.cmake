@@ -40,6 +40,19 @@ int main()
 }
 " B_HAVE_ATOMIC_SYNC)
 
+# Check for __atomic built-ins with explicit memory orders
+check_cxx_source_compiles("
+int main()
+{
+	int val = 0;
+	__atomic_store_n(&val, 1, __ATOMIC_RELEASE);
+	__atomic_fetch_add(&val, 1, __ATOMIC_RELAXED);
+	__atomic_compare_exchange_n(&val, &val, 0, false,
+		__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+	return __atomic_load_n(&val, __ATOMIC_ACQUIRE);
+}
+" B_HAVE_ATOMIC_BUILTINS)
+
 # Check for the __gnu_cxx:: atomic ops in ext/atomicity.h
 check_cxx_source_compiles("
 #include <ext/atomicity.h>
@@ -0,0 +1,200 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_ARENA_H
+#define B_ARENA_H
+
+#include "fn.h"
+
+B_BEGIN_NAMESPACE
+
+// The alignment of the memory blocks returned by arena::allocate(size).
+#define B_ARENA_ALIGNMENT (sizeof(void*) * 2)
+
+// Monotonic allocator. Memory is carved sequentially from large
+// blocks that are chained together; individual allocations are
+// never freed. Instead, all memory allocated after a certain point
+// can be released at once by calling rewind() or reset(), which
+// makes the arena suitable for request-scoped and temporary data.
+//
+// Objects placed in an arena are not destroyed by it; it is up to
+// the caller to run destructors where they are required.
+class arena : public allocator
+{
+public:
+	// Creates an empty arena. No memory is allocated until
+	// the first allocation request. 'block_size' is the size
+	// of the blocks that the arena requests from the heap.
+	// Allocations larger than half of that which do not fit
+	// in the current block get blocks of their own, so that
+	// the rest of the current block is not wasted.
+	explicit arena(size_t block_size = 16384);
+
+	// Allocates 'size' bytes aligned on the B_ARENA_ALIGNMENT
+	// boundary. Throws 'system_exception' if an out-of-memory
+	// condition occurs.
+	virtual void* allocate(size_t size);
+
+	// Allocates 'size' bytes aligned on the 'alignment'
+	// boundary, which must be a power of two.
+	void* allocate(size_t size, size_t alignment);
+
+	// Does nothing: arena memory is released by rewind()
+	// and reset().
+	virtual void deallocate(void* block, size_t size);
+
+	// Position in the arena that it can be rewound to.
+	struct marker
+	{
+		void* block;
+		char* pos;
+		void* large_block;
+	};
+
+	// Returns the current position in the arena.
+	marker mark() const;
+
+	// Releases all memory allocated since the specified marker
+	// was obtained. Markers obtained after 'position' become
+	// invalid.
+	void rewind(const marker& position);
+
+	// Releases all memory allocated from the arena. The first
+	// block is retained for reuse.
+	void reset();
+
+	// Returns the total size of the blocks currently
+	// allocated by the arena.
+	size_t total_bytes() const;
+
+	// Returns the number of bytes allocated from the arena
+	// and not yet released by rewind() or reset(), including
+	// alignment padding.
+	size_t used_bytes() const;
+
+	// Frees all memory allocated by the arena.
+	virtual ~arena();
+
+	// Returns the scratch arena of the calling thread. The
+	// scratch arena is created on first use and destroyed when
+	// the thread exits. Use arena_scope to release temporary
+	// allocations.
+	static arena* scratch();
+
+private:
+	arena(const arena&);
+	arena& operator =(const arena&);
+
+	struct block_header
+	{
+		block_header* prev;
+		size_t size;
+
+		// The number of bytes used in the preceding blocks
+		// of the same chain, including alignment padding.
+		size_t used_before;
+	};
+
+	char* block_start(block_header* block) const;
+
+	void* allocate_from_new_block(size_t size, size_t alignment);
+
+	// Allocates a block that holds a single large allocation.
+	void* allocate_large(size_t size, size_t alignment);
+
+	void free_blocks_until(block_header* last_kept);
+
+	void free_large_blocks_until(block_header* last_kept);
+
+	const size_t default_block_size;
+
+	block_header* current_block;
+	char* pos;
+	char* end;
+
+	// Blocks of large allocations, most recent first.
+	// They are kept apart from the chain of blocks that
+	// smaller allocations are carved from.
+	block_header* large_blocks;
+	size_t large_bytes_used;
+
+	size_t allocated_bytes;
+};
+
+inline arena::arena(size_t block_size) :
+	default_block_size(block_size),
+	current_block(NULL),
+	pos(NULL),
+	end(NULL),
+	large_blocks(NULL),
+	large_bytes_used(0),
+	allocated_bytes(0)
+{
+}
+
+inline void* arena::allocate(size_t size)
+{
+	return allocate(size, B_ARENA_ALIGNMENT);
+}
+
+inline void* arena::allocate(size_t size, size_t alignment)
+{
+	char* result = (char*) memory::align(pos, alignment);
+
+	// Aligning the position can move it past the end
+	// of the block, which is only aligned on the
+	// B_ARENA_ALIGNMENT boundary.
+	if (result == NULL || result > end ||
+			size > (size_t) (end - result))
+		return allocate_from_new_block(size, alignment);
+
+	pos = result + size;
+
+	return result;
+}
+
+inline void arena::deallocate(void* /*block*/, size_t /*size*/)
+{
+}
+
+inline arena::marker arena::mark() const
+{
+	marker position = {current_block, pos, large_blocks};
+
+	return position;
+}
+
+inline size_t arena::total_bytes() const
+{
+	return allocated_bytes;
+}
+
+// Restores the arena to its state at the time of construction
+// of this object, releasing all memory allocated in between.
+class arena_scope
+{
+public:
+	// Remembers the current position in 'a'.
+	explicit arena_scope(arena* a) : scoped_arena(a),
+		position(a->mark())
+	{
+	}
+
+	// Rewinds the arena to the remembered position.
+	~arena_scope()
+	{
+		scoped_arena->rewind(position);
+	}
+
+private:
+	arena_scope(const arena_scope&);
+	arena_scope& operator =(const arena_scope&);
+
+	arena* scoped_arena;
+	arena::marker position;
+};
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_ARENA_H) */
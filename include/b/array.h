@@ -6,7 +6,7 @@
 #define B_ARRAY_H
 
 #include "array_slice.h"
-#include "fn.h"
+#include "sort.h"
 
 B_BEGIN_NAMESPACE
 
@@ -192,6 +192,17 @@ public:
 	// number generator.
 	void shuffle(pseudorandom& prng);
 
+	// Sorts the array using b::sort() and a three-way comparison
+	// function with the same semantics as b::compare(). Pass
+	// b::compare<T> to sort the elements in ascending order.
+	template <class Compare>
+	void sort(Compare cmp);
+
+	// Same as sort(), but preserves the relative order
+	// of equal elements.
+	template <class Compare>
+	void stable_sort(Compare cmp);
+
 	template<class D>
 	T join(const D& delim);
 
@@ -868,6 +879,24 @@ void array<T>::shuffle(pseudorandom& prng)
 	shuffle_array(elements, length(), prng);
 }
 
+template <class T>
+template <class Compare>
+void array<T>::sort(Compare cmp)
+{
+	isolate();
+
+	b::sort(elements, length(), cmp);
+}
+
+template <class T>
+template <class Compare>
+void array<T>::stable_sort(Compare cmp)
+{
+	isolate();
+
+	b::stable_sort(elements, length(), cmp);
+}
+
 template <class T>
 template<class D>
 T array<T>::join(const D& delim)
@@ -21,26 +21,30 @@ B_END_NAMESPACE
 
 #else
 
-B_BEGIN_NAMESPACE
-
 #if defined(B_HAVE_EXT_ATOMICITY_H)
-
 #include <ext/atomicity.h>
-typedef volatile _Atomic_word platform_atomic_type;
-
 #elif defined(B_HAVE_BITS_ATOMICITY_H)
-
 #include <bits/atomicity.h>
+#elif defined(B_HAVE_ASM_ATOMIC_H)
+#include <asm/atomic.h>
+#elif defined(__DECCXX_VER) && defined(__ALPHA)
+#include <machine/builtins.h>
+#elif !defined(B_HAVE_ATOMIC_SYNC) && defined(__APPLE__)
+#include <libkern/OSAtomic.h>
+#endif
+
+B_BEGIN_NAMESPACE
+
+#if defined(B_HAVE_EXT_ATOMICITY_H) || defined(B_HAVE_BITS_ATOMICITY_H)
+
 typedef volatile _Atomic_word platform_atomic_type;
 
 #elif defined(B_HAVE_ASM_ATOMIC_H)
 
-#include <asm/atomic.h>
 typedef atomic_t platform_atomic_type;
 
 #elif defined(__DECCXX_VER) && defined(__ALPHA)
 
-#include <machine/builtins.h>
 typedef __int32 platform_atomic_type;
 
 #elif defined(B_HAVE_ATOMIC_SYNC)
@@ -49,7 +53,6 @@ typedef int platform_atomic_type;
 
 #elif defined(__APPLE__)
 
-#include <libkern/OSAtomic.h>
 typedef int32_t platform_atomic_type;
 #define B_USE_ATOMIC_INC_DEC_BARRIER
 
@@ -78,7 +81,7 @@ struct atomic
 inline atomic::operator int() const
 {
 #if defined(B_HAVE_ASM_ATOMIC_H)
-	return atomic_read(&value)
+	return atomic_read(&value);
 #else
 	return (int) value;
 #endif
@@ -143,4 +146,294 @@ B_END_NAMESPACE
 
 #endif /* !defined(B_HAVE_STD_ATOMIC) */
 
+// Select the implementation of 'atomic_value'. The choice depends
+// only on the configuration of the library and not on the language
+// standard of the translation unit, so that the library and its
+// clients agree on the layout of the template. The GCC __atomic
+// built-ins are preferred to __sync because they support memory
+// orders weaker than a full barrier. The atomicity headers offer
+// no compare-and-swap, so they cannot implement the template.
+// std::atomic is the last resort for compilers that support
+// neither kind of built-ins; the library must then be built
+// as C++11 as well.
+#if defined(B_HAVE_ATOMIC_BUILTINS)
+#define B_ATOMIC_VALUE_BUILTINS
+#elif defined(B_HAVE_ATOMIC_SYNC)
+#define B_ATOMIC_VALUE_SYNC
+#elif defined(B_HAVE_STD_ATOMIC) && __cplusplus >= 201103L
+#define B_ATOMIC_VALUE_STD
+#else
+#error atomic_value has to be implemented for this platform
+#endif
+
+B_BEGIN_NAMESPACE
+
+// Constraints on the ordering of memory accesses around an atomic
+// operation. They have the same meaning as in the C++11 memory model.
+enum memory_order
+{
+#if defined(B_ATOMIC_VALUE_BUILTINS)
+	memory_order_relaxed = __ATOMIC_RELAXED,
+	memory_order_acquire = __ATOMIC_ACQUIRE,
+	memory_order_release = __ATOMIC_RELEASE,
+	memory_order_acq_rel = __ATOMIC_ACQ_REL,
+	memory_order_seq_cst = __ATOMIC_SEQ_CST
+#else
+	memory_order_relaxed,
+	memory_order_acquire,
+	memory_order_release,
+	memory_order_acq_rel,
+	memory_order_seq_cst
+#endif /* defined(B_ATOMIC_VALUE_BUILTINS) */
+};
+
+// Variable of an integral or pointer type that can be accessed
+// by concurrent threads without a lock. Every operation takes
+// an optional memory order, which defaults to the strongest one.
+//
+// fetch_add() and fetch_sub() are only defined for integral types.
+template <class T>
+class atomic_value
+{
+public:
+	// Initializes the variable with zero.
+	atomic_value();
+
+	// Initializes the variable with the specified value.
+	explicit atomic_value(T initial_value);
+
+	// Returns the current value. The order must be relaxed,
+	// acquire, or sequentially consistent.
+	T load(memory_order order = memory_order_seq_cst) const;
+
+	// Replaces the value. The order must be relaxed, release,
+	// or sequentially consistent.
+	void store(T new_value, memory_order order = memory_order_seq_cst);
+
+	// Replaces the value and returns the previous one.
+	T exchange(T new_value, memory_order order = memory_order_seq_cst);
+
+	// Replaces the value with 'desired' if it is equal to
+	// '*expected' and returns true. Otherwise, stores the
+	// current value in '*expected' and returns false.
+	bool compare_exchange(T* expected, T desired,
+		memory_order order = memory_order_seq_cst);
+
+	// Adds 'operand' to the value and returns the previous value.
+	T fetch_add(T operand, memory_order order = memory_order_seq_cst);
+
+	// Subtracts 'operand' from the value and returns
+	// the previous value.
+	T fetch_sub(T operand, memory_order order = memory_order_seq_cst);
+
+private:
+	atomic_value(const atomic_value&);
+	atomic_value& operator =(const atomic_value&);
+
+#if defined(B_ATOMIC_VALUE_STD)
+	static std::memory_order std_order(memory_order order);
+
+	std::atomic<T> value;
+#else
+	volatile T value;
+#endif /* defined(B_ATOMIC_VALUE_STD) */
+};
+
+#if defined(B_ATOMIC_VALUE_STD)
+
+template <class T>
+inline std::memory_order atomic_value<T>::std_order(memory_order order)
+{
+	switch (order)
+	{
+	case memory_order_relaxed:
+		return std::memory_order_relaxed;
+	case memory_order_acquire:
+		return std::memory_order_acquire;
+	case memory_order_release:
+		return std::memory_order_release;
+	case memory_order_acq_rel:
+		return std::memory_order_acq_rel;
+	default:
+		return std::memory_order_seq_cst;
+	}
+}
+
+template <class T>
+inline atomic_value<T>::atomic_value() : value(T())
+{
+}
+
+template <class T>
+inline atomic_value<T>::atomic_value(T initial_value) : value(initial_value)
+{
+}
+
+template <class T>
+inline T atomic_value<T>::load(memory_order order) const
+{
+	return value.load(std_order(order));
+}
+
+template <class T>
+inline void atomic_value<T>::store(T new_value, memory_order order)
+{
+	value.store(new_value, std_order(order));
+}
+
+template <class T>
+inline T atomic_value<T>::exchange(T new_value, memory_order order)
+{
+	return value.exchange(new_value, std_order(order));
+}
+
+template <class T>
+inline bool atomic_value<T>::compare_exchange(T* expected, T desired,
+	memory_order order)
+{
+	return value.compare_exchange_strong(*expected, desired,
+		std_order(order));
+}
+
+template <class T>
+inline T atomic_value<T>::fetch_add(T operand, memory_order order)
+{
+	return value.fetch_add(operand, std_order(order));
+}
+
+template <class T>
+inline T atomic_value<T>::fetch_sub(T operand, memory_order order)
+{
+	return value.fetch_sub(operand, std_order(order));
+}
+
+#else
+
+template <class T>
+inline atomic_value<T>::atomic_value() : value(T())
+{
+}
+
+template <class T>
+inline atomic_value<T>::atomic_value(T initial_value) : value(initial_value)
+{
+}
+
+#if defined(B_ATOMIC_VALUE_BUILTINS)
+
+template <class T>
+inline T atomic_value<T>::load(memory_order order) const
+{
+	return __atomic_load_n(&value, order);
+}
+
+template <class T>
+inline void atomic_value<T>::store(T new_value, memory_order order)
+{
+	__atomic_store_n(&value, new_value, order);
+}
+
+template <class T>
+inline T atomic_value<T>::exchange(T new_value, memory_order order)
+{
+	return __atomic_exchange_n(&value, new_value, order);
+}
+
+template <class T>
+inline bool atomic_value<T>::compare_exchange(T* expected, T desired,
+	memory_order order)
+{
+	// The failure order may not include a release.
+	return __atomic_compare_exchange_n(&value, expected, desired, false,
+		order, order == memory_order_seq_cst ? memory_order_seq_cst :
+		order == memory_order_relaxed || order == memory_order_release ?
+			memory_order_relaxed : memory_order_acquire);
+}
+
+template <class T>
+inline T atomic_value<T>::fetch_add(T operand, memory_order order)
+{
+	return __atomic_fetch_add(&value, operand, order);
+}
+
+template <class T>
+inline T atomic_value<T>::fetch_sub(T operand, memory_order order)
+{
+	return __atomic_fetch_sub(&value, operand, order);
+}
+
+#else
+
+// The __sync built-ins are full barriers, so the memory
+// order is only used to skip the barriers of plain loads
+// and stores where they are not needed.
+
+template <class T>
+inline T atomic_value<T>::load(memory_order order) const
+{
+	if (order == memory_order_seq_cst)
+		__sync_synchronize();
+
+	T result = value;
+
+	if (order != memory_order_relaxed)
+		__sync_synchronize();
+
+	return result;
+}
+
+template <class T>
+inline void atomic_value<T>::store(T new_value, memory_order order)
+{
+	if (order != memory_order_relaxed)
+		__sync_synchronize();
+
+	value = new_value;
+
+	if (order == memory_order_seq_cst)
+		__sync_synchronize();
+}
+
+template <class T>
+inline T atomic_value<T>::exchange(T new_value, memory_order order)
+{
+	// __sync_lock_test_and_set() is only an acquire barrier.
+	if (order != memory_order_relaxed && order != memory_order_acquire)
+		__sync_synchronize();
+
+	return __sync_lock_test_and_set(&value, new_value);
+}
+
+template <class T>
+inline bool atomic_value<T>::compare_exchange(T* expected, T desired,
+	memory_order /*order*/)
+{
+	T old_value = __sync_val_compare_and_swap(&value, *expected, desired);
+
+	if (old_value == *expected)
+		return true;
+
+	*expected = old_value;
+
+	return false;
+}
+
+template <class T>
+inline T atomic_value<T>::fetch_add(T operand, memory_order /*order*/)
+{
+	return __sync_fetch_and_add(&value, operand);
+}
+
+template <class T>
+inline T atomic_value<T>::fetch_sub(T operand, memory_order /*order*/)
+{
+	return __sync_fetch_and_sub(&value, operand);
+}
+
+#endif /* defined(B_ATOMIC_VALUE_BUILTINS) */
+
+#endif /* defined(B_ATOMIC_VALUE_STD) */
+
+B_END_NAMESPACE
+
 #endif /* !defined(B_ATOMIC_H) */
@@ -0,0 +1,258 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_ATOMIC_REF_H
+#define B_ATOMIC_REF_H
+
+#include "shared_object.h"
+
+#include <stdint.h>
+
+B_BEGIN_NAMESPACE
+
+// Smart pointer that can be read and replaced by multiple threads
+// at the same time, for example, to publish a new version of a
+// configuration object while other threads keep using the old one.
+// 'T' must be derived from 'shared_object'.
+//
+// A reader cannot simply copy the pointer and increment the
+// reference count of the object, because the object may be released
+// and deleted in between. Instead, the pointer is combined with a
+// counter of references borrowed by the readers (a split reference
+// count). A reader increments the counter together with loading
+// the pointer, which keeps the object alive, acquires a proper
+// reference, and then returns the borrowed one. A writer that
+// replaces the pointer converts the references that are still
+// borrowed into proper ones, which the readers release when they
+// find out that the pointer has changed.
+//
+// On 64-bit platforms, the counter occupies the upper 16 bits of
+// the pointer, which assumes that addresses fit in 48 bits, as they
+// do in the user space of the common 64-bit processors.
+template <class T>
+class atomic_ref
+{
+public:
+	// Constructs a null pointer.
+	atomic_ref();
+
+	// Initializes this instance with a reference to 'obj_ptr'.
+	explicit atomic_ref(T* obj_ptr);
+
+	// Returns a reference to the current object.
+	ref<T> load() const;
+
+	// Replaces the current object with 'new_ref'.
+	void store(const ref<T>& new_ref);
+
+	// Replaces the current object with 'new_ref' and
+	// returns the previous one.
+	ref<T> exchange(const ref<T>& new_ref);
+
+	// Replaces the current object with 'desired' if it is the
+	// object pointed to by '*expected'. Otherwise, loads the
+	// current object into '*expected'. Returns true if the
+	// object has been replaced.
+	bool compare_exchange(ref<T>* expected, const ref<T>& desired);
+
+	// Releases the current object. No other thread may
+	// access this instance at this point.
+	~atomic_ref();
+
+private:
+	atomic_ref(const atomic_ref&);
+	atomic_ref& operator =(const atomic_ref&);
+
+	// The pointer occupies the lower 'pointer_bits' bits and
+	// the number of borrowed references occupies the rest.
+	// The counter must not overflow into the next bit, which
+	// limits the number of concurrent load() calls on the same
+	// instance to fewer than 65536 on 64-bit platforms.
+#if B_SIZEOF_SIZE_T == 8
+	typedef size_t counted_pointer;
+
+	enum {pointer_bits = 48};
+#else
+	typedef uint64_t counted_pointer;
+
+	enum {pointer_bits = 32};
+#endif /* B_SIZEOF_SIZE_T == 8 */
+
+	// Converts a pointer that is being stored in this instance.
+	static counted_pointer counted(T* obj_ptr);
+
+	static T* pointer_part(counted_pointer value);
+
+	static size_t borrowed_part(counted_pointer value);
+
+	static counted_pointer one_borrowed();
+
+	// Turns the references borrowed from a replaced
+	// 'value' into proper references.
+	static void convert_borrowed(counted_pointer value);
+
+	// Returns the reference borrowed by load().
+	void give_back(T* obj_ptr) const;
+
+	mutable atomic_value<counted_pointer> value;
+};
+
+template <class T>
+inline typename atomic_ref<T>::counted_pointer atomic_ref<T>::counted(
+	T* obj_ptr)
+{
+	counted_pointer v = (counted_pointer) (size_t) obj_ptr;
+
+	B_ASSERT((v >> pointer_bits) == 0);
+
+	return v;
+}
+
+template <class T>
+inline T* atomic_ref<T>::pointer_part(counted_pointer v)
+{
+	return (T*) (size_t) (v & (((counted_pointer) 1 << pointer_bits) - 1));
+}
+
+template <class T>
+inline size_t atomic_ref<T>::borrowed_part(counted_pointer v)
+{
+	return (size_t) (v >> pointer_bits);
+}
+
+template <class T>
+inline typename atomic_ref<T>::counted_pointer atomic_ref<T>::one_borrowed()
+{
+	return (counted_pointer) 1 << pointer_bits;
+}
+
+template <class T>
+inline atomic_ref<T>::atomic_ref()
+{
+}
+
+template <class T>
+atomic_ref<T>::atomic_ref(T* obj_ptr) : value(counted(obj_ptr))
+{
+	if (obj_ptr != NULL)
+		obj_ptr->add_ref();
+}
+
+template <class T>
+void atomic_ref<T>::convert_borrowed(counted_pointer v)
+{
+	T* obj_ptr = pointer_part(v);
+
+	if (obj_ptr != NULL)
+		for (size_t borrowed = borrowed_part(v); borrowed > 0; --borrowed)
+			obj_ptr->add_ref();
+}
+
+template <class T>
+void atomic_ref<T>::give_back(T* obj_ptr) const
+{
+	counted_pointer v = value.load(memory_order_relaxed);
+
+	// The reference cannot be given back once the pointer has
+	// been replaced: the writer has converted it into a proper
+	// one, which must be released instead. The release ordering
+	// makes the proper reference acquired by the reader visible
+	// to the writer that reads the returned counter.
+	while (pointer_part(v) == obj_ptr && borrowed_part(v) > 0)
+		if (value.compare_exchange(&v, v - one_borrowed(),
+				memory_order_release))
+			return;
+
+	if (obj_ptr != NULL)
+		obj_ptr->release();
+}
+
+template <class T>
+ref<T> atomic_ref<T>::load() const
+{
+	// The acquire ordering makes the contents of
+	// the object stored by the writer visible.
+	T* obj_ptr = pointer_part(value.fetch_add(one_borrowed(),
+		memory_order_acquire));
+
+	ref<T> result(obj_ptr);
+
+	give_back(obj_ptr);
+
+	return result;
+}
+
+template <class T>
+ref<T> atomic_ref<T>::exchange(const ref<T>& new_ref)
+{
+	T* new_ptr = new_ref.ptr();
+
+	if (new_ptr != NULL)
+		new_ptr->add_ref();
+
+	counted_pointer old_value = value.exchange(counted(new_ptr),
+		memory_order_acq_rel);
+
+	convert_borrowed(old_value);
+
+	// The reference held by this instance passes to the caller.
+	ref<T> result;
+
+	result.attach(pointer_part(old_value));
+
+	return result;
+}
+
+template <class T>
+inline void atomic_ref<T>::store(const ref<T>& new_ref)
+{
+	exchange(new_ref);
+}
+
+template <class T>
+bool atomic_ref<T>::compare_exchange(ref<T>* expected, const ref<T>& desired)
+{
+	T* expected_ptr = expected->ptr();
+	T* desired_ptr = desired.ptr();
+
+	if (desired_ptr != NULL)
+		desired_ptr->add_ref();
+
+	counted_pointer desired_value = counted(desired_ptr);
+	counted_pointer v = value.load(memory_order_relaxed);
+
+	// Retry while only the number of borrowed references changes.
+	while (pointer_part(v) == expected_ptr)
+		if (value.compare_exchange(&v, desired_value,
+				memory_order_acq_rel))
+		{
+			convert_borrowed(v);
+
+			// '*expected' keeps the replaced object alive.
+			if (expected_ptr != NULL)
+				expected_ptr->release();
+
+			return true;
+		}
+
+	if (desired_ptr != NULL)
+		desired_ptr->release();
+
+	*expected = load();
+
+	return false;
+}
+
+template <class T>
+atomic_ref<T>::~atomic_ref()
+{
+	T* obj_ptr = pointer_part(value.load(memory_order_acquire));
+
+	if (obj_ptr != NULL)
+		obj_ptr->release();
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_ATOMIC_REF_H) */
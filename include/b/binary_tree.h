@@ -39,6 +39,8 @@ inline binary_tree_node* binary_tree_node::prev()
 // Non-template base class for the 'binary_search_tree' template.
 struct binary_search_tree_base
 {
+	typedef binary_tree_node node_type;
+
 	binary_tree_node* root;
 	binary_tree_node* leftmost;
 	binary_tree_node* rightmost;
@@ -57,14 +59,34 @@ struct binary_search_tree_base
 	void insert_after_search(binary_tree_node* node,
 		binary_tree_node* parent, int cmp_result);
 
+	// Replaces the contents of this tree with 'count' detached
+	// nodes, which must be sorted by key, and links them into
+	// a perfectly balanced tree in linear time. The nodes that
+	// were in the tree before are not freed.
+	void build_from_sorted(binary_tree_node** nodes, size_t count);
+
 	void remove(binary_tree_node* node);
+
+	// Returns the node at position 'index' in key order or
+	// NULL if 'index' is out of range. The tree keeps no
+	// subtree sizes, so this walks the nodes from the nearest
+	// end of the tree and takes linear time.
+	binary_tree_node* select(size_t index) const;
+
+	// Returns the number of nodes that precede 'node' in key
+	// order. Takes linear time for the same reason.
+	size_t rank(const binary_tree_node* node) const;
 };
 
 // A non-balancing binary search tree. This is a low-level structure
 // that exposes its internals. It is not meant for routine use.
 // The 'set' and 'map' containers must be used instead.
-template <class Key_op>
-struct binary_search_tree : public binary_search_tree_base
+//
+// 'Base' provides the node type and the operations that modify
+// the structure of the tree. It can be replaced to maintain
+// additional data in the nodes (see order_statistic_tree.h).
+template <class Key_op, class Base = binary_search_tree_base>
+struct binary_search_tree : public Base
 {
 	Key_op key_for_node;
 
@@ -75,7 +97,7 @@ struct binary_search_tree : public binary_search_tree_base
 	template <class Key>
 	binary_tree_node* find(const Key& key) const
 	{
-		for (binary_tree_node* node = root; node != NULL; )
+		for (binary_tree_node* node = this->root; node != NULL; )
 			if (key < key_for_node(node))
 				node = node->left;
 			else
@@ -92,10 +114,10 @@ struct binary_search_tree : public binary_search_tree_base
 	{
 		*cmp_result = 0;
 
-		if (root == NULL)
+		if (this->root == NULL)
 			return NULL;
 
-		for (binary_tree_node* node = root; ; )
+		for (binary_tree_node* node = this->root; ; )
 			if (key < key_for_node(node))
 				if (node->left != NULL)
 					node = node->left;
@@ -124,7 +146,26 @@ struct binary_search_tree : public binary_search_tree_base
 		binary_tree_node* parent =
 			search(key_for_node(node), &cmp_result);
 
-		insert_after_search(node, parent, cmp_result);
+		this->insert_after_search(node, parent, cmp_result);
+	}
+
+	// Returns the number of nodes whose keys are less than 'key'.
+	template <class Key>
+	size_t rank(const Key& key) const
+	{
+		const binary_tree_node* lower_bound = NULL;
+
+		for (const binary_tree_node* node = this->root; node != NULL; )
+			if (key_for_node(node) < key)
+				node = node->right;
+			else
+			{
+				lower_bound = node;
+				node = node->left;
+			}
+
+		return lower_bound == NULL ? this->number_of_nodes :
+			Base::rank(lower_bound);
 	}
 };
 
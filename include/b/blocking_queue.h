@@ -0,0 +1,169 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_BLOCKING_QUEUE_H
+#define B_BLOCKING_QUEUE_H
+
+#include "mutex.h"
+#include "atomic.h"
+
+B_BEGIN_NAMESPACE
+
+// The number of times that blocking_queue retries a full or
+// empty queue before the calling thread goes to sleep.
+#define B_BLOCKING_QUEUE_SPIN_COUNT 100
+
+// Adds blocking push() and pop() operations to a bounded lock-free
+// queue, such as 'mpmc_queue' or 'spsc_queue'. A thread that finds
+// the queue full or empty spins for a while and then sleeps until
+// the other side makes progress. As long as nobody sleeps, the
+// operations cost one extra atomic read-modify-write on top of
+// the underlying queue.
+//
+// The threading restrictions of the underlying queue apply.
+template <class Queue>
+class blocking_queue
+{
+public:
+	typedef typename Queue::value_type value_type;
+
+	// Creates an empty queue that can hold at least
+	// 'min_capacity' elements.
+	explicit blocking_queue(size_t min_capacity);
+
+	// Returns the maximum number of elements in the queue.
+	size_t capacity() const;
+
+	// Appends a copy of 'value' to the queue. Returns false
+	// if the queue is full.
+	bool try_push(const value_type& value);
+
+	// Appends a copy of 'value' to the queue, waiting while
+	// the queue is full.
+	void push(const value_type& value);
+
+	// Removes the oldest element from the queue. Returns false
+	// if the queue is empty.
+	bool try_pop(value_type* value);
+
+	// Removes the oldest element from the queue, waiting while
+	// the queue is empty.
+	void pop(value_type* value);
+
+private:
+	blocking_queue(const blocking_queue&);
+	blocking_queue& operator =(const blocking_queue&);
+
+	// Wakes up a thread waiting on 'wait_condition' if
+	// 'waiter_count' is not zero.
+	void notify(atomic_value<size_t>* waiter_count,
+		condition* wait_condition);
+
+	Queue queue;
+
+	mutex wait_mutex;
+
+	atomic_value<size_t> waiting_producers;
+	condition not_full;
+
+	atomic_value<size_t> waiting_consumers;
+	condition not_empty;
+};
+
+template <class Queue>
+blocking_queue<Queue>::blocking_queue(size_t min_capacity) :
+	queue(min_capacity)
+{
+}
+
+template <class Queue>
+inline size_t blocking_queue<Queue>::capacity() const
+{
+	return queue.capacity();
+}
+
+template <class Queue>
+void blocking_queue<Queue>::notify(atomic_value<size_t>* waiter_count,
+	condition* wait_condition)
+{
+	// A read-modify-write rather than a load guarantees that
+	// either this thread sees the waiter or the waiter sees
+	// the change made to the queue before this call: the
+	// waiter registers itself with a read-modify-write of
+	// the same variable before it checks the queue.
+	if (waiter_count->fetch_add(0) != 0)
+	{
+		mutex_lock lock(wait_mutex);
+
+		wait_condition->signal();
+	}
+}
+
+template <class Queue>
+bool blocking_queue<Queue>::try_push(const value_type& value)
+{
+	if (!queue.try_push(value))
+		return false;
+
+	notify(&waiting_consumers, &not_empty);
+
+	return true;
+}
+
+template <class Queue>
+void blocking_queue<Queue>::push(const value_type& value)
+{
+	for (int spin = 0; spin < B_BLOCKING_QUEUE_SPIN_COUNT; ++spin)
+		if (try_push(value))
+			return;
+
+	{
+		mutex_lock lock(wait_mutex);
+
+		waiting_producers.fetch_add(1);
+
+		while (!queue.try_push(value))
+			not_full.wait(wait_mutex);
+
+		waiting_producers.fetch_sub(1);
+	}
+
+	notify(&waiting_consumers, &not_empty);
+}
+
+template <class Queue>
+bool blocking_queue<Queue>::try_pop(value_type* value)
+{
+	if (!queue.try_pop(value))
+		return false;
+
+	notify(&waiting_producers, &not_full);
+
+	return true;
+}
+
+template <class Queue>
+void blocking_queue<Queue>::pop(value_type* value)
+{
+	for (int spin = 0; spin < B_BLOCKING_QUEUE_SPIN_COUNT; ++spin)
+		if (try_pop(value))
+			return;
+
+	{
+		mutex_lock lock(wait_mutex);
+
+		waiting_consumers.fetch_add(1);
+
+		while (!queue.try_pop(value))
+			not_empty.wait(wait_mutex);
+
+		waiting_consumers.fetch_sub(1);
+	}
+
+	notify(&waiting_producers, &not_full);
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_BLOCKING_QUEUE_H) */
@@ -0,0 +1,999 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_BTREE_MAP_H
+#define B_BTREE_MAP_H
+
+#include "flat_map.h"
+
+B_BEGIN_NAMESPACE
+
+// The approximate size of a B+tree node in bytes. A node spans
+// a few cache lines: the tree stays shallow, while a search within
+// a node still touches a small number of adjacent lines.
+#define B_BTREE_NODE_SIZE 256
+
+// Ordered associative array with unique keys for large data sets.
+//
+// The elements are stored in the leaves of a B+tree, many elements
+// per leaf, and the leaves are linked in key order. Compared to
+// 'map', which allocates a node with three pointers for every
+// element, the tree takes less memory, a lookup visits a few nodes
+// instead of a few dozen, and iteration over a range of keys is
+// a mostly sequential scan.
+//
+// Insertion and removal invalidate the pointers to the elements
+// and the iterators.
+template <class Key, class T>
+class btree_map
+{
+public:
+	typedef kv_pair<Key, T> value_type;
+
+	// Creates an empty map.
+	btree_map();
+
+	// Returns true if this map is empty.
+	bool is_empty() const;
+
+	// Returns the number of elements in this map.
+	size_t size() const;
+
+	// Finds the value that matches the specified key.
+	// Returns NULL if there is no match.
+	template <class Search_key>
+	T* find(const Search_key& key) const;
+
+	// Adds the specified key-value pair to this map.
+	//
+	// If an element with the same key already exists,
+	// its value is overwritten with the specified value.
+	//
+	// The method returns a pointer to the stored map element.
+	value_type* insert(const Key& key, const T& value);
+
+	// Adds the specified key-value pair to this map.
+	//
+	// If an element with the same key already exists,
+	// its value is overwritten with the specified value.
+	//
+	// The method returns a pointer to the stored map element
+	// and sets 'new_element' to true or false, depending on
+	// whether an insertion or a replacement has occurred.
+	value_type* insert(const Key& key, const T& value,
+			bool* new_inserted);
+
+	// Removes the element that matches the specified key.
+	// Returns true if the element was found and deleted.
+	template <class Search_key>
+	bool remove(const Search_key& key);
+
+	// Replaces the contents of this map with 'count' elements
+	// sorted by key in strictly ascending order. The tree is
+	// built bottom-up in linear time.
+	void assign_sorted(const value_type* sorted, size_t count);
+
+	// Returns a pointer to the first element or NULL if there are
+	// no elements.
+	const value_type* first() const;
+
+	// Returns a pointer to the first element or NULL if there are
+	// no elements.
+	value_type* first();
+
+	// Returns a pointer to the last element or NULL if there are
+	// no elements.
+	const value_type* last() const;
+
+	// Returns a pointer to the last element or NULL if there are
+	// no elements.
+	value_type* last();
+
+	// Bidirectional const iterator type.
+	struct const_iterator;
+
+	// Starts forward iteration.
+	const_iterator begin() const;
+
+	// Marks the end of forward iteration.
+	const_iterator end() const;
+
+	// Returns an iterator pointing to the first element whose
+	// key is not less than 'key'. Use it to scan a range of keys.
+	template <class Search_key>
+	const_iterator lower_bound(const Search_key& key) const;
+
+	~btree_map();
+
+private:
+	btree_map(const btree_map&);
+	btree_map& operator =(const btree_map&);
+
+	enum
+	{
+		leaf_capacity = B_BTREE_NODE_SIZE / sizeof(value_type) > 4 ?
+			B_BTREE_NODE_SIZE / sizeof(value_type) : 4,
+		inner_capacity = B_BTREE_NODE_SIZE /
+			(sizeof(Key) + sizeof(void*)) > 4 ?
+			B_BTREE_NODE_SIZE / (sizeof(Key) + sizeof(void*)) : 4,
+		min_leaf_count = leaf_capacity / 2,
+		min_inner_count = inner_capacity / 2
+	};
+
+	struct node
+	{
+		// The number of elements in a leaf or
+		// the number of keys in an inner node.
+		size_t count;
+
+		bool is_leaf;
+	};
+
+	// Leaf nodes are allocated with room for one element more
+	// than the capacity, so that an overflowing leaf can be
+	// split after the insertion.
+	struct leaf_node : public node
+	{
+		leaf_node* prev;
+		leaf_node* next;
+
+		value_type first_element;
+
+		value_type* elements()
+		{
+			return &first_element;
+		}
+	};
+
+	// Inner node with 'count' keys and 'count + 1' children.
+	// Key 'i' is greater than all keys in child 'i' and not
+	// greater than any key in child 'i + 1'. Inner nodes also
+	// have room for one extra key and child.
+	struct inner_node : public node
+	{
+		node* children[inner_capacity + 2];
+
+		Key first_key;
+
+		Key* keys()
+		{
+			return &first_key;
+		}
+	};
+
+	static leaf_node* new_leaf();
+	static inner_node* new_inner();
+	static void free_leaf(leaf_node* leaf);
+	static void free_inner(inner_node* inner);
+	void free_subtree(node* n);
+
+	// Returns the smallest key in the subtree rooted at 'n'.
+	static const Key& min_key(node* n);
+
+	// Returns the position of the first element
+	// of 'leaf' whose key is not less than 'key'.
+	template <class Search_key>
+	static size_t leaf_lower_bound(leaf_node* leaf,
+		const Search_key& key);
+
+	// Returns the index of the child of 'inner' whose
+	// subtree can contain 'key'.
+	template <class Search_key>
+	static size_t child_index(inner_node* inner, const Search_key& key);
+
+	// Returns the leaf whose key range contains 'key'.
+	template <class Search_key>
+	leaf_node* find_leaf(const Search_key& key) const;
+
+	// Inserts an element into the subtree rooted at 'n'.
+	// If the root of the subtree overflows, splits it and
+	// sets '*split' to the new right sibling.
+	value_type* insert_into(node* n, const Key& key, const T& value,
+		bool* new_inserted, node** split);
+
+	leaf_node* split_leaf(leaf_node* leaf);
+	inner_node* split_inner(inner_node* inner);
+
+	// Removes an element from the subtree rooted at 'n'.
+	// The caller restores the minimum occupancy of 'n'.
+	template <class Search_key>
+	bool remove_from(node* n, const Search_key& key);
+
+	// Restores the minimum occupancy of child 'i' of 'parent'
+	// by borrowing from a sibling or by merging with it.
+	void rebalance_leaf(inner_node* parent, size_t i);
+	void rebalance_inner(inner_node* parent, size_t i);
+
+	// Merge child 'i + 1' of 'parent' into child 'i'.
+	void merge_leaves(inner_node* parent, size_t i);
+	void merge_inner(inner_node* parent, size_t i);
+
+	// Removes key 'i' and child 'i + 1' from 'parent'.
+	static void remove_child(inner_node* parent, size_t i);
+
+	node* root;
+	leaf_node* head;
+	leaf_node* tail;
+	size_t element_count;
+};
+
+template <class Key, class T>
+struct btree_map<Key, T>::const_iterator
+{
+	const leaf_node* leaf;
+	size_t index;
+
+	const_iterator(const leaf_node* l, size_t i) : leaf(l), index(i)
+	{
+	}
+
+	const_iterator& operator ++()
+	{
+		B_ASSERT(leaf != NULL);
+
+		if (++index == leaf->count)
+		{
+			leaf = leaf->next;
+			index = 0;
+		}
+
+		return *this;
+	}
+
+	const_iterator& operator --()
+	{
+		B_ASSERT(leaf != NULL);
+
+		if (index == 0)
+		{
+			leaf = leaf->prev;
+			index = leaf != NULL ? leaf->count - 1 : 0;
+		}
+		else
+			--index;
+
+		return *this;
+	}
+
+	bool operator ==(const const_iterator& rhs) const
+	{
+		return leaf == rhs.leaf && index == rhs.index;
+	}
+
+	bool operator !=(const const_iterator& rhs) const
+	{
+		return leaf != rhs.leaf || index != rhs.index;
+	}
+
+	const value_type* operator ->() const
+	{
+		return &leaf->first_element + index;
+	}
+
+	const value_type& operator *() const
+	{
+		return (&leaf->first_element)[index];
+	}
+};
+
+template <class Key, class T>
+btree_map<Key, T>::btree_map() :
+	root(NULL), head(NULL), tail(NULL), element_count(0)
+{
+}
+
+template <class Key, class T>
+inline bool btree_map<Key, T>::is_empty() const
+{
+	return element_count == 0;
+}
+
+template <class Key, class T>
+inline size_t btree_map<Key, T>::size() const
+{
+	return element_count;
+}
+
+template <class Key, class T>
+typename btree_map<Key, T>::leaf_node* btree_map<Key, T>::new_leaf()
+{
+	leaf_node* leaf = (leaf_node*) memory::alloc((size_t)
+		&((leaf_node*) (sizeof(value_type) *
+			(leaf_capacity + 1)))->first_element);
+
+	leaf->count = 0;
+	leaf->is_leaf = true;
+	leaf->prev = leaf->next = NULL;
+
+	return leaf;
+}
+
+template <class Key, class T>
+typename btree_map<Key, T>::inner_node* btree_map<Key, T>::new_inner()
+{
+	inner_node* inner = (inner_node*) memory::alloc((size_t)
+		&((inner_node*) (sizeof(Key) *
+			(inner_capacity + 1)))->first_key);
+
+	inner->count = 0;
+	inner->is_leaf = false;
+
+	return inner;
+}
+
+template <class Key, class T>
+void btree_map<Key, T>::free_leaf(leaf_node* leaf)
+{
+	destruct(leaf->elements(), leaf->count);
+
+	memory::free(leaf);
+}
+
+template <class Key, class T>
+void btree_map<Key, T>::free_inner(inner_node* inner)
+{
+	destruct(inner->keys(), inner->count);
+
+	memory::free(inner);
+}
+
+template <class Key, class T>
+void btree_map<Key, T>::free_subtree(node* n)
+{
+	if (n->is_leaf)
+		free_leaf((leaf_node*) n);
+	else
+	{
+		inner_node* inner = (inner_node*) n;
+
+		for (size_t i = 0; i <= inner->count; ++i)
+			free_subtree(inner->children[i]);
+
+		free_inner(inner);
+	}
+}
+
+template <class Key, class T>
+const Key& btree_map<Key, T>::min_key(node* n)
+{
+	while (!n->is_leaf)
+		n = ((inner_node*) n)->children[0];
+
+	return ((leaf_node*) n)->elements()->key;
+}
+
+template <class Key, class T>
+template <class Search_key>
+inline size_t btree_map<Key, T>::leaf_lower_bound(leaf_node* leaf,
+	const Search_key& key)
+{
+	flat_key_iterator<value_type, flat_map_key_op<Key, T> > first =
+		{leaf->elements()};
+
+	return (size_t) (find_lower_bound(first, leaf->count,
+		key).element - leaf->elements());
+}
+
+template <class Key, class T>
+template <class Search_key>
+inline size_t btree_map<Key, T>::child_index(inner_node* inner,
+	const Search_key& key)
+{
+	Key* keys = inner->keys();
+
+	size_t i = (size_t) (find_lower_bound(keys, inner->count, key) - keys);
+
+	return i < inner->count && !(key < keys[i]) ? i + 1 : i;
+}
+
+template <class Key, class T>
+template <class Search_key>
+typename btree_map<Key, T>::leaf_node* btree_map<Key, T>::find_leaf(
+	const Search_key& key) const
+{
+	node* n = root;
+
+	while (!n->is_leaf)
+	{
+		inner_node* inner = (inner_node*) n;
+
+		n = inner->children[child_index(inner, key)];
+	}
+
+	return (leaf_node*) n;
+}
+
+template <class Key, class T>
+template <class Search_key>
+T* btree_map<Key, T>::find(const Search_key& key) const
+{
+	if (root == NULL)
+		return NULL;
+
+	leaf_node* leaf = find_leaf(key);
+
+	size_t position = leaf_lower_bound(leaf, key);
+
+	if (position == leaf->count)
+		return NULL;
+
+	value_type* element = leaf->elements() + position;
+
+	return key < element->key ? NULL : &element->value;
+}
+
+template <class Key, class T>
+typename btree_map<Key, T>::value_type* btree_map<Key, T>::insert(
+	const Key& key, const T& value)
+{
+	bool new_inserted;
+
+	return insert(key, value, &new_inserted);
+}
+
+template <class Key, class T>
+typename btree_map<Key, T>::value_type* btree_map<Key, T>::insert(
+	const Key& key, const T& value, bool* new_inserted)
+{
+	if (root == NULL)
+		root = head = tail = new_leaf();
+
+	node* split;
+
+	value_type* element = insert_into(root, key, value,
+		new_inserted, &split);
+
+	if (split != NULL)
+	{
+		inner_node* new_root = new_inner();
+
+		new (new_root->keys()) Key(min_key(split));
+
+		new_root->children[0] = root;
+		new_root->children[1] = split;
+		new_root->count = 1;
+
+		root = new_root;
+	}
+
+	return element;
+}
+
+template <class Key, class T>
+typename btree_map<Key, T>::value_type* btree_map<Key, T>::insert_into(
+	node* n, const Key& key, const T& value,
+	bool* new_inserted, node** split)
+{
+	*split = NULL;
+
+	if (n->is_leaf)
+	{
+		leaf_node* leaf = (leaf_node*) n;
+		value_type* elements = leaf->elements();
+
+		size_t position = leaf_lower_bound(leaf, key);
+
+		if (position < leaf->count &&
+				!(key < elements[position].key))
+		{
+			elements[position].value = value;
+
+			*new_inserted = false;
+
+			return elements + position;
+		}
+
+		value_type new_element(key, value);
+
+		move_right_and_insert(elements + position,
+			leaf->count - position, &new_element, 1);
+
+		++leaf->count;
+		++element_count;
+
+		*new_inserted = true;
+
+		if (leaf->count <= (size_t) leaf_capacity)
+			return elements + position;
+
+		leaf_node* right = split_leaf(leaf);
+
+		*split = right;
+
+		return position < leaf->count ? elements + position :
+			right->elements() + (position - leaf->count);
+	}
+
+	inner_node* inner = (inner_node*) n;
+
+	size_t i = child_index(inner, key);
+
+	node* new_child;
+
+	value_type* element = insert_into(inner->children[i], key, value,
+		new_inserted, &new_child);
+
+	if (new_child != NULL)
+	{
+		Key separator(min_key(new_child));
+
+		move_right_and_insert(inner->keys() + i,
+			inner->count - i, &separator, 1);
+
+		memory::move(inner->children + i + 2, inner->children + i + 1,
+			(inner->count - i) * sizeof(node*));
+
+		inner->children[i + 1] = new_child;
+
+		if (++inner->count > (size_t) inner_capacity)
+			*split = split_inner(inner);
+	}
+
+	return element;
+}
+
+template <class Key, class T>
+typename btree_map<Key, T>::leaf_node* btree_map<Key, T>::split_leaf(
+	leaf_node* leaf)
+{
+	leaf_node* right = new_leaf();
+
+	size_t middle = leaf->count / 2;
+
+	right->count = leaf->count - middle;
+
+	construct_copies(right->elements(),
+		leaf->elements() + middle, right->count);
+
+	destruct(leaf->elements() + middle, right->count);
+
+	leaf->count = middle;
+
+	right->prev = leaf;
+	right->next = leaf->next;
+
+	if (leaf->next != NULL)
+		leaf->next->prev = right;
+	else
+		tail = right;
+
+	leaf->next = right;
+
+	return right;
+}
+
+template <class Key, class T>
+typename btree_map<Key, T>::inner_node* btree_map<Key, T>::split_inner(
+	inner_node* inner)
+{
+	inner_node* right = new_inner();
+
+	// The middle key is dropped: the parent gets the
+	// smallest key of the right node's subtree instead.
+	size_t middle = inner->count / 2;
+
+	right->count = inner->count - middle - 1;
+
+	construct_copies(right->keys(),
+		inner->keys() + middle + 1, right->count);
+
+	memory::copy(right->children, inner->children + middle + 1,
+		(right->count + 1) * sizeof(node*));
+
+	destruct(inner->keys() + middle, right->count + 1);
+
+	inner->count = middle;
+
+	return right;
+}
+
+template <class Key, class T>
+template <class Search_key>
+bool btree_map<Key, T>::remove(const Search_key& key)
+{
+	if (root == NULL || !remove_from(root, key))
+		return false;
+
+	if (root->is_leaf)
+	{
+		if (root->count == 0)
+		{
+			free_leaf((leaf_node*) root);
+
+			root = head = tail = NULL;
+		}
+	}
+	else
+		if (root->count == 0)
+		{
+			inner_node* old_root = (inner_node*) root;
+
+			root = old_root->children[0];
+
+			free_inner(old_root);
+		}
+
+	return true;
+}
+
+template <class Key, class T>
+template <class Search_key>
+bool btree_map<Key, T>::remove_from(node* n, const Search_key& key)
+{
+	if (n->is_leaf)
+	{
+		leaf_node* leaf = (leaf_node*) n;
+		value_type* elements = leaf->elements();
+
+		size_t position = leaf_lower_bound(leaf, key);
+
+		if (position == leaf->count ||
+				key < elements[position].key)
+			return false;
+
+		move_left(elements + position, elements + position + 1,
+			leaf->count - position - 1);
+
+		destruct(elements + --leaf->count, 1);
+
+		--element_count;
+
+		return true;
+	}
+
+	inner_node* inner = (inner_node*) n;
+
+	size_t i = child_index(inner, key);
+
+	node* child = inner->children[i];
+
+	if (!remove_from(child, key))
+		return false;
+
+	if (child->is_leaf)
+	{
+		if (child->count < (size_t) min_leaf_count)
+			rebalance_leaf(inner, i);
+	}
+	else
+		if (child->count < (size_t) min_inner_count)
+			rebalance_inner(inner, i);
+
+	return true;
+}
+
+template <class Key, class T>
+void btree_map<Key, T>::rebalance_leaf(inner_node* parent, size_t i)
+{
+	leaf_node* leaf = (leaf_node*) parent->children[i];
+
+	if (i > 0)
+	{
+		leaf_node* left = (leaf_node*) parent->children[i - 1];
+
+		if (left->count > (size_t) min_leaf_count)
+		{
+			value_type* borrowed = left->elements() + --left->count;
+
+			move_right_and_insert(leaf->elements(), leaf->count,
+				borrowed, 1);
+
+			destruct(borrowed, 1);
+
+			++leaf->count;
+
+			parent->keys()[i - 1] = leaf->elements()->key;
+
+			return;
+		}
+	}
+
+	if (i < parent->count)
+	{
+		leaf_node* right = (leaf_node*) parent->children[i + 1];
+
+		if (right->count > (size_t) min_leaf_count)
+		{
+			value_type* elements = right->elements();
+
+			construct_copies(leaf->elements() + leaf->count,
+				elements, 1);
+
+			++leaf->count;
+
+			move_left(elements, elements + 1, --right->count);
+
+			destruct(elements + right->count, 1);
+
+			parent->keys()[i] = elements->key;
+
+			return;
+		}
+	}
+
+	merge_leaves(parent, i > 0 ? i - 1 : i);
+}
+
+template <class Key, class T>
+void btree_map<Key, T>::rebalance_inner(inner_node* parent, size_t i)
+{
+	inner_node* inner = (inner_node*) parent->children[i];
+	Key* separators = parent->keys();
+
+	if (i > 0)
+	{
+		inner_node* left = (inner_node*) parent->children[i - 1];
+
+		if (left->count > (size_t) min_inner_count)
+		{
+			// Rotate the last child of the left
+			// sibling through the parent.
+			move_right_and_insert(inner->keys(), inner->count,
+				separators + i - 1, 1);
+
+			memory::move(inner->children + 1, inner->children,
+				(inner->count + 1) * sizeof(node*));
+
+			inner->children[0] = left->children[left->count];
+
+			++inner->count;
+
+			Key* last_key = left->keys() + --left->count;
+
+			separators[i - 1] = *last_key;
+
+			destruct(last_key, 1);
+
+			return;
+		}
+	}
+
+	if (i < parent->count)
+	{
+		inner_node* right = (inner_node*) parent->children[i + 1];
+
+		if (right->count > (size_t) min_inner_count)
+		{
+			// Rotate the first child of the right
+			// sibling through the parent.
+			construct_copies(inner->keys() + inner->count,
+				separators + i, 1);
+
+			inner->children[++inner->count] = right->children[0];
+
+			Key* keys = right->keys();
+
+			separators[i] = *keys;
+
+			move_left(keys, keys + 1, --right->count);
+
+			destruct(keys + right->count, 1);
+
+			memory::move(right->children, right->children + 1,
+				(right->count + 1) * sizeof(node*));
+
+			return;
+		}
+	}
+
+	merge_inner(parent, i > 0 ? i - 1 : i);
+}
+
+template <class Key, class T>
+void btree_map<Key, T>::merge_leaves(inner_node* parent, size_t i)
+{
+	leaf_node* left = (leaf_node*) parent->children[i];
+	leaf_node* right = (leaf_node*) parent->children[i + 1];
+
+	construct_copies(left->elements() + left->count,
+		right->elements(), right->count);
+
+	left->count += right->count;
+
+	left->next = right->next;
+
+	if (right->next != NULL)
+		right->next->prev = left;
+	else
+		tail = left;
+
+	free_leaf(right);
+
+	remove_child(parent, i);
+}
+
+template <class Key, class T>
+void btree_map<Key, T>::merge_inner(inner_node* parent, size_t i)
+{
+	inner_node* left = (inner_node*) parent->children[i];
+	inner_node* right = (inner_node*) parent->children[i + 1];
+
+	construct_copies(left->keys() + left->count, parent->keys() + i, 1);
+
+	construct_copies(left->keys() + left->count + 1,
+		right->keys(), right->count);
+
+	memory::copy(left->children + left->count + 1, right->children,
+		(right->count + 1) * sizeof(node*));
+
+	left->count += right->count + 1;
+
+	free_inner(right);
+
+	remove_child(parent, i);
+}
+
+template <class Key, class T>
+void btree_map<Key, T>::remove_child(inner_node* parent, size_t i)
+{
+	Key* keys = parent->keys();
+
+	move_left(keys + i, keys + i + 1, parent->count - i - 1);
+
+	destruct(keys + --parent->count, 1);
+
+	memory::move(parent->children + i + 1, parent->children + i + 2,
+		(parent->count - i) * sizeof(node*));
+}
+
+template <class Key, class T>
+void btree_map<Key, T>::assign_sorted(const value_type* sorted, size_t count)
+{
+	if (root != NULL)
+	{
+		free_subtree(root);
+
+		root = head = tail = NULL;
+		element_count = 0;
+	}
+
+	if (count == 0)
+		return;
+
+	// Spread the elements evenly over the smallest
+	// possible number of leaves.
+	size_t leaf_count = (count + leaf_capacity - 1) / leaf_capacity;
+
+	array<node*> level;
+
+	level.alloc_and_copy(leaf_count);
+
+	size_t i;
+
+	for (i = 0; i < leaf_count; ++i)
+	{
+		leaf_node* leaf = new_leaf();
+
+		leaf->count = count / leaf_count + (i < count % leaf_count);
+
+		construct_copies(leaf->elements(), sorted, leaf->count);
+
+#ifdef B_DEBUG
+		for (size_t j = 1; j < leaf->count; ++j)
+			B_ASSERT(sorted[j - 1].key < sorted[j].key);
+#endif /* defined(B_DEBUG) */
+
+		sorted += leaf->count;
+
+		leaf->prev = tail;
+
+		if (tail != NULL)
+			tail->next = leaf;
+		else
+			head = leaf;
+
+		tail = leaf;
+
+		level.append(leaf);
+	}
+
+	// Build the inner levels the same way until
+	// a single node remains.
+	while (level.length() > 1)
+	{
+		size_t child_count = level.length();
+		size_t parent_count = (child_count + inner_capacity) /
+			(inner_capacity + 1);
+
+		array<node*> parents;
+
+		parents.alloc_and_copy(parent_count);
+
+		node* const* children = level.data();
+
+		for (i = 0; i < parent_count; ++i)
+		{
+			inner_node* inner = new_inner();
+
+			size_t fanout = child_count / parent_count +
+				(i < child_count % parent_count);
+
+			inner->children[0] = *children;
+
+			for (size_t j = 1; j < fanout; ++j)
+			{
+				new (inner->keys() + j - 1)
+					Key(min_key(children[j]));
+
+				inner->children[j] = children[j];
+			}
+
+			inner->count = fanout - 1;
+
+			children += fanout;
+
+			parents.append(inner);
+		}
+
+		level = parents;
+	}
+
+	root = level[0];
+	element_count = count;
+}
+
+template <class Key, class T>
+const typename btree_map<Key, T>::value_type* btree_map<Key, T>::first() const
+{
+	return head != NULL ? head->elements() : NULL;
+}
+
+template <class Key, class T>
+typename btree_map<Key, T>::value_type* btree_map<Key, T>::first()
+{
+	return head != NULL ? head->elements() : NULL;
+}
+
+template <class Key, class T>
+const typename btree_map<Key, T>::value_type* btree_map<Key, T>::last() const
+{
+	return tail != NULL ? tail->elements() + tail->count - 1 : NULL;
+}
+
+template <class Key, class T>
+typename btree_map<Key, T>::value_type* btree_map<Key, T>::last()
+{
+	return tail != NULL ? tail->elements() + tail->count - 1 : NULL;
+}
+
+template <class Key, class T>
+typename btree_map<Key, T>::const_iterator btree_map<Key, T>::begin() const
+{
+	return const_iterator(head, 0);
+}
+
+template <class Key, class T>
+typename btree_map<Key, T>::const_iterator btree_map<Key, T>::end() const
+{
+	return const_iterator(NULL, 0);
+}
+
+template <class Key, class T>
+template <class Search_key>
+typename btree_map<Key, T>::const_iterator btree_map<Key, T>::lower_bound(
+	const Search_key& key) const
+{
+	if (root == NULL)
+		return end();
+
+	leaf_node* leaf = find_leaf(key);
+
+	size_t position = leaf_lower_bound(leaf, key);
+
+	if (position < leaf->count)
+		return const_iterator(leaf, position);
+
+	return const_iterator(leaf->next, 0);
+}
+
+template <class Key, class T>
+btree_map<Key, T>::~btree_map()
+{
+	if (root != NULL)
+		free_subtree(root);
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_BTREE_MAP_H) */
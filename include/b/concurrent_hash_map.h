@@ -0,0 +1,426 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_CONCURRENT_HASH_MAP_H
+#define B_CONCURRENT_HASH_MAP_H
+
+#include "mutex.h"
+#include "node_pool.h"
+
+B_BEGIN_NAMESPACE
+
+// The default number of independently locked parts of
+// a concurrent_hash_map.
+#define B_CONCURRENT_HASH_MAP_STRIPES 64
+
+// Hash table with unique keys for lookup tables that are read by
+// many threads and updated rarely.
+//
+// The table is divided into stripes by the hash values of the keys.
+// Each stripe has its own buckets, its own pool of nodes, and its
+// own reader-writer lock, which is held for reading only while
+// a lookup walks a bucket and copies the found value. Lookups of
+// keys in different stripes do not touch the same cache lines, and
+// lookups in the same stripe proceed in parallel unless a writer
+// is updating that stripe. Each stripe grows independently.
+//
+// Values are returned by copy, so that a value can be removed
+// or replaced while a reader still uses its copy. To share objects
+// through the table, store ref<> to classes derived from
+// 'shared_object', whose reference counts can be updated from
+// multiple threads.
+//
+// 'Key' must be comparable for equality with the search keys and
+// hashable with b::hash(), which must return equal values for equal
+// keys of different types. The copy constructors of 'Key' and 'T'
+// and the assignment operator of 'T' must not throw. The map never
+// copies search keys, so string keys can be looked up concurrently
+// by string_view or by strings that the calling thread owns.
+template <class Key, class T>
+class concurrent_hash_map
+{
+public:
+	// Creates an empty map divided into at least 'min_stripe_count'
+	// stripes. The number is rounded up to a power of two. The
+	// buckets are allocated when the first element is inserted
+	// into a stripe.
+	explicit concurrent_hash_map(
+		size_t min_stripe_count = B_CONCURRENT_HASH_MAP_STRIPES);
+
+	// Returns the number of stripes.
+	size_t stripe_count() const;
+
+	// Returns the number of elements. The stripes are counted
+	// one by one, so the result may be outdated if other threads
+	// modify the map concurrently.
+	size_t size() const;
+
+	// Finds the element with the specified key and copies its
+	// value to '*value'. Returns false if there is no match.
+	template <class Search_key>
+	bool find(const Search_key& key, T* value) const;
+
+	// Returns true if the map contains the specified key.
+	template <class Search_key>
+	bool contains(const Search_key& key) const;
+
+	// Adds the specified key-value pair to this map. If an element
+	// with the same key already exists, its value is overwritten.
+	// Returns true if a new element has been inserted.
+	bool insert(const Key& key, const T& value);
+
+	// Adds the specified key-value pair unless an element with
+	// the same key already exists. Returns true if the pair has
+	// been inserted.
+	bool try_insert(const Key& key, const T& value);
+
+	// Removes the element that matches the specified key.
+	// Returns true if the element was found and deleted.
+	template <class Search_key>
+	bool remove(const Search_key& key);
+
+	// Removes all elements. Each stripe is cleared
+	// atomically, but not the map as a whole.
+	void clear();
+
+	// Destroys the elements. No other thread may access
+	// the map at this point.
+	~concurrent_hash_map();
+
+private:
+	concurrent_hash_map(const concurrent_hash_map&);
+	concurrent_hash_map& operator =(const concurrent_hash_map&);
+
+	struct node
+	{
+		node(node* next_node, size_t h, const Key& k, const T& v) :
+			next(next_node), hash(h), key(k), value(v)
+		{
+		}
+
+		node* next;
+
+		// The hash value is stored so that growing
+		// the stripe does not need to rehash the keys.
+		size_t hash;
+
+		Key key;
+		T value;
+	};
+
+	struct stripe
+	{
+		stripe() : buckets(NULL), bucket_mask(0), count(0),
+			nodes(sizeof(node))
+		{
+		}
+
+		shared_mutex lock;
+
+		// The heads of the bucket chains. The number of
+		// buckets is a power of two.
+		node** buckets;
+		size_t bucket_mask;
+
+		// The number of elements in this stripe.
+		size_t count;
+
+		node_pool nodes;
+
+		char padding[B_CACHE_LINE_SIZE];
+	};
+
+	// The stripe is chosen by the low bits of the hash value,
+	// and the bucket within the stripe by the bits above them.
+	stripe& stripe_for(size_t hash) const;
+
+	node** bucket_for(const stripe& s, size_t hash) const;
+
+	template <class Search_key>
+	node* find_node(const stripe& s, size_t hash,
+		const Search_key& key) const;
+
+	// Inserts a new element into a stripe locked for writing.
+	void insert_new(stripe& s, size_t hash,
+		const Key& key, const T& value);
+
+	// Doubles the number of buckets in 's'.
+	void grow(stripe& s);
+
+	// Destroys the elements and frees the buckets of 's'.
+	static void clear_stripe(stripe& s);
+
+	stripe* stripes;
+	size_t stripe_mask;
+	unsigned stripe_bits;
+};
+
+template <class Key, class T>
+concurrent_hash_map<Key, T>::concurrent_hash_map(size_t min_stripe_count) :
+	stripe_bits(0)
+{
+	while (((size_t) 1 << stripe_bits) < min_stripe_count)
+		++stripe_bits;
+
+	stripe_mask = ((size_t) 1 << stripe_bits) - 1;
+
+	stripes = new stripe[stripe_mask + 1];
+}
+
+template <class Key, class T>
+inline size_t concurrent_hash_map<Key, T>::stripe_count() const
+{
+	return stripe_mask + 1;
+}
+
+template <class Key, class T>
+size_t concurrent_hash_map<Key, T>::size() const
+{
+	size_t total = 0;
+
+	for (size_t i = 0; i <= stripe_mask; ++i)
+	{
+		read_lock lock(stripes[i].lock);
+
+		total += stripes[i].count;
+	}
+
+	return total;
+}
+
+template <class Key, class T>
+inline typename concurrent_hash_map<Key, T>::stripe&
+	concurrent_hash_map<Key, T>::stripe_for(size_t hash) const
+{
+	return stripes[hash & stripe_mask];
+}
+
+template <class Key, class T>
+inline typename concurrent_hash_map<Key, T>::node**
+	concurrent_hash_map<Key, T>::bucket_for(const stripe& s,
+		size_t hash) const
+{
+	return s.buckets + ((hash >> stripe_bits) & s.bucket_mask);
+}
+
+template <class Key, class T>
+template <class Search_key>
+typename concurrent_hash_map<Key, T>::node*
+	concurrent_hash_map<Key, T>::find_node(const stripe& s,
+		size_t hash, const Search_key& key) const
+{
+	if (s.buckets == NULL)
+		return NULL;
+
+	node* n = *bucket_for(s, hash);
+
+	while (n != NULL && (n->hash != hash || !(n->key == key)))
+		n = n->next;
+
+	return n;
+}
+
+template <class Key, class T>
+template <class Search_key>
+bool concurrent_hash_map<Key, T>::find(const Search_key& key,
+	T* value) const
+{
+	size_t h = hash(key);
+	stripe& s = stripe_for(h);
+
+	read_lock lock(s.lock);
+
+	node* n = find_node(s, h, key);
+
+	if (n == NULL)
+		return false;
+
+	*value = n->value;
+
+	return true;
+}
+
+template <class Key, class T>
+template <class Search_key>
+bool concurrent_hash_map<Key, T>::contains(const Search_key& key) const
+{
+	size_t h = hash(key);
+	stripe& s = stripe_for(h);
+
+	read_lock lock(s.lock);
+
+	return find_node(s, h, key) != NULL;
+}
+
+template <class Key, class T>
+void concurrent_hash_map<Key, T>::grow(stripe& s)
+{
+	size_t new_bucket_count = s.buckets == NULL ? 8 :
+		(s.bucket_mask + 1) * 2;
+
+	node** old_buckets = s.buckets;
+	size_t old_bucket_count = old_buckets == NULL ? 0 :
+		s.bucket_mask + 1;
+
+	s.buckets = (node**) memory::alloc(new_bucket_count * sizeof(node*));
+	s.bucket_mask = new_bucket_count - 1;
+
+	memory::zero(s.buckets, new_bucket_count * sizeof(node*));
+
+	for (size_t i = 0; i < old_bucket_count; ++i)
+	{
+		node* n = old_buckets[i];
+
+		while (n != NULL)
+		{
+			node* next = n->next;
+			node** bucket = bucket_for(s, n->hash);
+
+			n->next = *bucket;
+			*bucket = n;
+
+			n = next;
+		}
+	}
+
+	memory::free(old_buckets);
+}
+
+template <class Key, class T>
+void concurrent_hash_map<Key, T>::insert_new(stripe& s, size_t hash,
+	const Key& key, const T& value)
+{
+	if (s.buckets == NULL || s.count > s.bucket_mask)
+		grow(s);
+
+	node** bucket = bucket_for(s, hash);
+
+	*bucket = new (s.nodes.allocate_node())
+		node(*bucket, hash, key, value);
+
+	++s.count;
+}
+
+template <class Key, class T>
+bool concurrent_hash_map<Key, T>::insert(const Key& key, const T& value)
+{
+	size_t h = hash(key);
+	stripe& s = stripe_for(h);
+
+	write_lock lock(s.lock);
+
+	node* n = find_node(s, h, key);
+
+	if (n != NULL)
+	{
+		n->value = value;
+
+		return false;
+	}
+
+	insert_new(s, h, key, value);
+
+	return true;
+}
+
+template <class Key, class T>
+bool concurrent_hash_map<Key, T>::try_insert(const Key& key, const T& value)
+{
+	size_t h = hash(key);
+	stripe& s = stripe_for(h);
+
+	write_lock lock(s.lock);
+
+	if (find_node(s, h, key) != NULL)
+		return false;
+
+	insert_new(s, h, key, value);
+
+	return true;
+}
+
+template <class Key, class T>
+template <class Search_key>
+bool concurrent_hash_map<Key, T>::remove(const Search_key& key)
+{
+	size_t h = hash(key);
+	stripe& s = stripe_for(h);
+
+	write_lock lock(s.lock);
+
+	if (s.buckets == NULL)
+		return false;
+
+	node** link = bucket_for(s, h);
+
+	while (*link != NULL)
+	{
+		node* n = *link;
+
+		if (n->hash == h && n->key == key)
+		{
+			*link = n->next;
+
+			n->~node();
+			s.nodes.deallocate_node(n);
+
+			--s.count;
+
+			return true;
+		}
+
+		link = &n->next;
+	}
+
+	return false;
+}
+
+template <class Key, class T>
+void concurrent_hash_map<Key, T>::clear_stripe(stripe& s)
+{
+	if (s.buckets == NULL)
+		return;
+
+	for (size_t i = 0; i <= s.bucket_mask; ++i)
+		for (node* n = s.buckets[i]; n != NULL; )
+		{
+			node* next = n->next;
+
+			n->~node();
+
+			n = next;
+		}
+
+	memory::free(s.buckets);
+
+	s.buckets = NULL;
+	s.bucket_mask = 0;
+	s.count = 0;
+
+	s.nodes.clear();
+}
+
+template <class Key, class T>
+void concurrent_hash_map<Key, T>::clear()
+{
+	for (size_t i = 0; i <= stripe_mask; ++i)
+	{
+		write_lock lock(stripes[i].lock);
+
+		clear_stripe(stripes[i]);
+	}
+}
+
+template <class Key, class T>
+concurrent_hash_map<Key, T>::~concurrent_hash_map()
+{
+	for (size_t i = 0; i <= stripe_mask; ++i)
+		clear_stripe(stripes[i]);
+
+	delete[] stripes;
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_CONCURRENT_HASH_MAP_H) */
@@ -44,6 +44,10 @@ public:
 	typedef typename Node_access::element_type element_type;
 	typedef typename Node_access::node_type node_type;
 
+	doubly_linked_list()
+	{
+	}
+
 	doubly_linked_list(const Node_access& node_access_inst) :
 		linked_list<Node_access>(node_access_inst)
 	{
@@ -0,0 +1,178 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_EPOCH_H
+#define B_EPOCH_H
+
+#include "atomic.h"
+#include "memory.h"
+
+#include <pthread.h>
+
+B_BEGIN_NAMESPACE
+
+// The number of objects a thread retires before it tries
+// to free the ones that no reader can reach anymore.
+#define B_EPOCH_COLLECT_THRESHOLD 64
+
+// Epoch-based memory reclamation. Threads that read a lock-free
+// structure do so inside critical sections of a domain, and
+// threads that unlink memory blocks from the structure retire
+// them instead of freeing them. A retired block is freed once
+// every thread that was inside a critical section at the time
+// of the retirement has left it.
+//
+// The domain keeps a global epoch number. A thread entering
+// a critical section announces the epoch it has observed, and
+// the epoch advances when all threads inside critical sections
+// have observed the current one. A block retired in epoch 'e'
+// is freed when the global epoch reaches 'e + 2'.
+//
+// Entering and leaving a critical section costs an atomic exchange
+// and a store to a location that only the calling thread writes,
+// so readers do not contend with each other. A thread that stays
+// inside a critical section for a long time delays the reclamation
+// of all memory retired in the domain.
+//
+// Each thread frees the blocks it has retired. The blocks of
+// a thread that has exited are taken over by the next thread that
+// registers with the domain or freed by the destructor of the domain.
+class epoch_domain
+{
+public:
+	// Creates a domain with no registered threads.
+	// Throws 'system_exception' if a thread-specific data
+	// key cannot be created.
+	epoch_domain();
+
+	// Returns the domain used by 'epoch_reclaimed' objects.
+	// The domain is never destroyed, so objects can be
+	// released from static destructors.
+	static epoch_domain& global();
+
+	// Enters a critical section. Critical sections can be nested.
+	// Throws 'system_exception' if the calling thread cannot
+	// be registered with the domain.
+	void enter();
+
+	// Leaves the critical section entered by the matching
+	// call to enter().
+	void exit();
+
+	// Returns true if the calling thread is inside
+	// a critical section of this domain.
+	bool in_critical_section() const;
+
+	// Function that frees a retired memory block.
+	typedef void (*deleter)(void* block);
+
+	// Schedules 'delete_block(block)' to be called once no thread
+	// can hold a reference to 'block' obtained in a critical section.
+	// The block must already be unreachable for new critical
+	// sections. Can be called both inside and outside of critical
+	// sections.
+	void retire(void* block, deleter delete_block);
+
+	// Tries to advance the epoch and frees the blocks retired by
+	// the calling thread that have become unreachable. Returns
+	// the number of blocks that remain retired.
+	size_t collect();
+
+	// Returns the current global epoch.
+	size_t epoch() const;
+
+	// Frees all retired blocks. No thread may be inside
+	// a critical section of this domain at this point.
+	~epoch_domain();
+
+private:
+	epoch_domain(const epoch_domain&);
+	epoch_domain& operator =(const epoch_domain&);
+
+	struct retired_block;
+	struct thread_record;
+
+	// Returns the record of the calling thread,
+	// registering the thread if necessary.
+	thread_record* current_record();
+
+	thread_record* find_record() const;
+
+	// Advances the global epoch if all threads inside critical
+	// sections have observed it. Returns the global epoch.
+	size_t try_advance();
+
+	// Frees the blocks of 'record' retired two or more
+	// epochs before 'global_epoch'.
+	static void free_retired(thread_record* record, size_t global_epoch);
+
+	static void release_record(void* record);
+
+	atomic_value<size_t> global_epoch;
+
+	char padding_after_epoch[B_CACHE_LINE_SIZE];
+
+	// All records ever registered, linked through their
+	// 'next' fields. Records are reused but never removed.
+	atomic_value<thread_record*> records;
+
+	pthread_key_t record_key;
+};
+
+// Keeps the calling thread inside a critical section of an
+// epoch domain for the lifetime of this object.
+class epoch_guard
+{
+public:
+	// Enters a critical section of 'd'.
+	explicit epoch_guard(epoch_domain& d) : domain(d)
+	{
+		domain.enter();
+	}
+
+	// Leaves the critical section.
+	~epoch_guard()
+	{
+		domain.exit();
+	}
+
+private:
+	epoch_guard(const epoch_guard&);
+	epoch_guard& operator =(const epoch_guard&);
+
+	epoch_domain& domain;
+};
+
+// Makes the deletion of an object derived from 'object' or
+// 'shared_object' wait until the global epoch domain has
+// advanced. Readers that find the object through a lock-free
+// structure inside a critical section of the global domain can
+// then use the object even if the last reference to it is released
+// concurrently.
+template <class Base>
+class epoch_reclaimed : public Base
+{
+protected:
+	// Retires the object instead of deleting it at once.
+	virtual void delete_this() const
+	{
+		epoch_domain::global().retire(
+			const_cast<epoch_reclaimed*>(this), destroy);
+	}
+
+private:
+	static void destroy(void* obj)
+	{
+		delete static_cast<epoch_reclaimed*>(obj);
+	}
+};
+
+inline size_t epoch_domain::epoch() const
+{
+	return global_epoch.load(memory_order_relaxed);
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_EPOCH_H) */
@@ -0,0 +1,246 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_EYTZINGER_ARRAY_H
+#define B_EYTZINGER_ARRAY_H
+
+#include "array.h"
+
+B_BEGIN_NAMESPACE
+
+// Static sorted array for read-mostly lookup tables. The elements
+// are stored in the breadth-first order of a complete binary search
+// tree (the Eytzinger layout): the children of the element at index
+// 'k' are at '2k' and '2k + 1', with the root at index one.
+//
+// The first levels of the tree share a few cache lines, and all
+// the descendants of an element four levels down are adjacent,
+// so a search can prefetch them long before it needs them. This
+// makes lookups in tables that do not fit in the cache
+// considerably faster than binary search in a sorted array.
+template <class T>
+class eytzinger_array
+{
+public:
+	// Creates an empty array.
+	eytzinger_array();
+
+	// Builds the array from 'count' elements sorted
+	// in ascending order.
+	eytzinger_array(const T* sorted, size_t count);
+
+	// Builds the array from a slice of sorted elements.
+	explicit eytzinger_array(const array_slice<T>& sorted);
+
+	// Returns the number of elements in this array.
+	size_t length() const;
+
+	// Returns true if the array is empty.
+	bool is_empty() const;
+
+	// Returns the smallest element that is not less than 'value'
+	// or NULL if all elements are less than 'value'.
+	const T* find_lower_bound(const T& value) const;
+
+	// For each of the 'key_count' elements of 'keys', stores
+	// the result of find_lower_bound() in the respective element
+	// of 'results'. The searches are interleaved to overlap
+	// their memory accesses.
+	void find_lower_bound(const T* keys, size_t key_count,
+		const T** results) const;
+
+	// Returns true if the array contains an element
+	// equal to 'value'.
+	bool contains(const T& value) const;
+
+private:
+	void build(const T* sorted, size_t count);
+
+	// Copies the sorted elements to the subtree rooted at 'k'
+	// starting with 'sorted[i]'. Returns the index of the next
+	// sorted element.
+	size_t fill(T* tree, const T* sorted, size_t i, size_t k) const;
+
+	// Returns the number of descendants of an element that are
+	// prefetched at once: the largest power of two that does not
+	// exceed the number of elements in a cache line.
+	static size_t prefetch_stride();
+
+	// Converts the index reached after descending past the leaves
+	// into the index of the lower bound; zero stands for none.
+	static size_t lower_bound_index(size_t k);
+
+	// The tree. The element at index zero is unused.
+	array<T> elements;
+
+	// The number of tree levels that are completely filled.
+	size_t complete_levels;
+};
+
+template <class T>
+eytzinger_array<T>::eytzinger_array() : complete_levels(0)
+{
+}
+
+template <class T>
+eytzinger_array<T>::eytzinger_array(const T* sorted, size_t count)
+{
+	build(sorted, count);
+}
+
+template <class T>
+eytzinger_array<T>::eytzinger_array(const array_slice<T>& sorted)
+{
+	build(sorted.data(), sorted.length());
+}
+
+template <class T>
+void eytzinger_array<T>::build(const T* sorted, size_t count)
+{
+	complete_levels = 0;
+
+	for (size_t n = count + 1; n > 1; n >>= 1)
+		++complete_levels;
+
+	if (count == 0)
+		return;
+
+	elements.assign(count + 1, *sorted);
+
+	fill(elements.lock(), sorted, 0, 1);
+	elements.unlock();
+}
+
+template <class T>
+size_t eytzinger_array<T>::fill(T* tree,
+	const T* sorted, size_t i, size_t k) const
+{
+	if (k < elements.length())
+	{
+		i = fill(tree, sorted, i, 2 * k);
+		tree[k] = sorted[i++];
+		i = fill(tree, sorted, i, 2 * k + 1);
+	}
+
+	return i;
+}
+
+template <class T>
+size_t eytzinger_array<T>::length() const
+{
+	size_t size = elements.length();
+
+	return size > 0 ? size - 1 : 0;
+}
+
+template <class T>
+bool eytzinger_array<T>::is_empty() const
+{
+	return elements.is_empty();
+}
+
+template <class T>
+size_t eytzinger_array<T>::prefetch_stride()
+{
+	size_t stride = 1;
+
+	while (stride * 2 * sizeof(T) <= 64)
+		stride *= 2;
+
+	return stride;
+}
+
+template <class T>
+size_t eytzinger_array<T>::lower_bound_index(size_t k)
+{
+	// Each step to the right child appends a one to 'k' and
+	// each step to the left child appends a zero. The lower
+	// bound is the element where the search last went left,
+	// so drop the trailing ones and that last zero.
+#if defined(__GNUG__)
+	return k >> __builtin_ffsl((long) ~k);
+#else
+	while (k & 1)
+		k >>= 1;
+
+	return k >> 1;
+#endif /* defined(__GNUG__) */
+}
+
+template <class T>
+const T* eytzinger_array<T>::find_lower_bound(const T& value) const
+{
+	const T* tree = elements.data();
+	size_t count = length();
+	size_t stride = prefetch_stride();
+
+	size_t k = 1;
+
+	while (k <= count)
+	{
+		memory::prefetch(tree + k * stride);
+
+		k = 2 * k + (tree[k] < value);
+	}
+
+	k = lower_bound_index(k);
+
+	return k == 0 ? NULL : tree + k;
+}
+
+template <class T>
+void eytzinger_array<T>::find_lower_bound(const T* keys, size_t key_count,
+	const T** results) const
+{
+	const T* tree = elements.data();
+	size_t count = length();
+
+	size_t indices[B_LOWER_BOUND_BATCH_SIZE];
+
+	while (key_count > 0)
+	{
+		size_t batch_size = key_count < B_LOWER_BOUND_BATCH_SIZE ?
+			key_count : B_LOWER_BOUND_BATCH_SIZE;
+
+		size_t i;
+
+		for (i = 0; i < batch_size; ++i)
+			indices[i] = 1;
+
+		// All searches pass through the complete levels,
+		// so these steps need no bounds checks.
+		for (size_t level = complete_levels; level > 0; --level)
+			for (i = 0; i < batch_size; ++i)
+				indices[i] = 2 * indices[i] +
+					(tree[indices[i]] < keys[i]);
+
+		for (i = 0; i < batch_size; ++i)
+		{
+			size_t k = indices[i];
+
+			if (k <= count)
+				k = 2 * k + (tree[k] < keys[i]);
+
+			k = lower_bound_index(k);
+
+			results[i] = k == 0 ? NULL : tree + k;
+		}
+
+		keys += batch_size;
+		results += batch_size;
+		key_count -= batch_size;
+	}
+}
+
+template <class T>
+bool eytzinger_array<T>::contains(const T& value) const
+{
+	const T* element = find_lower_bound(value);
+
+	return element != NULL && !(value < *element);
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_EYTZINGER_ARRAY_H) */
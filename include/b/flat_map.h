@@ -0,0 +1,126 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_FLAT_MAP_H
+#define B_FLAT_MAP_H
+
+#include "flat_set.h"
+#include "map.h"
+
+B_BEGIN_NAMESPACE
+
+// Functor that returns the key of a flat map element.
+template <class Key, class T>
+struct flat_map_key_op
+{
+	typedef Key key_type;
+
+	const Key& operator()(const kv_pair<Key, T>& element) const
+	{
+		return element.key;
+	}
+};
+
+// Associative array with unique keys stored in a sorted
+// contiguous array. See 'flat_set_base' for the trade-offs
+// compared to 'map'.
+template <class Key, class T>
+class flat_map : public flat_set_base<kv_pair<Key, T>, flat_map_key_op<Key, T> >
+{
+public:
+	typedef flat_set_base<kv_pair<Key, T>, flat_map_key_op<Key, T> > base;
+
+	// Creates an empty map.
+	flat_map()
+	{
+	}
+
+	// Finds the value that matches the specified key.
+	// Returns NULL if there is no match.
+	template <class Search_key>
+	T* find(const Search_key& key) const;
+
+	// Inserts a new map element after a failed search for it.
+	// Returns a pointer to the newly insterted element.
+	kv_pair<Key, T>* insert_new(const Key& key, const T& value,
+			const typename base::search_result& sr);
+
+	// Adds the specified key-value pair to this map.
+	//
+	// If an element with the same key already exists,
+	// its value is overwritten with the specified value.
+	//
+	// The method returns a pointer to the stored map element.
+	kv_pair<Key, T>* insert(const Key& key, const T& value);
+
+	// Adds the specified key-value pair to this map.
+	//
+	// If an element with the same key already exists,
+	// its value is overwritten with the specified value.
+	//
+	// The method returns a pointer to the stored map element
+	// and sets 'new_element' to true or false, depending on
+	// whether an insertion or a replacement has occurred.
+	kv_pair<Key, T>* insert(const Key& key, const T& value,
+			bool* new_inserted);
+};
+
+template <class Key, class T>
+template <class Search_key>
+T* flat_map<Key, T>::find(const Search_key& key) const
+{
+	kv_pair<Key, T>* match = base::find(key);
+
+	return match != NULL ? &match->value : NULL;
+}
+
+template <class Key, class T>
+kv_pair<Key, T>* flat_map<Key, T>::insert_new(const Key &key, const T &value,
+		const typename flat_map<Key, T>::base::search_result& sr)
+{
+	return base::insert_new(kv_pair<Key, T>(key, value), sr);
+}
+
+template <class Key, class T>
+kv_pair<Key, T>* flat_map<Key, T>::insert(const Key& key, const T& value)
+{
+	typename base::search_result sr = base::search(key);
+
+	kv_pair<Key, T>* match = sr.match();
+
+	if (match != NULL)
+	{
+		match->value = value;
+
+		return match;
+	}
+
+	return base::insert_new(kv_pair<Key, T>(key, value), sr);
+}
+
+template <class Key, class T>
+kv_pair<Key, T>* flat_map<Key, T>::insert(const Key& key, const T& value,
+		bool* new_inserted)
+{
+	typename base::search_result sr = base::search(key);
+
+	kv_pair<Key, T>* match = sr.match();
+
+	if (match != NULL)
+	{
+		match->value = value;
+
+		*new_inserted = false;
+
+		return match;
+	}
+
+	*new_inserted = true;
+
+	return base::insert_new(kv_pair<Key, T>(key, value), sr);
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_FLAT_MAP_H) */
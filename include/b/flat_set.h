@@ -0,0 +1,493 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_FLAT_SET_H
+#define B_FLAT_SET_H
+
+#include "array.h"
+
+B_BEGIN_NAMESPACE
+
+// Iterator over the keys of a sorted array of elements. It lets
+// find_lower_bound() search the array by key.
+template <class T, class Key_op>
+struct flat_key_iterator
+{
+	const T* element;
+
+	flat_key_iterator operator +(size_t offset) const
+	{
+		flat_key_iterator result = {element + offset};
+
+		return result;
+	}
+
+	flat_key_iterator& operator ++()
+	{
+		++element;
+
+		return *this;
+	}
+
+	const typename Key_op::key_type& operator *() const
+	{
+		return Key_op()(*element);
+	}
+};
+
+// Ordering of the elements of a flat container by key.
+template <class T, class Key_op>
+struct flat_key_less
+{
+	bool operator()(const T& lhs, const T& rhs) const
+	{
+		return Key_op()(lhs) < Key_op()(rhs);
+	}
+};
+
+// A sorted set of unique elements of type T stored in a contiguous
+// array. Compared to 'set_base', the elements take no memory beyond
+// their own size, lookups do a binary search over adjacent memory,
+// and iteration is a linear scan. On the other hand, insertion and
+// removal shift the elements that follow, so the container suits
+// small or read-mostly sets, especially ones built at once with
+// assign().
+//
+// Insertion and removal invalidate the pointers to the elements.
+//
+// The requirements for the type T are the same as for 'set_base'.
+// 'Key_op' is a functor that returns the key of an element.
+template <class T, class Key_op>
+class flat_set_base
+{
+public:
+	// Initializes an empty container.
+	flat_set_base();
+
+	// Returns true if this container is empty.
+	bool is_empty() const;
+
+	// Returns the number of elements in this container.
+	size_t size() const;
+
+	// Preallocates memory for 'capacity' elements.
+	void reserve(size_t capacity);
+
+	// Replaces the contents of this container with 'count'
+	// elements in arbitrary order. The elements are sorted
+	// once rather than inserted one by one. Of the elements
+	// with equal keys, the last one is kept, as if the
+	// elements were inserted in order with 'insert()'.
+	void assign(const T* values, size_t count);
+
+	// Finds the element that matches the specified key.
+	// Returns NULL if there is no match.
+	template <class Search_key>
+	T* find(const Search_key& key) const;
+
+	// Structure returned by the search() method.
+	struct search_result
+	{
+		// Returns the element that matches the search
+		// key or NULL if there are no elements or there is
+		// no match.
+		T* match() const;
+
+		// When 'value' is not NULL and 'cmp_result' is
+		// zero, 'value' points to the matching element.
+		// Otherwise, a new element must be inserted before
+		// 'value' if 'cmp_result' is negative or after it
+		// if 'cmp_result' is positive.
+		T* value;
+
+		// The result of comparison between '*value' and the
+		// search key. Zero when the sought element is found.
+		int cmp_result;
+	};
+
+	// Searches for the element that has the specified key.
+	//
+	// Returns a structure containing either the found
+	// element or a hint for the subsequent insertion of
+	// a new element with the same key.
+	template <class Search_key>
+	search_result search(const Search_key& key) const;
+
+	// Inserts a new element after a failed search for it.
+	// The container must not be modified between the search
+	// and the insertion.
+	//
+	// Returns a pointer to the copy of 'value' that is stored
+	// in the container.
+	T* insert_new(const T& value, const search_result& sr);
+
+	// Removes the element that matches the specified key.
+	// Returns true if the element was found and deleted.
+	template <class Search_key>
+	bool remove(const Search_key& key);
+
+	// Returns a pointer to the first element or NULL if there are
+	// no elements.
+	const T* first() const;
+
+	// Returns a pointer to the first element or NULL if there are
+	// no elements.
+	T* first();
+
+	// Returns a pointer to the last element or NULL if there are
+	// no elements.
+	const T* last() const;
+
+	// Returns a pointer to the last element or NULL if there are
+	// no elements.
+	T* last();
+
+	// Returns a pointer to the immediate successor of 'value'
+	// or NULL if 'value' is the last element.
+	const T* next(const T* value) const;
+
+	// Returns a pointer to the immediate successor of 'value'
+	// or NULL if 'value' is the last element.
+	T* next(T* value);
+
+	// Returns a pointer to the immediate predecessor of 'value'
+	// or NULL if 'value' is the first element.
+	const T* prev(const T* value) const;
+
+	// Returns a pointer to the immediate predecessor of 'value'
+	// or NULL if 'value' is the first element.
+	T* prev(T* value);
+
+	// Returns a pointer to the sorted elements.
+	const T* data() const;
+
+	// Random access const iterator type.
+	typedef const T* const_iterator;
+
+	// Starts forward iteration.
+	const_iterator begin() const;
+
+	// Marks the end of forward iteration.
+	const_iterator end() const;
+
+protected:
+	// Returns the position of the first element
+	// whose key is not less than 'key'.
+	template <class Search_key>
+	size_t lower_bound(const Search_key& key) const;
+
+	// Returns a modifiable pointer to the elements.
+	T* elements_for_update() const;
+
+	array<T> elements;
+
+private:
+	flat_set_base(const flat_set_base&);
+	flat_set_base& operator =(const flat_set_base&);
+};
+
+template <class T, class Key_op>
+inline flat_set_base<T, Key_op>::flat_set_base()
+{
+}
+
+template <class T, class Key_op>
+inline bool flat_set_base<T, Key_op>::is_empty() const
+{
+	return elements.is_empty();
+}
+
+template <class T, class Key_op>
+inline size_t flat_set_base<T, Key_op>::size() const
+{
+	return elements.length();
+}
+
+template <class T, class Key_op>
+inline void flat_set_base<T, Key_op>::reserve(size_t capacity)
+{
+	if (capacity > elements.capacity())
+		elements.alloc_and_copy(capacity);
+}
+
+template <class T, class Key_op>
+void flat_set_base<T, Key_op>::assign(const T* values, size_t count)
+{
+	elements.assign(values, count);
+
+	T* sorted = elements.lock();
+
+	flat_key_less<T, Key_op> less;
+
+	stable_sort_with(sorted, count, less);
+
+	size_t unique_count = 0;
+
+	for (size_t i = 0; i < count; ++i)
+		if (unique_count == 0 ||
+				less(sorted[unique_count - 1], sorted[i]))
+		{
+			if (unique_count != i)
+				sorted[unique_count] = sorted[i];
+
+			++unique_count;
+		}
+		else
+			sorted[unique_count - 1] = sorted[i];
+
+	elements.unlock();
+
+	elements.remove(unique_count, count - unique_count);
+}
+
+template <class T, class Key_op>
+template <class Search_key>
+size_t flat_set_base<T, Key_op>::lower_bound(const Search_key& key) const
+{
+	flat_key_iterator<T, Key_op> first = {elements.data()};
+
+	return (size_t) (find_lower_bound(first, elements.length(),
+		key).element - elements.data());
+}
+
+template <class T, class Key_op>
+inline T* flat_set_base<T, Key_op>::elements_for_update() const
+{
+	// The elements are never shared with another array
+	// because the container cannot be copied.
+	return const_cast<T*>(elements.data());
+}
+
+template <class T, class Key_op>
+template <class Search_key>
+T* flat_set_base<T, Key_op>::find(const Search_key& key) const
+{
+	size_t position = lower_bound(key);
+
+	if (position == elements.length())
+		return NULL;
+
+	T* element = elements_for_update() + position;
+
+	return key < Key_op()(*element) ? NULL : element;
+}
+
+template <class T, class Key_op>
+T* flat_set_base<T, Key_op>::search_result::match() const
+{
+	return cmp_result == 0 ? value : NULL;
+}
+
+template <class T, class Key_op>
+template <class Search_key>
+typename flat_set_base<T, Key_op>::search_result
+	flat_set_base<T, Key_op>::search(const Search_key& key) const
+{
+	search_result sr;
+
+	size_t position = lower_bound(key);
+	size_t count = elements.length();
+
+	if (position < count)
+	{
+		sr.value = elements_for_update() + position;
+		sr.cmp_result = key < Key_op()(*sr.value) ? -1 : 0;
+	}
+	else
+		if (count > 0)
+		{
+			sr.value = elements_for_update() + count - 1;
+			sr.cmp_result = 1;
+		}
+		else
+		{
+			sr.value = NULL;
+			sr.cmp_result = 0;
+		}
+
+	return sr;
+}
+
+template <class T, class Key_op>
+T* flat_set_base<T, Key_op>::insert_new(const T& value,
+		const typename flat_set_base<T, Key_op>::search_result& sr)
+{
+	B_ASSERT(sr.match() == NULL);
+
+	size_t position = sr.value == NULL ? 0 :
+		(size_t) (sr.value - elements.data()) + (sr.cmp_result > 0);
+
+	elements.insert(position, 1, value);
+
+	return elements_for_update() + position;
+}
+
+template <class T, class Key_op>
+template <class Search_key>
+bool flat_set_base<T, Key_op>::remove(const Search_key& key)
+{
+	const T* element = find(key);
+
+	if (element == NULL)
+		return false;
+
+	elements.remove((size_t) (element - elements.data()));
+
+	return true;
+}
+
+template <class T, class Key_op>
+const T* flat_set_base<T, Key_op>::first() const
+{
+	return elements.is_empty() ? NULL : elements.data();
+}
+
+template <class T, class Key_op>
+T* flat_set_base<T, Key_op>::first()
+{
+	return elements.is_empty() ? NULL : elements_for_update();
+}
+
+template <class T, class Key_op>
+const T* flat_set_base<T, Key_op>::last() const
+{
+	return elements.is_empty() ? NULL :
+		elements.data() + elements.length() - 1;
+}
+
+template <class T, class Key_op>
+T* flat_set_base<T, Key_op>::last()
+{
+	return elements.is_empty() ? NULL :
+		elements_for_update() + elements.length() - 1;
+}
+
+template <class T, class Key_op>
+const T* flat_set_base<T, Key_op>::next(const T* value) const
+{
+	return ++value == elements.end() ? NULL : value;
+}
+
+template <class T, class Key_op>
+T* flat_set_base<T, Key_op>::next(T* value)
+{
+	return ++value == elements.end() ? NULL : value;
+}
+
+template <class T, class Key_op>
+const T* flat_set_base<T, Key_op>::prev(const T* value) const
+{
+	return value == elements.data() ? NULL : value - 1;
+}
+
+template <class T, class Key_op>
+T* flat_set_base<T, Key_op>::prev(T* value)
+{
+	return value == elements.data() ? NULL : value - 1;
+}
+
+template <class T, class Key_op>
+inline const T* flat_set_base<T, Key_op>::data() const
+{
+	return elements.data();
+}
+
+template <class T, class Key_op>
+inline typename flat_set_base<T, Key_op>::const_iterator
+	flat_set_base<T, Key_op>::begin() const
+{
+	return elements.begin();
+}
+
+template <class T, class Key_op>
+inline typename flat_set_base<T, Key_op>::const_iterator
+	flat_set_base<T, Key_op>::end() const
+{
+	return elements.end();
+}
+
+// Functor that returns the flat set element itself as its key.
+template <class T>
+struct flat_set_key_op
+{
+	typedef T key_type;
+
+	const T& operator()(const T& element) const
+	{
+		return element;
+	}
+};
+
+template <class T>
+class flat_set : public flat_set_base<T, flat_set_key_op<T> >
+{
+public:
+	typedef flat_set_base<T, flat_set_key_op<T> > base;
+
+	// Creates an empty set.
+	flat_set()
+	{
+	}
+
+	// Inserts the specified value into this set.
+	//
+	// If an element with the same key already exists,
+	// its value is overwritten with the specified value.
+	//
+	// The method returns a pointer to the stored copy of 'value'.
+	T* insert(const T& value);
+
+	// Inserts the specified value into this set.
+	//
+	// If an element with the same key already exists,
+	// its value is overwritten with the specified value.
+	//
+	// The method returns a pointer to the stored copy of
+	// 'value' and sets 'new_element' to true or false,
+	// depending on whether an insertion or a replacement has
+	// occurred.
+	T* insert(const T& value, bool* new_element);
+};
+
+template <class T>
+T* flat_set<T>::insert(const T& value)
+{
+	typename base::search_result sr = base::search(value);
+
+	T* match = sr.match();
+
+	if (match != NULL)
+	{
+		*match = value;
+
+		return match;
+	}
+
+	return base::insert_new(value, sr);
+}
+
+template <class T>
+T* flat_set<T>::insert(const T& value, bool* new_inserted)
+{
+	typename base::search_result sr = base::search(value);
+
+	T* match = sr.match();
+
+	if (match != NULL)
+	{
+		*match = value;
+
+		*new_inserted = false;
+
+		return match;
+	}
+
+	*new_inserted = true;
+
+	return base::insert_new(value, sr);
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_FLAT_SET_H) */
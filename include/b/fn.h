@@ -96,6 +96,93 @@ Iter find_lower_bound(Iter first, size_t count, const T& value)
 	return first;
 }
 
+// Determines the same position as find_lower_bound(), but without
+// data-dependent branches: the number of iterations depends only on
+// 'count', and the result of each comparison is folded into the
+// next pointer arithmetically. Both midpoints that the following
+// iteration may read are prefetched, which hides part of the memory
+// latency when the sequence does not fit in the cache.
+template <class T>
+const T* find_lower_bound_branchless(const T* first, size_t count,
+	const T& value)
+{
+	if (count == 0)
+		return first;
+
+	while (count > 1)
+	{
+		size_t half = count >> 1;
+		size_t next_half = (count - half) >> 1;
+
+		memory::prefetch(first + next_half);
+		memory::prefetch(first + half + next_half);
+
+		first += half & -(size_t) (first[half] < value);
+
+		count -= half;
+	}
+
+	return first + (*first < value);
+}
+
+// The number of searches that find_lower_bound_batch()
+// performs simultaneously.
+#define B_LOWER_BOUND_BATCH_SIZE 16
+
+// For each of the 'key_count' elements of 'keys', determines the
+// position of its lower bound in the ordered sequence of 'count'
+// elements pointed to by 'table', and stores it in the respective
+// element of 'positions'.
+//
+// Since the branchless search takes the same number of steps for
+// any key, the searches of a batch advance in lockstep. The loads
+// of different searches are independent of each other, so their
+// cache misses overlap instead of being waited for one by one.
+template <class T>
+void find_lower_bound_batch(const T* table, size_t count,
+	const T* keys, size_t key_count, size_t* positions)
+{
+	if (count == 0)
+	{
+		while (key_count-- > 0)
+			*positions++ = 0;
+
+		return;
+	}
+
+	const T* bases[B_LOWER_BOUND_BATCH_SIZE];
+
+	while (key_count > 0)
+	{
+		size_t batch_size = key_count < B_LOWER_BOUND_BATCH_SIZE ?
+			key_count : B_LOWER_BOUND_BATCH_SIZE;
+
+		size_t i;
+
+		for (i = 0; i < batch_size; ++i)
+			bases[i] = table;
+
+		for (size_t remaining = count; remaining > 1; )
+		{
+			size_t half = remaining >> 1;
+
+			for (i = 0; i < batch_size; ++i)
+				bases[i] += half &
+					-(size_t) (bases[i][half] < keys[i]);
+
+			remaining -= half;
+		}
+
+		for (i = 0; i < batch_size; ++i)
+			positions[i] = (size_t) (bases[i] - table) +
+				(*bases[i] < keys[i]);
+
+		keys += batch_size;
+		positions += batch_size;
+		key_count -= batch_size;
+	}
+}
+
 // Aligns an integer value on the 'alignment' boundary.
 template <class T>
 inline T align(T value, size_t alignment)
@@ -222,6 +309,21 @@ inline size_t calc_length(const wchar_t* string, size_t limit)
 		(size_t) (null_char_ptr - string) : limit;
 }
 
+// Finds the first occurrence of 'ch' among the first 'length'
+// characters of 'string'. Returns NULL if there is no such character.
+inline const char* find_char(const char* string, size_t length, char ch)
+{
+	return (const char*) ::memchr(string, ch, length);
+}
+
+// Finds the first occurrence of 'ch' among the first 'length'
+// characters of 'string' (wchar_t version).
+inline const wchar_t* find_char(const wchar_t* string, size_t length,
+	wchar_t ch)
+{
+	return ::wmemchr(string, ch, length);
+}
+
 // Compares two null-terminated strings.
 inline int compare_strings(const char* lhs, const char* rhs)
 {
@@ -269,6 +371,14 @@ protected:
 public:
 	// Allocate a buffer large enough to contain 'size' bytes.
 	virtual void* allocate(size_t size) = 0;
+
+	// Releases a buffer previously returned by allocate().
+	// 'size' is the size that was requested. The default
+	// implementation does nothing, which suits allocators
+	// that release all their memory at once.
+	virtual void deallocate(void* /*block*/, size_t /*size*/)
+	{
+	}
 };
 
 // Formats a string buffer using a format specification.
@@ -307,6 +417,85 @@ inline size_t char_to_wchar(wchar_t* result, const char* source, size_t length)
 	return ::mbstowcs(result, source, length);
 }
 
+// Locale-independent UTF-8 transcoding
+
+// The maximum number of UTF-8 bytes that a single wide character
+// can be encoded with. For 16-bit wchar_t, a surrogate pair (two
+// wide characters) takes four bytes.
+#define B_UTF8_MAX_BYTES_PER_WCHAR (sizeof(wchar_t) > 2 ? 4 : 3)
+
+// Decodes 'length' bytes of UTF-8 into wide characters (UTF-32 or,
+// where wchar_t is 16 bits wide, UTF-16). Unlike char_to_wchar(),
+// this function does not depend on the current locale.
+//
+// The 'result' buffer must have room for at least 'length' wide
+// characters, which is the upper bound of the decoded length.
+// The result is not null-terminated.
+//
+// Malformed sequences are replaced with U+FFFD, unless 'validate' is
+// true, in which case the function returns (size_t) -1 as soon as
+// it encounters a malformed sequence. Otherwise, the function returns
+// the number of wide characters stored in 'result'.
+size_t utf8_to_wchar(wchar_t* result, const char* source, size_t length,
+	bool validate = false);
+
+// Encodes 'length' wide characters as UTF-8 independently of the
+// current locale.
+//
+// The 'result' buffer must have room for at least
+// 'length * B_UTF8_MAX_BYTES_PER_WCHAR' bytes. The result is not
+// null-terminated.
+//
+// Characters that cannot be represented in UTF-8 (surrogates
+// and values beyond U+10FFFF) are replaced with U+FFFD, unless
+// 'validate' is true, in which case the function returns (size_t) -1.
+// Otherwise, the function returns the number of bytes stored in
+// 'result'.
+size_t wchar_to_utf8(char* result, const wchar_t* source, size_t length,
+	bool validate = false);
+
+// Decodes a UTF-8 string into a new wide character string.
+// Malformed sequences are replaced with U+FFFD.
+wstring utf8_to_wstring(const string_view& utf8);
+
+// Encodes a wide character string as a new UTF-8 string.
+// Invalid characters are replaced with U+FFFD.
+string wstring_to_utf8(const wstring_view& wstr);
+
+// Hashing
+
+// Computes the hash value of a block of memory. The function
+// is fast on both short and long inputs and distributes the
+// values well enough for open addressing. Hash values are not
+// guaranteed to be the same across platforms or library
+// versions, so they must not be persisted.
+size_t hash_bytes(const void* data, size_t length);
+
+// Returns the hash value of a string view.
+inline size_t hash(const string_view& sv)
+{
+	return hash_bytes(sv.data(), sv.length());
+}
+
+// Returns the hash value of a wide string view.
+inline size_t hash(const wstring_view& sv)
+{
+	return hash_bytes(sv.data(), sv.length() * sizeof(wchar_t));
+}
+
+// Returns the hash value of a string. The value is equal to the
+// hash value of a string view of the same characters.
+inline size_t hash(const string& str)
+{
+	return str.hash();
+}
+
+// Returns the hash value of a wide string.
+inline size_t hash(const wstring& str)
+{
+	return str.hash();
+}
+
 // Template functions for construction, destruction,
 // copying and moving of arrays of various objects
 
@@ -444,7 +633,7 @@ template <class T>
 inline void assign_pairwise_reverse(T* dest, const T* source, size_t count)
 {
 #if defined(B_USE_STL)
-	std::copy_backward(source, source + count, dest);
+	std::copy_backward(source, source + count, dest + count);
 #else
 	while (count-- > 0)
 		dest[count] = source[count];
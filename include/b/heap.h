@@ -11,6 +11,11 @@
 
 B_BEGIN_NAMESPACE
 
+// The functions below move elements into a "hole" instead of
+// swapping them: the element being sifted is copied out once,
+// the elements on its way are shifted by a single assignment
+// each, and the element is stored at its final position.
+
 // Adds a value to a binary heap. The last element of the
 // 'data' array (the one with the index size-1) must contain
 // the value to be inserted and the rest of the elements must
@@ -23,23 +28,65 @@ void push_into_heap(T* data, size_t size)
 	// Algorithm:
 	//
 	//   child = size - 1
+	//   value = A[child]
 	//
-	//   while child > 0 and A[parent = child / 2] < A[child]
-	//       A[parent] <=> A[child]
+	//   while child > 0 and A[parent = child / 2] < value
+	//       A[child] = A[parent]
 	//       child = parent
-
-	size_t parent;
+	//
+	//   A[child] = value
 
 	--size; // Use size as the current child index
 
-	while (size > 0 && data[parent = size >> 1] < data[size])
+	if (size > 0)
+	{
+		T value(data[size]);
+
+		size_t parent;
+
+		while (size > 0 && data[parent = size >> 1] < value)
+		{
+			// Move the parent down into the hole
+			data[size] = data[parent];
+
+			// Move up
+			size = parent;
+		}
+
+		data[size] = value;
+	}
+}
+
+// Moves 'value' down from the position 'hole' of a binary
+// heap of 'size' elements until the heap property is restored.
+// The element at 'hole' is overwritten. This function is a
+// building block for pop_from_heap() and make_heap().
+template <class T>
+void sift_down_in_heap(T* data, size_t size, size_t hole, const T& value)
+{
+	// The root has a single child with the index 1;
+	// every other node 'i' has children '2i' and '2i + 1'.
+	size_t child = hole > 0 ? hole << 1 : 1;
+
+	while (child < size)
 	{
-		// Restore the heap property
-		swap(data[parent], data[size]);
+		// If the parent has two children then find
+		// the maximum one (use 'operator <' only)
+		if (child > 1 && child + 1 < size &&
+				data[child] < data[child + 1])
+			++child;
+
+		// Stop if the value is not less than the maximum child
+		if (!(value < data[child]))
+			break;
+
+		data[hole] = data[child];
 
-		// Move up
-		size = parent;
+		hole = child;
+		child <<= 1;
 	}
+
+	data[hole] = value;
 }
 
 // Given a valid heap in the 'data' array, moves the
@@ -51,57 +98,35 @@ void pop_from_heap(T* data, size_t size)
 {
 	B_ASSERT(size > 0);
 
-	// Algorithm:
-	//
-	//   A[size - 1] <=> A[0]
-	//
-	//   i = 0
-	//
-	//   while i has child(ren) and A[i] < A[j = maximum child of i]
-	//       A[i] <=> A[j]
-	//       i = j
-
 	if (size > 1)
 	{
-		// The first call to swap() function will exchange the
-		// first and the last elements of the array
+		size_t last = size - 1;
 
-		size_t child = 0; // Index of the first element
-		size_t parent = size - 1; // Index of the last element
+		T value(data[last]);
 
-		// New index of the last element (after the pop operation)
-		size = parent - 1;
+		data[last] = data[0];
+
+		sift_down_in_heap(data, last, 0, value);
+	}
+}
+
+// Rearranges the elements of the 'data' array into a binary
+// heap. Complexity: O(n), as opposed to O(n * log(n)) for
+// pushing the elements one by one.
+template <class T>
+void make_heap(T* data, size_t size)
+{
+	if (size > 1)
+	{
+		size_t parent = (size - 1) >> 1;
 
 		do
 		{
-			// Restore the heap property
-			swap(data[parent], data[child]);
-
-			// Continue with subtree rooted at child
-			parent = child;
-
-			// Set child to the index of the left child
-			child <<= 1;
-
-			if (child > size)
-				// The parent is a leaf or the tree is empty
-				// (It cannot be empty because of the first
-				// 'if (size > 1)')
-				// heap is in proper order, exit loop
-				break;
-			else
-				// The parent has at least one child
-				// If the parent has two children then
-				// find the maximum one (use 'operator <' only)
-				if (child < size &&
-					data[child] < data[child + 1])
-					// The maximum child is the right child
-					// (or the children are equal)
-					++child;
-
-			// Continue if the parent is less then the maximum child
+			T value(data[parent]);
+
+			sift_down_in_heap(data, size, parent, value);
 		}
-		while (data[parent] < data[child]);
+		while (parent-- > 0);
 	}
 }
 
@@ -112,13 +137,157 @@ void heapsort(T* data, size_t size)
 {
 	if (size > 1)
 	{
-		size_t heap_size = 1;
+		make_heap(data, size);
+
+		while (size > 1)
+			pop_from_heap(data, size--);
+	}
+}
+
+// D-ary heaps
+//
+// In a d-ary heap, each node has up to D children, which are
+// stored next to each other: the children of node 'i' have
+// indices from 'D * i + 1' to 'D * i + D'. With D = 4, the heap
+// is half as tall as a binary heap and the children of a node
+// usually share a cache line, which makes sifting down cheaper
+// for large heaps.
+
+// Default element placement policy for the d-ary heap functions.
+// A custom policy can be used to keep track of element positions.
+template <class T>
+struct heap_placement
+{
+	void operator()(T* data, size_t index, const T& value) const
+	{
+		data[index] = value;
+	}
+};
+
+// Moves 'value' up from the position 'hole' of a d-ary heap
+// until the heap property is restored. Elements are stored
+// using the 'place' policy.
+template <size_t D, class T, class Placement>
+void sift_up_in_dary_heap(T* data, size_t hole, const T& value,
+	Placement place)
+{
+	while (hole > 0)
+	{
+		size_t parent = (hole - 1) / D;
 
-		while (heap_size < size)
-			push_into_heap(data, ++heap_size);
+		if (!(data[parent] < value))
+			break;
+
+		place(data, hole, data[parent]);
+
+		hole = parent;
+	}
 
-		while (heap_size > 1)
-			pop_from_heap(data, heap_size--);
+	place(data, hole, value);
+}
+
+// Moves 'value' down from the position 'hole' of a d-ary heap
+// of 'size' elements until the heap property is restored.
+template <size_t D, class T, class Placement>
+void sift_down_in_dary_heap(T* data, size_t size, size_t hole,
+	const T& value, Placement place)
+{
+	size_t child;
+
+	while ((child = hole * D + 1) < size)
+	{
+		size_t end_of_children = size - child > D ? child + D : size;
+
+		size_t max_child = child;
+
+		while (++child < end_of_children)
+			if (data[max_child] < data[child])
+				max_child = child;
+
+		if (!(value < data[max_child]))
+			break;
+
+		place(data, hole, data[max_child]);
+
+		hole = max_child;
+	}
+
+	place(data, hole, value);
+}
+
+// Adds a value to a d-ary heap. As with push_into_heap(), the
+// value must be stored in the last element of the array.
+template <size_t D, class T>
+void push_into_dary_heap(T* data, size_t size)
+{
+	B_ASSERT(size > 0);
+
+	T value(data[size - 1]);
+
+	sift_up_in_dary_heap<D>(data, size - 1, value, heap_placement<T>());
+}
+
+// Moves the greatest element of a d-ary heap to the end
+// of the array and restores the heap property among the
+// remaining elements.
+template <size_t D, class T>
+void pop_from_dary_heap(T* data, size_t size)
+{
+	B_ASSERT(size > 0);
+
+	if (size > 1)
+	{
+		size_t last = size - 1;
+
+		T value(data[last]);
+
+		data[last] = data[0];
+
+		// The last element is likely to end up near the
+		// bottom, so the hole is moved all the way down
+		// along the path of the greatest children first,
+		// which takes one comparison per child instead of
+		// two, and then the element is sifted up.
+		size_t hole = 0, child;
+
+		while ((child = hole * D + 1) < last)
+		{
+			size_t end_of_children =
+				last - child > D ? child + D : last;
+
+			size_t max_child = child;
+
+			while (++child < end_of_children)
+				if (data[max_child] < data[child])
+					max_child = child;
+
+			data[hole] = data[max_child];
+
+			hole = max_child;
+		}
+
+		sift_up_in_dary_heap<D>(data, hole, value,
+			heap_placement<T>());
+	}
+}
+
+// Rearranges the elements of the 'data' array into
+// a d-ary heap in O(n) time.
+template <size_t D, class T>
+void make_dary_heap(T* data, size_t size)
+{
+	if (size > 1)
+	{
+		size_t parent = (size - 2) / D;
+
+		do
+		{
+			T value(data[parent]);
+
+			sift_down_in_dary_heap<D>(data, size, parent, value,
+				heap_placement<T>());
+		}
+		while (parent-- > 0);
 	}
 }
 
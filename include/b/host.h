@@ -52,6 +52,19 @@
 #define B_PRINTF_STYLE(fmt_index, arg_index)
 #endif /* defined(__GNUG__) */
 
+// The size of the processor cache line. Data that different threads
+// update concurrently is kept this far apart to avoid false sharing.
+#define B_CACHE_LINE_SIZE 64
+
+// Evaluates to true if destroying an object of type T has no
+// effect. Without compiler support, all types are assumed to
+// require destruction.
+#if defined(__GNUG__)
+#define B_HAS_TRIVIAL_DESTRUCTOR(T) __has_trivial_destructor(T)
+#else
+#define B_HAS_TRIVIAL_DESTRUCTOR(T) false
+#endif /* defined(__GNUG__) */
+
 #include <b/config.h>
 
 #include <errno.h>
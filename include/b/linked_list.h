@@ -44,6 +44,12 @@ public:
 	typedef typename Node_access::element_type element_type;
 	typedef typename Node_access::node_type node_type;
 
+	linked_list() :
+		first_element(NULL),
+		last_element(NULL)
+	{
+	}
+
 	linked_list(const Node_access& node_access_inst) :
 		Node_access(node_access_inst),
 		first_element(NULL),
@@ -0,0 +1,322 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_LOCK_FREE_LIST_H
+#define B_LOCK_FREE_LIST_H
+
+#include "atomic.h"
+
+#if B_SIZEOF_SIZE_T != 8
+#include <stdint.h>
+#endif /* B_SIZEOF_SIZE_T != 8 */
+
+B_BEGIN_NAMESPACE
+
+// A structure to implant into objects that are passed between
+// threads through 'lock_free_stack' or 'intrusive_mpsc_queue'.
+// Unlike 'linked_list_node', the link is atomic because other
+// threads may read it while it changes. An object can be in
+// one such container per implanted node.
+//
+// The node must be a superclass of the element, so that
+// 'node_access_via_cast' can convert the node back to
+// the element.
+template <class T>
+class concurrent_list_node
+{
+public:
+	typedef T element_type;
+
+	// The link to the next node. Only the containers
+	// are supposed to access it.
+	atomic_value<concurrent_list_node*> next_node;
+};
+
+// Intrusive lock-free LIFO stack (the Treiber stack). Elements are
+// linked through their implanted nodes, so pushing and popping
+// never allocate memory.
+//
+// The top of the stack is a pointer combined with a counter that
+// changes with every update, which protects pop() from the ABA
+// problem: when a thread pops an element, another thread pops it
+// too and pushes it back, the first thread notices the change even
+// though the top element is the same. On 64-bit platforms, the
+// counter occupies the upper 16 bits of the pointer, which assumes
+// that addresses fit in 48 bits, as they do in the user space of
+// the common 64-bit processors.
+//
+// pop() reads the link of the top element, which may have just been
+// popped by another thread. Elements must therefore stay readable
+// as long as another thread may be popping: they can be reused but
+// not freed, unless memory reclamation is coordinated otherwise.
+template <class Node_access>
+class lock_free_stack : public Node_access
+{
+public:
+	typedef typename Node_access::element_type element_type;
+	typedef typename Node_access::node_type node_type;
+
+	// Creates an empty stack.
+	lock_free_stack();
+
+	// Returns true if the stack is empty.
+	bool is_empty() const;
+
+	// Pushes 'element' onto the stack.
+	void push(element_type* element);
+
+	// Removes the top element from the stack and returns it.
+	// Returns NULL if the stack is empty.
+	element_type* pop();
+
+	// Removes all elements from the stack at once and returns
+	// the former top element. The elements remain linked from
+	// the top to the bottom and can be iterated with next().
+	element_type* pop_all();
+
+	// Returns the element that follows 'element' in the chain
+	// returned by pop_all().
+	static element_type* next(element_type* element);
+
+private:
+	lock_free_stack(const lock_free_stack&);
+	lock_free_stack& operator =(const lock_free_stack&);
+
+	typedef concurrent_list_node<element_type> link;
+
+	// The pointer occupies the lower 'pointer_bits' bits
+	// and the counter occupies the rest.
+#if B_SIZEOF_SIZE_T == 8
+	typedef size_t tagged_pointer;
+
+	enum {pointer_bits = 48};
+#else
+	typedef uint64_t tagged_pointer;
+
+	enum {pointer_bits = 32};
+#endif /* B_SIZEOF_SIZE_T == 8 */
+
+	static link* pointer_part(tagged_pointer top_value);
+
+	// Combines 'new_top' with the incremented counter
+	// from 'top_value'.
+	static tagged_pointer replace_pointer(tagged_pointer top_value,
+		link* new_top);
+
+	static element_type* element_for(link* node);
+
+	atomic_value<tagged_pointer> top;
+};
+
+template <class Node_access>
+lock_free_stack<Node_access>::lock_free_stack()
+{
+}
+
+template <class Node_access>
+inline typename lock_free_stack<Node_access>::link*
+	lock_free_stack<Node_access>::pointer_part(tagged_pointer top_value)
+{
+	return (link*) (size_t) (top_value &
+		(((tagged_pointer) 1 << pointer_bits) - 1));
+}
+
+template <class Node_access>
+inline typename lock_free_stack<Node_access>::tagged_pointer
+	lock_free_stack<Node_access>::replace_pointer(
+		tagged_pointer top_value, link* new_top)
+{
+	return (((top_value >> pointer_bits) + 1) << pointer_bits) |
+		(tagged_pointer) (size_t) new_top;
+}
+
+template <class Node_access>
+inline typename lock_free_stack<Node_access>::element_type*
+	lock_free_stack<Node_access>::element_for(link* node)
+{
+	return node == NULL ? NULL :
+		Node_access::element_for(static_cast<node_type*>(node));
+}
+
+template <class Node_access>
+inline bool lock_free_stack<Node_access>::is_empty() const
+{
+	return pointer_part(top.load(memory_order_relaxed)) == NULL;
+}
+
+template <class Node_access>
+void lock_free_stack<Node_access>::push(element_type* element)
+{
+	B_ASSERT(element != NULL);
+
+	link* node = Node_access::node_for(element);
+
+	tagged_pointer top_value = top.load(memory_order_relaxed);
+
+	do
+		node->next_node.store(pointer_part(top_value),
+			memory_order_relaxed);
+	while (!top.compare_exchange(&top_value,
+		replace_pointer(top_value, node), memory_order_release));
+}
+
+template <class Node_access>
+typename lock_free_stack<Node_access>::element_type*
+	lock_free_stack<Node_access>::pop()
+{
+	tagged_pointer top_value = top.load(memory_order_acquire);
+
+	for (;;)
+	{
+		link* node = pointer_part(top_value);
+
+		if (node == NULL)
+			return NULL;
+
+		link* next_node = node->next_node.load(memory_order_relaxed);
+
+		if (top.compare_exchange(&top_value,
+				replace_pointer(top_value, next_node),
+				memory_order_acquire))
+			return element_for(node);
+	}
+}
+
+template <class Node_access>
+typename lock_free_stack<Node_access>::element_type*
+	lock_free_stack<Node_access>::pop_all()
+{
+	tagged_pointer top_value = top.load(memory_order_relaxed);
+
+	while (!top.compare_exchange(&top_value,
+			replace_pointer(top_value, NULL), memory_order_acquire))
+		;
+
+	return element_for(pointer_part(top_value));
+}
+
+template <class Node_access>
+inline typename lock_free_stack<Node_access>::element_type*
+	lock_free_stack<Node_access>::next(element_type* element)
+{
+	return element_for(Node_access::node_for(element)->next_node.load(
+		memory_order_relaxed));
+}
+
+// Intrusive unbounded FIFO queue for any number of producer threads
+// and one consumer thread (Vyukov's algorithm). A producer links an
+// element with a single atomic exchange followed by a store, so
+// push() never waits for other threads. Neither operation
+// allocates memory.
+//
+// If a producer is preempted between the exchange and the store,
+// the consumer cannot reach the elements pushed after it yet, and
+// pop() returns NULL until the producer resumes.
+template <class Node_access>
+class intrusive_mpsc_queue : public Node_access
+{
+public:
+	typedef typename Node_access::element_type element_type;
+	typedef typename Node_access::node_type node_type;
+
+	// Creates an empty queue.
+	intrusive_mpsc_queue();
+
+	// Appends 'element' to the queue. Can be called
+	// by any thread.
+	void push(element_type* element);
+
+	// Removes the oldest element from the queue and returns
+	// it. Returns NULL if the queue is empty. Must only be
+	// called by the consumer thread.
+	element_type* pop();
+
+private:
+	intrusive_mpsc_queue(const intrusive_mpsc_queue&);
+	intrusive_mpsc_queue& operator =(const intrusive_mpsc_queue&);
+
+	typedef concurrent_list_node<element_type> link;
+
+	void push_node(link* node);
+
+	// The most recently pushed node.
+	atomic_value<link*> head;
+
+	char padding[B_CACHE_LINE_SIZE];
+
+	// The node before the oldest element. It is either
+	// the stub or the element that was popped last.
+	link* tail;
+
+	// Placeholder node that keeps the list non-empty.
+	link stub;
+};
+
+template <class Node_access>
+intrusive_mpsc_queue<Node_access>::intrusive_mpsc_queue() :
+	head(&stub),
+	tail(&stub)
+{
+}
+
+template <class Node_access>
+inline void intrusive_mpsc_queue<Node_access>::push_node(link* node)
+{
+	node->next_node.store(NULL, memory_order_relaxed);
+
+	link* prev = head.exchange(node, memory_order_acq_rel);
+
+	prev->next_node.store(node, memory_order_release);
+}
+
+template <class Node_access>
+void intrusive_mpsc_queue<Node_access>::push(element_type* element)
+{
+	B_ASSERT(element != NULL);
+
+	push_node(Node_access::node_for(element));
+}
+
+template <class Node_access>
+typename intrusive_mpsc_queue<Node_access>::element_type*
+	intrusive_mpsc_queue<Node_access>::pop()
+{
+	link* first = tail;
+	link* next = first->next_node.load(memory_order_acquire);
+
+	if (first == &stub)
+	{
+		if (next == NULL)
+			return NULL;
+
+		// Skip the stub.
+		tail = first = next;
+		next = next->next_node.load(memory_order_acquire);
+	}
+
+	if (next == NULL)
+	{
+		// 'first' may be the last element. Before it can be
+		// popped, the stub must be pushed behind it, so that
+		// the list does not become empty.
+		if (first != head.load(memory_order_acquire))
+			// A producer has not linked its element yet.
+			return NULL;
+
+		push_node(&stub);
+
+		next = first->next_node.load(memory_order_acquire);
+
+		if (next == NULL)
+			return NULL;
+	}
+
+	tail = next;
+
+	return Node_access::element_for(static_cast<node_type*>(first));
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_LOCK_FREE_LIST_H) */
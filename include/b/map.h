@@ -23,24 +23,38 @@ struct kv_pair
 
 // Functor that returns the key for to the map element stored
 // with the specified tree node.
-template <class Key, class T>
+template <class Key, class T, class Node = binary_tree_node>
 struct map_key_op
 {
 	const Key& operator()(const binary_tree_node* node) const
 	{
 		B_ASSERT(node != NULL);
 
-		return static_cast<const set_element<kv_pair<Key, T> >*>(
+		return static_cast<const set_element<kv_pair<Key, T>, Node>*>(
 			node)->value.key;
 	}
 };
 
 // Associative array container with unique keys.
-template <class Key, class T>
-class map : public set_base<kv_pair<Key, T>, map_key_op<Key, T> >
+template <class Key, class T, class Tree_base = binary_search_tree_base>
+class map : public set_base<kv_pair<Key, T>,
+	map_key_op<Key, T, typename Tree_base::node_type>, Tree_base>
 {
 public:
-	typedef set_base<kv_pair<Key, T>, map_key_op<Key, T> > base;
+	typedef set_base<kv_pair<Key, T>, map_key_op<Key, T,
+		typename Tree_base::node_type>, Tree_base> base;
+
+	// Creates an empty map that allocates its elements
+	// from a pool owned by the map.
+	map()
+	{
+	}
+
+	// Creates an empty map that allocates its elements
+	// with the specified allocator.
+	explicit map(allocator* element_allocator) : base(element_allocator)
+	{
+	}
 
 	// Finds the value that matches the specified key.
 	// Returns NULL if there is no match.
@@ -72,24 +86,24 @@ public:
 			bool* new_inserted);
 };
 
-template <class Key, class T>
+template <class Key, class T, class Tree_base>
 template <class Search_key>
-T* map<Key, T>::find(const Search_key& key) const
+T* map<Key, T, Tree_base>::find(const Search_key& key) const
 {
 	kv_pair<Key, T>* match = base::find(key);
 
 	return match != NULL ? &match->value : NULL;
 }
 
-template <class Key, class T>
-kv_pair<Key, T>* map<Key, T>::insert_new(const Key &key, const T &value,
-		const typename map<Key, T>::base::search_result& sr)
+template <class Key, class T, class Tree_base>
+kv_pair<Key, T>* map<Key, T, Tree_base>::insert_new(const Key &key, const T &value,
+		const typename map<Key, T, Tree_base>::base::search_result& sr)
 {
 	return base::insert_new(kv_pair<Key, T>(key, value), sr);
 }
 
-template <class Key, class T>
-kv_pair<Key, T>* map<Key, T>::insert(const Key& key, const T& value)
+template <class Key, class T, class Tree_base>
+kv_pair<Key, T>* map<Key, T, Tree_base>::insert(const Key& key, const T& value)
 {
 	typename base::search_result sr = base::search(key);
 
@@ -105,8 +119,8 @@ kv_pair<Key, T>* map<Key, T>::insert(const Key& key, const T& value)
 	return base::insert_new(kv_pair<Key, T>(key, value), sr);
 }
 
-template <class Key, class T>
-kv_pair<Key, T>* map<Key, T>::insert(const Key& key, const T& value,
+template <class Key, class T, class Tree_base>
+kv_pair<Key, T>* map<Key, T, Tree_base>::insert(const Key& key, const T& value,
 		bool* new_inserted)
 {
 	typename base::search_result sr = base::search(key);
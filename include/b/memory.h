@@ -13,6 +13,95 @@ B_BEGIN_NAMESPACE
 // can allocate.
 #define B_MIN_FIXED_ALLOC (sizeof(void*) * 2)
 
+// The sizes of the chunks that memory::fixed_alloc() allocates from
+// its slabs are multiples of this value. Larger requests are passed
+// to memory::alloc().
+#define B_FIXED_ALLOC_GRANULARITY 16
+#define B_MAX_FIXED_ALLOC 256
+
+// The size of the slabs that memory::fixed_alloc() carves
+// chunks from. Must be a power of two.
+#define B_FIXED_ALLOC_SLAB_SIZE 16384
+
+// The number of empty slabs of each size class that a thread
+// keeps for reuse before returning the slabs to the system.
+#define B_FIXED_ALLOC_SPARE_SLABS 1
+
+// Usage counters of one size class of memory::fixed_alloc().
+struct fixed_alloc_stats
+{
+	// The size of the chunks in this class.
+	size_t chunk_size;
+
+	// The number of chunks allocated and not yet freed. Chunks
+	// freed by threads other than the one that allocated them
+	// count as live until the allocating thread takes them back.
+	size_t live;
+
+	// The number of free chunks in the slabs of this class.
+	size_t cached;
+
+	// The largest number of chunks that the slabs of this
+	// class have held at the same time.
+	size_t peak;
+};
+
+// The number of size classes by which memory::alloc() counts
+// allocations when the library is configured with allocation
+// tracking. Class 'n' contains the blocks of up to 2^n bytes;
+// the last class contains all larger blocks.
+#define B_ALLOC_SIZE_CLASSES 32
+
+// One in this many allocations made by memory::alloc() records
+// its call site when allocation tracking is enabled.
+#ifndef B_ALLOC_SAMPLE_INTERVAL
+#define B_ALLOC_SAMPLE_INTERVAL 64
+#endif
+
+// The maximum number of distinct call sites that allocation
+// tracking records. Allocations from further sites are counted
+// together under a null call site.
+#define B_ALLOC_MAX_SITES 1024
+
+// Counters of the blocks allocated by memory::alloc(). They are
+// only maintained if the library is configured with
+// '-DB_ALLOC_TRACKING=ON'; otherwise, they are always zero.
+struct allocation_counters
+{
+	// The number of blocks allocated so far.
+	size_t allocations;
+
+	// The number of blocks allocated and not yet freed.
+	size_t live_blocks;
+
+	// The total size of those blocks.
+	size_t live_bytes;
+
+	// The largest value that 'live_bytes' has reached.
+	size_t peak_bytes;
+};
+
+// Allocations made from one call site, estimated from the
+// sampled allocations by multiplying their numbers by
+// B_ALLOC_SAMPLE_INTERVAL.
+struct allocation_site
+{
+	// The return address of the call to memory::alloc(). A
+	// debugger can resolve it to a source line, and so can
+	// addr2line once the load address of the module is
+	// subtracted from it.
+	const void* caller;
+
+	// The estimated number of allocations made from this site.
+	size_t allocations;
+
+	// The estimated number of bytes allocated from
+	// this site and not yet freed.
+	size_t live_bytes;
+};
+
+class output_stream;
+
 // Utility class for memory management. This class comprises
 // system-independent wrappers around common memory handling
 // routines, and also provides an effective technique for
@@ -31,16 +120,56 @@ public:
 	// the alloc() method.
 	static void free(void* block);
 
+	// Returns the counters of all blocks allocated by alloc().
+	static allocation_counters allocation_totals();
+
+	// Returns the counters of the blocks of the specified
+	// size class (see B_ALLOC_SIZE_CLASSES).
+	static allocation_counters allocations_by_size(size_t size_class);
+
+	// Copies up to 'max_count' call sites of alloc() to 'sites'
+	// in no particular order. Returns the number of recorded sites,
+	// which may exceed 'max_count'.
+	static size_t allocation_sites(allocation_site* sites,
+		size_t max_count);
+
+	// Writes a human-readable report of the allocation counters,
+	// including the size classes and the call sites with the
+	// most live bytes, to 'stream'.
+	static void dump_allocations(output_stream* stream);
+
 	// Allocates a chunk of memory of the appropriate size
 	// from the internal list of free chunks. If no such chunk
 	// is found, the method allocates a new one from the heap.
 	// Throws 'system_exception' if an out-of-memory condition occurs.
+	//
+	// Each thread allocates chunks from its own slabs without
+	// synchronization. The slabs of a thread that exits are
+	// taken over by the next thread that calls this method.
 	static void* fixed_alloc(size_t size);
 
 	// Places a chunk of memory allocated by a previous call
 	// to the fixed_alloc() method back to the list of free chunks.
+	// A chunk freed by a thread other than the one that has
+	// allocated it is passed back to the allocating thread
+	// through a lock-free list.
 	static void fixed_free(void* chunk, size_t size);
 
+	// Returns the number of size classes of fixed_alloc().
+	static size_t fixed_size_class_count();
+
+	// Returns the usage counters of the specified size class. The
+	// counters are collected from all threads without stopping
+	// them and may be slightly inconsistent with each other.
+	static fixed_alloc_stats fixed_stats(size_t size_class);
+
+	// Takes back the chunks freed by other threads and returns
+	// all empty slabs to the system, both for the calling thread
+	// and for the slabs of exited threads that no other thread
+	// has taken over. Long-running programs can call this method
+	// periodically to release memory after a peak in usage.
+	static void trim_fixed_caches();
+
 	// Fills 'length' bytes of memory pointed to by 'block' with the
 	// specified byte value.
 	static void fill(void* block, size_t length, char filler);
@@ -70,13 +199,21 @@ public:
 	// Aligns a pointer on the 'alignment' boundary.
 	// The boundary must be given as a power of two.
 	static void* align(void* value, size_t alignment);
+
+	// Hints the processor to start loading the cache line that
+	// contains 'address'. The address does not have to be valid.
+	static void prefetch(const void* address);
 };
 
+#if !defined(B_ALLOC_TRACKING)
+
 inline void memory::free(void* block)
 {
 	::free(block);
 }
 
+#endif /* !defined(B_ALLOC_TRACKING) */
+
 inline void memory::fill(void* block, size_t length, char filler)
 {
 	::memset(block, filler, length);
@@ -119,6 +256,15 @@ inline void* memory::align(void* value, size_t alignment)
 	return (void*) align((size_t) value, alignment);
 }
 
+inline void memory::prefetch(const void* address)
+{
+#if defined(__GNUG__)
+	__builtin_prefetch(address);
+#else
+	(void) address;
+#endif /* defined(__GNUG__) */
+}
+
 B_END_NAMESPACE
 
 #include "system_exception.h"
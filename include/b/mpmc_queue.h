@@ -0,0 +1,227 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_MPMC_QUEUE_H
+#define B_MPMC_QUEUE_H
+
+#include "atomic.h"
+#include "memory.h"
+
+B_BEGIN_NAMESPACE
+
+// Bounded lock-free FIFO queue for any number of producer and
+// consumer threads.
+//
+// Each cell of the ring buffer carries a sequence number, which
+// tells a producer that the cell is free for the element at the
+// current write position and a consumer that the cell holds the
+// element at the current read position. A thread claims a position
+// with a single compare-and-swap and then publishes the cell by
+// advancing its sequence number, so producers and consumers only
+// contend with each other for the positions at the ends of the
+// queue.
+//
+// The copy constructor and the destructor of T must not throw.
+template <class T>
+class mpmc_queue
+{
+public:
+	typedef T value_type;
+
+	// Creates an empty queue that can hold at least 'min_capacity'
+	// elements. The capacity is rounded up to a power of two.
+	explicit mpmc_queue(size_t min_capacity);
+
+	// Returns the maximum number of elements in the queue.
+	size_t capacity() const;
+
+	// Appends a copy of 'value' to the queue. Returns false
+	// if the queue is full.
+	bool try_push(const T& value);
+
+	// Appends up to 'count' elements to the queue and returns
+	// the number of elements that fit.
+	size_t try_push(const T* values, size_t count);
+
+	// Removes the oldest element from the queue and assigns it
+	// to '*value'. Returns false if the queue is empty.
+	bool try_pop(T* value);
+
+	// Removes up to 'max_count' oldest elements and returns
+	// their number.
+	size_t try_pop(T* values, size_t max_count);
+
+	// Destroys the elements that remain in the queue.
+	// No other thread may access the queue at this point.
+	~mpmc_queue();
+
+private:
+	mpmc_queue(const mpmc_queue&);
+	mpmc_queue& operator =(const mpmc_queue&);
+
+	// The element is constructed and destroyed in place
+	// as the cell is filled and emptied.
+	struct cell
+	{
+		atomic_value<size_t> sequence;
+		T value;
+	};
+
+	char padding_before[B_CACHE_LINE_SIZE];
+
+	cell* cells;
+	size_t mask;
+
+	char padding_after_cells[B_CACHE_LINE_SIZE];
+
+	atomic_value<size_t> push_position;
+
+	char padding_after_push[B_CACHE_LINE_SIZE];
+
+	atomic_value<size_t> pop_position;
+
+	char padding_after_pop[B_CACHE_LINE_SIZE];
+};
+
+template <class T>
+mpmc_queue<T>::mpmc_queue(size_t min_capacity)
+{
+	size_t size = 2;
+
+	while (size < min_capacity)
+		size <<= 1;
+
+	mask = size - 1;
+
+	cells = (cell*) memory::alloc(size * sizeof(cell));
+
+	for (size_t i = 0; i < size; ++i)
+		new (&cells[i].sequence) atomic_value<size_t>(i);
+}
+
+template <class T>
+inline size_t mpmc_queue<T>::capacity() const
+{
+	return mask + 1;
+}
+
+template <class T>
+bool mpmc_queue<T>::try_push(const T& value)
+{
+	size_t position = push_position.load(memory_order_relaxed);
+
+	cell* target;
+
+	for (;;)
+	{
+		target = cells + (position & mask);
+
+		size_t sequence = target->sequence.load(memory_order_acquire);
+
+		if (sequence == position)
+		{
+			// The cell is free. On failure, the compare-and-swap
+			// loads the position claimed by another producer.
+			if (push_position.compare_exchange(&position,
+					position + 1, memory_order_relaxed))
+				break;
+		}
+		else
+			if ((ptrdiff_t) (sequence - position) < 0)
+				// The cell still holds the element
+				// pushed one lap ago.
+				return false;
+			else
+				position = push_position.load(
+					memory_order_relaxed);
+	}
+
+	new (&target->value) T(value);
+
+	target->sequence.store(position + 1, memory_order_release);
+
+	return true;
+}
+
+template <class T>
+size_t mpmc_queue<T>::try_push(const T* values, size_t count)
+{
+	size_t pushed = 0;
+
+	while (pushed < count && try_push(values[pushed]))
+		++pushed;
+
+	return pushed;
+}
+
+template <class T>
+bool mpmc_queue<T>::try_pop(T* value)
+{
+	size_t position = pop_position.load(memory_order_relaxed);
+
+	cell* source;
+
+	for (;;)
+	{
+		source = cells + (position & mask);
+
+		size_t sequence = source->sequence.load(memory_order_acquire);
+
+		ptrdiff_t difference = (ptrdiff_t) (sequence - (position + 1));
+
+		if (difference == 0)
+		{
+			if (pop_position.compare_exchange(&position,
+					position + 1, memory_order_relaxed))
+				break;
+		}
+		else
+			if (difference < 0)
+				// The element at this position
+				// has not been pushed yet.
+				return false;
+			else
+				position = pop_position.load(
+					memory_order_relaxed);
+	}
+
+	*value = source->value;
+
+	source->value.~T();
+
+	// Free the cell for the element one lap ahead.
+	source->sequence.store(position + mask + 1, memory_order_release);
+
+	return true;
+}
+
+template <class T>
+size_t mpmc_queue<T>::try_pop(T* values, size_t max_count)
+{
+	size_t popped = 0;
+
+	while (popped < max_count && try_pop(values + popped))
+		++popped;
+
+	return popped;
+}
+
+template <class T>
+mpmc_queue<T>::~mpmc_queue()
+{
+	size_t end = push_position.load(memory_order_relaxed);
+
+	for (size_t position = pop_position.load(memory_order_relaxed);
+			position != end; ++position)
+		cells[position & mask].value.~T();
+
+	for (size_t i = 0; i <= mask; ++i)
+		cells[i].sequence.~atomic_value<size_t>();
+
+	memory::free(cells);
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_MPMC_QUEUE_H) */
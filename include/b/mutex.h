@@ -0,0 +1,538 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_MUTEX_H
+#define B_MUTEX_H
+
+#include "atomic.h"
+
+#include <pthread.h>
+#include <stdint.h>
+
+B_BEGIN_NAMESPACE
+
+// The number of times a thread retries to acquire a contended lock
+// before it goes to sleep. Short critical sections are often over
+// by then, which saves two system calls.
+#ifndef B_MUTEX_SPIN_COUNT
+#define B_MUTEX_SPIN_COUNT 100
+#endif
+
+// Contention counters of a lock. They are only maintained if the
+// library is configured with '-DB_LOCK_STATS=ON'; otherwise, they
+// are always zero.
+struct lock_stats
+{
+	// The number of times the lock has been acquired
+	// (in any mode for 'shared_mutex').
+	size_t acquisitions;
+
+	// How many of those acquisitions found the lock
+	// held by another thread and had to wait.
+	size_t contended_acquisitions;
+
+	// The total time spent waiting for the lock.
+	uint64_t wait_nanoseconds;
+};
+
+// Counters behind 'lock_stats', updated concurrently.
+class lock_counters
+{
+public:
+	// Records an acquisition of the lock.
+	void count_acquisition();
+
+	// Records an acquisition that had to wait, starting at
+	// the time returned by wait_start().
+	void count_contended_acquisition(uint64_t start);
+
+	// Returns the current time for count_contended_acquisition()
+	// or zero if the statistics are disabled.
+	static uint64_t wait_start();
+
+	// Returns a snapshot of the counters.
+	lock_stats get() const;
+
+	// Sets the counters to zero.
+	void reset();
+
+#if defined(B_LOCK_STATS)
+private:
+	atomic_value<size_t> acquisitions;
+	atomic_value<size_t> contended_acquisitions;
+	atomic_value<uint64_t> wait_nanoseconds;
+#endif /* defined(B_LOCK_STATS) */
+};
+
+// Non-recursive mutual exclusion lock. A thread that finds the
+// lock held spins for a while and then sleeps until the lock is
+// released. On Linux, an uncontended lock and unlock is a single
+// atomic instruction each, and the threads sleep on a futex.
+class mutex
+{
+public:
+	// Initializes the mutex in the unlocked state.
+	// Throws 'system_exception' if initialization fails.
+	mutex();
+
+	// Acquires the lock, blocking the calling
+	// thread until the lock becomes available.
+	void lock();
+
+	// Acquires the lock if it is available. Returns
+	// false if the lock is held by another thread.
+	bool try_lock();
+
+	// Releases the lock held by the calling thread.
+	void unlock();
+
+	// Returns the contention counters of this mutex.
+	lock_stats stats() const;
+
+	// Sets the contention counters to zero.
+	void reset_stats();
+
+	// Destroys the mutex, which must not be locked.
+	~mutex();
+
+private:
+	mutex(const mutex&);
+	mutex& operator =(const mutex&);
+
+	friend class condition;
+
+	void lock_contended();
+
+#if defined(B_HAVE_LINUX_FUTEX_H)
+	// Reacquires the lock after waiting on a condition.
+	void lock_after_wait();
+
+	void wake_waiter();
+
+	// Zero if the mutex is unlocked, one if it is locked,
+	// and two if it is locked and other threads may be
+	// sleeping on it.
+	atomic_value<int> state;
+#else
+	pthread_mutex_t handle;
+#endif /* defined(B_HAVE_LINUX_FUTEX_H) */
+
+	lock_counters counters;
+};
+
+// Holds a mutex locked for the lifetime of this object.
+class mutex_lock
+{
+public:
+	// Acquires the specified mutex.
+	explicit mutex_lock(mutex& m) : locked_mutex(m)
+	{
+		locked_mutex.lock();
+	}
+
+	// Releases the mutex.
+	~mutex_lock()
+	{
+		locked_mutex.unlock();
+	}
+
+private:
+	mutex_lock(const mutex_lock&);
+	mutex_lock& operator =(const mutex_lock&);
+
+	mutex& locked_mutex;
+};
+
+// Condition variable that threads wait on while holding a mutex.
+class condition
+{
+public:
+	// Initializes the condition variable.
+	// Throws 'system_exception' if initialization fails.
+	condition();
+
+	// Atomically releases 'locked_mutex', which must be held
+	// by the calling thread, and blocks until the condition
+	// is signaled. The mutex is reacquired before returning.
+	// The wait can end without a signal, so the caller must
+	// recheck the awaited state.
+	void wait(mutex& locked_mutex);
+
+	// Unblocks at least one of the waiting threads.
+	void signal();
+
+	// Unblocks all waiting threads.
+	void broadcast();
+
+	// Destroys the condition variable, which must have
+	// no waiters.
+	~condition();
+
+private:
+	condition(const condition&);
+	condition& operator =(const condition&);
+
+#if defined(B_HAVE_LINUX_FUTEX_H)
+	// Incremented by every signal. A waiter sleeps only
+	// while the sequence has not changed since it released
+	// the mutex.
+	atomic_value<int> sequence;
+#else
+	pthread_cond_t handle;
+#endif /* defined(B_HAVE_LINUX_FUTEX_H) */
+};
+
+// Reader-writer lock for read-mostly data. Any number of readers
+// can hold the lock at the same time, while a writer holds it
+// exclusively. On Linux, once a writer is waiting, new readers
+// wait too, so that a stream of readers cannot starve the writers.
+//
+// The lock is not recursive in either mode.
+class shared_mutex
+{
+public:
+	// Initializes the lock in the unlocked state.
+	// Throws 'system_exception' if initialization fails.
+	shared_mutex();
+
+	// Acquires the lock for writing.
+	void lock();
+
+	// Acquires the lock for writing if no other thread
+	// holds it in any mode.
+	bool try_lock();
+
+	// Releases the lock held for writing.
+	void unlock();
+
+	// Acquires the lock for reading.
+	void lock_shared();
+
+	// Acquires the lock for reading unless a writer
+	// holds it or is waiting for it.
+	bool try_lock_shared();
+
+	// Releases the lock held for reading.
+	void unlock_shared();
+
+	// Returns the contention counters of this lock.
+	lock_stats stats() const;
+
+	// Sets the contention counters to zero.
+	void reset_stats();
+
+	// Destroys the lock, which must not be held.
+	~shared_mutex();
+
+private:
+	shared_mutex(const shared_mutex&);
+	shared_mutex& operator =(const shared_mutex&);
+
+	void lock_contended();
+	void lock_shared_contended();
+
+#if defined(B_HAVE_LINUX_FUTEX_H)
+	// Bits of 'state'.
+	enum
+	{
+		writer = 1,
+		writer_waiting = 2,
+		sleepers = 4,
+		reader = 8
+	};
+
+	// Releases the lock and wakes up the sleeping
+	// threads if there are any.
+	void release(int held);
+
+	// Marks the lock as having sleepers and sleeps
+	// until the state changes from 'expected'.
+	void sleep(int expected);
+
+	// The 'writer' flag, the 'writer_waiting' flag, the
+	// 'sleepers' flag, and the number of readers multiplied
+	// by 'reader'.
+	atomic_value<int> state;
+#else
+	pthread_rwlock_t handle;
+#endif /* defined(B_HAVE_LINUX_FUTEX_H) */
+
+	lock_counters counters;
+};
+
+// Holds a shared_mutex locked for reading for the
+// lifetime of this object.
+class read_lock
+{
+public:
+	// Acquires the specified lock for reading.
+	explicit read_lock(shared_mutex& m) : locked_mutex(m)
+	{
+		locked_mutex.lock_shared();
+	}
+
+	// Releases the lock.
+	~read_lock()
+	{
+		locked_mutex.unlock_shared();
+	}
+
+private:
+	read_lock(const read_lock&);
+	read_lock& operator =(const read_lock&);
+
+	shared_mutex& locked_mutex;
+};
+
+// Holds a shared_mutex locked for writing for the
+// lifetime of this object.
+class write_lock
+{
+public:
+	// Acquires the specified lock for writing.
+	explicit write_lock(shared_mutex& m) : locked_mutex(m)
+	{
+		locked_mutex.lock();
+	}
+
+	// Releases the lock.
+	~write_lock()
+	{
+		locked_mutex.unlock();
+	}
+
+private:
+	write_lock(const write_lock&);
+	write_lock& operator =(const write_lock&);
+
+	shared_mutex& locked_mutex;
+};
+
+#if defined(B_LOCK_STATS)
+
+inline void lock_counters::count_acquisition()
+{
+	acquisitions.fetch_add(1, memory_order_relaxed);
+}
+
+#else
+
+inline void lock_counters::count_acquisition()
+{
+}
+
+inline void lock_counters::count_contended_acquisition(uint64_t)
+{
+}
+
+inline uint64_t lock_counters::wait_start()
+{
+	return 0;
+}
+
+inline lock_stats lock_counters::get() const
+{
+	lock_stats s = {0, 0, 0};
+
+	return s;
+}
+
+inline void lock_counters::reset()
+{
+}
+
+#endif /* defined(B_LOCK_STATS) */
+
+#if defined(B_HAVE_LINUX_FUTEX_H)
+
+inline mutex::mutex()
+{
+}
+
+inline void mutex::lock()
+{
+	int unlocked = 0;
+
+	if (!state.compare_exchange(&unlocked, 1, memory_order_acquire))
+		lock_contended();
+
+	counters.count_acquisition();
+}
+
+inline bool mutex::try_lock()
+{
+	int unlocked = 0;
+
+	if (!state.compare_exchange(&unlocked, 1, memory_order_acquire))
+		return false;
+
+	counters.count_acquisition();
+
+	return true;
+}
+
+inline void mutex::unlock()
+{
+	if (state.exchange(0, memory_order_release) == 2)
+		wake_waiter();
+}
+
+inline mutex::~mutex()
+{
+}
+
+inline condition::condition()
+{
+}
+
+inline condition::~condition()
+{
+}
+
+inline shared_mutex::shared_mutex()
+{
+}
+
+inline void shared_mutex::lock()
+{
+	int unlocked = 0;
+
+	if (!state.compare_exchange(&unlocked, writer, memory_order_acquire))
+		lock_contended();
+
+	counters.count_acquisition();
+}
+
+inline void shared_mutex::unlock()
+{
+	release(writer);
+}
+
+inline void shared_mutex::lock_shared()
+{
+	int s = state.load(memory_order_relaxed);
+
+	if ((s & (writer | writer_waiting)) != 0 ||
+			!state.compare_exchange(&s, s + reader,
+				memory_order_acquire))
+		lock_shared_contended();
+
+	counters.count_acquisition();
+}
+
+inline void shared_mutex::unlock_shared()
+{
+	release(reader);
+}
+
+inline shared_mutex::~shared_mutex()
+{
+}
+
+#else
+
+inline void mutex::lock()
+{
+	if (pthread_mutex_trylock(&handle) != 0)
+		lock_contended();
+
+	counters.count_acquisition();
+}
+
+inline bool mutex::try_lock()
+{
+	if (pthread_mutex_trylock(&handle) != 0)
+		return false;
+
+	counters.count_acquisition();
+
+	return true;
+}
+
+inline void mutex::unlock()
+{
+	pthread_mutex_unlock(&handle);
+}
+
+inline mutex::~mutex()
+{
+	pthread_mutex_destroy(&handle);
+}
+
+inline void condition::wait(mutex& locked_mutex)
+{
+	pthread_cond_wait(&handle, &locked_mutex.handle);
+}
+
+inline void condition::signal()
+{
+	pthread_cond_signal(&handle);
+}
+
+inline void condition::broadcast()
+{
+	pthread_cond_broadcast(&handle);
+}
+
+inline condition::~condition()
+{
+	pthread_cond_destroy(&handle);
+}
+
+inline void shared_mutex::lock()
+{
+	if (pthread_rwlock_trywrlock(&handle) != 0)
+		lock_contended();
+
+	counters.count_acquisition();
+}
+
+inline void shared_mutex::unlock()
+{
+	pthread_rwlock_unlock(&handle);
+}
+
+inline void shared_mutex::lock_shared()
+{
+	if (pthread_rwlock_tryrdlock(&handle) != 0)
+		lock_shared_contended();
+
+	counters.count_acquisition();
+}
+
+inline void shared_mutex::unlock_shared()
+{
+	pthread_rwlock_unlock(&handle);
+}
+
+inline shared_mutex::~shared_mutex()
+{
+	pthread_rwlock_destroy(&handle);
+}
+
+#endif /* defined(B_HAVE_LINUX_FUTEX_H) */
+
+inline lock_stats mutex::stats() const
+{
+	return counters.get();
+}
+
+inline void mutex::reset_stats()
+{
+	counters.reset();
+}
+
+inline lock_stats shared_mutex::stats() const
+{
+	return counters.get();
+}
+
+inline void shared_mutex::reset_stats()
+{
+	counters.reset();
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_MUTEX_H) */
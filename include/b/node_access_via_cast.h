@@ -33,6 +33,13 @@ public:
 	{
 		return &static_cast<node_type&>(*element);
 	}
+
+	// Returns a pointer to the element that contains 'node'.
+	// This requires the node to be a superclass of the element.
+	static element_type* element_for(node_type* node)
+	{
+		return static_cast<element_type*>(node);
+	}
 };
 
 B_END_NAMESPACE
@@ -0,0 +1,149 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_NODE_POOL_H
+#define B_NODE_POOL_H
+
+#include "fn.h"
+
+B_BEGIN_NAMESPACE
+
+// The smallest number of nodes that node_pool requests from
+// the heap at once.
+#define B_NODE_POOL_MIN_SLAB_NODES 16
+
+// The size in bytes beyond which node_pool stops doubling its slabs.
+#define B_NODE_POOL_MAX_SLAB_SIZE 65536
+
+// Allocator of memory blocks (nodes) of the same size. Nodes are
+// carved from large chunks of memory (slabs) that double in size
+// as the pool grows. Freed nodes are kept for reuse and go back
+// to the heap only when the whole pool is cleared or destroyed.
+//
+// Compared to allocating each node from the heap, this reduces
+// the cost of allocation to a few instructions, keeps nodes that
+// were allocated together close in memory, and makes freeing all
+// nodes at once proportional to the number of slabs.
+class node_pool : public allocator
+{
+public:
+	// Creates an empty pool of nodes of 'node_size' bytes.
+	// No memory is allocated until the first request.
+	explicit node_pool(size_t node_size);
+
+	// Returns the size of the nodes, which can be greater
+	// than the size requested in the constructor.
+	size_t node_size() const;
+
+	// Allocates a node. Throws 'system_exception' if
+	// an out-of-memory condition occurs.
+	void* allocate_node();
+
+	// Returns a node to the pool for reuse.
+	void deallocate_node(void* node);
+
+	// Allocates a node. 'size' must not exceed node_size().
+	virtual void* allocate(size_t size);
+
+	// Returns a node to the pool for reuse.
+	virtual void deallocate(void* block, size_t size);
+
+	// Returns the number of nodes that can be allocated
+	// without requesting more memory from the heap.
+	size_t available() const;
+
+	// Makes sure that 'count' nodes can be allocated without
+	// further requests to the heap.
+	void reserve(size_t count);
+
+	// Frees all slabs. The nodes allocated from the pool
+	// become invalid.
+	void clear();
+
+	// Frees all memory allocated by the pool.
+	virtual ~node_pool();
+
+private:
+	node_pool(const node_pool&);
+	node_pool& operator =(const node_pool&);
+
+	struct slab
+	{
+		slab* next;
+	};
+
+	struct free_node
+	{
+		free_node* next;
+	};
+
+	void* allocate_from_new_slab();
+
+	// Allocates a slab of 'node_count' nodes. The nodes
+	// that remain in the current slab are moved to the
+	// list of free nodes.
+	void add_slab(size_t node_count);
+
+	const size_t size;
+
+	slab* slabs;
+
+	free_node* free_nodes;
+	size_t free_node_count;
+
+	// The part of the newest slab that has not been
+	// handed out yet.
+	char* pos;
+	char* end;
+
+	// The number of nodes in all slabs.
+	size_t capacity;
+};
+
+inline size_t node_pool::node_size() const
+{
+	return size;
+}
+
+inline void* node_pool::allocate_node()
+{
+	if (free_nodes != NULL)
+	{
+		free_node* node = free_nodes;
+
+		free_nodes = node->next;
+		--free_node_count;
+
+		return node;
+	}
+
+	if (pos != end)
+	{
+		void* node = pos;
+
+		pos += size;
+
+		return node;
+	}
+
+	return allocate_from_new_slab();
+}
+
+inline void node_pool::deallocate_node(void* node)
+{
+	free_node* freed = static_cast<free_node*>(node);
+
+	freed->next = free_nodes;
+	free_nodes = freed;
+	++free_node_count;
+}
+
+inline size_t node_pool::available() const
+{
+	return free_node_count + (size_t) (end - pos) / size;
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_NODE_POOL_H) */
@@ -0,0 +1,52 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_ORDER_STATISTIC_TREE_H
+#define B_ORDER_STATISTIC_TREE_H
+
+#include "binary_tree.h"
+
+B_BEGIN_NAMESPACE
+
+// Binary tree node that stores the number of nodes in the subtree
+// rooted at it.
+struct order_statistic_tree_node : public binary_tree_node
+{
+	size_t subtree_size;
+};
+
+// Replacement for 'binary_search_tree_base' that keeps the subtree
+// sizes up to date. With them, the node at a given position and
+// the position of a given node are found in time proportional to
+// the height of the tree rather than to the number of nodes.
+//
+// The tree does not rebalance itself, so its height depends on the
+// order of insertions. Trees built with build_from_sorted() are
+// perfectly balanced.
+//
+// All nodes of the tree must be of type 'order_statistic_tree_node'.
+// To enable rank and select queries in a 'set' or a 'map', pass this
+// structure as their 'Tree_base' template argument.
+struct order_statistic_tree_base : public binary_search_tree_base
+{
+	typedef order_statistic_tree_node node_type;
+
+	void insert_after_search(binary_tree_node* node,
+		binary_tree_node* parent, int cmp_result);
+
+	void build_from_sorted(binary_tree_node** nodes, size_t count);
+
+	void remove(binary_tree_node* node);
+
+	// Returns the node at position 'index' in key order or
+	// NULL if 'index' is out of range.
+	binary_tree_node* select(size_t index) const;
+
+	// Returns the number of nodes that precede 'node' in key order.
+	size_t rank(const binary_tree_node* node) const;
+};
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_ORDER_STATISTIC_TREE_H) */
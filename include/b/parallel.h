@@ -0,0 +1,666 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Parallel algorithms over arrays
+
+#ifndef B_PARALLEL_H
+#define B_PARALLEL_H
+
+#include "thread_pool.h"
+#include "array.h"
+
+B_BEGIN_NAMESPACE
+
+// The algorithms below split their input into subranges of at
+// least 'grain' elements and process the subranges as tasks of
+// the specified thread pool. If 'grain' is zero, it is chosen
+// so that each thread gets several subranges to balance the load.
+// Function objects are called concurrently from multiple threads.
+
+// Returns the default subrange size for 'count' elements.
+inline size_t parallel_grain(thread_pool* pool, size_t count,
+	size_t min_grain = 1024)
+{
+	size_t concurrency = pool->concurrency();
+
+	if (concurrency <= 1)
+		return count > 0 ? count : 1;
+
+	size_t grain = count / (concurrency * 8);
+
+	return grain > min_grain ? grain : min_grain;
+}
+
+template <class Body>
+void parallel_for_range(thread_pool* pool, const Body& body,
+	size_t begin, size_t end, size_t grain);
+
+template <class Body>
+class parallel_for_task : public task
+{
+public:
+	parallel_for_task(thread_pool* p, const Body& b,
+			size_t range_begin, size_t range_end, size_t g) :
+		pool(p), body(b), begin(range_begin), end(range_end), grain(g)
+	{
+	}
+
+	virtual void run()
+	{
+		parallel_for_range(pool, body, begin, end, grain);
+	}
+
+private:
+	thread_pool* pool;
+	const Body& body;
+	size_t begin;
+	size_t end;
+	size_t grain;
+};
+
+template <class Body>
+void parallel_for_range(thread_pool* pool, const Body& body,
+	size_t begin, size_t end, size_t grain)
+{
+	if (end - begin <= grain)
+	{
+		body(begin, end);
+		return;
+	}
+
+	// Schedule the right half and process the left
+	// half in this thread.
+	size_t middle = begin + (end - begin) / 2;
+
+	// The task is declared first so that it outlives the
+	// group, whose destructor waits for it if the body throws.
+	parallel_for_task<Body> right_half(pool, body, middle, end, grain);
+
+	task_group group(pool);
+
+	group.run(&right_half);
+
+	parallel_for_range(pool, body, begin, middle, grain);
+
+	group.wait();
+}
+
+// Calls 'body(begin, end)' for non-overlapping subranges that
+// cover the range from zero to 'count' (not including 'count').
+template <class Body>
+void parallel_for(thread_pool* pool, size_t count, const Body& body,
+	size_t grain = 0)
+{
+	if (count > 0)
+		parallel_for_range(pool, body, 0, count,
+			grain > 0 ? grain : parallel_grain(pool, count));
+}
+
+template <class T, class Function>
+struct parallel_for_each_body
+{
+	T* data;
+	mutable Function function;
+
+	void operator()(size_t begin, size_t end) const
+	{
+		for (; begin < end; ++begin)
+			function(data[begin]);
+	}
+};
+
+// Calls 'function(element)' for each element of the array.
+// The function can modify the elements.
+template <class T, class Function>
+void parallel_for_each(thread_pool* pool, array<T>& elements,
+	Function function, size_t grain = 0)
+{
+	parallel_for_each_body<T, Function> body =
+		{elements.lock(), function};
+
+	parallel_for(pool, elements.length(), body, grain);
+
+	elements.unlock();
+}
+
+// Calls 'function(element)' for each element of the slice.
+template <class T, class Function>
+void parallel_for_each(thread_pool* pool, const array_slice<T>& elements,
+	Function function, size_t grain = 0)
+{
+	parallel_for_each_body<const T, Function> body =
+		{elements.data(), function};
+
+	parallel_for(pool, elements.length(), body, grain);
+}
+
+template <class T, class U, class Function>
+struct parallel_transform_body
+{
+	const T* source;
+	U* result;
+	mutable Function function;
+
+	void operator()(size_t begin, size_t end) const
+	{
+		for (; begin < end; ++begin)
+			result[begin] = function(source[begin]);
+	}
+};
+
+// Stores 'function(source[i])' in 'result[i]' for each element
+// of 'source'. 'result' must point to a sufficiently large array
+// of constructed objects.
+template <class T, class U, class Function>
+void parallel_transform(thread_pool* pool, const array_slice<T>& source,
+	U* result, Function function, size_t grain = 0)
+{
+	parallel_transform_body<T, U, Function> body =
+		{source.data(), result, function};
+
+	parallel_for(pool, source.length(), body, grain);
+}
+
+template <class T, class U, class Function>
+void parallel_transform(thread_pool* pool, const array<T>& source,
+	U* result, Function function, size_t grain = 0)
+{
+	parallel_transform(pool, array_slice<T>(source), result,
+		function, grain);
+}
+
+template <class T, class R, class Accumulate, class Combine>
+struct parallel_reduce_context
+{
+	thread_pool* pool;
+	const T* data;
+	const R& identity;
+	Accumulate accumulate;
+	Combine combine;
+	size_t grain;
+};
+
+template <class T, class R, class Accumulate, class Combine>
+R parallel_reduce_range(
+	parallel_reduce_context<T, R, Accumulate, Combine>& context,
+	size_t begin, size_t end);
+
+template <class T, class R, class Accumulate, class Combine>
+class parallel_reduce_task : public task
+{
+public:
+	typedef parallel_reduce_context<T, R, Accumulate, Combine> context_type;
+
+	parallel_reduce_task(context_type& c, size_t range_begin,
+			size_t range_end) :
+		result(c.identity),
+		context(c), begin(range_begin), end(range_end)
+	{
+	}
+
+	virtual void run()
+	{
+		result = parallel_reduce_range(context, begin, end);
+	}
+
+	R result;
+
+private:
+	context_type& context;
+	size_t begin;
+	size_t end;
+};
+
+template <class T, class R, class Accumulate, class Combine>
+R parallel_reduce_range(
+	parallel_reduce_context<T, R, Accumulate, Combine>& context,
+	size_t begin, size_t end)
+{
+	if (end - begin <= context.grain)
+	{
+		R result(context.identity);
+
+		for (; begin < end; ++begin)
+			result = context.accumulate(result, context.data[begin]);
+
+		return result;
+	}
+
+	size_t middle = begin + (end - begin) / 2;
+
+	parallel_reduce_task<T, R, Accumulate, Combine> right_half(context,
+		middle, end);
+
+	task_group group(context.pool);
+
+	group.run(&right_half);
+
+	R left_result(parallel_reduce_range(context, begin, middle));
+
+	group.wait();
+
+	return context.combine(left_result, right_half.result);
+}
+
+// Reduces the elements of 'source' to a single value. Each
+// subrange is reduced by calling 'result = accumulate(result,
+// element)' starting with 'identity'; then the partial results
+// are merged by 'combine(left, right)' in the order of the
+// subranges. With a fixed 'grain', the order of operations does
+// not depend on thread scheduling, so the result is reproducible
+// even for floating-point values.
+template <class T, class R, class Accumulate, class Combine>
+R parallel_reduce(thread_pool* pool, const array_slice<T>& source,
+	const R& identity, Accumulate accumulate, Combine combine,
+	size_t grain = 0)
+{
+	parallel_reduce_context<T, R, Accumulate, Combine> context =
+	{
+		pool, source.data(), identity, accumulate, combine,
+		grain > 0 ? grain : parallel_grain(pool, source.length())
+	};
+
+	return parallel_reduce_range(context, 0, source.length());
+}
+
+template <class T, class R, class Accumulate, class Combine>
+R parallel_reduce(thread_pool* pool, const array<T>& source,
+	const R& identity, Accumulate accumulate, Combine combine,
+	size_t grain = 0)
+{
+	return parallel_reduce(pool, array_slice<T>(source), identity,
+		accumulate, combine, grain);
+}
+
+// Parallel merge sort
+
+template <class T, class Less>
+struct parallel_sort_context
+{
+	thread_pool* pool;
+	Less less;
+	size_t grain;
+};
+
+// Merges two sorted ranges into 'result'. Elements of 'a'
+// precede equal elements of 'b'.
+template <class T, class Less>
+void parallel_merge(parallel_sort_context<T, Less>& context,
+	const T* a, size_t a_count, const T* b, size_t b_count, T* result);
+
+template <class T, class Less>
+class parallel_merge_task : public task
+{
+public:
+	parallel_merge_task(parallel_sort_context<T, Less>& c,
+			const T* a_range, size_t a_range_count,
+			const T* b_range, size_t b_range_count, T* r) :
+		context(c), a(a_range), a_count(a_range_count),
+		b(b_range), b_count(b_range_count), result(r)
+	{
+	}
+
+	virtual void run()
+	{
+		parallel_merge(context, a, a_count, b, b_count, result);
+	}
+
+private:
+	parallel_sort_context<T, Less>& context;
+	const T* a;
+	size_t a_count;
+	const T* b;
+	size_t b_count;
+	T* result;
+};
+
+template <class T, class Less>
+void parallel_merge(parallel_sort_context<T, Less>& context,
+	const T* a, size_t a_count, const T* b, size_t b_count, T* result)
+{
+	if (a_count + b_count <= context.grain)
+	{
+		while (a_count > 0 && b_count > 0)
+			if (context.less(*b, *a))
+			{
+				*result++ = *b++;
+				--b_count;
+			}
+			else
+			{
+				*result++ = *a++;
+				--a_count;
+			}
+
+		while (a_count-- > 0)
+			*result++ = *a++;
+
+		while (b_count-- > 0)
+			*result++ = *b++;
+
+		return;
+	}
+
+	// Split the longer range in half and the other range
+	// at the position of the middle element of the first.
+	size_t a_split, b_split;
+
+	if (a_count >= b_count)
+	{
+		a_split = a_count / 2;
+
+		// Elements of 'b' that are less than the pivot.
+		size_t low = 0, high = b_count;
+
+		while (low < high)
+		{
+			size_t middle = low + (high - low) / 2;
+
+			if (context.less(b[middle], a[a_split]))
+				low = middle + 1;
+			else
+				high = middle;
+		}
+
+		b_split = low;
+	}
+	else
+	{
+		b_split = b_count / 2;
+
+		// Elements of 'a' that are not greater than the pivot.
+		size_t low = 0, high = a_count;
+
+		while (low < high)
+		{
+			size_t middle = low + (high - low) / 2;
+
+			if (!context.less(b[b_split], a[middle]))
+				low = middle + 1;
+			else
+				high = middle;
+		}
+
+		a_split = low;
+	}
+
+	parallel_merge_task<T, Less> right_part(context,
+		a + a_split, a_count - a_split,
+		b + b_split, b_count - b_split, result + a_split + b_split);
+
+	task_group group(context.pool);
+
+	group.run(&right_part);
+
+	parallel_merge(context, a, a_split, b, b_split, result);
+
+	group.wait();
+}
+
+// Sorts 'data' and stores the result either in 'data' or, if
+// 'into_buffer' is true, in 'buffer'. The contents of the other
+// array are destroyed.
+template <bool Branchless, class T, class Less>
+void parallel_merge_sort(parallel_sort_context<T, Less>& context,
+	T* data, T* buffer, size_t count, bool into_buffer);
+
+template <bool Branchless, class T, class Less>
+class parallel_merge_sort_task : public task
+{
+public:
+	parallel_merge_sort_task(parallel_sort_context<T, Less>& c,
+			T* d, T* buf, size_t n, bool into_buf) :
+		context(c), data(d), buffer(buf), count(n),
+		into_buffer(into_buf)
+	{
+	}
+
+	virtual void run()
+	{
+		parallel_merge_sort<Branchless>(context,
+			data, buffer, count, into_buffer);
+	}
+
+private:
+	parallel_sort_context<T, Less>& context;
+	T* data;
+	T* buffer;
+	size_t count;
+	bool into_buffer;
+};
+
+template <bool Branchless, class T, class Less>
+void parallel_merge_sort(parallel_sort_context<T, Less>& context,
+	T* data, T* buffer, size_t count, bool into_buffer)
+{
+	if (count <= context.grain)
+	{
+		sort_range<Branchless>(data, count, context.less);
+
+		if (into_buffer)
+			for (size_t i = 0; i < count; ++i)
+				buffer[i] = data[i];
+
+		return;
+	}
+
+	size_t half = count / 2;
+
+	// Sort the halves into the array that is not the
+	// destination of this call and then merge them.
+	{
+		parallel_merge_sort_task<Branchless, T, Less> right_half(
+			context, data + half, buffer + half, count - half,
+			!into_buffer);
+
+		task_group group(context.pool);
+
+		group.run(&right_half);
+
+		parallel_merge_sort<Branchless>(context, data, buffer,
+			half, !into_buffer);
+
+		group.wait();
+	}
+
+	if (into_buffer)
+		parallel_merge(context, data, half,
+			data + half, count - half, buffer);
+	else
+		parallel_merge(context, buffer, half,
+			buffer + half, count - half, data);
+}
+
+// Sorts 'data' in place. The worker threads copy the elements,
+// so copies of the elements must not share state.
+template <bool Branchless, class T, class Less>
+void parallel_sort_elements(thread_pool* pool, T* data, size_t count,
+	Less less)
+{
+	parallel_sort_context<T, Less> context =
+	{
+		pool, less, parallel_grain(pool, count, 8192)
+	};
+
+	stable_sort_buffer<T> buffer(data, count);
+
+	parallel_merge_sort<Branchless>(context,
+		data, buffer.elements, count, false);
+}
+
+template <class T, class Less>
+struct indirect_less
+{
+	bool operator ()(const T* a, const T* b) const
+	{
+		return less(*a, *b);
+	}
+
+	Less less;
+};
+
+// Sorts pointers to the elements in parallel and then moves
+// the elements to their places in the calling thread. The
+// worker threads only compare the elements, so elements
+// whose copies share state, such as copy-on-write strings,
+// are never copied by more than one thread at a time.
+template <class T, class Less>
+void parallel_sort_pointers(thread_pool* pool, T* data, size_t count,
+	Less less)
+{
+	stable_sort_buffer<T*> pointers(count);
+
+	T** order = pointers.elements;
+
+	for (size_t i = 0; i < count; ++i)
+		order[i] = data + i;
+
+	indirect_less<T, Less> pointer_less = {less};
+
+	parallel_sort_elements<false>(pool, order, count, pointer_less);
+
+	// Apply the permutation one cycle at a time.
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (order[i] == data + i)
+			continue;
+
+		T value(data[i]);
+		size_t hole = i;
+
+		for (;;)
+		{
+			size_t source = (size_t) (order[hole] - data);
+
+			order[hole] = data + hole;
+
+			if (source == i)
+				break;
+
+			data[hole] = data[source];
+			hole = source;
+		}
+
+		data[hole] = value;
+	}
+}
+
+// Chooses between sorting the elements themselves, which is
+// done for arithmetic types, and sorting pointers to them.
+template <bool Arithmetic>
+struct parallel_sort_method
+{
+	template <bool Branchless, class T, class Less>
+	static void sort(thread_pool* pool, T* data, size_t count, Less less)
+	{
+		parallel_sort_pointers(pool, data, count, less);
+	}
+};
+
+template <>
+struct parallel_sort_method<true>
+{
+	template <bool Branchless, class T, class Less>
+	static void sort(thread_pool* pool, T* data, size_t count, Less less)
+	{
+		parallel_sort_elements<Branchless>(pool, data, count, less);
+	}
+};
+
+template <bool Branchless, class T, class Less>
+void parallel_sort_with(thread_pool* pool, T* data, size_t count,
+	Less less)
+{
+	if (pool->concurrency() <= 1 || count <= 16384)
+	{
+		sort_range<Branchless>(data, count, less);
+		return;
+	}
+
+	parallel_sort_method<branchless_sort_traits<T>::value>::
+		template sort<Branchless>(pool, data, count, less);
+}
+
+// Sorts the array pointed to by 'data' in ascending order. The
+// array is split into subranges that are sorted by b::sort() in
+// parallel and then merged, also in parallel. Arrays of arithmetic
+// types are sorted directly, which requires temporary storage for
+// 'count' elements. For other types, the threads sort pointers to
+// the elements, and the calling thread then moves the elements to
+// their places; this requires storage for '2 * count' pointers.
+// The sort is not stable.
+template <class T>
+void parallel_sort(thread_pool* pool, T* data, size_t count)
+{
+	parallel_sort_with<branchless_sort_traits<T>::value>(pool,
+		data, count, default_less<T>());
+}
+
+// Parallel sort with a three-way comparison function that
+// has the same semantics as b::compare().
+template <class T, class Compare>
+void parallel_sort(thread_pool* pool, T* data, size_t count, Compare cmp)
+{
+	compare_less<T, Compare> less = {cmp};
+
+	parallel_sort_with<false>(pool, data, count, less);
+}
+
+template <class T>
+void parallel_sort(thread_pool* pool, array<T>& elements)
+{
+	parallel_sort(pool, elements.lock(), elements.length());
+
+	elements.unlock();
+}
+
+template <class T, class Compare>
+void parallel_sort(thread_pool* pool, array<T>& elements, Compare cmp)
+{
+	parallel_sort(pool, elements.lock(), elements.length(), cmp);
+
+	elements.unlock();
+}
+
+template <class T>
+struct parallel_lower_bound_body
+{
+	const T* table;
+	size_t table_size;
+	const T* keys;
+	size_t* positions;
+
+	void operator()(size_t begin, size_t end) const
+	{
+		find_lower_bound_batch(table, table_size,
+			keys + begin, end - begin, positions + begin);
+	}
+};
+
+// For each element of 'keys', finds the position of its lower
+// bound in the sorted 'table' and stores it in the respective
+// element of the 'positions' array.
+template <class T>
+void parallel_find_lower_bound(thread_pool* pool,
+	const array_slice<T>& table, const array_slice<T>& keys,
+	size_t* positions, size_t grain = 0)
+{
+	parallel_lower_bound_body<T> body =
+		{table.data(), table.length(), keys.data(), positions};
+
+	parallel_for(pool, keys.length(), body, grain);
+}
+
+template <class T>
+void parallel_find_lower_bound(thread_pool* pool,
+	const array<T>& table, const array<T>& keys,
+	size_t* positions, size_t grain = 0)
+{
+	parallel_find_lower_bound(pool, array_slice<T>(table),
+		array_slice<T>(keys), positions, grain);
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_PARALLEL_H) */
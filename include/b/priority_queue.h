@@ -10,14 +10,24 @@
 
 B_BEGIN_NAMESPACE
 
-// Priority queue container.
-template <class T>
+// Priority queue container. The elements are kept in a d-ary
+// heap; 'Arity' is the number of children of each heap node.
+// An arity of four is usually faster than two for large queues.
+template <class T, size_t Arity = 2>
 class priority_queue
 {
 public:
 	// Adds a value to this priority queue.
 	void push(const T& element);
 
+	// Adds 'count' elements to this priority queue at once.
+	// When the number of new elements is comparable to the
+	// size of the queue, the heap is rebuilt in linear time.
+	void push_all(const T* elements, size_t count);
+
+	// Returns the element with the greatest value.
+	const T& top() const;
+
 	// Removes the element with the greatest value from the priority queue
 	// and returns it.
 	T pop();
@@ -28,24 +38,51 @@ public:
 	// Returns true if the priority queue is empty.
 	bool is_empty() const;
 
+	// Preallocates memory for 'capacity' elements.
+	void reserve(size_t capacity);
+
 protected:
 	array<T> data;
 };
 
-template <class T>
-void priority_queue<T>::push(const T& element)
+template <class T, size_t Arity>
+void priority_queue<T, Arity>::push(const T& element)
 {
 	data.append(element);
-	push_into_heap(data.lock(), data.length());
+	push_into_dary_heap<Arity>(data.lock(), data.length());
 	data.unlock();
 }
 
-template <class T>
-T priority_queue<T>::pop()
+template <class T, size_t Arity>
+void priority_queue<T, Arity>::push_all(const T* elements, size_t count)
+{
+	size_t old_length = data.length();
+
+	data.append(elements, count);
+
+	T* heap = data.lock();
+
+	if (count >= old_length)
+		make_dary_heap<Arity>(heap, data.length());
+	else
+		while (count-- > 0)
+			push_into_dary_heap<Arity>(heap, ++old_length);
+
+	data.unlock();
+}
+
+template <class T, size_t Arity>
+inline const T& priority_queue<T, Arity>::top() const
+{
+	return data.first();
+}
+
+template <class T, size_t Arity>
+T priority_queue<T, Arity>::pop()
 {
 	size_t data_size = data.length();
 
-	pop_from_heap(data.lock(), data_size);
+	pop_from_dary_heap<Arity>(data.lock(), data_size);
 	data.unlock();
 
 	T result(data[--data_size]);
@@ -55,18 +92,281 @@ T priority_queue<T>::pop()
 	return result;
 }
 
-template <class T>
-size_t priority_queue<T>::length() const
+template <class T, size_t Arity>
+size_t priority_queue<T, Arity>::length() const
 {
 	return data.length();
 }
 
-template <class T>
-bool priority_queue<T>::is_empty() const
+template <class T, size_t Arity>
+bool priority_queue<T, Arity>::is_empty() const
 {
 	return data.is_empty();
 }
 
+template <class T, size_t Arity>
+void priority_queue<T, Arity>::reserve(size_t capacity)
+{
+	if (data.capacity() < capacity)
+		data.alloc_and_copy(capacity);
+}
+
+// Priority queue that allows changing and removing elements
+// that are already in the queue. Each pushed element receives
+// a handle, which stays valid until the element is popped or
+// erased. Handles of removed elements are reused.
+//
+// The elements are kept in a 4-ary heap.
+template <class T>
+class indexed_priority_queue
+{
+public:
+	// Element handle type.
+	typedef size_t handle;
+
+	// Adds a value to this priority queue and returns its handle.
+	handle push(const T& element);
+
+	// Returns the element with the greatest value.
+	const T& top() const;
+
+	// Returns the handle of the element with the greatest value.
+	handle top_handle() const;
+
+	// Removes the element with the greatest value from
+	// the priority queue and returns it.
+	T pop();
+
+	// Returns the element with the specified handle.
+	const T& get(handle h) const;
+
+	// Replaces the value of the element with the specified
+	// handle and restores the heap order. The new value may be
+	// either greater or less than the old one.
+	void update(handle h, const T& new_value);
+
+	// Removes the element with the specified handle.
+	void erase(handle h);
+
+	// Returns true if 'h' refers to an element of this queue.
+	bool contains(handle h) const;
+
+	// Returns the number of elements in this priority queue.
+	size_t length() const;
+
+	// Returns true if the priority queue is empty.
+	bool is_empty() const;
+
+	// Preallocates memory for 'capacity' elements.
+	void reserve(size_t capacity);
+
+private:
+	enum
+	{
+		arity = 4
+	};
+
+	struct entry
+	{
+		entry(const T& v, handle eh) : value(v), h(eh)
+		{
+		}
+
+		T value;
+		handle h;
+
+		bool operator <(const entry& rhs) const
+		{
+			return value < rhs.value;
+		}
+	};
+
+	// Element placement policy that keeps the
+	// handle-to-position mapping up to date.
+	struct tracking_placement
+	{
+		size_t* positions;
+
+		void operator()(entry* data, size_t index,
+			const entry& e) const
+		{
+			data[index] = e;
+			positions[e.h] = index;
+		}
+	};
+
+	// Moves an entry that replaces the one at 'index'
+	// either up or down to its proper position.
+	void restore_order(entry* data, size_t index, const entry& e,
+		tracking_placement place);
+
+	// Removes the entry at 'index' from the heap.
+	void remove_at(size_t index);
+
+	// The heap of entries.
+	array<entry> heap;
+
+	// Heap positions of the elements indexed by handle.
+	// Free handles have the position of (size_t) -1.
+	array<size_t> positions;
+
+	// Handles available for reuse.
+	array<handle> free_handles;
+};
+
+template <class T>
+typename indexed_priority_queue<T>::handle
+	indexed_priority_queue<T>::push(const T& element)
+{
+	handle h;
+
+	if (!free_handles.is_empty())
+	{
+		h = free_handles.last();
+		free_handles.remove(free_handles.length() - 1);
+	}
+	else
+	{
+		h = positions.length();
+		positions.append((size_t) -1);
+	}
+
+	entry e(element, h);
+
+	heap.append(e);
+
+	tracking_placement place = {positions.lock()};
+
+	sift_up_in_dary_heap<arity>(heap.lock(), heap.length() - 1, e, place);
+	heap.unlock();
+	positions.unlock();
+
+	return h;
+}
+
+template <class T>
+inline const T& indexed_priority_queue<T>::top() const
+{
+	return heap.first().value;
+}
+
+template <class T>
+inline typename indexed_priority_queue<T>::handle
+	indexed_priority_queue<T>::top_handle() const
+{
+	return heap.first().h;
+}
+
+template <class T>
+T indexed_priority_queue<T>::pop()
+{
+	T result(heap.first().value);
+
+	remove_at(0);
+
+	return result;
+}
+
+template <class T>
+inline const T& indexed_priority_queue<T>::get(handle h) const
+{
+	B_ASSERT(contains(h));
+
+	return heap[positions[h]].value;
+}
+
+template <class T>
+void indexed_priority_queue<T>::update(handle h, const T& new_value)
+{
+	B_ASSERT(contains(h));
+
+	tracking_placement place = {positions.lock()};
+
+	restore_order(heap.lock(), place.positions[h],
+		entry(new_value, h), place);
+	heap.unlock();
+	positions.unlock();
+}
+
+template <class T>
+void indexed_priority_queue<T>::erase(handle h)
+{
+	B_ASSERT(contains(h));
+
+	remove_at(positions[h]);
+}
+
+template <class T>
+inline bool indexed_priority_queue<T>::contains(handle h) const
+{
+	return h < positions.length() && positions[h] != (size_t) -1;
+}
+
+template <class T>
+inline size_t indexed_priority_queue<T>::length() const
+{
+	return heap.length();
+}
+
+template <class T>
+inline bool indexed_priority_queue<T>::is_empty() const
+{
+	return heap.is_empty();
+}
+
+template <class T>
+void indexed_priority_queue<T>::reserve(size_t capacity)
+{
+	if (heap.capacity() < capacity)
+		heap.alloc_and_copy(capacity);
+
+	if (positions.capacity() < capacity)
+		positions.alloc_and_copy(capacity);
+
+	if (free_handles.capacity() < capacity)
+		free_handles.alloc_and_copy(capacity);
+}
+
+template <class T>
+void indexed_priority_queue<T>::restore_order(entry* data, size_t index,
+	const entry& e, tracking_placement place)
+{
+	if (index > 0 && data[(index - 1) / arity] < e)
+		sift_up_in_dary_heap<arity>(data, index, e, place);
+	else
+		sift_down_in_dary_heap<arity>(data, heap.length(), index, e,
+			place);
+}
+
+template <class T>
+void indexed_priority_queue<T>::remove_at(size_t index)
+{
+	B_ASSERT(index < heap.length());
+
+	size_t last = heap.length() - 1;
+
+	handle removed = heap[index].h;
+
+	if (index < last)
+	{
+		entry e = heap[last];
+
+		heap.remove(last);
+
+		tracking_placement place = {positions.lock()};
+
+		restore_order(heap.lock(), index, e, place);
+		heap.unlock();
+		positions.unlock();
+	}
+	else
+		heap.remove(last);
+
+	positions[removed] = (size_t) -1;
+
+	free_handles.append(removed);
+}
+
 B_END_NAMESPACE
 
 #endif /* !defined(B_PRIORITY_QUEUE_H) */
@@ -6,12 +6,14 @@
 #define B_SET_H
 
 #include "binary_tree.h"
+#include "node_pool.h"
+#include "array.h"
 
 B_BEGIN_NAMESPACE
 
 // A container for objects addressable by unique keys.
-template <class T>
-struct set_element : public binary_tree_node
+template <class T, class Node = binary_tree_node>
+struct set_element : public Node
 {
 	set_element(const T& v);
 
@@ -26,33 +28,33 @@ struct set_element : public binary_tree_node
 	set_element* prev();
 };
 
-template <class T>
-inline set_element<T>::set_element(const T& v) : value(v)
+template <class T, class Node>
+inline set_element<T, Node>::set_element(const T& v) : value(v)
 {
 }
 
-template <class T>
-inline const set_element<T>* set_element<T>::next() const
+template <class T, class Node>
+inline const set_element<T, Node>* set_element<T, Node>::next() const
 {
-	return static_cast<const set_element<T>*>(binary_tree_node::next());
+	return static_cast<const set_element<T, Node>*>(binary_tree_node::next());
 }
 
-template <class T>
-inline set_element<T>* set_element<T>::next()
+template <class T, class Node>
+inline set_element<T, Node>* set_element<T, Node>::next()
 {
-	return static_cast<set_element<T>*>(binary_tree_node::next());
+	return static_cast<set_element<T, Node>*>(binary_tree_node::next());
 }
 
-template <class T>
-inline const set_element<T>* set_element<T>::prev() const
+template <class T, class Node>
+inline const set_element<T, Node>* set_element<T, Node>::prev() const
 {
-	return static_cast<const set_element<T>*>(binary_tree_node::prev());
+	return static_cast<const set_element<T, Node>*>(binary_tree_node::prev());
 }
 
-template <class T>
-inline set_element<T>* set_element<T>::prev()
+template <class T, class Node>
+inline set_element<T, Node>* set_element<T, Node>::prev()
 {
-	return static_cast<set_element<T>*>(binary_tree_node::prev());
+	return static_cast<set_element<T, Node>*>(binary_tree_node::prev());
 }
 
 // A sorted set of unique elements of type T. The class uses a
@@ -67,19 +69,39 @@ inline set_element<T>* set_element<T>::prev()
 // 2) must support conversion to the argument type of 'search()'
 // and 'find()'.
 //
-template <class T, class Key_op>
+template <class T, class Key_op, class Tree_base = binary_search_tree_base>
 class set_base
 {
 public:
-	// Initializes this object.
+	// The type of the tree nodes that store the elements.
+	typedef set_element<T, typename Tree_base::node_type> element_type;
+
+	// Initializes this object. The elements of the container
+	// are allocated from a pool owned by the container.
 	set_base();
 
+	// Initializes this object to allocate its elements with
+	// 'element_allocator', which must outlive the container.
+	// Combined with an arena, this makes it possible to
+	// release the memory of all elements at once.
+	explicit set_base(allocator* element_allocator);
+
 	// Returns true if this container is empty.
 	bool is_empty() const;
 
 	// Returns the number of elements in this container.
 	size_t size() const;
 
+	// Preallocates memory for 'capacity' elements. Has no
+	// effect if the container uses a custom allocator.
+	void reserve(size_t capacity);
+
+	// Removes all elements. Unless the container uses a custom
+	// allocator, the memory of the elements is released at once
+	// and, if T has a trivial destructor, the elements are not
+	// visited at all.
+	void clear();
+
 	// Finds the element that matches the specified key.
 	// Returns NULL if there is no match.
 	template <class Search_key>
@@ -123,6 +145,36 @@ public:
 	template <class Search_key>
 	bool remove(const Search_key& key);
 
+	// Bulk operations
+	//
+	// The methods below process the elements in key order and
+	// relink the resulting elements into a perfectly balanced
+	// tree. Elements that remain in the container keep their
+	// addresses.
+
+	// Replaces the contents of this container with copies of
+	// 'count' elements sorted in strictly ascending order.
+	// Complexity: O(n).
+	void assign_sorted(const T* sorted, size_t count);
+
+	// Inserts 'count' elements in arbitrary order. An element
+	// with the key of an existing element overwrites it; of the
+	// new elements with equal keys, the last one is stored.
+	// Complexity: O(n + k * log(k)) for 'k' new elements.
+	void insert_range(const T* values, size_t count);
+
+	// Adds copies of the elements of 'other' whose keys are
+	// not in this container. Complexity: O(n + m).
+	void unite(const set_base& other);
+
+	// Removes the elements whose keys are not in 'other'.
+	// Complexity: O(n + m).
+	void intersect(const set_base& other);
+
+	// Removes the elements whose keys are in 'other'.
+	// Complexity: O(n + m).
+	void subtract(const set_base& other);
+
 	// Returns a pointer to the first element or NULL if there are
 	// no elements.
 	const T* first() const;
@@ -155,6 +207,17 @@ public:
 	// or NULL if 'value' is the first element.
 	static T* prev(T* value);
 
+	// Returns the element at position 'index' in key order or
+	// NULL if 'index' is out of range.
+	// Complexity: O(h) with 'order_statistic_tree_base' as the
+	// tree base, where h is the height of the tree; O(n) otherwise.
+	T* select(size_t index) const;
+
+	// Returns the number of elements whose keys are less than 'key'.
+	// Complexity: same as select().
+	template <class Search_key>
+	size_t rank(const Search_key& key) const;
+
 	// Bidirectional const iterator type.
 	struct const_iterator;
 
@@ -169,45 +232,88 @@ protected:
 
 	static T* value_for_node(binary_tree_node* node);
 
-	binary_search_tree<Key_op> tree;
+	element_type* new_element(const T& value);
+
+	void delete_element(element_type* element);
+
+	// Ordering of tree nodes by key.
+	bool less(const binary_tree_node* lhs,
+		const binary_tree_node* rhs) const;
+
+	// Allocates elements for 'count' values and appends them
+	// to 'nodes'. Frees the new elements if an allocation fails.
+	void new_elements(const T* values, size_t count,
+		array<binary_tree_node*>* nodes);
+
+	// Frees the elements that 'nodes' points to.
+	void delete_elements(const array<binary_tree_node*>& nodes);
+
+	// Replaces the tree with the specified nodes
+	// sorted by key.
+	void rebuild(array<binary_tree_node*>& nodes);
+
+	binary_search_tree<Key_op, Tree_base> tree;
+
+	allocator* const element_allocator;
+
+	// The source of elements when there is no custom allocator.
+	node_pool element_pool;
 
 public:
 	~set_base();
 };
 
-template <class T, class Key_op>
-inline set_base<T, Key_op>::set_base() : tree(Key_op())
+template <class T, class Key_op, class Tree_base>
+inline set_base<T, Key_op, Tree_base>::set_base() :
+	tree(Key_op()),
+	element_allocator(NULL),
+	element_pool(sizeof(element_type))
 {
 }
 
-template <class T, class Key_op>
-inline bool set_base<T, Key_op>::is_empty() const
+template <class T, class Key_op, class Tree_base>
+inline set_base<T, Key_op, Tree_base>::set_base(allocator* alloc) :
+	tree(Key_op()),
+	element_allocator(alloc),
+	element_pool(sizeof(element_type))
+{
+}
+
+template <class T, class Key_op, class Tree_base>
+inline bool set_base<T, Key_op, Tree_base>::is_empty() const
 {
 	return tree.root == NULL;
 }
 
-template <class T, class Key_op>
-inline size_t set_base<T, Key_op>::size() const
+template <class T, class Key_op, class Tree_base>
+inline size_t set_base<T, Key_op, Tree_base>::size() const
 {
 	return tree.number_of_nodes;
 }
 
-template <class T, class Key_op>
+template <class T, class Key_op, class Tree_base>
+void set_base<T, Key_op, Tree_base>::reserve(size_t capacity)
+{
+	if (element_allocator == NULL && capacity > tree.number_of_nodes)
+		element_pool.reserve(capacity - tree.number_of_nodes);
+}
+
+template <class T, class Key_op, class Tree_base>
 template <class Search_key>
-T* set_base<T, Key_op>::find(const Search_key& key) const
+T* set_base<T, Key_op, Tree_base>::find(const Search_key& key) const
 {
 	return value_for_node(tree.find(key));
 }
 
-template <class T, class Key_op>
-T* set_base<T, Key_op>::search_result::match() const
+template <class T, class Key_op, class Tree_base>
+T* set_base<T, Key_op, Tree_base>::search_result::match() const
 {
 	return cmp_result == 0 ? value : NULL;
 }
 
-template <class T, class Key_op>
+template <class T, class Key_op, class Tree_base>
 template <class Search_key>
-typename set_base<T, Key_op>::search_result set_base<T, Key_op>::search(
+typename set_base<T, Key_op, Tree_base>::search_result set_base<T, Key_op, Tree_base>::search(
 		const Search_key& key) const
 {
 	search_result sr;
@@ -217,27 +323,27 @@ typename set_base<T, Key_op>::search_result set_base<T, Key_op>::search(
 	return sr;
 }
 
-template <class T, class Key_op>
-T* set_base<T, Key_op>::insert_new(const T& value,
-		const set_base<T, Key_op>::search_result& sr)
+template <class T, class Key_op, class Tree_base>
+T* set_base<T, Key_op, Tree_base>::insert_new(const T& value,
+		const set_base<T, Key_op, Tree_base>::search_result& sr)
 {
 	B_ASSERT(sr.match() == NULL);
 
-	set_element<T>* new_element = new set_element<T>(value);
+	element_type* element = new_element(value);
 
-	tree.insert_after_search(new_element,
+	tree.insert_after_search(element,
 		sr.value != NULL ?
-			B_OUTERSTRUCT(set_element<T>, value, sr.value) : NULL,
+			B_OUTERSTRUCT(element_type, value, sr.value) : NULL,
 		sr.cmp_result);
 
-	return &new_element->value;
+	return &element->value;
 }
 
-template <class T, class Key_op>
+template <class T, class Key_op, class Tree_base>
 template <class Search_key>
-bool set_base<T, Key_op>::remove(const Search_key& key)
+bool set_base<T, Key_op, Tree_base>::remove(const Search_key& key)
 {
-	set_element<T>* element_to_delete = static_cast<set_element<T>*>(
+	element_type* element_to_delete = static_cast<element_type*>(
 		tree.find(key));
 
 	if (element_to_delete == NULL)
@@ -245,73 +351,274 @@ bool set_base<T, Key_op>::remove(const Search_key& key)
 
 	tree.remove(element_to_delete);
 
-	delete element_to_delete;
+	delete_element(element_to_delete);
 
 	return true;
 }
 
-template <class T, class Key_op>
-const T* set_base<T, Key_op>::first() const
+// Ordering of tree nodes by the keys that 'Key_op' returns.
+template <class Key_op>
+struct set_node_less
+{
+	const Key_op* key_for_node;
+
+	bool operator()(const binary_tree_node* lhs,
+		const binary_tree_node* rhs) const
+	{
+		return (*key_for_node)(lhs) < (*key_for_node)(rhs);
+	}
+};
+
+template <class T, class Key_op, class Tree_base>
+void set_base<T, Key_op, Tree_base>::assign_sorted(const T* sorted, size_t count)
+{
+	array<binary_tree_node*> nodes;
+
+	nodes.alloc_and_copy(count);
+
+	new_elements(sorted, count, &nodes);
+
+#ifdef B_DEBUG
+	for (size_t i = 1; i < count; ++i)
+		B_ASSERT(less(nodes[i - 1], nodes[i]));
+#endif /* defined(B_DEBUG) */
+
+	array<binary_tree_node*> old_nodes;
+
+	old_nodes.alloc_and_copy(size());
+
+	for (binary_tree_node* node = tree.leftmost;
+			node != NULL; node = node->next())
+		old_nodes.append(node);
+
+	rebuild(nodes);
+
+	delete_elements(old_nodes);
+}
+
+template <class T, class Key_op, class Tree_base>
+void set_base<T, Key_op, Tree_base>::insert_range(const T* values, size_t count)
+{
+	array<binary_tree_node*> added;
+
+	added.alloc_and_copy(count);
+
+	new_elements(values, count, &added);
+
+	binary_tree_node** new_nodes = added.lock();
+
+	set_node_less<Key_op> node_less = {&tree.key_for_node};
+
+	stable_sort_with(new_nodes, count, node_less);
+
+	array<binary_tree_node*> merged;
+
+	merged.alloc_and_copy(size() + count);
+
+	binary_tree_node* existing = tree.leftmost;
+
+	for (size_t i = 0; i < count; )
+	{
+		binary_tree_node* candidate = new_nodes[i];
+
+		while (++i < count && !less(candidate, new_nodes[i]))
+		{
+			delete_element(static_cast<element_type*>(candidate));
+
+			candidate = new_nodes[i];
+		}
+
+		while (existing != NULL && less(existing, candidate))
+		{
+			merged.append(existing);
+			existing = existing->next();
+		}
+
+		if (existing != NULL && !less(candidate, existing))
+		{
+			*value_for_node(existing) = *value_for_node(candidate);
+
+			delete_element(static_cast<element_type*>(candidate));
+
+			merged.append(existing);
+			existing = existing->next();
+		}
+		else
+			merged.append(candidate);
+	}
+
+	added.unlock();
+
+	for (; existing != NULL; existing = existing->next())
+		merged.append(existing);
+
+	rebuild(merged);
+}
+
+template <class T, class Key_op, class Tree_base>
+void set_base<T, Key_op, Tree_base>::unite(const set_base& other)
+{
+	array<binary_tree_node*> merged;
+
+	merged.alloc_and_copy(size() + other.size());
+
+	array<binary_tree_node*> created;
+
+	binary_tree_node* existing = tree.leftmost;
+
+	try
+	{
+		for (const binary_tree_node* node = other.tree.leftmost;
+				node != NULL; node = node->next())
+		{
+			while (existing != NULL && less(existing, node))
+			{
+				merged.append(existing);
+				existing = existing->next();
+			}
+
+			if (existing != NULL && !less(node, existing))
+			{
+				merged.append(existing);
+				existing = existing->next();
+			}
+			else
+			{
+				created.append(new_element(
+					*value_for_node(node)));
+
+				merged.append(created.last());
+			}
+		}
+	}
+	catch (...)
+	{
+		delete_elements(created);
+		throw;
+	}
+
+	for (; existing != NULL; existing = existing->next())
+		merged.append(existing);
+
+	rebuild(merged);
+}
+
+template <class T, class Key_op, class Tree_base>
+void set_base<T, Key_op, Tree_base>::intersect(const set_base& other)
+{
+	array<binary_tree_node*> kept;
+	array<binary_tree_node*> removed;
+
+	kept.alloc_and_copy(size());
+
+	const binary_tree_node* theirs = other.tree.leftmost;
+
+	for (binary_tree_node* node = tree.leftmost;
+			node != NULL; node = node->next())
+	{
+		while (theirs != NULL && less(theirs, node))
+			theirs = theirs->next();
+
+		if (theirs != NULL && !less(node, theirs))
+			kept.append(node);
+		else
+			removed.append(node);
+	}
+
+	rebuild(kept);
+
+	delete_elements(removed);
+}
+
+template <class T, class Key_op, class Tree_base>
+void set_base<T, Key_op, Tree_base>::subtract(const set_base& other)
+{
+	array<binary_tree_node*> kept;
+	array<binary_tree_node*> removed;
+
+	kept.alloc_and_copy(size());
+
+	const binary_tree_node* theirs = other.tree.leftmost;
+
+	for (binary_tree_node* node = tree.leftmost;
+			node != NULL; node = node->next())
+	{
+		while (theirs != NULL && less(theirs, node))
+			theirs = theirs->next();
+
+		if (theirs != NULL && !less(node, theirs))
+			removed.append(node);
+		else
+			kept.append(node);
+	}
+
+	rebuild(kept);
+
+	delete_elements(removed);
+}
+
+template <class T, class Key_op, class Tree_base>
+const T* set_base<T, Key_op, Tree_base>::first() const
 {
 	return value_for_node(tree.leftmost);
 }
 
-template <class T, class Key_op>
-T* set_base<T, Key_op>::first()
+template <class T, class Key_op, class Tree_base>
+T* set_base<T, Key_op, Tree_base>::first()
 {
 	return value_for_node(tree.leftmost);
 }
 
-template <class T, class Key_op>
-const T* set_base<T, Key_op>::last() const
+template <class T, class Key_op, class Tree_base>
+const T* set_base<T, Key_op, Tree_base>::last() const
 {
 	return value_for_node(tree.rightmost);
 }
 
-template <class T, class Key_op>
-T* set_base<T, Key_op>::last()
+template <class T, class Key_op, class Tree_base>
+T* set_base<T, Key_op, Tree_base>::last()
 {
 	return value_for_node(tree.rightmost);
 }
 
-template <class T, class Key_op>
-const T* set_base<T, Key_op>::next(const T* value)
+template <class T, class Key_op, class Tree_base>
+const T* set_base<T, Key_op, Tree_base>::next(const T* value)
 {
-	const set_element<T>* next_element = B_OUTERSTRUCT(
-		set_element<T>, value, value)->next();
+	const element_type* next_element = B_OUTERSTRUCT(
+		element_type, value, value)->next();
 
 	return next_element == NULL ? NULL : &next_element->value;
 }
 
-template <class T, class Key_op>
-T* set_base<T, Key_op>::next(T* value)
+template <class T, class Key_op, class Tree_base>
+T* set_base<T, Key_op, Tree_base>::next(T* value)
 {
-	set_element<T>* next_element = B_OUTERSTRUCT(
-		set_element<T>, value, value)->next();
+	element_type* next_element = B_OUTERSTRUCT(
+		element_type, value, value)->next();
 
 	return next_element == NULL ? NULL : &next_element->value;
 }
 
-template <class T, class Key_op>
-const T* set_base<T, Key_op>::prev(const T* value)
+template <class T, class Key_op, class Tree_base>
+const T* set_base<T, Key_op, Tree_base>::prev(const T* value)
 {
-	const set_element<T>* prev_element = B_OUTERSTRUCT(
-		set_element<T>, value, value)->prev();
+	const element_type* prev_element = B_OUTERSTRUCT(
+		element_type, value, value)->prev();
 
 	return prev_element == NULL ? NULL : &prev_element->value;
 }
 
-template <class T, class Key_op>
-T* set_base<T, Key_op>::prev(T* value)
+template <class T, class Key_op, class Tree_base>
+T* set_base<T, Key_op, Tree_base>::prev(T* value)
 {
-	set_element<T>* prev_element = B_OUTERSTRUCT(
-		set_element<T>, value, value)->prev();
+	element_type* prev_element = B_OUTERSTRUCT(
+		element_type, value, value)->prev();
 
 	return prev_element == NULL ? NULL : &prev_element->value;
 }
 
-template <class T, class Key_op>
-struct set_base<T, Key_op>::const_iterator
+template <class T, class Key_op, class Tree_base>
+struct set_base<T, Key_op, Tree_base>::const_iterator
 {
 	const T* value_addr;
 
@@ -323,7 +630,7 @@ struct set_base<T, Key_op>::const_iterator
 	{
 		B_ASSERT(value_addr != NULL);
 
-		value_addr = set_base<T, Key_op>::next(value_addr);
+		value_addr = set_base<T, Key_op, Tree_base>::next(value_addr);
 
 		return *this;
 	}
@@ -332,7 +639,7 @@ struct set_base<T, Key_op>::const_iterator
 	{
 		B_ASSERT(value_addr != NULL);
 
-		value_addr = set_base<T, Key_op>::prev(value_addr);
+		value_addr = set_base<T, Key_op, Tree_base>::prev(value_addr);
 
 		return *this;
 	}
@@ -358,63 +665,194 @@ struct set_base<T, Key_op>::const_iterator
 	}
 };
 
-template <class T, class Key_op>
-typename set_base<T, Key_op>::const_iterator set_base<T, Key_op>::begin() const
+template <class T, class Key_op, class Tree_base>
+typename set_base<T, Key_op, Tree_base>::const_iterator set_base<T, Key_op, Tree_base>::begin() const
 {
 	return first();
 }
 
-template <class T, class Key_op>
-inline typename set_base<T, Key_op>::const_iterator set_base<T, Key_op>::end() const
+template <class T, class Key_op, class Tree_base>
+inline typename set_base<T, Key_op, Tree_base>::const_iterator set_base<T, Key_op, Tree_base>::end() const
 {
 	return NULL;
 }
 
-template <class T, class Key_op>
-const T* set_base<T, Key_op>::value_for_node(const binary_tree_node* node)
+template <class T, class Key_op, class Tree_base>
+const T* set_base<T, Key_op, Tree_base>::value_for_node(const binary_tree_node* node)
 {
-	return node != NULL ? &static_cast<const set_element<T>*>(node)->value : NULL;
+	return node != NULL ? &static_cast<const element_type*>(node)->value : NULL;
 }
 
-template <class T, class Key_op>
-T* set_base<T, Key_op>::value_for_node(binary_tree_node* node)
+template <class T, class Key_op, class Tree_base>
+T* set_base<T, Key_op, Tree_base>::value_for_node(binary_tree_node* node)
 {
-	return node != NULL ? &static_cast<set_element<T>*>(node)->value : NULL;
+	return node != NULL ? &static_cast<element_type*>(node)->value : NULL;
 }
 
-template <class T, class Key_op>
-set_base<T, Key_op>::~set_base()
+template <class T, class Key_op, class Tree_base>
+typename set_base<T, Key_op, Tree_base>::element_type*
+	set_base<T, Key_op, Tree_base>::new_element(const T& value)
 {
-	for (set_element<T>* element_to_delete = static_cast<set_element<T>*>(tree.leftmost);
-			element_to_delete != NULL; )
+	void* place = element_allocator == NULL ?
+		element_pool.allocate_node() :
+		element_allocator->allocate(sizeof(element_type));
+
+	try
+	{
+		return new (place) element_type(value);
+	}
+	catch (...)
 	{
-		set_element<T>* next_element = element_to_delete->next();
+		if (element_allocator == NULL)
+			element_pool.deallocate_node(place);
+		else
+			element_allocator->deallocate(place,
+				sizeof(element_type));
+		throw;
+	}
+}
 
-		tree.remove(element_to_delete);
+template <class T, class Key_op, class Tree_base>
+void set_base<T, Key_op, Tree_base>::delete_element(element_type* element)
+{
+	element->~element_type();
 
-		delete element_to_delete;
+	if (element_allocator == NULL)
+		element_pool.deallocate_node(element);
+	else
+		element_allocator->deallocate(element, sizeof(element_type));
+}
 
-		element_to_delete = next_element;
+template <class T, class Key_op, class Tree_base>
+inline bool set_base<T, Key_op, Tree_base>::less(const binary_tree_node* lhs,
+	const binary_tree_node* rhs) const
+{
+	return tree.key_for_node(lhs) < tree.key_for_node(rhs);
+}
+
+template <class T, class Key_op, class Tree_base>
+void set_base<T, Key_op, Tree_base>::new_elements(const T* values, size_t count,
+	array<binary_tree_node*>* nodes)
+{
+	size_t initial_length = nodes->length();
+
+	try
+	{
+		while (count-- > 0)
+			nodes->append(new_element(*values++));
 	}
+	catch (...)
+	{
+		while (nodes->length() > initial_length)
+		{
+			delete_element(static_cast<element_type*>(
+				nodes->last()));
+
+			nodes->remove(nodes->length() - 1);
+		}
+
+		throw;
+	}
+}
+
+template <class T, class Key_op, class Tree_base>
+void set_base<T, Key_op, Tree_base>::delete_elements(
+	const array<binary_tree_node*>& nodes)
+{
+	for (size_t i = 0; i < nodes.length(); ++i)
+		delete_element(static_cast<element_type*>(nodes[i]));
+}
+
+template <class T, class Key_op, class Tree_base>
+void set_base<T, Key_op, Tree_base>::rebuild(array<binary_tree_node*>& nodes)
+{
+	tree.build_from_sorted(nodes.lock(), nodes.length());
+
+	nodes.unlock();
+}
+
+template <class T, class Key_op, class Tree_base>
+T* set_base<T, Key_op, Tree_base>::select(size_t index) const
+{
+	return value_for_node(tree.select(index));
+}
+
+template <class T, class Key_op, class Tree_base>
+template <class Search_key>
+size_t set_base<T, Key_op, Tree_base>::rank(const Search_key& key) const
+{
+	return tree.rank(key);
+}
+
+template <class T, class Key_op, class Tree_base>
+void set_base<T, Key_op, Tree_base>::clear()
+{
+	if (element_allocator != NULL)
+		// The allocator may reuse the memory of a deleted
+		// element right away, so each element must be
+		// unlinked from the tree before it is deleted.
+		while (tree.leftmost != NULL)
+		{
+			element_type* element_to_delete =
+				static_cast<element_type*>(tree.leftmost);
+
+			tree.remove(element_to_delete);
+
+			delete_element(element_to_delete);
+		}
+	else
+	{
+		// Pooled memory stays valid until the pool is
+		// cleared, so the tree links remain intact while
+		// the values are destroyed.
+		if (!B_HAS_TRIVIAL_DESTRUCTOR(T))
+			for (binary_tree_node* node = tree.leftmost;
+					node != NULL; node = node->next())
+				static_cast<element_type*>(node)->value.~T();
+
+		tree.build_from_sorted(NULL, 0);
+
+		element_pool.clear();
+	}
+}
+
+template <class T, class Key_op, class Tree_base>
+set_base<T, Key_op, Tree_base>::~set_base()
+{
+	clear();
 }
 
 // Functor that returns the set element stored with the specified tree node.
-template <class T>
+template <class T, class Node = binary_tree_node>
 struct set_key_op
 {
 	const T& operator()(const binary_tree_node* node) const
 	{
 		B_ASSERT(node != NULL);
 
-		return static_cast<const set_element<T>*>(node)->value;
+		return static_cast<const set_element<T, Node>*>(node)->value;
 	}
 };
 
-template <class T>
-class set : public set_base<T, set_key_op<T> >
+template <class T, class Tree_base = binary_search_tree_base>
+class set : public set_base<T,
+	set_key_op<T, typename Tree_base::node_type>, Tree_base>
 {
 public:
-	typedef set_base<T, set_key_op<T> > base;
+	typedef set_base<T, set_key_op<T,
+		typename Tree_base::node_type>, Tree_base> base;
+
+	// Creates an empty set that allocates its elements
+	// from a pool owned by the set.
+	set()
+	{
+	}
+
+	// Creates an empty set that allocates its elements
+	// with the specified allocator.
+	explicit set(allocator* element_allocator) : base(element_allocator)
+	{
+	}
 
 	// Inserts a new element after a failed search for it.
 	//
@@ -442,15 +880,15 @@ public:
 	T* insert(const T& value, bool* new_element);
 };
 
-template <class T>
-T* set<T>::insert_new(const T &value,
-		const typename set<T>::base::search_result& sr)
+template <class T, class Tree_base>
+T* set<T, Tree_base>::insert_new(const T &value,
+		const typename set<T, Tree_base>::base::search_result& sr)
 {
 	return base::insert_new(value, sr);
 }
 
-template <class T>
-T* set<T>::insert(const T& value)
+template <class T, class Tree_base>
+T* set<T, Tree_base>::insert(const T& value)
 {
 	typename base::search_result sr = base::search(value);
 
@@ -466,8 +904,8 @@ T* set<T>::insert(const T& value)
 	return base::insert_new(value, sr);
 }
 
-template <class T>
-T* set<T>::insert(const T& value, bool* new_inserted)
+template <class T, class Tree_base>
+T* set<T, Tree_base>::insert(const T& value, bool* new_inserted)
 {
 	typename base::search_result sr = base::search(value);
 
@@ -0,0 +1,115 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_SHARED_OBJECT_H
+#define B_SHARED_OBJECT_H
+
+#include "atomic.h"
+#include "memory.h"
+
+B_BEGIN_NAMESPACE
+
+// Base class for objects that are referenced from multiple threads.
+// It has the same interface as 'object' and works with the ref<>
+// template, but its reference count is updated atomically, so
+// copies of ref<> that point to the same object can be created
+// and destroyed concurrently.
+//
+// A thread can only copy a reference that it knows to stay valid
+// during the copying, for example, one that it owns or one that
+// is stored in a container locked for reading.
+class shared_object
+{
+public:
+	// Allocates objects of the derived classes.
+	static void* operator new(size_t size);
+
+	// Deallocates objects previously allocated by operator new.
+	static void operator delete(void* object, size_t size)
+	{
+		memory::fixed_free(object, size);
+	}
+
+protected:
+	// Initializes the reference count with zero.
+	shared_object();
+
+	// Initializes the reference count with zero.
+	// A newly created object has no references,
+	// even if it is a copy of an existing object.
+	shared_object(const shared_object&);
+
+public:
+	// Increases the reference count by one.
+	void add_ref() const;
+
+	// Decreases the reference count and, if it becomes
+	// zero, calls the delete_this() method.
+	void release() const;
+
+	// Makes sure the counter is not overwritten when
+	// one object is assigned to another.
+	shared_object& operator =(const shared_object&);
+
+protected:
+	// Deletes this object. The method is called by the
+	// release() method when there are no more references
+	// to this object.
+	virtual void delete_this() const;
+
+	// Protected destructor prohibits explicit deletion
+	// of this object.
+	virtual ~shared_object()
+	{
+		B_ASSERT(refs.load(memory_order_relaxed) <= 0);
+	}
+
+	// The reference count.
+	mutable atomic_value<int> refs;
+};
+
+inline void* shared_object::operator new(size_t size)
+{
+	return memory::fixed_alloc(size > B_MIN_FIXED_ALLOC ?
+		size : B_MIN_FIXED_ALLOC);
+}
+
+inline shared_object::shared_object()
+{
+}
+
+inline shared_object::shared_object(const shared_object&)
+{
+}
+
+inline void shared_object::add_ref() const
+{
+	// A new reference is copied from an existing one, which
+	// keeps the object alive, so no ordering is needed.
+	refs.fetch_add(1, memory_order_relaxed);
+}
+
+inline void shared_object::release() const
+{
+	// The last release must see the effects of all threads
+	// that have released their references before it.
+	if (refs.fetch_sub(1, memory_order_acq_rel) == 1)
+		delete_this();
+}
+
+inline shared_object& shared_object::operator =(const shared_object&)
+{
+	return *this;
+}
+
+inline void shared_object::delete_this() const
+{
+	delete const_cast<shared_object*>(this);
+}
+
+B_END_NAMESPACE
+
+#include <b/ref.h>
+
+#endif /* !defined(B_SHARED_OBJECT_H) */
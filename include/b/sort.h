@@ -0,0 +1,747 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Sorting algorithms
+
+#ifndef B_SORT_H
+#define B_SORT_H
+
+#include "fn.h"
+
+B_BEGIN_NAMESPACE
+
+// Orderings
+
+// Ordering that uses 'operator <' of the element type.
+template <class T>
+struct default_less
+{
+	bool operator()(const T& lhs, const T& rhs) const
+	{
+		return lhs < rhs;
+	}
+};
+
+// Ordering defined by a three-way comparison function
+// that has the same semantics as b::compare().
+template <class T, class Compare>
+struct compare_less
+{
+	Compare cmp;
+
+	bool operator()(const T& lhs, const T& rhs) const
+	{
+		return cmp(lhs, rhs) < 0;
+	}
+};
+
+// Element types for which b::sort() partitions without
+// branches when the default ordering is used.
+template <class T>
+struct branchless_sort_traits
+{
+	enum
+	{
+		value = false
+	};
+};
+
+#define B_BRANCHLESS_SORT_TYPE(T) \
+	template <> \
+	struct branchless_sort_traits<T> \
+	{ \
+		enum \
+		{ \
+			value = true \
+		}; \
+	};
+
+B_BRANCHLESS_SORT_TYPE(char)
+B_BRANCHLESS_SORT_TYPE(signed char)
+B_BRANCHLESS_SORT_TYPE(unsigned char)
+B_BRANCHLESS_SORT_TYPE(wchar_t)
+B_BRANCHLESS_SORT_TYPE(short)
+B_BRANCHLESS_SORT_TYPE(unsigned short)
+B_BRANCHLESS_SORT_TYPE(int)
+B_BRANCHLESS_SORT_TYPE(unsigned)
+B_BRANCHLESS_SORT_TYPE(long)
+B_BRANCHLESS_SORT_TYPE(unsigned long)
+B_BRANCHLESS_SORT_TYPE(float)
+B_BRANCHLESS_SORT_TYPE(double)
+
+#undef B_BRANCHLESS_SORT_TYPE
+
+// Implementation details of b::sort() and b::stable_sort()
+
+enum
+{
+	// Ranges shorter than this are sorted by insertion.
+	sort_insertion_threshold = 24,
+
+	// Ranges longer than this use the pseudomedian
+	// of nine as the pivot.
+	sort_ninther_threshold = 128,
+
+	// Maximum number of element moves that
+	// sort_partial_insertion() performs before
+	// giving up.
+	sort_partial_insertion_limit = 8,
+
+	// Number of elements that are compared in one
+	// go by sort_partition_right_branchless().
+	sort_block_size = 64,
+
+	// Ranges shorter than this are sorted by insertion
+	// in stable_sort().
+	stable_sort_insertion_threshold = 32
+};
+
+// Sorts [first, last) by insertion. If 'guarded' is false,
+// the element preceding 'first' must not be greater than any
+// element of the range, which saves a bounds check.
+template <class T, class Less>
+void sort_insertion(T* first, T* last, Less less, bool guarded = true)
+{
+	if (first == last)
+		return;
+
+	for (T* current = first + 1; current != last; ++current)
+	{
+		T* hole = current;
+		T* prev = current - 1;
+
+		if (less(*hole, *prev))
+		{
+			T value(*hole);
+
+			do
+				*hole-- = *prev;
+			while ((!guarded || hole != first) && less(value, *--prev));
+
+			*hole = value;
+		}
+	}
+}
+
+// Attempts to sort [first, last) by insertion. Returns false
+// if too many elements are out of place for insertion sort to
+// be efficient, in which case the range is left unsorted.
+template <class T, class Less>
+bool sort_partial_insertion(T* first, T* last, Less less)
+{
+	if (first == last)
+		return true;
+
+	size_t moves = 0;
+
+	for (T* current = first + 1; current != last; ++current)
+	{
+		T* hole = current;
+		T* prev = current - 1;
+
+		if (less(*hole, *prev))
+		{
+			T value(*hole);
+
+			do
+				*hole-- = *prev;
+			while (hole != first && less(value, *--prev));
+
+			*hole = value;
+
+			moves += (size_t) (current - hole);
+		}
+
+		if (moves > sort_partial_insertion_limit)
+			return false;
+	}
+
+	return true;
+}
+
+// Sorts three elements in place.
+template <class T, class Less>
+inline void sort3(T* a, T* b, T* c, Less less)
+{
+	if (less(*b, *a))
+		swap(*a, *b);
+
+	if (less(*c, *b))
+	{
+		swap(*b, *c);
+
+		if (less(*b, *a))
+			swap(*a, *b);
+	}
+}
+
+// Sorts [first, last) using heapsort. This is the fallback
+// for inputs that make quicksort degrade.
+template <class T, class Less>
+void sort_heap(T* first, T* last, Less less)
+{
+	size_t size = (size_t) (last - first);
+
+	if (size < 2)
+		return;
+
+	size_t start = size / 2;
+
+	for (;;)
+	{
+		if (start > 0)
+			--start;
+		else if (--size == 0)
+			break;
+		else
+			swap(first[0], first[size]);
+
+		// Sift the element at 'start' down.
+		T value(first[start]);
+
+		size_t hole = start, child;
+
+		while ((child = hole * 2 + 1) < size)
+		{
+			if (child + 1 < size && less(first[child], first[child + 1]))
+				++child;
+
+			if (!less(value, first[child]))
+				break;
+
+			first[hole] = first[child];
+
+			hole = child;
+		}
+
+		first[hole] = value;
+	}
+}
+
+// Partitions [first, last) around the pivot '*first'. Elements
+// equal to the pivot go to the right partition. Returns the
+// final position of the pivot; '*already_partitioned' is set
+// to true if no elements had to be exchanged.
+template <class T, class Less>
+T* sort_partition_right(T* first, T* last, Less less,
+	bool* already_partitioned)
+{
+	T pivot(*first);
+
+	T* left = first;
+	T* right = last;
+
+	// The pivot is the median of at least three elements,
+	// so these loops are bounded by those elements.
+	while (less(*++left, pivot))
+		;
+
+	if (left - 1 == first)
+		while (left < right && !less(*--right, pivot))
+			;
+	else
+		while (!less(*--right, pivot))
+			;
+
+	*already_partitioned = left >= right;
+
+	while (left < right)
+	{
+		swap(*left, *right);
+
+		while (less(*++left, pivot))
+			;
+		while (!less(*--right, pivot))
+			;
+	}
+
+	T* pivot_pos = left - 1;
+
+	*first = *pivot_pos;
+	*pivot_pos = pivot;
+
+	return pivot_pos;
+}
+
+// Same as sort_partition_right(), but instead of branching on
+// each comparison, the comparison results are collected into
+// blocks of offsets, which are then used to exchange the
+// misplaced elements. This avoids branch mispredictions on
+// random input.
+template <class T, class Less>
+T* sort_partition_right_branchless(T* first, T* last, Less less,
+	bool* already_partitioned)
+{
+	T pivot(*first);
+
+	T* left = first;
+	T* right = last;
+
+	while (less(*++left, pivot))
+		;
+
+	if (left - 1 == first)
+		while (left < right && !less(*--right, pivot))
+			;
+	else
+		while (!less(*--right, pivot))
+			;
+
+	*already_partitioned = left >= right;
+
+	if (left < right)
+	{
+		swap(*left, *right);
+		++left;
+
+		unsigned char offsets_l[sort_block_size];
+		unsigned char offsets_r[sort_block_size];
+
+		T* base_l = left;
+		T* base_r = right;
+
+		size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+		while (left < right)
+		{
+			// Fill the blocks that have been exhausted. If both
+			// are empty, split the remaining elements between
+			// them.
+			size_t unknown = (size_t) (right - left);
+
+			size_t split_l = num_l == 0 ?
+				(num_r == 0 ? unknown / 2 : unknown) : 0;
+			size_t split_r = num_r == 0 ? unknown - split_l : 0;
+
+			if (split_l > sort_block_size)
+				split_l = sort_block_size;
+
+			if (split_r > sort_block_size)
+				split_r = sort_block_size;
+
+			for (size_t i = 0; i < split_l; ++i)
+			{
+				offsets_l[num_l] = (unsigned char) i;
+				num_l += !less(*left, pivot);
+				++left;
+			}
+
+			for (size_t i = 0; i < split_r; )
+			{
+				offsets_r[num_r] = (unsigned char) ++i;
+				num_r += less(*--right, pivot);
+			}
+
+			// Exchange the misplaced elements.
+			size_t num = num_l < num_r ? num_l : num_r;
+
+			const unsigned char* ol = offsets_l + start_l;
+			const unsigned char* or_ = offsets_r + start_r;
+
+			if (num_l == num_r)
+				for (size_t i = 0; i < num; ++i)
+					swap(base_l[ol[i]], *(base_r - or_[i]));
+			else if (num > 0)
+			{
+				// Cyclic permutation: one copy per element
+				// instead of three.
+				T* l = base_l + ol[0];
+				T* r = base_r - or_[0];
+
+				T tmp(*l);
+
+				*l = *r;
+
+				for (size_t i = 1; i < num; ++i)
+				{
+					l = base_l + ol[i];
+					*r = *l;
+					r = base_r - or_[i];
+					*l = *r;
+				}
+
+				*r = tmp;
+			}
+
+			num_l -= num;
+			num_r -= num;
+			start_l += num;
+			start_r += num;
+
+			if (num_l == 0)
+			{
+				start_l = 0;
+				base_l = left;
+			}
+
+			if (num_r == 0)
+			{
+				start_r = 0;
+				base_r = right;
+			}
+		}
+
+		// Move the remaining misplaced elements to the
+		// boundary between the partitions.
+		if (num_l > 0)
+		{
+			const unsigned char* ol = offsets_l + start_l;
+
+			while (num_l-- > 0)
+				swap(base_l[ol[num_l]], *--right);
+
+			left = right;
+		}
+
+		if (num_r > 0)
+		{
+			const unsigned char* or_ = offsets_r + start_r;
+
+			while (num_r-- > 0)
+			{
+				swap(*(base_r - or_[num_r]), *left);
+				++left;
+			}
+		}
+	}
+
+	T* pivot_pos = left - 1;
+
+	*first = *pivot_pos;
+	*pivot_pos = pivot;
+
+	return pivot_pos;
+}
+
+// Partitions [first, last) around the pivot '*first', putting
+// the elements equal to the pivot to the left partition. Used
+// when the pivot is equal to the element preceding the range,
+// in which case the entire left partition consists of equal
+// elements and needs no further sorting.
+template <class T, class Less>
+T* sort_partition_left(T* first, T* last, Less less)
+{
+	T pivot(*first);
+
+	T* left = first;
+	T* right = last;
+
+	while (less(pivot, *--right))
+		;
+
+	if (right + 1 == last)
+		while (left < right && !less(pivot, *++left))
+			;
+	else
+		while (!less(pivot, *++left))
+			;
+
+	while (left < right)
+	{
+		swap(*left, *right);
+
+		while (less(pivot, *--right))
+			;
+		while (!less(pivot, *++left))
+			;
+	}
+
+	*first = *right;
+	*right = pivot;
+
+	return right;
+}
+
+template <bool Branchless, class T, class Less>
+void sort_loop(T* first, T* last, Less less, int bad_allowed,
+	bool leftmost)
+{
+	for (;;)
+	{
+		size_t size = (size_t) (last - first);
+
+		if (size < sort_insertion_threshold)
+		{
+			sort_insertion(first, last, less, leftmost);
+			return;
+		}
+
+		// Choose the pivot as the median of three or the
+		// pseudomedian of nine and move it to 'first'.
+		size_t half = size / 2;
+
+		if (size > sort_ninther_threshold)
+		{
+			sort3(first, first + half, last - 1, less);
+			sort3(first + 1, first + (half - 1), last - 2, less);
+			sort3(first + 2, first + (half + 1), last - 3, less);
+			sort3(first + (half - 1), first + half,
+				first + (half + 1), less);
+			swap(*first, first[half]);
+		}
+		else
+			sort3(first + half, first, last - 1, less);
+
+		// If the pivot is equal to the element preceding
+		// the range, all elements equal to the pivot are
+		// already in their final positions.
+		if (!leftmost && !less(first[-1], *first))
+		{
+			first = sort_partition_left(first, last, less) + 1;
+			continue;
+		}
+
+		bool already_partitioned;
+
+		T* pivot_pos = Branchless ?
+			sort_partition_right_branchless(first, last, less,
+				&already_partitioned) :
+			sort_partition_right(first, last, less,
+				&already_partitioned);
+
+		size_t l_size = (size_t) (pivot_pos - first);
+		size_t r_size = (size_t) (last - (pivot_pos + 1));
+
+		if (l_size < size / 8 || r_size < size / 8)
+		{
+			// Too many bad partitions indicate a pattern that
+			// defeats quicksort: switch to heapsort.
+			if (--bad_allowed == 0)
+			{
+				sort_heap(first, last, less);
+				return;
+			}
+
+			// Break up the pattern by moving a few elements.
+			if (l_size >= sort_insertion_threshold)
+			{
+				swap(*first, first[l_size / 4]);
+				swap(pivot_pos[-1], *(pivot_pos - l_size / 4));
+
+				if (l_size > sort_ninther_threshold)
+				{
+					swap(first[1], first[l_size / 4 + 1]);
+					swap(first[2], first[l_size / 4 + 2]);
+					swap(pivot_pos[-2],
+						*(pivot_pos - (l_size / 4 + 1)));
+					swap(pivot_pos[-3],
+						*(pivot_pos - (l_size / 4 + 2)));
+				}
+			}
+
+			if (r_size >= sort_insertion_threshold)
+			{
+				swap(pivot_pos[1], pivot_pos[1 + r_size / 4]);
+				swap(last[-1], *(last - r_size / 4));
+
+				if (r_size > sort_ninther_threshold)
+				{
+					swap(pivot_pos[2], pivot_pos[2 + r_size / 4]);
+					swap(pivot_pos[3], pivot_pos[3 + r_size / 4]);
+					swap(last[-2], *(last - (1 + r_size / 4)));
+					swap(last[-3], *(last - (2 + r_size / 4)));
+				}
+			}
+		}
+		else
+			// A balanced partition that required no exchanges
+			// suggests that the input is nearly sorted.
+			if (already_partitioned &&
+					sort_partial_insertion(first, pivot_pos, less) &&
+					sort_partial_insertion(pivot_pos + 1,
+						last, less))
+				return;
+
+		// Recurse into the left partition and
+		// loop over the right one.
+		sort_loop<Branchless>(first, pivot_pos, less,
+			bad_allowed, leftmost);
+
+		first = pivot_pos + 1;
+		leftmost = false;
+	}
+}
+
+template <bool Branchless, class T, class Less>
+void sort_range(T* data, size_t count, Less less)
+{
+	if (count < 2)
+		return;
+
+	int log2 = 0;
+
+	for (size_t n = count; (n >>= 1) != 0; )
+		++log2;
+
+	sort_loop<Branchless>(data, data + count, less, log2, true);
+}
+
+// Temporary buffer for stable_sort() and parallel_sort().
+// The elements are either copy-constructed from the source
+// array or default-constructed.
+template <class T>
+class stable_sort_buffer
+{
+public:
+	explicit stable_sort_buffer(size_t count) :
+		elements((T*) memory::alloc(count * sizeof(T))),
+		constructed(0)
+	{
+		try
+		{
+			for (; constructed < count; ++constructed)
+				new (elements + constructed) T();
+		}
+		catch (...)
+		{
+			destroy();
+			throw;
+		}
+	}
+
+	stable_sort_buffer(const T* source, size_t count) :
+		elements((T*) memory::alloc(count * sizeof(T))),
+		constructed(0)
+	{
+		try
+		{
+			for (; constructed < count; ++constructed)
+				new (elements + constructed) T(source[constructed]);
+		}
+		catch (...)
+		{
+			destroy();
+			throw;
+		}
+	}
+
+	~stable_sort_buffer()
+	{
+		destroy();
+	}
+
+	T* const elements;
+
+private:
+	stable_sort_buffer(const stable_sort_buffer&);
+	stable_sort_buffer& operator =(const stable_sort_buffer&);
+
+	void destroy()
+	{
+		while (constructed > 0)
+			elements[--constructed].~T();
+
+		memory::free(elements);
+	}
+
+	size_t constructed;
+};
+
+// Sorts 'count' elements using top-down merge sort.
+// The buffer must have room for 'count / 2' elements.
+template <class T, class Less>
+void stable_sort_range(T* data, size_t count, T* buffer, Less less)
+{
+	if (count < stable_sort_insertion_threshold)
+	{
+		sort_insertion(data, data + count, less);
+		return;
+	}
+
+	size_t half = count / 2;
+
+	stable_sort_range(data, half, buffer, less);
+	stable_sort_range(data + half, count - half, buffer, less);
+
+	// Skip merging if the halves are already in order.
+	if (!less(data[half], data[half - 1]))
+		return;
+
+	T* left = buffer;
+	T* left_end = buffer + half;
+
+	for (size_t i = 0; i < half; ++i)
+		buffer[i] = data[i];
+
+	T* right = data + half;
+	T* end = data + count;
+	T* out = data;
+
+	// When the values are equal, the element from the
+	// left half goes first, which makes the sort stable.
+	while (left < left_end && right < end)
+		if (less(*right, *left))
+			*out++ = *right++;
+		else
+			*out++ = *left++;
+
+	while (left < left_end)
+		*out++ = *left++;
+}
+
+template <class T, class Less>
+void stable_sort_with(T* data, size_t count, Less less)
+{
+	if (count < stable_sort_insertion_threshold)
+		sort_insertion(data, data + count, less);
+	else
+	{
+		stable_sort_buffer<T> buffer(data, count / 2);
+
+		stable_sort_range(data, count, buffer.elements, less);
+	}
+}
+
+// Sorting functions
+
+// Sorts the array pointed to by 'data' in ascending order
+// using 'operator <'. The sort is not stable.
+//
+// The algorithm is pattern-defeating quicksort: introsort
+// with insertion sort for short ranges, adaptive handling
+// of sorted and nearly sorted input and of runs of equal
+// elements, and block-based branchless partitioning for
+// arithmetic types. Complexity: O(n * log(n)) in the worst
+// case; O(n) for sorted input.
+template <class T>
+void sort(T* data, size_t count)
+{
+	sort_range<branchless_sort_traits<T>::value>(data, count,
+		default_less<T>());
+}
+
+// Sorts the array pointed to by 'data' according to the
+// three-way comparison function 'cmp', which has the same
+// semantics as b::compare(). The sort is not stable.
+template <class T, class Compare>
+void sort(T* data, size_t count, Compare cmp)
+{
+	compare_less<T, Compare> less = {cmp};
+
+	sort_range<false>(data, count, less);
+}
+
+// Sorts the array pointed to by 'data' in ascending order
+// using 'operator <'. Equal elements retain their relative
+// order. The function uses merge sort, which needs temporary
+// storage for 'count / 2' elements. Complexity: O(n * log(n));
+// O(n) for sorted input.
+template <class T>
+void stable_sort(T* data, size_t count)
+{
+	stable_sort_with(data, count, default_less<T>());
+}
+
+// Stable sort with a three-way comparison function.
+template <class T, class Compare>
+void stable_sort(T* data, size_t count, Compare cmp)
+{
+	compare_less<T, Compare> less = {cmp};
+
+	stable_sort_with(data, count, less);
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_SORT_H) */
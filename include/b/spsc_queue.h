@@ -0,0 +1,235 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_SPSC_QUEUE_H
+#define B_SPSC_QUEUE_H
+
+#include "atomic.h"
+#include "memory.h"
+
+B_BEGIN_NAMESPACE
+
+// Bounded wait-free FIFO queue (a ring buffer) for exactly one
+// producer thread and one consumer thread.
+//
+// The write position is updated only by the producer and the read
+// position only by the consumer, so no operation ever retries.
+// The two positions are kept in separate cache lines, and each side
+// caches the last position of the other side that it has seen, so
+// the cache line of the other side is only read when the queue
+// looks full or empty. The batch operations publish a whole batch
+// with a single store.
+//
+// The copy constructor and the destructor of T must not throw.
+template <class T>
+class spsc_queue
+{
+public:
+	typedef T value_type;
+
+	// Creates an empty queue that can hold at least 'min_capacity'
+	// elements. The capacity is rounded up to a power of two.
+	explicit spsc_queue(size_t min_capacity);
+
+	// Returns the maximum number of elements in the queue.
+	size_t capacity() const;
+
+	// Appends a copy of 'value' to the queue. Returns false
+	// if the queue is full. Must only be called by the producer.
+	bool try_push(const T& value);
+
+	// Appends up to 'count' elements to the queue and returns
+	// the number of elements that fit. Must only be called by
+	// the producer.
+	size_t try_push(const T* values, size_t count);
+
+	// Removes the oldest element from the queue and assigns it
+	// to '*value'. Returns false if the queue is empty. Must
+	// only be called by the consumer.
+	bool try_pop(T* value);
+
+	// Removes up to 'max_count' oldest elements and returns
+	// their number. Must only be called by the consumer.
+	size_t try_pop(T* values, size_t max_count);
+
+	// Destroys the elements that remain in the queue.
+	~spsc_queue();
+
+private:
+	spsc_queue(const spsc_queue&);
+	spsc_queue& operator =(const spsc_queue&);
+
+	// Returns the number of elements that the producer can
+	// push without overwriting unread elements. The position
+	// of the consumer is only reloaded if the cached one
+	// leaves room for fewer than 'wanted' elements.
+	size_t free_slots(size_t position, size_t wanted);
+
+	// Returns the number of elements that the consumer
+	// can pop. Same as above for the producer position.
+	size_t filled_slots(size_t position, size_t wanted);
+
+	char padding_before[B_CACHE_LINE_SIZE];
+
+	T* slots;
+	size_t mask;
+
+	char padding_after_slots[B_CACHE_LINE_SIZE];
+
+	// The producer side.
+	atomic_value<size_t> push_position;
+	size_t cached_pop_position;
+
+	char padding_after_push[B_CACHE_LINE_SIZE];
+
+	// The consumer side.
+	atomic_value<size_t> pop_position;
+	size_t cached_push_position;
+
+	char padding_after_pop[B_CACHE_LINE_SIZE];
+};
+
+template <class T>
+spsc_queue<T>::spsc_queue(size_t min_capacity) :
+	cached_pop_position(0),
+	cached_push_position(0)
+{
+	size_t size = 1;
+
+	while (size < min_capacity)
+		size <<= 1;
+
+	mask = size - 1;
+
+	slots = (T*) memory::alloc(size * sizeof(T));
+}
+
+template <class T>
+inline size_t spsc_queue<T>::capacity() const
+{
+	return mask + 1;
+}
+
+template <class T>
+inline size_t spsc_queue<T>::free_slots(size_t position, size_t wanted)
+{
+	size_t free_count = mask + 1 - (position - cached_pop_position);
+
+	if (free_count < wanted)
+	{
+		cached_pop_position = pop_position.load(memory_order_acquire);
+
+		free_count = mask + 1 - (position - cached_pop_position);
+	}
+
+	return free_count;
+}
+
+template <class T>
+inline size_t spsc_queue<T>::filled_slots(size_t position, size_t wanted)
+{
+	size_t filled_count = cached_push_position - position;
+
+	if (filled_count < wanted)
+	{
+		cached_push_position =
+			push_position.load(memory_order_acquire);
+
+		filled_count = cached_push_position - position;
+	}
+
+	return filled_count;
+}
+
+template <class T>
+bool spsc_queue<T>::try_push(const T& value)
+{
+	size_t position = push_position.load(memory_order_relaxed);
+
+	if (free_slots(position, 1) == 0)
+		return false;
+
+	new (slots + (position & mask)) T(value);
+
+	push_position.store(position + 1, memory_order_release);
+
+	return true;
+}
+
+template <class T>
+size_t spsc_queue<T>::try_push(const T* values, size_t count)
+{
+	size_t position = push_position.load(memory_order_relaxed);
+
+	size_t free_count = free_slots(position, count);
+
+	if (count > free_count)
+		count = free_count;
+
+	for (size_t i = 0; i < count; ++i)
+		new (slots + ((position + i) & mask)) T(values[i]);
+
+	push_position.store(position + count, memory_order_release);
+
+	return count;
+}
+
+template <class T>
+bool spsc_queue<T>::try_pop(T* value)
+{
+	size_t position = pop_position.load(memory_order_relaxed);
+
+	if (filled_slots(position, 1) == 0)
+		return false;
+
+	T* slot = slots + (position & mask);
+
+	*value = *slot;
+
+	slot->~T();
+
+	pop_position.store(position + 1, memory_order_release);
+
+	return true;
+}
+
+template <class T>
+size_t spsc_queue<T>::try_pop(T* values, size_t max_count)
+{
+	size_t position = pop_position.load(memory_order_relaxed);
+
+	size_t count = filled_slots(position, max_count);
+
+	if (count > max_count)
+		count = max_count;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		T* slot = slots + ((position + i) & mask);
+
+		values[i] = *slot;
+
+		slot->~T();
+	}
+
+	pop_position.store(position + count, memory_order_release);
+
+	return count;
+}
+
+template <class T>
+spsc_queue<T>::~spsc_queue()
+{
+	size_t end = push_position.load(memory_order_relaxed);
+
+	for (size_t position = pop_position.load(memory_order_relaxed);
+			position != end; ++position)
+		slots[position & mask].~T();
+
+	memory::free(slots);
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_SPSC_QUEUE_H) */
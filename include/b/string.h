@@ -304,6 +304,14 @@ public:
 	// Returns true if this string is greater or equal than 'rhs'.
 	bool operator >=(const char_t* rhs) const;
 
+// Hashing
+public:
+	// Returns the hash value of this string. Unless caching is
+	// disabled by the B_STRING_HASH_CACHE build option, the value
+	// is computed once and stored in the buffer, which is shared
+	// by copies of this string, until the string is modified.
+	size_t hash() const;
+
 // Formatting
 public:
 	// Constructs a new string from a format string.
@@ -350,6 +358,10 @@ private:
 	struct buffer
 	{
 		int refs;
+#if defined(B_STRING_HASH_CACHE)
+		// Cached hash value or zero if it is not computed yet.
+		size_t hash;
+#endif /* defined(B_STRING_HASH_CACHE) */
 		size_t capacity;
 		size_t length;
 		char_t first_char[1];
@@ -375,6 +387,10 @@ private:
 
 	void replace_buffer(char_t* new_buffer_chars);
 
+	// Discards the cached hash value. Must be called whenever
+	// the contents of an unshared buffer changes.
+	void invalidate_hash();
+
 	// Make sure that the buffer is not shared with other strings.
 	// Reallocate the buffer if it's shared; preserve the original
 	// buffer contents.
@@ -465,9 +481,17 @@ inline void string::isolate()
 	}
 }
 
+inline void string::invalidate_hash()
+{
+#if defined(B_STRING_HASH_CACHE)
+	metadata()->hash = 0;
+#endif /* defined(B_STRING_HASH_CACHE) */
+}
+
 inline char_t* string::lock()
 {
 	isolate();
+	invalidate_hash();
 
 	--metadata()->refs;
 
@@ -501,6 +525,7 @@ inline char_t& string::at(size_t index)
 	B_ASSERT(index < (is_locked() ? capacity() : length()));
 
 	isolate();
+	invalidate_hash();
 	return chars[index];
 }
 
@@ -516,6 +541,7 @@ inline char_t& string::operator [](size_t index)
 	B_ASSERT(index < (is_locked() ? capacity() : length()));
 
 	isolate();
+	invalidate_hash();
 	return chars[index];
 }
 
@@ -531,6 +557,7 @@ inline char_t& string::first()
 	B_ASSERT(!is_empty());
 
 	isolate();
+	invalidate_hash();
 	return *chars;
 }
 
@@ -546,6 +573,7 @@ inline char_t& string::last()
 	B_ASSERT(!is_empty());
 
 	isolate();
+	invalidate_hash();
 	return chars[length() - 1];
 }
 
@@ -691,6 +719,26 @@ inline bool string::operator >=(const char_t* rhs) const
 	return compare(rhs) >= 0;
 }
 
+inline size_t string::hash() const
+{
+#if defined(B_STRING_HASH_CACHE)
+	buffer* buf = metadata();
+
+	if (buf->hash != 0)
+		return buf->hash;
+
+	size_t hash_value = hash_bytes(chars, buf->length * sizeof(char_t));
+
+	// Static buffers and locked buffers are never updated.
+	if (buf->refs > 0 && buf->length > 0)
+		buf->hash = hash_value;
+
+	return hash_value;
+#else
+	return hash_bytes(chars, length() * sizeof(char_t));
+#endif /* defined(B_STRING_HASH_CACHE) */
+}
+
 inline void string::trim(const string_view& samples)
 {
 	trim_right(samples);
@@ -802,10 +850,19 @@ B_END_NAMESPACE
 
 #undef B_STRING_INLINE
 
+#if defined(B_STRING_HASH_CACHE)
+#define B_STRING_LITERAL_HASH_FIELD size_t hash;
+#define B_STRING_LITERAL_HASH_VALUE 0,
+#else
+#define B_STRING_LITERAL_HASH_FIELD
+#define B_STRING_LITERAL_HASH_VALUE
+#endif /* defined(B_STRING_HASH_CACHE) */
+
 #define B_STRING_LITERAL_IMPL(char_type, string_type, name, value) \
 	static struct \
 	{ \
 		int refs; \
+		B_STRING_LITERAL_HASH_FIELD \
 		size_t capacity; \
 		size_t length; \
 		char_type chars[sizeof(value)]; \
@@ -813,6 +870,7 @@ B_END_NAMESPACE
 	const name##_buffer = \
 	{ \
 		-1, \
+		B_STRING_LITERAL_HASH_VALUE \
 		sizeof(value) / sizeof(char_type) - 1, \
 		sizeof(value) / sizeof(char_type) - 1, \
 		value \
@@ -0,0 +1,279 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_STRING_POOL_H
+#define B_STRING_POOL_H
+
+#include "string_view.h"
+#include "mutex.h"
+
+B_BEGIN_NAMESPACE
+
+// Handle to a string interned by a string_pool. Two atoms created
+// by the same pool are equal if and only if their strings are equal,
+// so atom comparison is a single pointer comparison. Atoms remain
+// valid for the lifetime of the pool that created them.
+class atom
+{
+public:
+	// Creates an atom that represents the empty string.
+	// Interning an empty string in any pool returns an
+	// atom equal to this one.
+	atom();
+
+	// Returns the string that this atom represents.
+	string_view str() const;
+
+	// Returns a pointer to the null-terminated characters.
+	const char* data() const;
+
+	// Returns the length of the string.
+	size_t length() const;
+
+	// Returns true if this atom represents the empty string.
+	bool is_empty() const;
+
+	// Returns the value of b::hash() for the string, which
+	// is computed when the string is interned. As an exception,
+	// the hash value of the empty atom is zero.
+	size_t hash() const;
+
+	// Compares the identity of two atoms.
+	bool operator ==(const atom& rhs) const;
+
+	// Compares the identity of two atoms.
+	bool operator !=(const atom& rhs) const;
+
+	// Orders atoms by their addresses. The order is unrelated
+	// to the order of the strings, but it does not change during
+	// the lifetime of the pool, which is sufficient for using atoms
+	// as keys in b::set and b::map. Note that atoms interned one
+	// after another usually have ascending addresses.
+	bool operator <(const atom& rhs) const;
+
+	// Interned string as it is stored in the pool.
+	struct entry
+	{
+		size_t hash;
+		size_t length;
+		char chars[1];
+	};
+
+private:
+	friend class string_pool;
+
+	explicit atom(const entry* e);
+
+	const entry* ent;
+
+	static const entry empty_entry;
+};
+
+inline atom::atom() : ent(&empty_entry)
+{
+}
+
+inline atom::atom(const entry* e) : ent(e)
+{
+}
+
+inline string_view atom::str() const
+{
+	return string_view(ent->chars, ent->length);
+}
+
+inline const char* atom::data() const
+{
+	return ent->chars;
+}
+
+inline size_t atom::length() const
+{
+	return ent->length;
+}
+
+inline bool atom::is_empty() const
+{
+	return ent->length == 0;
+}
+
+inline size_t atom::hash() const
+{
+	return ent->hash;
+}
+
+inline bool atom::operator ==(const atom& rhs) const
+{
+	return ent == rhs.ent;
+}
+
+inline bool atom::operator !=(const atom& rhs) const
+{
+	return ent != rhs.ent;
+}
+
+inline bool atom::operator <(const atom& rhs) const
+{
+	return ent < rhs.ent;
+}
+
+// Memory usage statistics of a string pool.
+struct string_pool_stats
+{
+	// Number of distinct strings in the pool.
+	size_t string_count;
+
+	// Total length of all strings in the pool.
+	size_t string_bytes;
+
+	// Memory allocated for the strings, including
+	// per-string overhead and unused block space.
+	size_t arena_bytes;
+
+	// Memory allocated for the hash table.
+	size_t table_bytes;
+};
+
+// Deduplicating storage for immutable strings. Each distinct
+// string is copied into the pool only once; all requests to
+// intern an equal string return the same atom. Strings are
+// never removed from the pool until it is destroyed.
+//
+// This class is not thread-safe; see concurrent_string_pool.
+class string_pool
+{
+public:
+	// Creates an empty pool.
+	string_pool();
+
+	// Returns the atom for the specified string. The string
+	// is copied into the pool if it is not there yet.
+	atom intern(const string_view& str);
+
+	// Looks up the specified string without adding it to
+	// the pool. Returns true and stores the atom in 'result'
+	// if the string is found.
+	bool find(const string_view& str, atom* result) const;
+
+	// Returns the number of distinct non-empty strings
+	// in the pool.
+	size_t size() const;
+
+	// Returns memory usage statistics of this pool.
+	string_pool_stats stats() const;
+
+	// Frees all memory allocated by the pool and
+	// invalidates all atoms created by it.
+	~string_pool();
+
+private:
+	string_pool(const string_pool&);
+	string_pool& operator =(const string_pool&);
+
+	// Hash table slot. The hash value is duplicated here
+	// so that mismatching entries are skipped without
+	// dereferencing them.
+	struct slot
+	{
+		size_t hash;
+		const atom::entry* ent;
+	};
+
+	// Returns the slot that either contains the string
+	// or must receive it.
+	slot* find_slot(const string_view& str, size_t hash_value) const;
+
+	atom::entry* allocate_entry(size_t length);
+
+	void grow_table();
+
+	struct arena_block
+	{
+		arena_block* next;
+		size_t size;
+	};
+
+	arena_block* blocks;
+	char* arena_pos;
+	char* arena_end;
+	size_t arena_bytes;
+
+	slot* table;
+	size_t table_size;
+	size_t string_count;
+	size_t string_bytes;
+};
+
+inline string_pool::string_pool() :
+	blocks(NULL),
+	arena_pos(NULL),
+	arena_end(NULL),
+	arena_bytes(0),
+	table(NULL),
+	table_size(0),
+	string_count(0),
+	string_bytes(0)
+{
+}
+
+inline size_t string_pool::size() const
+{
+	return string_count;
+}
+
+// Version of string_pool that can be shared between threads.
+// Atoms are immutable, so reading them requires no locking.
+class concurrent_string_pool
+{
+public:
+	// Returns the atom for the specified string.
+	atom intern(const string_view& str);
+
+	// Looks up the specified string without adding it.
+	bool find(const string_view& str, atom* result) const;
+
+	// Returns the number of distinct non-empty strings.
+	size_t size() const;
+
+	// Returns memory usage statistics of this pool.
+	string_pool_stats stats() const;
+
+private:
+	mutable mutex pool_mutex;
+
+	string_pool pool;
+};
+
+inline atom concurrent_string_pool::intern(const string_view& str)
+{
+	mutex_lock lock(pool_mutex);
+
+	return pool.intern(str);
+}
+
+inline bool concurrent_string_pool::find(const string_view& str,
+	atom* result) const
+{
+	mutex_lock lock(pool_mutex);
+
+	return pool.find(str, result);
+}
+
+inline size_t concurrent_string_pool::size() const
+{
+	mutex_lock lock(pool_mutex);
+
+	return pool.size();
+}
+
+inline string_pool_stats concurrent_string_pool::stats() const
+{
+	mutex_lock lock(pool_mutex);
+
+	return pool.stats();
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_STRING_POOL_H) */
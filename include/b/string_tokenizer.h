@@ -0,0 +1,172 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+// Declaration of the char_set, wchar_set, string_tokenizer,
+// and wstring_tokenizer classes.
+
+#ifndef B_STRING_TOKENIZER_H
+
+#if defined(B_STRING_TOKENIZER_DECL)
+
+B_BEGIN_NAMESPACE
+
+// Set of characters with a constant-time membership test.
+// Characters with codes below 256 are kept in a bit table.
+// Wide characters outside of that range are looked up in the
+// string view that the set was constructed from, which means
+// that the characters of that view must outlive the set.
+class char_set
+{
+public:
+	// Creates an empty set.
+	char_set();
+
+	// Creates a set of all characters found in 'chars'.
+	explicit char_set(const string_view& chars);
+
+	// Returns true if 'ch' is a member of this set.
+	bool contains(char_t ch) const;
+
+private:
+	enum
+	{
+		bits_per_word = sizeof(size_t) * 8
+	};
+
+	size_t bits[256 / bits_per_word];
+
+	string_view chars_beyond_table;
+};
+
+// Splits a string into tokens separated by any of the specified
+// delimiter characters. The tokens are returned as string_view
+// objects pointing into the input string, so that tokenization
+// requires no memory allocation. The input string must outlive
+// the tokenizer and the tokens it returns.
+class string_tokenizer
+{
+public:
+	// Prepares to split 'input' at every occurrence of any of the
+	// characters from 'delimiters'. The characters of 'delimiters'
+	// must outlive the tokenizer.
+	//
+	// Unless 'skip_empty_tokens' is true, two adjacent delimiters
+	// produce an empty token, and so do the leading and trailing
+	// delimiters (that is, N delimiters always produce N + 1
+	// tokens). When 'skip_empty_tokens' is true, runs of delimiters
+	// are treated as a single separator.
+	string_tokenizer(const string_view& input,
+		const string_view& delimiters, bool skip_empty_tokens = false);
+
+	// Retrieves the next token. Returns false when there are no
+	// more tokens in the input string.
+	bool next(string_view* token);
+
+	// Returns the part of the input string that has not been
+	// tokenized yet.
+	string_view remainder() const;
+
+private:
+	const char_t* find_delimiter(const char_t* from) const;
+
+	char_set delimiter_set;
+
+	// Only used when there is exactly one delimiter
+	// character, in which case it is searched for
+	// with memchr() or wmemchr().
+	const char_t* single_delimiter;
+
+	// Beginning of the next token and the end of the input.
+	const char_t* current;
+	const char_t* end;
+
+	bool skip_empty;
+
+	// Set when all tokens have been returned.
+	bool exhausted;
+};
+
+inline char_set::char_set()
+{
+	memory::zero(bits, sizeof(bits));
+}
+
+inline bool char_set::contains(char_t ch) const
+{
+	size_t code = char_code(ch);
+
+	if (code < 256)
+		return (bits[code / bits_per_word] >>
+			(code % bits_per_word) & 1) != 0;
+
+	return chars_beyond_table.find(ch) != (size_t) -1;
+}
+
+inline const char_t* string_tokenizer::find_delimiter(
+	const char_t* from) const
+{
+	if (single_delimiter != NULL)
+		return from < end ? find_char(from, (size_t) (end - from),
+			*single_delimiter) : NULL;
+
+	for (; from < end; ++from)
+		if (delimiter_set.contains(*from))
+			return from;
+
+	return NULL;
+}
+
+inline string_view string_tokenizer::remainder() const
+{
+	return !exhausted ? string_view(current,
+		(size_t) (end - current)) : string_view();
+}
+
+B_END_NAMESPACE
+
+#else /* !defined(B_STRING_TOKENIZER_DECL) */
+
+#include "string_view.h"
+
+B_BEGIN_NAMESPACE
+
+// Returns the non-negative code of a character
+// for use as a lookup table index.
+inline size_t char_code(char ch)
+{
+	return (unsigned char) ch;
+}
+
+// Returns the code of a wide character. Negative values
+// are converted to large integers outside of any table range.
+inline size_t char_code(wchar_t ch)
+{
+	return (size_t) ch;
+}
+
+B_END_NAMESPACE
+
+#define B_STRING_TOKENIZER_DECL
+
+#define string_view wstring_view
+#define char_t wchar_t
+#define char_set wchar_set
+#define string_tokenizer wstring_tokenizer
+#include "string_tokenizer.h"
+#undef string_tokenizer
+#undef char_set
+#undef char_t
+#undef string_view
+
+#define char_t char
+#include "string_tokenizer.h"
+#undef char_t
+
+#undef B_STRING_TOKENIZER_DECL
+
+#define B_STRING_TOKENIZER_H
+
+#endif /* defined(B_STRING_TOKENIZER_DECL) */
+
+#endif /* !defined(B_STRING_TOKENIZER_H) */
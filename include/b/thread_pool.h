@@ -0,0 +1,204 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_THREAD_POOL_H
+#define B_THREAD_POOL_H
+
+#include "atomic.h"
+#include "memory.h"
+#include "opaque.h"
+
+#include <stdint.h>
+
+B_BEGIN_NAMESPACE
+
+class task_group;
+
+// A unit of work that can be executed by a thread_pool.
+// Tasks must not throw exceptions.
+class task
+{
+public:
+	// Allocates tasks from the lists of free chunks
+	// maintained by memory::fixed_alloc().
+	static void* operator new(size_t size);
+
+	// Deallocates tasks previously allocated by operator new.
+	static void operator delete(void* chunk, size_t size)
+	{
+		memory::fixed_free(chunk, size);
+	}
+
+	// Performs the work.
+	virtual void run() = 0;
+
+	virtual ~task();
+
+private:
+	friend class task_group;
+	friend class thread_pool;
+
+	task_group* group;
+};
+
+// Work-stealing thread pool. Each worker thread keeps a lock-free
+// deque of tasks: new tasks are pushed to and taken from the back
+// of the deque of the thread that spawns them, while idle threads
+// steal tasks from the front of the other deques. This keeps
+// recently spawned (and therefore cache-hot) tasks on the same
+// thread and makes the idle threads steal the largest pieces
+// of work.
+//
+// Copies of a thread_pool object share the same threads, which
+// are stopped when the last copy is destroyed. All task groups
+// must be completed by then.
+class thread_pool
+{
+B_OPAQUE:
+	// Creates a pool that runs tasks on 'concurrency' threads.
+	// The pool starts 'concurrency - 1' worker threads; the
+	// remaining thread is the one that waits for a task group,
+	// because it executes tasks while waiting. If 'concurrency'
+	// is zero, the number of online processors is used.
+	// Throws 'system_exception' if a thread cannot be started.
+	explicit thread_pool(size_t concurrency = 0);
+
+	// Returns the number of threads that execute tasks.
+	size_t concurrency() const;
+
+	// Returns the number of worker threads started by the pool,
+	// which is one less than concurrency().
+	size_t worker_count() const;
+
+	// Counters that describe the work of a worker thread.
+	struct worker_stats
+	{
+		// The number of tasks the worker has executed.
+		size_t tasks_executed;
+
+		// How many of those tasks the worker has taken
+		// from the deques of other workers.
+		size_t steals;
+
+		// The time the worker has spent looking for tasks
+		// or waiting for them to be submitted.
+		uint64_t idle_nanoseconds;
+	};
+
+	// Returns the counters of the worker with the specified
+	// index, which must be less than worker_count(). The
+	// counters are updated as the worker runs and are not
+	// synchronized with each other.
+	worker_stats stats(size_t worker_index) const;
+
+	// Sets the counters of all workers to zero.
+	void reset_stats();
+
+private:
+	friend class task_group;
+
+	// Schedules a task for execution.
+	void submit(task* t);
+
+	// Executes one scheduled task, if there is one.
+	// Returns false if no task was found.
+	bool run_scheduled_task();
+};
+
+// A set of tasks that can be waited for as a whole.
+class task_group
+{
+public:
+	// Creates an empty task group that runs tasks in 'pool'.
+	explicit task_group(thread_pool* pool);
+
+	// Schedules 't' for execution. The task object must remain
+	// valid until the group is waited for.
+	void run(task* t);
+
+	// Schedules a call to 'function()'. A copy of the function
+	// object is kept in a task allocated with memory::fixed_alloc()
+	// and destroyed after the call.
+	template <class Function>
+	void spawn(const Function& function);
+
+	// Waits until all tasks of this group are completed.
+	// The calling thread executes scheduled tasks while
+	// it waits.
+	void wait();
+
+	// Waits for the remaining tasks.
+	~task_group();
+
+private:
+	task_group(const task_group&);
+	task_group& operator =(const task_group&);
+
+	friend class thread_pool;
+
+	thread_pool* pool;
+
+	// The number of tasks that have not completed yet.
+	atomic_value<size_t> pending;
+};
+
+inline void* task::operator new(size_t size)
+{
+	return memory::fixed_alloc(size);
+}
+
+inline task::~task()
+{
+}
+
+// Task that calls a copy of a function object and deletes
+// itself. Used by task_group::spawn().
+template <class Function>
+class function_task : public task
+{
+public:
+	explicit function_task(const Function& f) : function(f)
+	{
+	}
+
+	virtual void run()
+	{
+		function();
+
+		// The pool does not access the task after run().
+		delete this;
+	}
+
+private:
+	Function function;
+};
+
+inline task_group::task_group(thread_pool* p) : pool(p)
+{
+}
+
+inline void task_group::run(task* t)
+{
+	t->group = this;
+
+	// Submitting the task publishes the new count.
+	pending.fetch_add(1, memory_order_relaxed);
+
+	pool->submit(t);
+}
+
+template <class Function>
+void task_group::spawn(const Function& function)
+{
+	run(new function_task<Function>(function));
+}
+
+inline task_group::~task_group()
+{
+	wait();
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_THREAD_POOL_H) */
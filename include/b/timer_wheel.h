@@ -0,0 +1,351 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_TIMER_WHEEL_H
+#define B_TIMER_WHEEL_H
+
+#include "doubly_linked_list.h"
+
+B_BEGIN_NAMESPACE
+
+// A structure to implant into the objects that can be
+// scheduled to expire in a timer_wheel.
+template <class T>
+class timer_wheel_node : public doubly_linked_list_node<T>
+{
+public:
+	timer_wheel_node() : slot_index((size_t) -1)
+	{
+	}
+
+	// Returns the time the object was scheduled to expire at.
+	size_t expiry() const
+	{
+		return expiry_time;
+	}
+
+	// Returns true if the object is currently scheduled
+	// in a timer wheel.
+	bool is_scheduled() const
+	{
+		return slot_index != (size_t) -1;
+	}
+
+private:
+	template <class Node_access>
+	friend class timer_wheel;
+
+	size_t expiry_time;
+
+	// Index of the timer wheel slot that contains
+	// the object or (size_t) -1.
+	size_t slot_index;
+};
+
+// Hierarchical timer wheel. Objects with implanted timer_wheel_node
+// structures are scheduled to expire at a certain time, measured in
+// abstract ticks. Scheduling and cancellation take constant time and
+// do not allocate memory.
+//
+// The wheel consists of several levels of 64 slots each. Level 'n'
+// keeps the timers that expire within the next 64^(n+1) ticks, with
+// each slot covering 64^n ticks. As time advances, the timers from
+// the upper levels are redistributed among the lower ones, and the
+// contents of the lowest level slots are returned as expired.
+template <class Node_access>
+class timer_wheel
+{
+public:
+	typedef typename Node_access::element_type element_type;
+	typedef typename Node_access::node_type node_type;
+
+	// The type of the list that receives expired elements.
+	typedef doubly_linked_list<Node_access> list_type;
+
+	// Creates an empty timer wheel with the current
+	// time set to 'start_time'.
+	explicit timer_wheel(size_t start_time = 0);
+
+	// Returns the current time of this timer wheel.
+	size_t current_time() const;
+
+	// Returns the number of scheduled elements.
+	size_t length() const;
+
+	// Returns true if no elements are scheduled.
+	bool is_empty() const;
+
+	// Schedules 'element' to expire at the time 'expiry'. An
+	// element that is already scheduled is rescheduled. If
+	// 'expiry' is not later than the current time, the element
+	// expires at the next tick.
+	void schedule(element_type* element, size_t expiry);
+
+	// Removes a scheduled element from the wheel.
+	void cancel(element_type* element);
+
+	// Retrieves the time by which the wheel must be advanced
+	// for any work to be done: either the earliest expiry time,
+	// or an earlier time at which the timers are moved between
+	// levels. Returns false if no elements are scheduled.
+	bool next_event_time(size_t* event_time) const;
+
+	// Moves the current time forward to 'new_time' and appends
+	// all elements that expire at or before 'new_time' to the
+	// 'expired' list in the order of their expiry. The appended
+	// elements are no longer scheduled and can be rescheduled
+	// right away.
+	void advance(size_t new_time, list_type* expired);
+
+private:
+	timer_wheel(const timer_wheel&);
+	timer_wheel& operator =(const timer_wheel&);
+
+	enum
+	{
+		level_bits = 6,
+		slots_per_level = 1 << level_bits,
+		slot_mask = slots_per_level - 1,
+		level_count = (sizeof(size_t) * 8 + level_bits - 1) / level_bits,
+		slot_count = level_count * slots_per_level,
+		bits_per_word = sizeof(size_t) * 8
+	};
+
+	// Adds the element to the slot that corresponds
+	// to its expiry time relative to the current time.
+	void place(element_type* element, node_type* node);
+
+	void mark_occupied(size_t index);
+	void mark_vacant(size_t index);
+
+	// Finds the first non-empty slot. Because the slots are
+	// numbered level by level, this is the earliest slot of
+	// the lowest non-empty level.
+	bool find_first_occupied(size_t* index) const;
+
+	// Returns the time at which the slot becomes due.
+	size_t slot_time(size_t index) const;
+
+	static size_t lowest_bit_index(size_t bits);
+
+	size_t now;
+	size_t element_count;
+
+	list_type slots[slot_count];
+
+	// Bitmap of non-empty slots.
+	size_t occupied[(slot_count + bits_per_word - 1) / bits_per_word];
+};
+
+template <class Node_access>
+timer_wheel<Node_access>::timer_wheel(size_t start_time) :
+	now(start_time),
+	element_count(0)
+{
+	for (size_t i = 0; i < B_COUNTOF(occupied); ++i)
+		occupied[i] = 0;
+}
+
+template <class Node_access>
+inline size_t timer_wheel<Node_access>::current_time() const
+{
+	return now;
+}
+
+template <class Node_access>
+inline size_t timer_wheel<Node_access>::length() const
+{
+	return element_count;
+}
+
+template <class Node_access>
+inline bool timer_wheel<Node_access>::is_empty() const
+{
+	return element_count == 0;
+}
+
+template <class Node_access>
+void timer_wheel<Node_access>::schedule(element_type* element,
+	size_t expiry)
+{
+	node_type* node = Node_access::node_for(element);
+
+	if (node->is_scheduled())
+		cancel(element);
+
+	node->expiry_time = expiry;
+
+	place(element, node);
+
+	++element_count;
+}
+
+template <class Node_access>
+void timer_wheel<Node_access>::cancel(element_type* element)
+{
+	node_type* node = Node_access::node_for(element);
+
+	B_ASSERT(node->is_scheduled());
+
+	list_type& slot = slots[node->slot_index];
+
+	slot.remove(element);
+
+	if (slot.is_empty())
+		mark_vacant(node->slot_index);
+
+	node->slot_index = (size_t) -1;
+
+	--element_count;
+}
+
+template <class Node_access>
+bool timer_wheel<Node_access>::next_event_time(size_t* event_time) const
+{
+	size_t index;
+
+	if (!find_first_occupied(&index))
+		return false;
+
+	*event_time = slot_time(index);
+
+	return true;
+}
+
+template <class Node_access>
+void timer_wheel<Node_access>::advance(size_t new_time, list_type* expired)
+{
+	B_ASSERT(new_time >= now);
+
+	size_t index;
+
+	while (find_first_occupied(&index))
+	{
+		size_t due_time = slot_time(index);
+
+		if (due_time > new_time)
+			break;
+
+		now = due_time;
+
+		element_type* element = slots[index].first();
+
+		slots[index].empty();
+		mark_vacant(index);
+
+		while (element != NULL)
+		{
+			element_type* next = list_type::next(element);
+
+			node_type* node = Node_access::node_for(element);
+
+			// Elements of the lowest level slots always expire;
+			// elements of the upper levels are redistributed
+			// unless they are already due.
+			if (index < slots_per_level || node->expiry_time <= now)
+			{
+				node->slot_index = (size_t) -1;
+				--element_count;
+
+				expired->append(element);
+			}
+			else
+				place(element, node);
+
+			element = next;
+		}
+	}
+
+	now = new_time;
+}
+
+template <class Node_access>
+void timer_wheel<Node_access>::place(element_type* element, node_type* node)
+{
+	size_t key = node->expiry_time > now ? node->expiry_time : now + 1;
+
+	// The level is determined by the most significant
+	// group of bits in which 'key' and 'now' differ.
+	size_t level = 0;
+	size_t difference = (key ^ now) >> level_bits;
+
+	while (difference != 0)
+	{
+		++level;
+		difference >>= level_bits;
+	}
+
+	size_t index = level * slots_per_level +
+		((key >> (level * level_bits)) & slot_mask);
+
+	node->slot_index = index;
+
+	slots[index].append(element);
+
+	mark_occupied(index);
+}
+
+template <class Node_access>
+inline void timer_wheel<Node_access>::mark_occupied(size_t index)
+{
+	occupied[index / bits_per_word] |= (size_t) 1 << (index % bits_per_word);
+}
+
+template <class Node_access>
+inline void timer_wheel<Node_access>::mark_vacant(size_t index)
+{
+	occupied[index / bits_per_word] &=
+		~((size_t) 1 << (index % bits_per_word));
+}
+
+template <class Node_access>
+bool timer_wheel<Node_access>::find_first_occupied(size_t* index) const
+{
+	for (size_t word = 0; word < B_COUNTOF(occupied); ++word)
+		if (occupied[word] != 0)
+		{
+			*index = word * bits_per_word +
+				lowest_bit_index(occupied[word]);
+
+			return true;
+		}
+
+	return false;
+}
+
+template <class Node_access>
+size_t timer_wheel<Node_access>::slot_time(size_t index) const
+{
+	size_t shift = (index / slots_per_level) * level_bits;
+
+	// All bits below and including the level's group of
+	// bits. The shift wraps around to zero for the top level.
+	size_t span_mask = ((size_t) slots_per_level << shift) - 1;
+
+	return (now & ~span_mask) | ((index & slot_mask) << shift);
+}
+
+template <class Node_access>
+inline size_t timer_wheel<Node_access>::lowest_bit_index(size_t bits)
+{
+	B_ASSERT(bits != 0);
+
+#if defined(__GNUG__)
+	return (size_t) __builtin_ctzl(bits);
+#else
+	size_t index = 0;
+
+	while ((bits & 1) == 0)
+	{
+		bits >>= 1;
+		++index;
+	}
+
+	return index;
+#endif /* defined(__GNUG__) */
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_TIMER_WHEEL_H) */
@@ -0,0 +1,235 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#ifndef B_WORK_STEALING_DEQUE_H
+#define B_WORK_STEALING_DEQUE_H
+
+#include "atomic.h"
+#include "memory.h"
+
+B_BEGIN_NAMESPACE
+
+// Unbounded lock-free deque with a single owner thread (the
+// Chase-Lev deque). The owner pushes and pops elements at the
+// back like a stack, while any other thread can steal elements
+// from the front. The owner and the thieves only contend for
+// the last remaining element.
+//
+// When the ring buffer fills up, the owner replaces it with one
+// twice as large. Thieves may still be reading the old buffer,
+// so the replaced buffers are freed by the destructor.
+//
+// T must be an integral or pointer type.
+template <class T>
+class work_stealing_deque
+{
+public:
+	typedef T value_type;
+
+	// Creates an empty deque with room for at least 'min_capacity'
+	// elements before it has to grow. The capacity is rounded up
+	// to a power of two.
+	explicit work_stealing_deque(size_t min_capacity = 64);
+
+	// Returns true if the deque appears to be empty. The result
+	// may be outdated by the time the method returns.
+	bool is_empty() const;
+
+	// Appends 'value' to the back of the deque.
+	// Only the owner thread may call this method.
+	void push_back(T value);
+
+	// Removes the element at the back of the deque and assigns
+	// it to '*value'. Returns false if the deque is empty.
+	// Only the owner thread may call this method.
+	bool pop_back(T* value);
+
+	// Removes the element at the front of the deque and assigns
+	// it to '*value'. Returns false if the deque is empty or
+	// another thread has taken the element first. Any thread
+	// may call this method.
+	bool steal(T* value);
+
+	// Frees the current and the replaced buffers.
+	// No other thread may access the deque at this point.
+	~work_stealing_deque();
+
+private:
+	work_stealing_deque(const work_stealing_deque&);
+	work_stealing_deque& operator =(const work_stealing_deque&);
+
+	// Ring buffer with a power-of-two number of cells. The
+	// positions grow monotonically and are reduced modulo the
+	// number of cells on access.
+	struct ring
+	{
+		size_t mask;
+		ring* replaced;
+		atomic_value<T> cells[1];
+	};
+
+	static ring* alloc_ring(size_t size, ring* replaced);
+
+	// Copies the elements between 'front' and 'back' to
+	// a buffer twice as large and makes it current.
+	ring* grow(ring* r, size_t front, size_t back);
+
+	char padding_before[B_CACHE_LINE_SIZE];
+
+	// The position of the front element. Advanced by the
+	// thieves and by the owner when it takes the last element.
+	atomic_value<size_t> front_position;
+
+	char padding_after_front[B_CACHE_LINE_SIZE];
+
+	// The position after the back element. Only the
+	// owner changes it.
+	atomic_value<size_t> back_position;
+
+	atomic_value<ring*> current_ring;
+
+	char padding_after_back[B_CACHE_LINE_SIZE];
+};
+
+template <class T>
+typename work_stealing_deque<T>::ring*
+	work_stealing_deque<T>::alloc_ring(size_t size, ring* replaced)
+{
+	ring* r = (ring*) memory::alloc(sizeof(ring) +
+		(size - 1) * sizeof(atomic_value<T>));
+
+	r->mask = size - 1;
+	r->replaced = replaced;
+
+	for (size_t i = 0; i < size; ++i)
+		new (r->cells + i) atomic_value<T>;
+
+	return r;
+}
+
+template <class T>
+work_stealing_deque<T>::work_stealing_deque(size_t min_capacity)
+{
+	size_t size = 1;
+
+	while (size < min_capacity)
+		size <<= 1;
+
+	current_ring.store(alloc_ring(size, NULL), memory_order_relaxed);
+}
+
+template <class T>
+inline bool work_stealing_deque<T>::is_empty() const
+{
+	return (ptrdiff_t) (back_position.load(memory_order_relaxed) -
+		front_position.load(memory_order_relaxed)) <= 0;
+}
+
+template <class T>
+typename work_stealing_deque<T>::ring* work_stealing_deque<T>::grow(
+	ring* r, size_t front, size_t back)
+{
+	ring* new_ring = alloc_ring((r->mask + 1) * 2, r);
+
+	for (size_t i = front; i != back; ++i)
+		new_ring->cells[i & new_ring->mask].store(
+			r->cells[i & r->mask].load(memory_order_relaxed),
+			memory_order_relaxed);
+
+	// Thieves that load the new buffer must see its contents.
+	current_ring.store(new_ring, memory_order_release);
+
+	return new_ring;
+}
+
+template <class T>
+void work_stealing_deque<T>::push_back(T value)
+{
+	size_t back = back_position.load(memory_order_relaxed);
+	size_t front = front_position.load(memory_order_acquire);
+	ring* r = current_ring.load(memory_order_relaxed);
+
+	if (back - front > r->mask)
+		r = grow(r, front, back);
+
+	r->cells[back & r->mask].store(value, memory_order_relaxed);
+
+	back_position.store(back + 1, memory_order_release);
+}
+
+template <class T>
+bool work_stealing_deque<T>::pop_back(T* value)
+{
+	size_t back = back_position.load(memory_order_relaxed) - 1;
+	ring* r = current_ring.load(memory_order_relaxed);
+
+	// Reserve the back element before looking at the front,
+	// so that a thief either sees the reservation or the owner
+	// sees the thief's claim. Both accesses must be sequentially
+	// consistent for that.
+	back_position.store(back, memory_order_seq_cst);
+
+	size_t front = front_position.load(memory_order_seq_cst);
+
+	if ((ptrdiff_t) (back - front) < 0)
+	{
+		back_position.store(back + 1, memory_order_relaxed);
+
+		return false;
+	}
+
+	*value = r->cells[back & r->mask].load(memory_order_relaxed);
+
+	if (back != front)
+		return true;
+
+	// This is the last element; race the thieves for it.
+	bool taken = front_position.compare_exchange(&front, front + 1,
+		memory_order_seq_cst);
+
+	back_position.store(back + 1, memory_order_relaxed);
+
+	return taken;
+}
+
+template <class T>
+bool work_stealing_deque<T>::steal(T* value)
+{
+	size_t front = front_position.load(memory_order_seq_cst);
+	size_t back = back_position.load(memory_order_seq_cst);
+
+	if ((ptrdiff_t) (back - front) <= 0)
+		return false;
+
+	ring* r = current_ring.load(memory_order_acquire);
+
+	T element = r->cells[front & r->mask].load(memory_order_relaxed);
+
+	if (!front_position.compare_exchange(&front, front + 1,
+			memory_order_seq_cst))
+		return false;
+
+	*value = element;
+
+	return true;
+}
+
+template <class T>
+work_stealing_deque<T>::~work_stealing_deque()
+{
+	ring* r = current_ring.load(memory_order_relaxed);
+
+	while (r != NULL)
+	{
+		ring* replaced = r->replaced;
+
+		memory::free(r);
+
+		r = replaced;
+	}
+}
+
+B_END_NAMESPACE
+
+#endif /* !defined(B_WORK_STEALING_DEQUE_H) */
@@ -0,0 +1,187 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/arena.h>
+
+#include <pthread.h>
+
+namespace
+{
+	pthread_key_t scratch_arena_key;
+	pthread_once_t scratch_arena_key_once = PTHREAD_ONCE_INIT;
+
+	void delete_scratch_arena(void* scratch_arena)
+	{
+		delete static_cast<b::arena*>(scratch_arena);
+	}
+
+	void create_scratch_arena_key()
+	{
+		pthread_key_create(&scratch_arena_key, delete_scratch_arena);
+	}
+}
+
+B_BEGIN_NAMESPACE
+
+void arena::rewind(const marker& position)
+{
+	free_large_blocks_until(
+		static_cast<block_header*>(position.large_block));
+
+	block_header* block = static_cast<block_header*>(position.block);
+
+	if (block != NULL)
+	{
+		free_blocks_until(block);
+
+		pos = position.pos;
+	}
+	else
+	{
+		// Rewinding to a marker obtained before the first
+		// block was allocated retains that block for reuse.
+		if (current_block == NULL)
+			return;
+
+		block = current_block;
+
+		while (block->prev != NULL)
+			block = block->prev;
+
+		free_blocks_until(block);
+
+		pos = block_start(block);
+	}
+
+	end = (char*) block + block->size;
+}
+
+void arena::reset()
+{
+	marker initial = {NULL, NULL, NULL};
+
+	rewind(initial);
+}
+
+size_t arena::used_bytes() const
+{
+	if (current_block == NULL)
+		return large_bytes_used;
+
+	return large_bytes_used + current_block->used_before +
+		(size_t) (pos - block_start(current_block));
+}
+
+arena::~arena()
+{
+	free_large_blocks_until(NULL);
+	free_blocks_until(NULL);
+}
+
+arena* arena::scratch()
+{
+	pthread_once(&scratch_arena_key_once, create_scratch_arena_key);
+
+	arena* scratch_arena = static_cast<arena*>(
+		pthread_getspecific(scratch_arena_key));
+
+	if (scratch_arena == NULL)
+	{
+		scratch_arena = new arena;
+
+		pthread_setspecific(scratch_arena_key, scratch_arena);
+	}
+
+	return scratch_arena;
+}
+
+char* arena::block_start(block_header* block) const
+{
+	return (char*) block + memory::align(sizeof(block_header),
+		B_ARENA_ALIGNMENT);
+}
+
+void* arena::allocate_from_new_block(size_t size, size_t alignment)
+{
+	if (size > default_block_size / 2)
+		return allocate_large(size, alignment);
+
+	size_t header_size = memory::align(sizeof(block_header),
+		B_ARENA_ALIGNMENT);
+
+	// Reserve room for aligning the first allocation
+	// if the requested alignment is stricter than the
+	// alignment of the block start.
+	size_t required_size = header_size + size +
+		(alignment > B_ARENA_ALIGNMENT ? alignment : 0);
+
+	size_t block_size = required_size > default_block_size ?
+		required_size : default_block_size;
+
+	block_header* block = (block_header*) memory::alloc(block_size);
+
+	block->prev = current_block;
+	block->size = block_size;
+	block->used_before = used_bytes() - large_bytes_used;
+
+	current_block = block;
+	allocated_bytes += block_size;
+
+	char* result = (char*) memory::align(block_start(block), alignment);
+
+	pos = result + size;
+	end = (char*) block + block_size;
+
+	return result;
+}
+
+void* arena::allocate_large(size_t size, size_t alignment)
+{
+	size_t header_size = memory::align(sizeof(block_header),
+		B_ARENA_ALIGNMENT);
+
+	size_t block_size = header_size + size +
+		(alignment > B_ARENA_ALIGNMENT ? alignment : 0);
+
+	block_header* block = (block_header*) memory::alloc(block_size);
+
+	block->prev = large_blocks;
+	block->size = block_size;
+	block->used_before = large_bytes_used;
+
+	large_blocks = block;
+	large_bytes_used += block_size - header_size;
+	allocated_bytes += block_size;
+
+	return memory::align(block_start(block), alignment);
+}
+
+void arena::free_large_blocks_until(block_header* last_kept)
+{
+	while (large_blocks != last_kept)
+	{
+		block_header* prev = large_blocks->prev;
+
+		large_bytes_used = large_blocks->used_before;
+		allocated_bytes -= large_blocks->size;
+		memory::free(large_blocks);
+
+		large_blocks = prev;
+	}
+}
+
+void arena::free_blocks_until(block_header* last_kept)
+{
+	while (current_block != last_kept)
+	{
+		block_header* prev = current_block->prev;
+
+		allocated_bytes -= current_block->size;
+		memory::free(current_block);
+
+		current_block = prev;
+	}
+}
+
+B_END_NAMESPACE
@@ -97,6 +97,42 @@ void binary_search_tree_base::insert_after_search(binary_tree_node* node,
 	++number_of_nodes;
 }
 
+// Links the middle node of the sorted range as the root of the
+// subtree and the halves of the range as its branches.
+static binary_tree_node* link_balanced_subtree(binary_tree_node** nodes,
+	size_t count, binary_tree_node* parent)
+{
+	if (count == 0)
+		return NULL;
+
+	size_t middle = count / 2;
+
+	binary_tree_node* node = nodes[middle];
+
+	node->parent = parent;
+	node->left = link_balanced_subtree(nodes, middle, node);
+	node->right = link_balanced_subtree(nodes + middle + 1,
+		count - middle - 1, node);
+
+	return node;
+}
+
+void binary_search_tree_base::build_from_sorted(binary_tree_node** nodes,
+	size_t count)
+{
+	root = link_balanced_subtree(nodes, count, NULL);
+
+	if (count == 0)
+		leftmost = rightmost = NULL;
+	else
+	{
+		leftmost = nodes[0];
+		rightmost = nodes[count - 1];
+	}
+
+	number_of_nodes = count;
+}
+
 static void update_parent(binary_tree_node** root, binary_tree_node* parent,
 	binary_tree_node* old_child, binary_tree_node* new_child)
 {
@@ -216,4 +252,32 @@ void binary_search_tree_base::remove(binary_tree_node* node)
 	update_parent(&root, node->parent, node, next_node);
 }
 
+binary_tree_node* binary_search_tree_base::select(size_t index) const
+{
+	if (index >= number_of_nodes)
+		return NULL;
+
+	binary_tree_node* node;
+
+	if (index < number_of_nodes / 2)
+		for (node = leftmost; index > 0; --index)
+			node = node->next();
+	else
+		for (node = rightmost, index = number_of_nodes - index - 1;
+				index > 0; --index)
+			node = node->prev();
+
+	return node;
+}
+
+size_t binary_search_tree_base::rank(const binary_tree_node* node) const
+{
+	size_t result = 0;
+
+	while ((node = node->prev()) != NULL)
+		++result;
+
+	return result;
+}
+
 B_END_NAMESPACE
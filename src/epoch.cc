@@ -0,0 +1,308 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/epoch.h>
+
+#include <b/system_exception.h>
+
+B_BEGIN_NAMESPACE
+
+struct epoch_domain::retired_block
+{
+	retired_block* next;
+	void* block;
+	deleter delete_block;
+
+	// The global epoch at the time of the retirement.
+	size_t epoch;
+};
+
+struct epoch_domain::thread_record
+{
+	thread_record() : nesting(0), retired_head(NULL), retired_tail(NULL),
+		retired_count(0), next_collection(B_EPOCH_COLLECT_THRESHOLD),
+		next(NULL)
+	{
+	}
+
+	// The epoch observed by the thread shifted left by one
+	// bit, with the lowest bit set while the thread is inside
+	// a critical section. Only the owner thread writes it.
+	atomic_value<size_t> state;
+
+	// The depth of nested critical sections.
+	size_t nesting;
+
+	// The retired blocks in the order of retirement, so
+	// that the oldest ones are at the head of the list.
+	retired_block* retired_head;
+	retired_block* retired_tail;
+	size_t retired_count;
+
+	// The value of 'retired_count' at which retire()
+	// tries to free the blocks.
+	size_t next_collection;
+
+	// Nonzero while a thread owns this record.
+	atomic_value<int> in_use;
+
+	thread_record* next;
+
+	char padding[B_CACHE_LINE_SIZE];
+};
+
+epoch_domain::epoch_domain()
+{
+	int error = pthread_key_create(&record_key, release_record);
+
+	if (error != 0)
+	{
+		B_STRING_LITERAL(method_name, "b::epoch_domain::epoch_domain()");
+
+		throw system_exception(method_name, error);
+	}
+}
+
+epoch_domain& epoch_domain::global()
+{
+	// The domain is never destroyed: static references to
+	// 'epoch_reclaimed' objects may be released after it
+	// would otherwise have been destroyed at exit.
+	static epoch_domain* domain = new epoch_domain;
+
+	return *domain;
+}
+
+inline epoch_domain::thread_record* epoch_domain::find_record() const
+{
+	return (thread_record*) pthread_getspecific(record_key);
+}
+
+epoch_domain::thread_record* epoch_domain::current_record()
+{
+	thread_record* record = find_record();
+
+	if (record != NULL)
+		return record;
+
+	// Take over a record released by an exited thread
+	// together with the blocks that it has retired.
+	for (record = records.load(memory_order_acquire);
+			record != NULL; record = record->next)
+	{
+		int unused = 0;
+
+		if (record->in_use.load(memory_order_relaxed) == 0 &&
+				record->in_use.compare_exchange(&unused, 1,
+					memory_order_acquire))
+			break;
+	}
+
+	if (record == NULL)
+	{
+		record = new thread_record;
+
+		record->in_use.store(1, memory_order_relaxed);
+
+		thread_record* head = records.load(memory_order_relaxed);
+
+		do
+			record->next = head;
+		while (!records.compare_exchange(&head, record,
+			memory_order_release));
+	}
+
+	int error = pthread_setspecific(record_key, record);
+
+	if (error != 0)
+	{
+		record->in_use.store(0, memory_order_release);
+
+		B_STRING_LITERAL(method_name,
+			"b::epoch_domain::current_record()");
+
+		throw system_exception(method_name, error);
+	}
+
+	return record;
+}
+
+void epoch_domain::release_record(void* record)
+{
+	thread_record* r = (thread_record*) record;
+
+	r->nesting = 0;
+	r->state.store(r->state.load(memory_order_relaxed) & ~(size_t) 1,
+		memory_order_release);
+
+	r->in_use.store(0, memory_order_release);
+}
+
+void epoch_domain::enter()
+{
+	thread_record* record = current_record();
+
+	if (record->nesting++ > 0)
+		return;
+
+	size_t epoch = global_epoch.load(memory_order_seq_cst);
+
+	// The exchange is a full barrier: the announcement becomes
+	// visible to try_advance() before the thread reads any
+	// pointers inside the critical section.
+	record->state.exchange((epoch << 1) | 1, memory_order_seq_cst);
+}
+
+void epoch_domain::exit()
+{
+	thread_record* record = find_record();
+
+	B_ASSERT(record != NULL && record->nesting > 0);
+
+	if (--record->nesting > 0)
+		return;
+
+	// Release ordering keeps the reads made inside the critical
+	// section from being delayed past the point where another
+	// thread may free the memory they access.
+	record->state.store(record->state.load(memory_order_relaxed) &
+		~(size_t) 1, memory_order_release);
+}
+
+bool epoch_domain::in_critical_section() const
+{
+	thread_record* record = find_record();
+
+	return record != NULL && record->nesting > 0;
+}
+
+size_t epoch_domain::try_advance()
+{
+	size_t epoch = global_epoch.load(memory_order_seq_cst);
+
+	for (thread_record* record = records.load(memory_order_acquire);
+			record != NULL; record = record->next)
+	{
+		size_t state = record->state.load(memory_order_seq_cst);
+
+		if ((state & 1) != 0 && (state >> 1) != epoch)
+			return epoch;
+	}
+
+	// On failure, 'epoch' receives the value set by the
+	// thread that has advanced the epoch first.
+	if (global_epoch.compare_exchange(&epoch, epoch + 1,
+			memory_order_seq_cst))
+		++epoch;
+
+	return epoch;
+}
+
+void epoch_domain::free_retired(thread_record* record, size_t global_epoch)
+{
+	retired_block* head = record->retired_head;
+	retired_block* first_kept = head;
+
+	while (first_kept != NULL && first_kept->epoch + 2 <= global_epoch)
+	{
+		first_kept = first_kept->next;
+		--record->retired_count;
+	}
+
+	if (first_kept == head)
+		return;
+
+	// Detach the blocks before freeing them, because the
+	// deleters may retire more blocks.
+	record->retired_head = first_kept;
+
+	if (first_kept == NULL)
+		record->retired_tail = NULL;
+
+	while (head != first_kept)
+	{
+		retired_block* next = head->next;
+
+		head->delete_block(head->block);
+
+		memory::fixed_free(head, sizeof(retired_block));
+
+		head = next;
+	}
+}
+
+void epoch_domain::retire(void* block, deleter delete_block)
+{
+	thread_record* record = current_record();
+
+	retired_block* retired = (retired_block*)
+		memory::fixed_alloc(sizeof(retired_block));
+
+	retired->next = NULL;
+	retired->block = block;
+	retired->delete_block = delete_block;
+	retired->epoch = global_epoch.load(memory_order_seq_cst);
+
+	if (record->retired_tail == NULL)
+		record->retired_head = retired;
+	else
+		record->retired_tail->next = retired;
+
+	record->retired_tail = retired;
+
+	if (++record->retired_count >= record->next_collection)
+	{
+		free_retired(record, try_advance());
+
+		// If the blocks cannot be freed yet because some
+		// thread stays in its critical section, do not rescan
+		// the records on every subsequent retirement.
+		record->next_collection = record->retired_count +
+			B_EPOCH_COLLECT_THRESHOLD;
+	}
+}
+
+size_t epoch_domain::collect()
+{
+	thread_record* record = current_record();
+
+	free_retired(record, try_advance());
+
+	return record->retired_count;
+}
+
+epoch_domain::~epoch_domain()
+{
+	thread_record* record = records.load(memory_order_acquire);
+
+	// A deleter may retire more blocks, so repeat
+	// until every list stays empty.
+	bool freed;
+
+	do
+	{
+		freed = false;
+
+		for (thread_record* r = record; r != NULL; r = r->next)
+			if (r->retired_head != NULL)
+			{
+				free_retired(r, (size_t) -1);
+				freed = true;
+			}
+	}
+	while (freed);
+
+	pthread_key_delete(record_key);
+
+	while (record != NULL)
+	{
+		thread_record* next = record->next;
+
+		delete record;
+
+		record = next;
+	}
+}
+
+B_END_NAMESPACE
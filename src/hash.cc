@@ -0,0 +1,156 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/fn.h>
+
+#include <stdint.h>
+
+// The hash function below follows the design of wyhash by Wang Yi:
+// input is consumed in 16- and 48-byte chunks, each mixed by a full
+// 64x64->128-bit multiplication folded back into 64 bits.
+
+#define B_UINT64(high, low) (((uint64_t) (high) << 32) | (uint64_t) (low))
+
+namespace
+{
+	const uint64_t secret[] =
+	{
+		B_UINT64(0x2d358dccU, 0xaa6c78a5U),
+		B_UINT64(0x8bb84b93U, 0x962eacc9U),
+		B_UINT64(0x4b33a62eU, 0xd433d4a3U),
+		B_UINT64(0x4d5a2da5U, 0x1de1aa47U)
+	};
+
+	// Replaces 'a' and 'b' with the low and the high halves
+	// of their 128-bit product.
+	inline void multiply(uint64_t* a, uint64_t* b)
+	{
+#if defined(__SIZEOF_INT128__)
+		__extension__ typedef unsigned __int128 uint128;
+
+		uint128 product = (uint128) *a * *b;
+
+		*a = (uint64_t) product;
+		*b = (uint64_t) (product >> 64);
+#else
+		uint64_t a_high = *a >> 32, a_low = (uint32_t) *a;
+		uint64_t b_high = *b >> 32, b_low = (uint32_t) *b;
+
+		uint64_t high = a_high * b_high;
+		uint64_t mid1 = a_high * b_low;
+		uint64_t mid2 = a_low * b_high;
+		uint64_t low = a_low * b_low;
+
+		uint64_t carry = ((low >> 32) + (uint32_t) mid1 +
+			(uint32_t) mid2) >> 32;
+
+		*a = low + (mid1 << 32) + (mid2 << 32);
+		*b = high + (mid1 >> 32) + (mid2 >> 32) + carry;
+#endif
+	}
+
+	inline uint64_t mix(uint64_t a, uint64_t b)
+	{
+		multiply(&a, &b);
+
+		return a ^ b;
+	}
+
+	inline uint64_t read64(const unsigned char* p)
+	{
+		uint64_t value;
+
+		b::memory::copy(&value, p, sizeof(value));
+
+		return value;
+	}
+
+	inline uint64_t read32(const unsigned char* p)
+	{
+		uint32_t value;
+
+		b::memory::copy(&value, p, sizeof(value));
+
+		return value;
+	}
+
+	// Reads one to three bytes.
+	inline uint64_t read_small(const unsigned char* p, size_t length)
+	{
+		return ((uint64_t) p[0] << 16) |
+			((uint64_t) p[length >> 1] << 8) | p[length - 1];
+	}
+}
+
+B_BEGIN_NAMESPACE
+
+size_t hash_bytes(const void* data, size_t length)
+{
+	const unsigned char* p = (const unsigned char*) data;
+
+	uint64_t seed = mix(secret[0], secret[1]);
+	uint64_t a, b;
+
+	if (length <= 16)
+	{
+		if (length >= 4)
+		{
+			size_t offset = (length >> 3) << 2;
+
+			a = (read32(p) << 32) | read32(p + offset);
+			b = (read32(p + length - 4) << 32) |
+				read32(p + length - 4 - offset);
+		}
+		else if (length > 0)
+		{
+			a = read_small(p, length);
+			b = 0;
+		}
+		else
+			a = b = 0;
+	}
+	else
+	{
+		size_t remaining = length;
+
+		if (remaining > 48)
+		{
+			uint64_t seed1 = seed, seed2 = seed;
+
+			do
+			{
+				seed = mix(read64(p) ^ secret[1],
+					read64(p + 8) ^ seed);
+				seed1 = mix(read64(p + 16) ^ secret[2],
+					read64(p + 24) ^ seed1);
+				seed2 = mix(read64(p + 32) ^ secret[3],
+					read64(p + 40) ^ seed2);
+				p += 48;
+				remaining -= 48;
+			}
+			while (remaining > 48);
+
+			seed ^= seed1 ^ seed2;
+		}
+
+		while (remaining > 16)
+		{
+			seed = mix(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+			p += 16;
+			remaining -= 16;
+		}
+
+		a = read64(p + remaining - 16);
+		b = read64(p + remaining - 8);
+	}
+
+	a ^= secret[1];
+	b ^= seed;
+
+	multiply(&a, &b);
+
+	return (size_t) mix(a ^ secret[0] ^ length, b ^ secret[1]);
+}
+
+B_END_NAMESPACE
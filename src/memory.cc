@@ -4,6 +4,261 @@
 
 #include <b/memory.h>
 
+#include <b/atomic.h>
+#include <b/io_streams.h>
+
+#include <pthread.h>
+#include <stdarg.h>
+
+#if defined(B_ALLOC_TRACKING)
+
+namespace
+{
+	// Precedes each block allocated by memory::alloc().
+	// Its size keeps the blocks aligned as malloc() does.
+	struct block_header
+	{
+		size_t size;
+
+		// The index of the call site plus one, or zero
+		// if the allocation has not been sampled.
+		size_t site;
+	};
+
+	struct tracked_counters
+	{
+		// Counts a new block. Returns the number
+		// of blocks allocated before it.
+		size_t count_alloc(size_t size);
+
+		void count_free(size_t size);
+
+		b::allocation_counters get() const;
+
+		b::atomic_value<size_t> allocations;
+		b::atomic_value<size_t> live_blocks;
+		b::atomic_value<size_t> live_bytes;
+		b::atomic_value<size_t> peak_bytes;
+	};
+
+	size_t tracked_counters::count_alloc(size_t size)
+	{
+		size_t previous = allocations.fetch_add(1,
+			b::memory_order_relaxed);
+
+		live_blocks.fetch_add(1, b::memory_order_relaxed);
+
+		size_t bytes = live_bytes.fetch_add(size,
+			b::memory_order_relaxed) + size;
+		size_t peak = peak_bytes.load(b::memory_order_relaxed);
+
+		while (peak < bytes && !peak_bytes.compare_exchange(&peak,
+				bytes, b::memory_order_relaxed))
+			;
+
+		return previous;
+	}
+
+	void tracked_counters::count_free(size_t size)
+	{
+		live_blocks.fetch_sub(1, b::memory_order_relaxed);
+		live_bytes.fetch_sub(size, b::memory_order_relaxed);
+	}
+
+	b::allocation_counters tracked_counters::get() const
+	{
+		b::allocation_counters counters;
+
+		counters.allocations = allocations.load(b::memory_order_relaxed);
+		counters.live_blocks = live_blocks.load(b::memory_order_relaxed);
+		counters.live_bytes = live_bytes.load(b::memory_order_relaxed);
+		counters.peak_bytes = peak_bytes.load(b::memory_order_relaxed);
+
+		return counters;
+	}
+
+	// Counters of the sampled allocations of one call site.
+	struct site_counters
+	{
+		b::atomic_value<const void*> caller;
+		b::atomic_value<size_t> allocations;
+		b::atomic_value<size_t> live_bytes;
+	};
+
+	// The counters are created on first use and never destroyed,
+	// because static constructors and destructors of other
+	// translation units allocate and free blocks before or
+	// after the dynamic initialization of this one.
+	struct tracking_state
+	{
+		tracked_counters totals;
+		tracked_counters size_classes[B_ALLOC_SIZE_CLASSES];
+
+		// Open-addressing table of call sites. The extra entry at
+		// the end counts the sites that do not fit in the table.
+		site_counters sites[B_ALLOC_MAX_SITES + 1];
+	};
+
+	pthread_once_t tracking_once = PTHREAD_ONCE_INIT;
+	tracking_state* tracking;
+
+	void create_tracking_state()
+	{
+		tracking = new tracking_state;
+	}
+
+	inline tracking_state& tracked()
+	{
+		pthread_once(&tracking_once, create_tracking_state);
+
+		return *tracking;
+	}
+
+	size_t size_class_of_block(size_t size)
+	{
+		size_t size_class = 0;
+
+		while (size_class < B_ALLOC_SIZE_CLASSES - 1 &&
+				((size_t) 1 << size_class) < size)
+			++size_class;
+
+		return size_class;
+	}
+
+	// Returns the index of the table entry of 'caller',
+	// inserting the caller if it is not in the table yet.
+	size_t find_site(const void* caller)
+	{
+		size_t index = ((size_t) caller >> 2) % B_ALLOC_MAX_SITES;
+
+		for (size_t probes = 0; probes < B_ALLOC_MAX_SITES; ++probes)
+		{
+			site_counters& site = tracked().sites[index];
+
+			const void* recorded = site.caller.load(
+				b::memory_order_acquire);
+
+			if (recorded == caller)
+				return index;
+
+			if (recorded == NULL && (site.caller.compare_exchange(
+					&recorded, caller, b::memory_order_acq_rel) ||
+					recorded == caller))
+				return index;
+
+			if (++index == B_ALLOC_MAX_SITES)
+				index = 0;
+		}
+
+		return B_ALLOC_MAX_SITES;
+	}
+}
+
+B_BEGIN_NAMESPACE
+
+void* memory::alloc(size_t size)
+{
+	B_STRING_LITERAL(method_name, "b::memory::alloc()");
+
+	block_header* header;
+
+	if (size > (size_t) -1 - sizeof(block_header) || (header =
+			(block_header*) malloc(sizeof(block_header) + size)) == NULL)
+		throw system_exception(method_name, ENOMEM);
+
+	header->size = size;
+	header->site = 0;
+
+	tracking_state& t = tracked();
+
+	t.size_classes[size_class_of_block(size)].count_alloc(size);
+
+	if (t.totals.count_alloc(size) % B_ALLOC_SAMPLE_INTERVAL == 0)
+	{
+#if defined(__GNUG__)
+		const void* caller = __builtin_return_address(0);
+#else
+		const void* caller = NULL;
+#endif /* defined(__GNUG__) */
+
+		size_t index = find_site(caller);
+
+		t.sites[index].allocations.fetch_add(1, memory_order_relaxed);
+		t.sites[index].live_bytes.fetch_add(size, memory_order_relaxed);
+
+		header->site = index + 1;
+	}
+
+	return header + 1;
+}
+
+void memory::free(void* block)
+{
+	if (block == NULL)
+		return;
+
+	block_header* header = (block_header*) block - 1;
+
+	size_t size = header->size;
+
+	tracking_state& t = tracked();
+
+	t.size_classes[size_class_of_block(size)].count_free(size);
+	t.totals.count_free(size);
+
+	if (header->site != 0)
+		t.sites[header->site - 1].live_bytes.fetch_sub(size,
+			memory_order_relaxed);
+
+	::free(header);
+}
+
+allocation_counters memory::allocation_totals()
+{
+	return tracked().totals.get();
+}
+
+allocation_counters memory::allocations_by_size(size_t size_class)
+{
+	B_ASSERT(size_class < B_ALLOC_SIZE_CLASSES);
+
+	return tracked().size_classes[size_class].get();
+}
+
+size_t memory::allocation_sites(allocation_site* site_array,
+	size_t max_count)
+{
+	const site_counters* sites = tracked().sites;
+
+	size_t count = 0;
+
+	for (size_t i = 0; i <= B_ALLOC_MAX_SITES; ++i)
+	{
+		const site_counters& site = sites[i];
+
+		size_t allocations = site.allocations.load(memory_order_relaxed);
+
+		if (allocations == 0)
+			continue;
+
+		if (count < max_count)
+		{
+			allocation_site& s = site_array[count];
+
+			s.caller = site.caller.load(memory_order_relaxed);
+			s.allocations = allocations * B_ALLOC_SAMPLE_INTERVAL;
+			s.live_bytes = site.live_bytes.load(
+				memory_order_relaxed) * B_ALLOC_SAMPLE_INTERVAL;
+		}
+
+		++count;
+	}
+
+	return count;
+}
+
+#else
+
 B_BEGIN_NAMESPACE
 
 void* memory::alloc(size_t size)
@@ -18,14 +273,625 @@ void* memory::alloc(size_t size)
 	return block;
 }
 
+allocation_counters memory::allocation_totals()
+{
+	allocation_counters counters = {0, 0, 0, 0};
+
+	return counters;
+}
+
+allocation_counters memory::allocations_by_size(size_t)
+{
+	return allocation_totals();
+}
+
+size_t memory::allocation_sites(allocation_site*, size_t)
+{
+	return 0;
+}
+
+#endif /* defined(B_ALLOC_TRACKING) */
+
+B_END_NAMESPACE
+
+namespace
+{
+	void write_formatted(b::output_stream* stream,
+		const char* fmt, ...) B_PRINTF_STYLE(2, 3);
+
+	void write_formatted(b::output_stream* stream, const char* fmt, ...)
+	{
+		char line[256];
+
+		va_list ap;
+
+		va_start(ap, fmt);
+		int length = vsnprintf(line, sizeof(line), fmt, ap);
+		va_end(ap);
+
+		if (length > 0)
+			stream->write(line, (size_t) length < sizeof(line) ?
+				(size_t) length : sizeof(line) - 1);
+	}
+
+#if defined(B_ALLOC_TRACKING)
+	void write_counters(b::output_stream* stream, const char* label,
+		const b::allocation_counters& counters)
+	{
+		write_formatted(stream, "%-14s %15lu %15lu %15lu %15lu\n", label,
+			(unsigned long) counters.allocations,
+			(unsigned long) counters.live_blocks,
+			(unsigned long) counters.live_bytes,
+			(unsigned long) counters.peak_bytes);
+	}
+
+	// The number of call sites that dump_allocations() lists.
+	enum {dumped_site_count = 10};
+#endif /* defined(B_ALLOC_TRACKING) */
+}
+
+B_BEGIN_NAMESPACE
+
+void memory::dump_allocations(output_stream* stream)
+{
+#if defined(B_ALLOC_TRACKING)
+	write_formatted(stream, "%-14s %15s %15s %15s %15s\n", "Size",
+		"Allocations", "Live blocks", "Live bytes", "Peak bytes");
+
+	for (size_t i = 0; i < B_ALLOC_SIZE_CLASSES; ++i)
+	{
+		allocation_counters counters = allocations_by_size(i);
+
+		if (counters.allocations == 0)
+			continue;
+
+		char label[32];
+
+		snprintf(label, sizeof(label),
+			i < B_ALLOC_SIZE_CLASSES - 1 ? "<= %lu" : "> %lu",
+			(unsigned long) ((size_t) 1 << (i < B_ALLOC_SIZE_CLASSES - 1 ?
+				i : i - 1)));
+
+		write_counters(stream, label, counters);
+	}
+
+	write_counters(stream, "Total", allocation_totals());
+
+	// Select the call sites with the most live bytes.
+	const site_counters* sites = tracked().sites;
+
+	allocation_site top[dumped_site_count];
+	size_t top_count = 0;
+
+	for (size_t i = 0; i <= B_ALLOC_MAX_SITES; ++i)
+	{
+		allocation_site site;
+
+		if (sites[i].allocations.load(memory_order_relaxed) == 0)
+			continue;
+
+		site.caller = sites[i].caller.load(memory_order_relaxed);
+		site.allocations = sites[i].allocations.load(
+			memory_order_relaxed) * B_ALLOC_SAMPLE_INTERVAL;
+		site.live_bytes = sites[i].live_bytes.load(
+			memory_order_relaxed) * B_ALLOC_SAMPLE_INTERVAL;
+
+		size_t position = top_count;
+
+		while (position > 0 &&
+				top[position - 1].live_bytes < site.live_bytes)
+			--position;
+
+		if (position == dumped_site_count)
+			continue;
+
+		if (top_count < dumped_site_count)
+			++top_count;
+
+		for (size_t j = top_count - 1; j > position; --j)
+			top[j] = top[j - 1];
+
+		top[position] = site;
+	}
+
+	write_formatted(stream, "\nCall sites with the most live bytes "
+		"(one in %d allocations sampled):\n%-18s %15s %15s\n",
+		B_ALLOC_SAMPLE_INTERVAL, "Caller", "Allocations", "Live bytes");
+
+	for (size_t i = 0; i < top_count; ++i)
+		write_formatted(stream, "%-18p %15lu %15lu\n", top[i].caller,
+			(unsigned long) top[i].allocations,
+			(unsigned long) top[i].live_bytes);
+#else
+	write_formatted(stream, "Allocation tracking is disabled; configure "
+		"with -DB_ALLOC_TRACKING=ON to enable it.\n");
+#endif /* defined(B_ALLOC_TRACKING) */
+}
+
+B_END_NAMESPACE
+
+namespace
+{
+	enum
+	{
+		size_class_count = B_MAX_FIXED_ALLOC / B_FIXED_ALLOC_GRANULARITY
+	};
+
+	struct free_chunk
+	{
+		free_chunk* next;
+	};
+
+	struct thread_heap;
+
+	// Slabs are aligned on their size, so that the slab of
+	// a chunk can be found by clearing the low bits of its
+	// address. The chunks follow the header.
+	struct slab
+	{
+		// The heap that has allocated this slab. Heaps are
+		// never deleted, so the pointer stays valid.
+		thread_heap* owner;
+
+		size_t size_class;
+
+		// Freed chunks of this slab.
+		free_chunk* free_list;
+
+		// The number of chunks that have never been
+		// allocated, which follow the allocated ones.
+		size_t unused_count;
+		char* first_unused;
+
+		// The number of chunks that are allocated.
+		size_t used;
+
+		// Links in the list of slabs with free chunks.
+		slab* prev;
+		slab* next;
+	};
+
+	inline size_t slab_header_size()
+	{
+		return b::memory::align(sizeof(slab), B_FIXED_ALLOC_GRANULARITY);
+	}
+
+	inline size_t chunk_size(size_t size_class)
+	{
+		return (size_class + 1) * B_FIXED_ALLOC_GRANULARITY;
+	}
+
+	inline size_t chunks_per_slab(size_t size_class)
+	{
+		return (B_FIXED_ALLOC_SLAB_SIZE - slab_header_size()) /
+			chunk_size(size_class);
+	}
+
+	inline slab* slab_of(void* chunk)
+	{
+		return (slab*) ((size_t) chunk &
+			~(size_t) (B_FIXED_ALLOC_SLAB_SIZE - 1));
+	}
+
+	// Chunks of one size class owned by a thread.
+	struct size_class_heap
+	{
+		size_class_heap() : available(NULL), empty_slabs(0)
+		{
+		}
+
+		// Slabs that have free or unused chunks.
+		slab* available;
+
+		// The number of slabs with no chunks allocated.
+		size_t empty_slabs;
+
+		// The number of allocated chunks, written only
+		// by the owner and read by fixed_stats().
+		b::atomic_value<size_t> live;
+
+		char padding_before_remote[B_CACHE_LINE_SIZE];
+
+		// Chunks freed by other threads.
+		b::atomic_value<free_chunk*> remote_frees;
+
+		char padding_after_remote[B_CACHE_LINE_SIZE];
+	};
+
+	struct thread_heap
+	{
+		size_class_heap classes[size_class_count];
+
+		// Nonzero while a thread owns this heap or while
+		// trim_fixed_caches() cleans it up.
+		b::atomic_value<int> in_use;
+
+		thread_heap* next;
+	};
+
+	// Slab counts for fixed_stats(), updated only
+	// when slabs are allocated or freed.
+	struct slab_counters
+	{
+		b::atomic_value<size_t> current;
+		b::atomic_value<size_t> peak;
+	};
+
+	// State shared by all threads. It is created on first use
+	// and never destroyed, because static constructors and
+	// destructors of other translation units may allocate
+	// chunks before or after the dynamic initialization of
+	// this one.
+	struct shared_heaps
+	{
+		// All heaps ever created. Heaps of exited
+		// threads are reused but never removed.
+		b::atomic_value<thread_heap*> heaps;
+
+		slab_counters slab_counts[size_class_count];
+	};
+
+	pthread_once_t shared_once = PTHREAD_ONCE_INIT;
+	shared_heaps* shared;
+
+	// The thread-specific data key makes exiting threads abandon
+	// their heaps.
+	pthread_key_t heap_key;
+
+#if defined(B_HAVE_THREAD_STORAGE)
+	// The heap of the calling thread, which is faster
+	// to read than the thread-specific data.
+	__thread thread_heap* cached_heap;
+#endif /* defined(B_HAVE_THREAD_STORAGE) */
+
+	void abandon_heap(void* heap);
+
+	void create_shared_heaps()
+	{
+		shared = new shared_heaps;
+
+		pthread_key_create(&heap_key, abandon_heap);
+	}
+
+	inline shared_heaps& shared_state()
+	{
+		pthread_once(&shared_once, create_shared_heaps);
+
+		return *shared;
+	}
+
+	void link_available(size_class_heap& c, slab* s)
+	{
+		s->prev = NULL;
+		s->next = c.available;
+
+		if (c.available != NULL)
+			c.available->prev = s;
+
+		c.available = s;
+	}
+
+	void unlink_available(size_class_heap& c, slab* s)
+	{
+		if (s->prev != NULL)
+			s->prev->next = s->next;
+		else
+			c.available = s->next;
+
+		if (s->next != NULL)
+			s->next->prev = s->prev;
+	}
+
+	slab* alloc_slab(thread_heap* heap, size_t size_class)
+	{
+		void* block;
+
+		if (posix_memalign(&block, B_FIXED_ALLOC_SLAB_SIZE,
+				B_FIXED_ALLOC_SLAB_SIZE) != 0)
+		{
+			B_STRING_LITERAL(method_name, "b::memory::fixed_alloc()");
+
+			throw b::system_exception(method_name, ENOMEM);
+		}
+
+		slab* s = (slab*) block;
+
+		s->owner = heap;
+		s->size_class = size_class;
+		s->free_list = NULL;
+		s->unused_count = chunks_per_slab(size_class);
+		s->first_unused = (char*) block + slab_header_size();
+		s->used = 0;
+
+		slab_counters& counts = shared_state().slab_counts[size_class];
+
+		size_t count = counts.current.fetch_add(1,
+			b::memory_order_relaxed) + 1;
+		size_t peak = counts.peak.load(b::memory_order_relaxed);
+
+		while (peak < count && !counts.peak.compare_exchange(&peak,
+				count, b::memory_order_relaxed))
+			;
+
+		return s;
+	}
+
+	void free_slab(size_class_heap& c, slab* s)
+	{
+		unlink_available(c, s);
+
+		shared_state().slab_counts[s->size_class].current.fetch_sub(1,
+			b::memory_order_relaxed);
+
+		::free(s);
+	}
+
+	// Returns a chunk to its slab. Only the owner of
+	// the heap of the slab may call this function.
+	void free_local(size_class_heap& c, free_chunk* chunk,
+		size_t spare_slabs)
+	{
+		slab* s = slab_of(chunk);
+
+		chunk->next = s->free_list;
+		s->free_list = chunk;
+
+		if (s->free_list->next == NULL && s->unused_count == 0)
+			link_available(c, s);
+
+		c.live.store(c.live.load(b::memory_order_relaxed) - 1,
+			b::memory_order_relaxed);
+
+		if (--s->used > 0)
+			return;
+
+		if (c.empty_slabs < spare_slabs)
+			++c.empty_slabs;
+		else
+			free_slab(c, s);
+	}
+
+	// Takes back the chunks freed by other threads.
+	void free_remote(size_class_heap& c, size_t spare_slabs)
+	{
+		free_chunk* chunk = c.remote_frees.exchange(NULL,
+			b::memory_order_acquire);
+
+		while (chunk != NULL)
+		{
+			free_chunk* next = chunk->next;
+
+			free_local(c, chunk, spare_slabs);
+
+			chunk = next;
+		}
+	}
+
+	// Frees the remote chunks and the empty slabs of a heap
+	// that no thread is going to allocate from soon.
+	void trim(thread_heap* heap)
+	{
+		for (size_t i = 0; i < size_class_count; ++i)
+		{
+			size_class_heap& c = heap->classes[i];
+
+			free_remote(c, 0);
+
+			for (slab* s = c.available; s != NULL; )
+			{
+				slab* next = s->next;
+
+				if (s->used == 0)
+					free_slab(c, s);
+
+				s = next;
+			}
+
+			c.empty_slabs = 0;
+		}
+	}
+
+	void abandon_heap(void* heap)
+	{
+		thread_heap* h = (thread_heap*) heap;
+
+		trim(h);
+
+#if defined(B_HAVE_THREAD_STORAGE)
+		cached_heap = NULL;
+#endif /* defined(B_HAVE_THREAD_STORAGE) */
+
+		h->in_use.store(0, b::memory_order_release);
+	}
+
+	inline thread_heap* find_heap()
+	{
+#if defined(B_HAVE_THREAD_STORAGE)
+		return cached_heap;
+#else
+		shared_state();
+
+		return (thread_heap*) pthread_getspecific(heap_key);
+#endif /* defined(B_HAVE_THREAD_STORAGE) */
+	}
+
+	// Claims a heap that no thread owns.
+	bool claim_heap(thread_heap* heap)
+	{
+		int unused = 0;
+
+		return heap->in_use.load(b::memory_order_relaxed) == 0 &&
+			heap->in_use.compare_exchange(&unused, 1,
+				b::memory_order_acquire);
+	}
+
+	thread_heap* current_heap()
+	{
+		thread_heap* heap = find_heap();
+
+		if (heap != NULL)
+			return heap;
+
+		b::atomic_value<thread_heap*>& heaps = shared_state().heaps;
+
+		for (heap = heaps.load(b::memory_order_acquire);
+				heap != NULL; heap = heap->next)
+			if (claim_heap(heap))
+				break;
+
+		if (heap == NULL)
+		{
+			heap = new thread_heap;
+
+			heap->in_use.store(1, b::memory_order_relaxed);
+
+			thread_heap* head = heaps.load(b::memory_order_relaxed);
+
+			do
+				heap->next = head;
+			while (!heaps.compare_exchange(&head, heap,
+				b::memory_order_release));
+		}
+
+		pthread_setspecific(heap_key, heap);
+
+#if defined(B_HAVE_THREAD_STORAGE)
+		cached_heap = heap;
+#endif /* defined(B_HAVE_THREAD_STORAGE) */
+
+		return heap;
+	}
+
+	inline size_t size_class_of(size_t size)
+	{
+		return size == 0 ? 0 : (size - 1) / B_FIXED_ALLOC_GRANULARITY;
+	}
+}
+
+B_BEGIN_NAMESPACE
+
 void* memory::fixed_alloc(size_t size)
 {
-	return alloc(size);
+	if (size > B_MAX_FIXED_ALLOC)
+		return alloc(size);
+
+	size_t size_class = size_class_of(size);
+
+	thread_heap* heap = current_heap();
+	size_class_heap& c = heap->classes[size_class];
+
+	slab* s = c.available;
+
+	if (s == NULL)
+	{
+		free_remote(c, B_FIXED_ALLOC_SPARE_SLABS);
+
+		if ((s = c.available) == NULL)
+			link_available(c, s = alloc_slab(heap, size_class));
+	}
+
+	void* chunk;
+
+	if (s->free_list != NULL)
+	{
+		chunk = s->free_list;
+		s->free_list = s->free_list->next;
+	}
+	else
+	{
+		chunk = s->first_unused;
+		s->first_unused += chunk_size(size_class);
+		--s->unused_count;
+	}
+
+	if (s->used++ == 0 && c.empty_slabs > 0)
+		--c.empty_slabs;
+
+	if (s->free_list == NULL && s->unused_count == 0)
+		unlink_available(c, s);
+
+	c.live.store(c.live.load(memory_order_relaxed) + 1,
+		memory_order_relaxed);
+
+	return chunk;
+}
+
+void memory::fixed_free(void* chunk, size_t size)
+{
+	if (size > B_MAX_FIXED_ALLOC)
+	{
+		free(chunk);
+		return;
+	}
+
+	if (chunk == NULL)
+		return;
+
+	slab* s = slab_of(chunk);
+	thread_heap* owner = s->owner;
+	size_class_heap& c = owner->classes[s->size_class];
+
+	if (owner == find_heap())
+	{
+		free_local(c, (free_chunk*) chunk, B_FIXED_ALLOC_SPARE_SLABS);
+		return;
+	}
+
+	free_chunk* head = c.remote_frees.load(memory_order_relaxed);
+
+	do
+		((free_chunk*) chunk)->next = head;
+	while (!c.remote_frees.compare_exchange(&head, (free_chunk*) chunk,
+		memory_order_release));
+}
+
+size_t memory::fixed_size_class_count()
+{
+	return size_class_count;
+}
+
+fixed_alloc_stats memory::fixed_stats(size_t size_class)
+{
+	B_ASSERT(size_class < size_class_count);
+
+	size_t live = 0;
+
+	for (thread_heap* heap = shared_state().heaps.load(
+			memory_order_acquire);
+			heap != NULL; heap = heap->next)
+		live += heap->classes[size_class].live.load(
+			memory_order_relaxed);
+
+	size_t capacity = chunks_per_slab(size_class);
+	const slab_counters& counts = shared_state().slab_counts[size_class];
+	size_t total = counts.current.load(memory_order_relaxed) * capacity;
+
+	fixed_alloc_stats stats;
+
+	stats.chunk_size = chunk_size(size_class);
+	stats.live = live;
+	stats.cached = total > live ? total - live : 0;
+	stats.peak = counts.peak.load(memory_order_relaxed) * capacity;
+
+	return stats;
 }
 
-void memory::fixed_free(void* chunk, size_t /*size*/)
+void memory::trim_fixed_caches()
 {
-	free(chunk);
+	thread_heap* own_heap = find_heap();
+
+	if (own_heap != NULL)
+		trim(own_heap);
+
+	for (thread_heap* heap = shared_state().heaps.load(
+			memory_order_acquire);
+			heap != NULL; heap = heap->next)
+		if (claim_heap(heap))
+		{
+			trim(heap);
+
+			heap->in_use.store(0, memory_order_release);
+		}
 }
 
 B_END_NAMESPACE
@@ -0,0 +1,392 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/mutex.h>
+
+#include <b/system_exception.h>
+
+#if defined(B_HAVE_LINUX_FUTEX_H)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <limits.h>
+#endif /* defined(B_HAVE_LINUX_FUTEX_H) */
+
+namespace
+{
+	// Tells the processor that the thread is spinning.
+	inline void cpu_relax()
+	{
+#if defined(__GNUG__) && (defined(__i386__) || defined(__x86_64__))
+		__builtin_ia32_pause();
+#endif
+	}
+
+#if defined(B_HAVE_LINUX_FUTEX_H)
+	// The futex system calls operate on the integer that
+	// 'atomic_value<int>' wraps without adding any fields.
+	inline int* futex_address(b::atomic_value<int>* word)
+	{
+		return reinterpret_cast<int*>(word);
+	}
+
+	// Sleeps until 'word' is woken up, unless it no longer
+	// contains 'expected'.
+	void futex_wait(b::atomic_value<int>* word, int expected)
+	{
+		syscall(SYS_futex, futex_address(word), FUTEX_WAIT_PRIVATE,
+			expected, NULL, NULL, 0);
+	}
+
+	// Wakes up to 'count' threads sleeping on 'word'.
+	void futex_wake(b::atomic_value<int>* word, int count)
+	{
+		syscall(SYS_futex, futex_address(word), FUTEX_WAKE_PRIVATE,
+			count, NULL, NULL, 0);
+	}
+#endif /* defined(B_HAVE_LINUX_FUTEX_H) */
+}
+
+B_BEGIN_NAMESPACE
+
+#if defined(B_LOCK_STATS)
+
+void lock_counters::count_contended_acquisition(uint64_t start)
+{
+	contended_acquisitions.fetch_add(1, memory_order_relaxed);
+	wait_nanoseconds.fetch_add(wait_start() - start,
+		memory_order_relaxed);
+}
+
+uint64_t lock_counters::wait_start()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+
+lock_stats lock_counters::get() const
+{
+	lock_stats s;
+
+	s.acquisitions = acquisitions.load(memory_order_relaxed);
+	s.contended_acquisitions =
+		contended_acquisitions.load(memory_order_relaxed);
+	s.wait_nanoseconds = wait_nanoseconds.load(memory_order_relaxed);
+
+	return s;
+}
+
+void lock_counters::reset()
+{
+	acquisitions.store(0, memory_order_relaxed);
+	contended_acquisitions.store(0, memory_order_relaxed);
+	wait_nanoseconds.store(0, memory_order_relaxed);
+}
+
+#endif /* defined(B_LOCK_STATS) */
+
+#if defined(B_HAVE_LINUX_FUTEX_H)
+
+void mutex::lock_contended()
+{
+	uint64_t start = lock_counters::wait_start();
+
+	// Spin while the owner may release the lock soon. If
+	// there are sleeping threads already, join them at once.
+	for (int i = 0; i < B_MUTEX_SPIN_COUNT; ++i)
+	{
+		cpu_relax();
+
+		int s = state.load(memory_order_relaxed);
+
+		if (s == 2)
+			break;
+
+		if (s == 0 && state.compare_exchange(&s, 1,
+				memory_order_acquire))
+		{
+			counters.count_contended_acquisition(start);
+			return;
+		}
+	}
+
+	lock_after_wait();
+
+	counters.count_contended_acquisition(start);
+}
+
+void mutex::lock_after_wait()
+{
+	// The thread cannot tell whether other threads are still
+	// sleeping, so it takes the lock in the state that makes
+	// unlock() wake one of them up.
+	while (state.exchange(2, memory_order_acquire) != 0)
+		futex_wait(&state, 2);
+}
+
+void mutex::wake_waiter()
+{
+	futex_wake(&state, 1);
+}
+
+void condition::wait(mutex& locked_mutex)
+{
+	// The sequence is read while the mutex is held, so a signal
+	// sent after the mutex is released changes it and the
+	// futex does not put the thread to sleep.
+	int s = sequence.load(memory_order_relaxed);
+
+	locked_mutex.unlock();
+
+	futex_wait(&sequence, s);
+
+	locked_mutex.lock_after_wait();
+}
+
+void condition::signal()
+{
+	sequence.fetch_add(1, memory_order_release);
+
+	futex_wake(&sequence, 1);
+}
+
+void condition::broadcast()
+{
+	sequence.fetch_add(1, memory_order_release);
+
+	futex_wake(&sequence, INT_MAX);
+}
+
+bool shared_mutex::try_lock()
+{
+	int s = state.load(memory_order_relaxed);
+
+	while ((s & writer) == 0 && s < reader)
+		if (state.compare_exchange(&s, s | writer,
+				memory_order_acquire))
+		{
+			counters.count_acquisition();
+
+			return true;
+		}
+
+	return false;
+}
+
+bool shared_mutex::try_lock_shared()
+{
+	int s = state.load(memory_order_relaxed);
+
+	while ((s & (writer | writer_waiting)) == 0)
+		if (state.compare_exchange(&s, s + reader,
+				memory_order_acquire))
+		{
+			counters.count_acquisition();
+
+			return true;
+		}
+
+	return false;
+}
+
+void shared_mutex::lock_contended()
+{
+	uint64_t start = lock_counters::wait_start();
+
+	int spin_count = 0;
+
+	for (;;)
+	{
+		int s = state.load(memory_order_relaxed);
+
+		if ((s & writer) == 0 && s < reader)
+		{
+			// The lock is free. Other waiting writers will
+			// set 'writer_waiting' again when they wake up.
+			if (state.compare_exchange(&s,
+					(s | writer) & ~writer_waiting,
+					memory_order_acquire))
+				break;
+		}
+		else if ((s & writer_waiting) == 0)
+			// Keep new readers out.
+			state.compare_exchange(&s, s | writer_waiting,
+				memory_order_relaxed);
+		else if (spin_count < B_MUTEX_SPIN_COUNT)
+		{
+			++spin_count;
+			cpu_relax();
+		}
+		else
+			sleep(s);
+	}
+
+	counters.count_contended_acquisition(start);
+}
+
+void shared_mutex::lock_shared_contended()
+{
+	uint64_t start = lock_counters::wait_start();
+
+	int spin_count = 0;
+
+	for (;;)
+	{
+		int s = state.load(memory_order_relaxed);
+
+		if ((s & (writer | writer_waiting)) == 0)
+		{
+			if (state.compare_exchange(&s, s + reader,
+					memory_order_acquire))
+				break;
+		}
+		else if (spin_count < B_MUTEX_SPIN_COUNT)
+		{
+			++spin_count;
+			cpu_relax();
+		}
+		else
+			sleep(s);
+	}
+
+	counters.count_contended_acquisition(start);
+}
+
+void shared_mutex::sleep(int expected)
+{
+	if ((expected & sleepers) == 0)
+	{
+		if (!state.compare_exchange(&expected, expected | sleepers,
+				memory_order_relaxed))
+			return;
+
+		expected |= sleepers;
+	}
+
+	futex_wait(&state, expected);
+}
+
+void shared_mutex::release(int held)
+{
+	int s = state.load(memory_order_relaxed);
+	int released;
+
+	do
+	{
+		released = s - held;
+
+		// Once the last holder is gone, all sleeping threads
+		// are woken up to compete for the lock again.
+		if ((released & sleepers) != 0 && released < reader)
+			released &= ~sleepers;
+	}
+	while (!state.compare_exchange(&s, released, memory_order_release));
+
+	if (((s - held) & sleepers) != (released & sleepers))
+		futex_wake(&state, INT_MAX);
+}
+
+#else
+
+mutex::mutex()
+{
+	int error = pthread_mutex_init(&handle, NULL);
+
+	if (error != 0)
+	{
+		B_STRING_LITERAL(method_name, "b::mutex::mutex()");
+
+		throw system_exception(method_name, error);
+	}
+}
+
+void mutex::lock_contended()
+{
+	uint64_t start = lock_counters::wait_start();
+
+	for (int i = 0; i < B_MUTEX_SPIN_COUNT; ++i)
+	{
+		cpu_relax();
+
+		if (pthread_mutex_trylock(&handle) == 0)
+		{
+			counters.count_contended_acquisition(start);
+			return;
+		}
+	}
+
+	pthread_mutex_lock(&handle);
+
+	counters.count_contended_acquisition(start);
+}
+
+condition::condition()
+{
+	int error = pthread_cond_init(&handle, NULL);
+
+	if (error != 0)
+	{
+		B_STRING_LITERAL(method_name, "b::condition::condition()");
+
+		throw system_exception(method_name, error);
+	}
+}
+
+shared_mutex::shared_mutex()
+{
+	int error = pthread_rwlock_init(&handle, NULL);
+
+	if (error != 0)
+	{
+		B_STRING_LITERAL(method_name,
+			"b::shared_mutex::shared_mutex()");
+
+		throw system_exception(method_name, error);
+	}
+}
+
+bool shared_mutex::try_lock()
+{
+	if (pthread_rwlock_trywrlock(&handle) != 0)
+		return false;
+
+	counters.count_acquisition();
+
+	return true;
+}
+
+bool shared_mutex::try_lock_shared()
+{
+	if (pthread_rwlock_tryrdlock(&handle) != 0)
+		return false;
+
+	counters.count_acquisition();
+
+	return true;
+}
+
+void shared_mutex::lock_contended()
+{
+	uint64_t start = lock_counters::wait_start();
+
+	pthread_rwlock_wrlock(&handle);
+
+	counters.count_contended_acquisition(start);
+}
+
+void shared_mutex::lock_shared_contended()
+{
+	uint64_t start = lock_counters::wait_start();
+
+	pthread_rwlock_rdlock(&handle);
+
+	counters.count_contended_acquisition(start);
+}
+
+#endif /* defined(B_HAVE_LINUX_FUTEX_H) */
+
+B_END_NAMESPACE
@@ -0,0 +1,110 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/node_pool.h>
+
+B_BEGIN_NAMESPACE
+
+// The size of the slab header rounded up so that the nodes
+// that follow it have the alignment of heap blocks.
+#define SLAB_HEADER_SIZE (sizeof(void*) * 2)
+
+node_pool::node_pool(size_t requested_size) :
+	size(memory::align(requested_size > sizeof(free_node) ?
+		requested_size : sizeof(free_node), sizeof(void*))),
+	slabs(NULL),
+	free_nodes(NULL),
+	free_node_count(0),
+	pos(NULL),
+	end(NULL),
+	capacity(0)
+{
+}
+
+void* node_pool::allocate(size_t requested_size)
+{
+	B_ASSERT(requested_size <= size);
+
+	(void) requested_size;
+
+	return allocate_node();
+}
+
+void node_pool::deallocate(void* block, size_t /*size*/)
+{
+	deallocate_node(block);
+}
+
+void node_pool::reserve(size_t count)
+{
+	size_t available_count = available();
+
+	if (count > available_count)
+		add_slab(count - available_count);
+}
+
+void node_pool::clear()
+{
+	while (slabs != NULL)
+	{
+		slab* next = slabs->next;
+
+		memory::free(slabs);
+
+		slabs = next;
+	}
+
+	free_nodes = NULL;
+	free_node_count = 0;
+	pos = end = NULL;
+	capacity = 0;
+}
+
+node_pool::~node_pool()
+{
+	clear();
+}
+
+void* node_pool::allocate_from_new_slab()
+{
+	size_t max_node_count = B_NODE_POOL_MAX_SLAB_SIZE / size;
+
+	// Double the capacity until the slabs reach the maximum size.
+	size_t node_count = capacity < max_node_count ?
+		capacity : max_node_count;
+
+	if (node_count < B_NODE_POOL_MIN_SLAB_NODES)
+		node_count = B_NODE_POOL_MIN_SLAB_NODES;
+
+	add_slab(node_count);
+
+	void* node = pos;
+
+	pos += size;
+
+	return node;
+}
+
+void node_pool::add_slab(size_t node_count)
+{
+	slab* new_slab = (slab*) memory::alloc(SLAB_HEADER_SIZE +
+		node_count * size);
+
+	while (pos != end)
+	{
+		deallocate_node(pos);
+
+		pos += size;
+	}
+
+	new_slab->next = slabs;
+	slabs = new_slab;
+
+	pos = (char*) new_slab + SLAB_HEADER_SIZE;
+	end = pos + node_count * size;
+
+	capacity += node_count;
+}
+
+B_END_NAMESPACE
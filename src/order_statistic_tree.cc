@@ -0,0 +1,123 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/order_statistic_tree.h>
+
+B_BEGIN_NAMESPACE
+
+static size_t subtree_size(const binary_tree_node* node)
+{
+	return node == NULL ? 0 :
+		static_cast<const order_statistic_tree_node*>(
+			node)->subtree_size;
+}
+
+// Recomputes the subtree sizes on the path from 'node' to the root.
+static void update_subtree_sizes(binary_tree_node* node)
+{
+	for (; node != NULL; node = node->parent)
+		static_cast<order_statistic_tree_node*>(node)->subtree_size =
+			subtree_size(node->left) +
+			subtree_size(node->right) + 1;
+}
+
+// Computes the subtree sizes of a freshly linked subtree.
+static size_t compute_subtree_sizes(binary_tree_node* node)
+{
+	if (node == NULL)
+		return 0;
+
+	size_t size = compute_subtree_sizes(node->left) +
+		compute_subtree_sizes(node->right) + 1;
+
+	static_cast<order_statistic_tree_node*>(node)->subtree_size = size;
+
+	return size;
+}
+
+void order_statistic_tree_base::insert_after_search(binary_tree_node* node,
+	binary_tree_node* parent, int cmp_result)
+{
+	binary_search_tree_base::insert_after_search(node, parent, cmp_result);
+
+	static_cast<order_statistic_tree_node*>(node)->subtree_size = 1;
+
+	while ((node = node->parent) != NULL)
+		++static_cast<order_statistic_tree_node*>(node)->subtree_size;
+}
+
+void order_statistic_tree_base::build_from_sorted(binary_tree_node** nodes,
+	size_t count)
+{
+	binary_search_tree_base::build_from_sorted(nodes, count);
+
+	compute_subtree_sizes(root);
+}
+
+void order_statistic_tree_base::remove(binary_tree_node* node)
+{
+	// Find the lowest node whose subtree changes with the
+	// removal. The cases follow binary_search_tree_base::remove().
+	binary_tree_node* lowest_changed;
+
+	if (node->left == NULL || node->right == NULL)
+		lowest_changed = node->parent;
+	else
+		if (node->left->right == NULL)
+			lowest_changed = node->left;
+		else
+			if (node->right->left == NULL)
+				lowest_changed = node->right;
+			else
+			{
+				// The parent of the inorder successor,
+				// which replaces the removed node.
+				lowest_changed = node->right->left;
+
+				while (lowest_changed->left != NULL)
+					lowest_changed = lowest_changed->left;
+
+				lowest_changed = lowest_changed->parent;
+			}
+
+	binary_search_tree_base::remove(node);
+
+	update_subtree_sizes(lowest_changed);
+}
+
+binary_tree_node* order_statistic_tree_base::select(size_t index) const
+{
+	binary_tree_node* node = root;
+
+	while (node != NULL)
+	{
+		size_t left_size = subtree_size(node->left);
+
+		if (index < left_size)
+			node = node->left;
+		else
+			if (index > left_size)
+			{
+				index -= left_size + 1;
+				node = node->right;
+			}
+			else
+				break;
+	}
+
+	return node;
+}
+
+size_t order_statistic_tree_base::rank(const binary_tree_node* node) const
+{
+	size_t result = subtree_size(node->left);
+
+	for (; node->parent != NULL; node = node->parent)
+		if (node->parent->right == node)
+			result += subtree_size(node->parent->left) + 1;
+
+	return result;
+}
+
+B_END_NAMESPACE
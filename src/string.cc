@@ -2,7 +2,7 @@
 // Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
 // See the file LICENSE for the license terms.
 
-#include <b/string.h>
+#include <b/string_tokenizer.h>
 
 #include <stdint.h>
 
@@ -61,10 +61,15 @@ namespace
 #define char_t wchar_t
 #define B_L_PREFIX(ch) L##ch
 #define string_view wstring_view
+#define char_set wchar_set
+#define string_tokenizer wstring_tokenizer
 #define string_allocator wstring_allocator
 #include "string_impl.h"
 #include "string_view_impl.h"
+#include "string_tokenizer_impl.h"
 #undef string_allocator
+#undef string_tokenizer
+#undef char_set
 #define string_formatting wstring_formatting
 #include "string_formatting.h"
 #undef string_formatting
@@ -77,6 +82,7 @@ namespace
 #define B_L_PREFIX(ch) ch
 #include "string_impl.h"
 #include "string_view_impl.h"
+#include "string_tokenizer_impl.h"
 #include "string_formatting.h"
 #undef B_L_PREFIX
 #undef char_t
@@ -65,7 +65,10 @@ void string::discard_and_alloc(size_t new_capacity)
 			chars = alloc_buffer(new_capacity, 0);
 	}
 	else
+	{
 		metadata()->length = 0;
+		invalidate_hash();
+	}
 	*chars = 0;
 }
 
@@ -132,6 +135,8 @@ void string::assign(const char_t* source, size_t count)
 	{
 		if (is_shared() || count > capacity())
 			discard_and_alloc(extra_capacity(count));
+		else
+			invalidate_hash();
 		assign_pairwise(chars, source, count);
 		chars[metadata()->length = count] = 0;
 	}
@@ -147,6 +152,8 @@ void string::assign(size_t count, char_t ch)
 	{
 		if (is_shared() || count > capacity())
 			discard_and_alloc(extra_capacity(count));
+		else
+			invalidate_hash();
 		assign_value(chars, count, ch);
 		chars[metadata()->length = count] = 0;
 	}
@@ -198,6 +205,7 @@ void string::replace(size_t start, const char_t* source, size_t count)
 	}
 	else
 	{
+		invalidate_hash();
 		assign_pairwise(chars + start, source, count);
 
 		if (end_of_change > length())
@@ -242,6 +250,7 @@ void string::replace(size_t start, char_t ch, size_t count)
 	}
 	else
 	{
+		invalidate_hash();
 		assign_value(chars + start, count, ch);
 
 		if (end_of_change > length())
@@ -275,6 +284,7 @@ void string::insert(size_t pos, const char_t* source, size_t count)
 		}
 		else
 		{
+			invalidate_hash();
 			move_right_and_insert(tail, tail_length, source, count);
 
 			metadata()->length = new_length;
@@ -306,6 +316,7 @@ void string::insert(size_t pos, char_t ch, size_t count)
 		}
 		else
 		{
+			invalidate_hash();
 			move_right_and_insert(tail, tail_length, ch, count);
 
 			metadata()->length = new_length;
@@ -321,6 +332,8 @@ void string::append(const char_t* source, size_t count)
 	{
 		if (is_shared() || count + length() > capacity())
 			alloc_and_copy(extra_capacity(length() + count));
+		else
+			invalidate_hash();
 		assign_pairwise(chars + length(), source, count);
 		chars[metadata()->length += count] = 0;
 	}
@@ -334,6 +347,8 @@ void string::append(size_t count, char_t ch)
 	{
 		if (is_shared() || count + length() > capacity())
 			alloc_and_copy(extra_capacity(length() + count));
+		else
+			invalidate_hash();
 		assign_value(chars + length(), count, ch);
 		chars[metadata()->length += count] = 0;
 	}
@@ -370,6 +385,7 @@ void string::remove(size_t start, size_t count)
 
 		if (!is_shared())
 		{
+			invalidate_hash();
 			move_left(chars + start,
 				chars + start + count, new_length - start + 1);
 
@@ -397,7 +413,10 @@ void string::truncate(size_t new_length)
 	if (new_length < length())
 	{
 		if (!is_shared())
+		{
+			invalidate_hash();
 			chars[metadata()->length = new_length] = 0;
+		}
 		else
 		{
 			char_t* new_buffer_chars = alloc_buffer(
@@ -415,6 +434,7 @@ void string::empty()
 {
 	if (!is_shared())
 	{
+		invalidate_hash();
 		metadata()->length = 0;
 		*chars = 0;
 	}
@@ -530,19 +550,9 @@ void string::append_formatted_va(const char_t* fmt, va_list ap)
 
 size_t string::find(char_t ch) const
 {
-	size_t counter = length();
+	const char_t* ptr = find_char(chars, length(), ch);
 
-	const char_t* ptr = chars;
-
-	while (counter-- > 0)
-	{
-		if (*ptr == ch)
-			return (size_t) (ptr - chars);
-
-		++ptr;
-	}
-
-	return (size_t) -1;
+	return ptr != NULL ? (size_t) (ptr - chars) : (size_t) -1;
 }
 
 size_t string::rfind(char_t ch) const
@@ -580,9 +590,10 @@ bool string::split(char_t delim, string_view* slice, string_view* rest) const
 
 void string::trim_right(const string_view& samples)
 {
+	const char_set sample_set(samples);
 	char_t* new_last = chars + length();
 
-	while (--new_last >= chars && samples.find(*new_last) != (size_t) -1)
+	while (--new_last >= chars && sample_set.contains(*new_last))
 		;
 
 	truncate((size_t) (new_last + 1 - chars));
@@ -593,11 +604,12 @@ void string::trim_left(const string_view& samples)
 	if (is_empty())
 		return;
 
+	const char_set sample_set(samples);
 	size_t new_length = length();
 	const char_t* new_first = chars;
 
 	do
-		if (samples.find(*new_first) == (size_t) -1)
+		if (!sample_set.contains(*new_first))
 			break;
 		else
 			++new_first;
@@ -607,6 +619,7 @@ void string::trim_left(const string_view& samples)
 	{
 		if (!is_shared())
 		{
+			invalidate_hash();
 			metadata()->length = new_length;
 			move_left(chars, new_first, new_length + 1);
 		}
@@ -629,6 +642,9 @@ char_t* string::empty_string()
 	static const buffer empty_string_buffer =
 	{
 		/* refs         */ 2,
+#if defined(B_STRING_HASH_CACHE)
+		/* hash         */ 0,
+#endif /* defined(B_STRING_HASH_CACHE) */
 		/* capacity     */ 0,
 		/* length       */ 0,
 		/* first_char   */ {0}
@@ -645,6 +661,9 @@ char_t* string::alloc_buffer(size_t capacity, size_t length)
 		capacity * sizeof(char_t));
 
 	new_buffer->refs = 1;
+#if defined(B_STRING_HASH_CACHE)
+	new_buffer->hash = 0;
+#endif /* defined(B_STRING_HASH_CACHE) */
 	new_buffer->capacity = capacity;
 	new_buffer->length = length;
 
@@ -0,0 +1,190 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/string_pool.h>
+
+namespace
+{
+	// Size of the arena blocks that interned strings are
+	// allocated from. Longer strings get blocks of their own.
+	const size_t arena_block_size = 16384;
+
+	const size_t initial_table_size = 64;
+}
+
+B_BEGIN_NAMESPACE
+
+const atom::entry atom::empty_entry = {0, 0, {0}};
+
+atom string_pool::intern(const string_view& str)
+{
+	if (str.is_empty())
+		return atom();
+
+	size_t hash_value = hash(str);
+
+	if (table != NULL)
+	{
+		slot* s = find_slot(str, hash_value);
+
+		if (s->ent != NULL)
+			return atom(s->ent);
+	}
+
+	// Keep the load factor below 3/4.
+	if ((string_count + 1) * 4 > table_size * 3)
+		grow_table();
+
+	atom::entry* new_entry = allocate_entry(str.length());
+
+	new_entry->hash = hash_value;
+	new_entry->length = str.length();
+	memory::copy(new_entry->chars, str.data(), str.length());
+	new_entry->chars[str.length()] = '\0';
+
+	slot* s = find_slot(str, hash_value);
+
+	s->hash = hash_value;
+	s->ent = new_entry;
+
+	++string_count;
+	string_bytes += str.length();
+
+	return atom(new_entry);
+}
+
+bool string_pool::find(const string_view& str, atom* result) const
+{
+	if (str.is_empty())
+	{
+		*result = atom();
+		return true;
+	}
+
+	if (table == NULL)
+		return false;
+
+	const slot* s = find_slot(str, hash(str));
+
+	if (s->ent == NULL)
+		return false;
+
+	*result = atom(s->ent);
+	return true;
+}
+
+string_pool_stats string_pool::stats() const
+{
+	string_pool_stats result;
+
+	result.string_count = string_count;
+	result.string_bytes = string_bytes;
+	result.arena_bytes = arena_bytes;
+	result.table_bytes = table_size * sizeof(slot);
+
+	return result;
+}
+
+string_pool::~string_pool()
+{
+	while (blocks != NULL)
+	{
+		arena_block* next = blocks->next;
+		memory::free(blocks);
+		blocks = next;
+	}
+
+	memory::free(table);
+}
+
+string_pool::slot* string_pool::find_slot(const string_view& str,
+	size_t hash_value) const
+{
+	size_t mask = table_size - 1;
+	size_t index = hash_value & mask;
+
+	for (;;)
+	{
+		slot* s = table + index;
+
+		if (s->ent == NULL || (s->hash == hash_value &&
+				s->ent->length == str.length() &&
+				memory::compare(s->ent->chars, str.data(),
+					str.length()) == 0))
+			return s;
+
+		index = (index + 1) & mask;
+	}
+}
+
+atom::entry* string_pool::allocate_entry(size_t length)
+{
+	size_t entry_size = memory::align(B_OFFSETOF(atom::entry, chars) +
+		length + 1, sizeof(size_t));
+
+	if (entry_size <= (size_t) (arena_end - arena_pos))
+	{
+		char* result = arena_pos;
+		arena_pos += entry_size;
+		return reinterpret_cast<atom::entry*>(result);
+	}
+
+	size_t header_size = memory::align(sizeof(arena_block),
+		sizeof(size_t));
+
+	bool dedicated = entry_size > arena_block_size / 4;
+
+	size_t block_size = header_size +
+		(dedicated ? entry_size : arena_block_size);
+
+	arena_block* block = (arena_block*) memory::alloc(block_size);
+
+	block->next = blocks;
+	block->size = block_size;
+	blocks = block;
+	arena_bytes += block_size;
+
+	char* result = (char*) block + header_size;
+
+	// A long string gets a block of its own, which leaves
+	// the free space of the current block available for
+	// the strings that follow.
+	if (!dedicated)
+	{
+		arena_pos = result + entry_size;
+		arena_end = (char*) block + block_size;
+	}
+
+	return reinterpret_cast<atom::entry*>(result);
+}
+
+void string_pool::grow_table()
+{
+	size_t new_size = table_size > 0 ?
+		table_size * 2 : initial_table_size;
+
+	slot* new_table = (slot*) memory::alloc(new_size * sizeof(slot));
+
+	memory::zero(new_table, new_size * sizeof(slot));
+
+	size_t mask = new_size - 1;
+
+	for (slot* s = table; s < table + table_size; ++s)
+		if (s->ent != NULL)
+		{
+			size_t index = s->hash & mask;
+
+			while (new_table[index].ent != NULL)
+				index = (index + 1) & mask;
+
+			new_table[index] = *s;
+		}
+
+	memory::free(table);
+
+	table = new_table;
+	table_size = new_size;
+}
+
+B_END_NAMESPACE
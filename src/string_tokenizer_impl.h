@@ -0,0 +1,67 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+B_BEGIN_NAMESPACE
+
+char_set::char_set(const string_view& chars)
+{
+	memory::zero(bits, sizeof(bits));
+
+	const char_t* ch = chars.data();
+	size_t code;
+
+	for (size_t counter = chars.length(); counter > 0; --counter)
+		if ((code = char_code(*ch++)) < 256)
+			bits[code / bits_per_word] |=
+				(size_t) 1 << (code % bits_per_word);
+		else
+			chars_beyond_table = chars;
+}
+
+string_tokenizer::string_tokenizer(const string_view& input,
+		const string_view& delimiters, bool skip_empty_tokens) :
+	delimiter_set(delimiters),
+	single_delimiter(delimiters.length() == 1 ? delimiters.data() : NULL),
+	current(input.data()),
+	end(input.data() + input.length()),
+	skip_empty(skip_empty_tokens),
+	exhausted(false)
+{
+}
+
+bool string_tokenizer::next(string_view* token)
+{
+	if (exhausted)
+		return false;
+
+	if (skip_empty)
+	{
+		while (current < end && delimiter_set.contains(*current))
+			++current;
+
+		if (current == end)
+		{
+			exhausted = true;
+			return false;
+		}
+	}
+
+	const char_t* delim = find_delimiter(current);
+
+	if (delim == NULL)
+	{
+		token->assign(current, (size_t) (end - current));
+		current = end;
+		exhausted = true;
+	}
+	else
+	{
+		token->assign(current, (size_t) (delim - current));
+		current = delim + 1;
+	}
+
+	return true;
+}
+
+B_END_NAMESPACE
@@ -6,13 +6,12 @@ B_BEGIN_NAMESPACE
 
 size_t string_view::find(char_t ch) const
 {
-	const char_t* ptr = view;
+	if (view_length == 0)
+		return (size_t) -1;
 
-	for (size_t counter = view_length; counter > 0; --counter, ++ptr)
-		if (*ptr == ch)
-			return (size_t) (ptr - view);
+	const char_t* ptr = find_char(view, view_length, ch);
 
-	return (size_t) -1;
+	return ptr != NULL ? (size_t) (ptr - view) : (size_t) -1;
 }
 
 size_t string_view::rfind(char_t ch) const
@@ -68,15 +67,18 @@ bool string_view::split(char_t delim, string_view* slice, string_view* rest)
 
 void string_view::trim_right(const string_view& samples)
 {
+	const char_set sample_set(samples);
 	const char_t* end = view + view_length;
 
-	while (view_length > 0 && samples.find(*--end) != (size_t) -1)
+	while (view_length > 0 && sample_set.contains(*--end))
 		--view_length;
 }
 
 void string_view::trim_left(const string_view& samples)
 {
-	while (view_length > 0 && samples.find(*view) != (size_t) -1)
+	const char_set sample_set(samples);
+
+	while (view_length > 0 && sample_set.contains(*view))
 	{
 		++view;
 		--view_length;
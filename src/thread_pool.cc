@@ -0,0 +1,441 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/thread_pool.h>
+
+#include <b/mutex.h>
+#include <b/system_exception.h>
+#include <b/work_stealing_deque.h>
+
+#include <sched.h>
+#include <unistd.h>
+
+namespace
+{
+	// Queue of tasks submitted by threads that are not
+	// workers, protected by a mutex.
+	class task_queue
+	{
+	public:
+		task_queue() : tasks(NULL), mask(0), head(0), tail(0)
+		{
+		}
+
+		void push_back(b::task* t);
+		b::task* pop_front();
+
+		~task_queue()
+		{
+			b::memory::free(tasks);
+		}
+
+	private:
+		task_queue(const task_queue&);
+		task_queue& operator =(const task_queue&);
+
+		b::mutex lock;
+
+		// Ring buffer with a power-of-two capacity. 'head'
+		// and 'tail' grow monotonically and are reduced
+		// modulo the capacity on access.
+		b::task** tasks;
+		size_t mask;
+		size_t head;
+		size_t tail;
+	};
+
+	void task_queue::push_back(b::task* t)
+	{
+		b::mutex_lock guard(lock);
+
+		if (tasks == NULL || tail - head > mask)
+		{
+			size_t new_capacity = tasks == NULL ? 64 : (mask + 1) * 2;
+
+			b::task** new_tasks = (b::task**)
+				b::memory::alloc(new_capacity * sizeof(b::task*));
+
+			for (size_t i = head; i != tail; ++i)
+				new_tasks[i & (new_capacity - 1)] = tasks[i & mask];
+
+			b::memory::free(tasks);
+
+			tasks = new_tasks;
+			mask = new_capacity - 1;
+		}
+
+		tasks[tail++ & mask] = t;
+	}
+
+	b::task* task_queue::pop_front()
+	{
+		b::mutex_lock guard(lock);
+
+		return head == tail ? NULL : tasks[head++ & mask];
+	}
+
+	// Returns the current value of the monotonic clock.
+	uint64_t monotonic_nanoseconds()
+	{
+		struct timespec ts;
+
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+
+		return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+	}
+
+	pthread_key_t current_worker_key;
+	pthread_once_t current_worker_key_once = PTHREAD_ONCE_INIT;
+
+	void create_current_worker_key()
+	{
+		pthread_key_create(&current_worker_key, NULL);
+	}
+
+	// Number of unsuccessful attempts to find a task
+	// before an idle worker goes to sleep.
+	const int spin_count = 64;
+}
+
+B_BEGIN_NAMESPACE
+
+class thread_pool::impl : public object
+{
+public:
+	impl(size_t concurrency);
+
+	struct worker
+	{
+		impl* pool;
+		size_t index;
+		pthread_t thread;
+		work_stealing_deque<task*> deque;
+
+		// Only the worker itself updates the counters.
+		atomic_value<size_t> tasks_executed;
+		atomic_value<size_t> steals;
+		atomic_value<uint64_t> idle_nanoseconds;
+
+		char padding_after_stats[B_CACHE_LINE_SIZE];
+	};
+
+	// Returns the worker structure of the calling thread
+	// or NULL if the thread is not a worker of this pool.
+	worker* current_worker();
+
+	void submit(task* t);
+
+	// Takes a task from the deque of 'self' or, if it is
+	// empty, from the deques of other threads.
+	task* find_task(worker* self);
+
+	static void execute(task* t);
+
+	// Executes 't' and updates the counters of 'self'.
+	static void execute(task* t, worker* self);
+
+	static void* worker_main(void* arg);
+
+	// Stops the worker threads and frees the resources.
+	void release();
+
+	virtual ~impl();
+
+	size_t concurrency;
+	size_t worker_count;
+	size_t started_count;
+	worker* workers;
+
+	// Tasks submitted by threads that are not workers.
+	task_queue injected;
+
+	// The total number of tasks in all deques.
+	atomic_value<size_t> queued;
+
+	// Round-robin counter for choosing steal victims
+	// in threads that are not workers.
+	atomic_value<size_t> next_victim;
+
+	pthread_mutex_t sleep_mutex;
+	pthread_cond_t wake_condition;
+
+	// The number of workers waiting for the condition.
+	atomic_value<int> sleeping;
+
+	atomic_value<bool> stopping;
+};
+
+thread_pool::impl::impl(size_t c) :
+	concurrency(c),
+	worker_count(c - 1),
+	started_count(0),
+	workers(worker_count > 0 ? new worker[worker_count] : NULL)
+{
+	pthread_once(&current_worker_key_once, create_current_worker_key);
+
+	pthread_mutex_init(&sleep_mutex, NULL);
+	pthread_cond_init(&wake_condition, NULL);
+
+	for (; started_count < worker_count; ++started_count)
+	{
+		worker* w = workers + started_count;
+
+		w->pool = this;
+		w->index = started_count;
+
+		int error = pthread_create(&w->thread, NULL, worker_main, w);
+
+		if (error != 0)
+		{
+			release();
+
+			B_STRING_LITERAL(method_name,
+				"b::thread_pool::thread_pool()");
+
+			throw system_exception(method_name, error);
+		}
+	}
+}
+
+inline thread_pool::impl::worker* thread_pool::impl::current_worker()
+{
+	worker* w = (worker*) pthread_getspecific(current_worker_key);
+
+	return w != NULL && w->pool == this ? w : NULL;
+}
+
+void thread_pool::impl::submit(task* t)
+{
+	worker* self = current_worker();
+
+	if (self != NULL)
+		self->deque.push_back(t);
+	else
+		injected.push_back(t);
+
+	// The sequentially consistent operations on 'queued' and
+	// 'sleeping' here and in worker_main() guarantee that either
+	// this thread sees the sleeping worker or the worker sees
+	// the new task.
+	queued.fetch_add(1);
+
+	if (sleeping.load() > 0)
+	{
+		pthread_mutex_lock(&sleep_mutex);
+		pthread_cond_signal(&wake_condition);
+		pthread_mutex_unlock(&sleep_mutex);
+	}
+}
+
+task* thread_pool::impl::find_task(worker* self)
+{
+	if (queued.load(memory_order_acquire) == 0)
+		return NULL;
+
+	task* t;
+
+	if ((self == NULL || !self->deque.pop_back(&t)) &&
+			(t = injected.pop_front()) == NULL)
+	{
+		// Steal from the other workers starting with
+		// the one that follows this thread.
+		size_t victim = self != NULL ? self->index + 1 :
+			next_victim.fetch_add(1, memory_order_relaxed);
+
+		for (size_t i = 0; i < worker_count; ++i, ++victim)
+		{
+			worker* w = workers + victim % worker_count;
+
+			if (w != self && w->deque.steal(&t))
+				break;
+		}
+
+		if (t == NULL)
+			return NULL;
+
+		if (self != NULL)
+			self->steals.store(self->steals.load(
+				memory_order_relaxed) + 1, memory_order_relaxed);
+	}
+
+	queued.fetch_sub(1, memory_order_relaxed);
+
+	return t;
+}
+
+inline void thread_pool::impl::execute(task* t)
+{
+	// The task object may be destroyed as soon as the
+	// group learns that it has been completed.
+	task_group* group = t->group;
+
+	t->run();
+
+	// Makes the results of the task visible to the
+	// thread that waits for the group.
+	group->pending.fetch_sub(1, memory_order_release);
+}
+
+inline void thread_pool::impl::execute(task* t, worker* self)
+{
+	// Count the task before its group can see it completed.
+	if (self != NULL)
+		self->tasks_executed.store(self->tasks_executed.load(
+			memory_order_relaxed) + 1, memory_order_relaxed);
+
+	execute(t);
+}
+
+void* thread_pool::impl::worker_main(void* arg)
+{
+	worker* self = (worker*) arg;
+	impl* pool = self->pool;
+
+	pthread_setspecific(current_worker_key, self);
+
+	int idle_count = 0;
+	uint64_t idle_since = 0;
+
+	while (!pool->stopping.load(memory_order_acquire))
+	{
+		task* t = pool->find_task(self);
+
+		if (t != NULL)
+		{
+			if (idle_since != 0)
+			{
+				self->idle_nanoseconds.store(
+					self->idle_nanoseconds.load(
+						memory_order_relaxed) +
+					monotonic_nanoseconds() - idle_since,
+					memory_order_relaxed);
+
+				idle_since = 0;
+			}
+
+			execute(t, self);
+			idle_count = 0;
+		}
+		else
+			if (idle_since == 0)
+				idle_since = monotonic_nanoseconds();
+			else if (++idle_count < spin_count)
+				sched_yield();
+			else
+			{
+				pthread_mutex_lock(&pool->sleep_mutex);
+
+				pool->sleeping.fetch_add(1);
+
+				if (pool->queued.load() == 0 &&
+						!pool->stopping.load(memory_order_relaxed))
+					pthread_cond_wait(&pool->wake_condition,
+						&pool->sleep_mutex);
+
+				pool->sleeping.fetch_sub(1, memory_order_relaxed);
+
+				pthread_mutex_unlock(&pool->sleep_mutex);
+
+				idle_count = 0;
+			}
+	}
+
+	return NULL;
+}
+
+void thread_pool::impl::release()
+{
+	pthread_mutex_lock(&sleep_mutex);
+	stopping.store(true, memory_order_release);
+	pthread_cond_broadcast(&wake_condition);
+	pthread_mutex_unlock(&sleep_mutex);
+
+	for (size_t i = 0; i < started_count; ++i)
+		pthread_join(workers[i].thread, NULL);
+
+	delete[] workers;
+
+	pthread_cond_destroy(&wake_condition);
+	pthread_mutex_destroy(&sleep_mutex);
+}
+
+thread_pool::impl::~impl()
+{
+	release();
+}
+
+thread_pool::thread_pool(size_t concurrency)
+{
+	if (concurrency == 0)
+	{
+		long processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+
+		concurrency = processor_count > 0 ? (size_t) processor_count : 1;
+	}
+
+	impl_ref = new impl(concurrency);
+}
+
+size_t thread_pool::concurrency() const
+{
+	return impl_ref->concurrency;
+}
+
+size_t thread_pool::worker_count() const
+{
+	return impl_ref->worker_count;
+}
+
+thread_pool::worker_stats thread_pool::stats(size_t worker_index) const
+{
+	B_ASSERT(worker_index < impl_ref->worker_count);
+
+	const impl::worker* w = impl_ref->workers + worker_index;
+
+	worker_stats s;
+
+	s.tasks_executed = w->tasks_executed.load(memory_order_relaxed);
+	s.steals = w->steals.load(memory_order_relaxed);
+	s.idle_nanoseconds = w->idle_nanoseconds.load(memory_order_relaxed);
+
+	return s;
+}
+
+void thread_pool::reset_stats()
+{
+	for (size_t i = 0; i < impl_ref->worker_count; ++i)
+	{
+		impl::worker* w = impl_ref->workers + i;
+
+		w->tasks_executed.store(0, memory_order_relaxed);
+		w->steals.store(0, memory_order_relaxed);
+		w->idle_nanoseconds.store(0, memory_order_relaxed);
+	}
+}
+
+void thread_pool::submit(task* t)
+{
+	impl_ref->submit(t);
+}
+
+bool thread_pool::run_scheduled_task()
+{
+	task* t = impl_ref->find_task(impl_ref->current_worker());
+
+	if (t == NULL)
+		return false;
+
+	impl::execute(t, impl_ref->current_worker());
+
+	return true;
+}
+
+void task_group::wait()
+{
+	while (pending.load(memory_order_acquire) != 0)
+		if (!pool->run_scheduled_task())
+			sched_yield();
+}
+
+B_END_NAMESPACE
@@ -0,0 +1,220 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/string.h>
+
+namespace
+{
+	const unsigned long replacement_char = 0xFFFD;
+
+	// A word with the high bit set in every byte. A word-sized
+	// chunk of input is pure ASCII if it has none of these bits.
+	const size_t non_ascii_bits = (size_t) -1 / 0xFF * 0x80;
+
+	inline wchar_t* store_code_point(wchar_t* dst, unsigned long cp)
+	{
+		if (sizeof(wchar_t) > 2 || cp < 0x10000)
+			*dst++ = (wchar_t) cp;
+		else
+		{
+			cp -= 0x10000;
+			*dst++ = (wchar_t) (0xD800 | (cp >> 10));
+			*dst++ = (wchar_t) (0xDC00 | (cp & 0x3FF));
+		}
+
+		return dst;
+	}
+
+	inline bool is_continuation_byte(unsigned char ch)
+	{
+		return (ch & 0xC0) == 0x80;
+	}
+
+	// Decodes a non-ASCII UTF-8 sequence. Returns false if the
+	// sequence is malformed, in which case the maximal invalid
+	// subpart of it is consumed, so that it can be replaced with
+	// a single U+FFFD.
+	bool decode_sequence(const unsigned char** src_ptr,
+		const unsigned char* end, unsigned long* cp)
+	{
+		const unsigned char* src = *src_ptr;
+		unsigned char lead = *src++;
+
+		// The number of continuation bytes and the valid
+		// range for the first of them (RFC 3629, section 4).
+		size_t tail_length;
+		unsigned char lower = 0x80, upper = 0xBF;
+
+		if (lead >= 0xC2 && lead <= 0xDF)
+		{
+			tail_length = 1;
+			*cp = lead & 0x1F;
+		}
+		else if (lead >= 0xE0 && lead <= 0xEF)
+		{
+			tail_length = 2;
+			*cp = lead & 0x0F;
+
+			if (lead == 0xE0)
+				lower = 0xA0;
+			else if (lead == 0xED)
+				upper = 0x9F;
+		}
+		else if (lead >= 0xF0 && lead <= 0xF4)
+		{
+			tail_length = 3;
+			*cp = lead & 0x07;
+
+			if (lead == 0xF0)
+				lower = 0x90;
+			else if (lead == 0xF4)
+				upper = 0x8F;
+		}
+		else
+		{
+			*src_ptr = src;
+			return false;
+		}
+
+		if (src < end && *src >= lower && *src <= upper)
+			do
+				*cp = (*cp << 6) | (*src++ & 0x3F);
+			while (--tail_length > 0 && src < end &&
+				is_continuation_byte(*src));
+
+		*src_ptr = src;
+
+		return tail_length == 0;
+	}
+}
+
+B_BEGIN_NAMESPACE
+
+size_t utf8_to_wchar(wchar_t* result, const char* source, size_t length,
+	bool validate)
+{
+	const unsigned char* src = (const unsigned char*) source;
+	const unsigned char* const end = src + length;
+	wchar_t* dst = result;
+
+	while (src < end)
+	{
+		// ASCII fast path: check one machine word at a time.
+		while ((size_t) (end - src) >= sizeof(size_t))
+		{
+			size_t word;
+
+			memory::copy(&word, src, sizeof(word));
+
+			if ((word & non_ascii_bits) != 0)
+				break;
+
+			for (size_t i = 0; i < sizeof(size_t); ++i)
+				*dst++ = (wchar_t) *src++;
+		}
+
+		if (src == end)
+			break;
+
+		if (*src < 0x80)
+		{
+			*dst++ = (wchar_t) *src++;
+			continue;
+		}
+
+		unsigned long cp;
+
+		if (decode_sequence(&src, end, &cp))
+			dst = store_code_point(dst, cp);
+		else
+		{
+			if (validate)
+				return (size_t) -1;
+
+			*dst++ = (wchar_t) replacement_char;
+		}
+	}
+
+	return (size_t) (dst - result);
+}
+
+size_t wchar_to_utf8(char* result, const wchar_t* source, size_t length,
+	bool validate)
+{
+	const wchar_t* const end = source + length;
+	unsigned char* dst = (unsigned char*) result;
+
+	while (source < end)
+	{
+		// ASCII fast path: pass through runs of 7-bit characters.
+		while (source < end && (unsigned long) *source < 0x80)
+			*dst++ = (unsigned char) *source++;
+
+		if (source == end)
+			break;
+
+		unsigned long cp = (unsigned long) *source++;
+
+		if (sizeof(wchar_t) == 2 && cp >= 0xD800 && cp <= 0xDBFF &&
+			source < end && (unsigned long) *source >= 0xDC00 &&
+			(unsigned long) *source <= 0xDFFF)
+		{
+			cp = 0x10000 + ((cp - 0xD800) << 10) +
+				((unsigned long) *source++ - 0xDC00);
+		}
+		else if ((cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF)
+		{
+			if (validate)
+				return (size_t) -1;
+
+			cp = replacement_char;
+		}
+
+		if (cp < 0x800)
+			*dst++ = (unsigned char) (0xC0 | (cp >> 6));
+		else
+		{
+			if (cp < 0x10000)
+				*dst++ = (unsigned char) (0xE0 | (cp >> 12));
+			else
+			{
+				*dst++ = (unsigned char) (0xF0 | (cp >> 18));
+				*dst++ = (unsigned char)
+					(0x80 | ((cp >> 12) & 0x3F));
+			}
+
+			*dst++ = (unsigned char) (0x80 | ((cp >> 6) & 0x3F));
+		}
+
+		*dst++ = (unsigned char) (0x80 | (cp & 0x3F));
+	}
+
+	return (size_t) (dst - (unsigned char*) result);
+}
+
+wstring utf8_to_wstring(const string_view& utf8)
+{
+	wstring wstr;
+
+	// The decoded string cannot be longer than its source,
+	// so the buffer is allocated once and filled in one pass.
+	wstr.reserve(utf8.length());
+
+	wstr.unlock(utf8_to_wchar(wstr.lock(), utf8.data(), utf8.length()));
+
+	return wstr;
+}
+
+string wstring_to_utf8(const wstring_view& wstr)
+{
+	string utf8;
+
+	utf8.reserve(wstr.length() * B_UTF8_MAX_BYTES_PER_WCHAR);
+
+	utf8.unlock(wchar_to_utf8(utf8.lock(), wstr.data(), wstr.length()));
+
+	return utf8;
+}
+
+B_END_NAMESPACE
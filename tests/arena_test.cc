@@ -0,0 +1,220 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/arena.h>
+#include <b/map.h>
+
+#include <pthread.h>
+
+#include "test_case.h"
+
+B_TEST_CASE(allocation)
+{
+	b::arena a(1024);
+
+	B_CHECK(a.total_bytes() == 0);
+	B_CHECK(a.used_bytes() == 0);
+
+	char* first = (char*) a.allocate(10);
+	char* second = (char*) a.allocate(10);
+
+	B_CHECK((size_t) first % B_ARENA_ALIGNMENT == 0);
+	B_CHECK((size_t) second % B_ARENA_ALIGNMENT == 0);
+	B_CHECK(second >= first + 10);
+	B_CHECK(a.total_bytes() == 1024);
+
+	void* aligned = a.allocate(1, 64);
+
+	B_CHECK((size_t) aligned % 64 == 0);
+
+	// An allocation larger than the block size
+	// gets a block of its own.
+	char* large = (char*) a.allocate(5000);
+
+	b::memory::fill(large, 5000, 'x');
+
+	B_CHECK(a.total_bytes() > 1024 + 5000);
+	B_CHECK(a.used_bytes() >= 5021);
+}
+
+B_TEST_CASE(rewind_and_reset)
+{
+	b::arena a(256);
+
+	a.allocate(100);
+
+	b::arena::marker position = a.mark();
+	size_t used = a.used_bytes();
+
+	void* next = a.allocate(16);
+
+	for (int i = 0; i < 100; ++i)
+		a.allocate(100);
+
+	B_CHECK(a.total_bytes() > 256);
+
+	a.rewind(position);
+
+	B_CHECK(a.total_bytes() == 256);
+	B_CHECK(a.used_bytes() == used);
+	B_CHECK(a.allocate(16) == next);
+
+	a.reset();
+
+	B_CHECK(a.total_bytes() == 256);
+	B_CHECK(a.used_bytes() == 0);
+
+	// Rewinding to the initial marker of an empty arena
+	// is the same as resetting it.
+	b::arena empty_arena(256);
+
+	b::arena::marker initial = empty_arena.mark();
+
+	empty_arena.allocate(1000);
+	empty_arena.allocate(10);
+	empty_arena.rewind(initial);
+
+	B_CHECK(empty_arena.used_bytes() == 0);
+}
+
+B_TEST_CASE(large_allocations)
+{
+	b::arena a(1024);
+
+	char* small = (char*) a.allocate(400);
+	size_t used = a.used_bytes();
+
+	b::arena::marker position = a.mark();
+
+	// A request that does not fit in the rest of the block
+	// gets a block of its own, and the following small
+	// allocations continue in the current block.
+	a.allocate(600);
+
+	B_CHECK(a.used_bytes() >= used + 600);
+
+	char* next = (char*) a.allocate(100);
+
+	B_CHECK(next == small + 400);
+	B_CHECK(a.total_bytes() > 1024 + 600);
+	B_CHECK(a.total_bytes() < 2048 + 600);
+
+	a.rewind(position);
+
+	B_CHECK(a.total_bytes() == 1024);
+	B_CHECK(a.used_bytes() == used);
+	B_CHECK(a.allocate(100) == next);
+
+	// Large blocks allocated before a marker survive
+	// rewinding to it.
+	b::arena empty_arena(256);
+
+	empty_arena.allocate(1000);
+
+	b::arena::marker initial = empty_arena.mark();
+	size_t large_used = empty_arena.used_bytes();
+
+	empty_arena.allocate(10);
+	empty_arena.allocate(1000);
+	empty_arena.rewind(initial);
+
+	B_CHECK(empty_arena.used_bytes() == large_used);
+	B_CHECK(empty_arena.total_bytes() >= 256 + 1000);
+
+	empty_arena.reset();
+
+	B_CHECK(empty_arena.used_bytes() == 0);
+	B_CHECK(empty_arena.total_bytes() == 256);
+}
+
+B_TEST_CASE(alignment_past_block_end)
+{
+	b::arena a(1000);
+
+	a.allocate(400);
+	a.allocate(400);
+	a.allocate(160);
+
+	a.allocate(1);
+
+	// Block ends are not aligned on 64 bytes, so aligning
+	// the position moves it past the end of each block
+	// once the block is full.
+	for (int i = 0; i < 100; ++i)
+	{
+		char* aligned = (char*) a.allocate(1, 64);
+
+		B_CHECK((size_t) aligned % 64 == 0);
+
+		*aligned = 'x';
+	}
+
+	B_CHECK(a.total_bytes() > 1000);
+	B_CHECK(a.used_bytes() <= a.total_bytes());
+}
+
+B_TEST_CASE(format_into_arena)
+{
+	b::arena a;
+
+	b::string_view formatted = b::format_buffer(&a, "%d-%s", 42, "x");
+
+	B_CHECK(formatted == "42-x");
+}
+
+B_TEST_CASE(map_with_arena)
+{
+	b::arena a;
+
+	{
+		b::map<int, b::string> m(&a);
+
+		for (int i = 0; i < 100; ++i)
+			m.insert(i, b::string::formatted("%d", i));
+
+		B_CHECK(m.size() == 100);
+		B_CHECK(*m.find(42) == "42");
+
+		B_CHECK(m.remove(42));
+		B_CHECK(m.find(42) == NULL);
+	}
+
+	B_CHECK(a.used_bytes() > 0);
+
+	a.reset();
+
+	B_CHECK(a.used_bytes() == 0);
+}
+
+static void* get_scratch_arena(void*)
+{
+	return b::arena::scratch();
+}
+
+B_TEST_CASE(scratch_arena)
+{
+	b::arena* scratch = b::arena::scratch();
+
+	B_REQUIRE(scratch != NULL);
+	B_CHECK(b::arena::scratch() == scratch);
+
+	{
+		b::arena_scope scope(scratch);
+
+		scratch->allocate(100000);
+
+		B_CHECK(scratch->used_bytes() >= 100000);
+	}
+
+	B_CHECK(scratch->used_bytes() == 0);
+
+	pthread_t thread;
+	void* other_scratch;
+
+	B_REQUIRE(pthread_create(&thread, NULL,
+		get_scratch_arena, NULL) == 0);
+	pthread_join(thread, &other_scratch);
+
+	B_CHECK(other_scratch != scratch);
+}
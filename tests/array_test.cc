@@ -165,6 +165,27 @@ B_TEST_CASE(insertion)
 	run_insertion_test(5U);
 }
 
+B_TEST_CASE(object_insertion)
+{
+	{
+		test_array elements;
+
+		elements.discard_and_alloc(10);
+
+		// Leave room for the missing element in place,
+		// so that the tail is shifted by assignment.
+		for (int i = 0; i < 5; ++i)
+			elements.append(test_element(i < 2 ? i : i + 1));
+
+		elements.insert(2, 1, test_element(2));
+
+		for (int i = 0; i < 6; ++i)
+			B_CHECK(elements[(size_t) i].value == i);
+	}
+
+	B_CHECK(element_counter == 0);
+}
+
 B_TEST_CASE(shuffle)
 {
 	b::array<unsigned> numbers = sequence_of_numbers<unsigned>(100);
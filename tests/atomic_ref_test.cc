@@ -0,0 +1,162 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/atomic_ref.h>
+
+#include "test_case.h"
+
+#include <sched.h>
+
+class config : public b::shared_object
+{
+public:
+	config(int v) : version(v), checksum(~v)
+	{
+		instance_count.fetch_add(1, b::memory_order_relaxed);
+	}
+
+	virtual ~config()
+	{
+		// Damage the object so that readers
+		// of a deleted object notice it.
+		checksum = version;
+
+		instance_count.fetch_sub(1, b::memory_order_relaxed);
+	}
+
+	bool is_intact() const
+	{
+		return checksum == ~version;
+	}
+
+	int version;
+	int checksum;
+
+	static b::atomic_value<int> instance_count;
+};
+
+b::atomic_value<int> config::instance_count;
+
+static int live_configs()
+{
+	return config::instance_count.load(b::memory_order_relaxed);
+}
+
+B_TEST_CASE(basic_operations)
+{
+	{
+		b::atomic_ref<config> current;
+
+		B_CHECK(current.load().is_null());
+
+		b::ref<config> first = new config(1);
+
+		current.store(first);
+
+		B_CHECK(current.load() == first);
+
+		b::ref<config> previous = current.exchange(new config(2));
+
+		B_CHECK(previous == first);
+		B_CHECK(current.load()->version == 2);
+
+		first = previous = NULL;
+
+		B_CHECK(live_configs() == 1);
+
+		b::ref<config> expected = new config(3);
+
+		B_CHECK(!current.compare_exchange(&expected, new config(4)));
+		B_CHECK(expected->version == 2);
+
+		B_CHECK(current.compare_exchange(&expected, new config(5)));
+		B_CHECK(expected->version == 2);
+		B_CHECK(current.load()->version == 5);
+
+		expected = NULL;
+
+		B_CHECK(live_configs() == 1);
+	}
+
+	B_CHECK(live_configs() == 0);
+
+	{
+		b::atomic_ref<config> initialized(new config(6));
+
+		B_CHECK(initialized.load()->version == 6);
+	}
+
+	B_CHECK(live_configs() == 0);
+}
+
+#define READER_COUNT 3
+#define READS 20000
+#define UPDATES 5000
+
+static b::atomic_ref<config>* shared_config;
+static b::atomic_value<int> damaged_reads;
+
+static void* read_configs(void*)
+{
+	int last_version = 0;
+
+	for (int i = 0; i < READS; ++i)
+	{
+		b::ref<config> c = shared_config->load();
+
+		if (!c->is_intact() || c->version < last_version)
+			damaged_reads.fetch_add(1, b::memory_order_relaxed);
+
+		last_version = c->version;
+
+		if (i % 16 == 0)
+			sched_yield();
+	}
+
+	return NULL;
+}
+
+static void* update_configs(void*)
+{
+	for (int i = 0; i < UPDATES; ++i)
+	{
+		b::ref<config> c = shared_config->load();
+
+		// Only one of the concurrent updates of the
+		// same version succeeds.
+		while (!shared_config->compare_exchange(&c,
+				new config(c->version + 1)))
+			;
+	}
+
+	return NULL;
+}
+
+B_TEST_CASE(concurrent_updates)
+{
+	{
+		b::atomic_ref<config> current(new config(0));
+
+		shared_config = &current;
+
+		pthread_t threads[READER_COUNT + 2];
+
+		for (size_t i = 0; i < READER_COUNT; ++i)
+			B_REQUIRE(pthread_create(threads + i, NULL,
+				read_configs, NULL) == 0);
+
+		for (size_t i = READER_COUNT; i < B_COUNTOF(threads); ++i)
+			B_REQUIRE(pthread_create(threads + i, NULL,
+				update_configs, NULL) == 0);
+
+		for (size_t i = 0; i < B_COUNTOF(threads); ++i)
+			pthread_join(threads[i], NULL);
+
+		B_CHECK(damaged_reads.load(b::memory_order_relaxed) == 0);
+		B_CHECK(current.load()->version == UPDATES * 2);
+		B_CHECK(live_configs() == 1);
+	}
+
+	B_CHECK(live_configs() == 0);
+}
@@ -6,6 +6,11 @@
 
 #include "test_case.h"
 
+#include <pthread.h>
+
+template class b::atomic_value<int>;
+template class b::atomic_value<size_t>;
+
 B_TEST_CASE(atomic)
 {
 	b::atomic refs = B_ATOMIC_INIT(1);
@@ -21,3 +26,89 @@ B_TEST_CASE(atomic)
 
 	B_CHECK(!--refs);
 }
+
+B_TEST_CASE(atomic_value)
+{
+	b::atomic_value<int> value;
+
+	B_CHECK(value.load() == 0);
+
+	value.store(5, b::memory_order_release);
+
+	B_CHECK(value.load(b::memory_order_acquire) == 5);
+	B_CHECK(value.exchange(7) == 5);
+	B_CHECK(value.fetch_add(3, b::memory_order_relaxed) == 7);
+	B_CHECK(value.fetch_sub(4) == 10);
+	B_CHECK(value.load(b::memory_order_relaxed) == 6);
+
+	int expected = 5;
+
+	B_CHECK(!value.compare_exchange(&expected, 8));
+	B_CHECK(expected == 6);
+
+	B_CHECK(value.compare_exchange(&expected, 8,
+		b::memory_order_acq_rel));
+	B_CHECK(expected == 6);
+	B_CHECK(value.load() == 8);
+}
+
+B_TEST_CASE(atomic_pointer)
+{
+	int numbers[2] = {1, 2};
+
+	b::atomic_value<int*> pointer(numbers);
+
+	B_CHECK(pointer.load() == numbers);
+
+	int* expected = numbers;
+
+	B_CHECK(pointer.compare_exchange(&expected, numbers + 1,
+		b::memory_order_release));
+	B_CHECK(*pointer.load(b::memory_order_acquire) == 2);
+	B_CHECK(pointer.exchange(NULL) == numbers + 1);
+	B_CHECK(pointer.load() == NULL);
+}
+
+#define THREAD_COUNT 4
+#define INCREMENT_COUNT 10000
+
+struct counters
+{
+	b::atomic_value<size_t> added;
+	b::atomic_value<size_t> swapped;
+};
+
+static void* increment(void* arg)
+{
+	counters* shared = static_cast<counters*>(arg);
+
+	for (size_t i = 0; i < INCREMENT_COUNT; ++i)
+	{
+		shared->added.fetch_add(1, b::memory_order_relaxed);
+
+		size_t expected = shared->swapped.load(b::memory_order_relaxed);
+
+		while (!shared->swapped.compare_exchange(&expected,
+				expected + 1, b::memory_order_relaxed))
+			;
+	}
+
+	return NULL;
+}
+
+B_TEST_CASE(concurrent_updates)
+{
+	counters shared;
+
+	pthread_t threads[THREAD_COUNT];
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		B_REQUIRE(pthread_create(threads + i, NULL,
+			increment, &shared) == 0);
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		pthread_join(threads[i], NULL);
+
+	B_CHECK(shared.added.load() == THREAD_COUNT * INCREMENT_COUNT);
+	B_CHECK(shared.swapped.load() == THREAD_COUNT * INCREMENT_COUNT);
+}
@@ -0,0 +1,94 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/blocking_queue.h>
+#include <b/mpmc_queue.h>
+#include <b/spsc_queue.h>
+
+#include "test_case.h"
+
+template class b::blocking_queue<b::mpmc_queue<int> >;
+template class b::blocking_queue<b::spsc_queue<int> >;
+
+B_TEST_CASE(non_blocking_operations)
+{
+	b::blocking_queue<b::spsc_queue<int> > queue(2);
+
+	B_CHECK(queue.capacity() == 2);
+
+	B_CHECK(queue.try_push(1));
+	queue.push(2);
+	B_CHECK(!queue.try_push(3));
+
+	int value;
+
+	queue.pop(&value);
+	B_CHECK(value == 1);
+	B_CHECK(queue.try_pop(&value));
+	B_CHECK(value == 2);
+	B_CHECK(!queue.try_pop(&value));
+}
+
+#define THREAD_COUNT 3
+#define ITEMS_PER_THREAD 10000
+
+// A capacity this small makes both the producers
+// and the consumers wait most of the time.
+typedef b::blocking_queue<b::mpmc_queue<size_t> > queue_type;
+
+static queue_type* shared_queue;
+static b::atomic_value<size_t> consumed_sum;
+
+static void* produce(void* arg)
+{
+	size_t first = (size_t) arg * ITEMS_PER_THREAD;
+
+	for (size_t i = first; i < first + ITEMS_PER_THREAD; ++i)
+		shared_queue->push(i);
+
+	return NULL;
+}
+
+static void* consume(void*)
+{
+	size_t sum = 0;
+
+	for (size_t i = 0; i < ITEMS_PER_THREAD; ++i)
+	{
+		size_t value;
+
+		shared_queue->pop(&value);
+
+		sum += value;
+	}
+
+	consumed_sum.fetch_add(sum);
+
+	return NULL;
+}
+
+B_TEST_CASE(waiting_producers_and_consumers)
+{
+	queue_type queue(2);
+
+	shared_queue = &queue;
+
+	pthread_t threads[THREAD_COUNT * 2];
+
+	// Start the consumers first so that they have to wait.
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		B_REQUIRE(pthread_create(threads + THREAD_COUNT + i, NULL,
+			consume, NULL) == 0);
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		B_REQUIRE(pthread_create(threads + i, NULL,
+			produce, (void*) i) == 0);
+
+	for (size_t i = 0; i < B_COUNTOF(threads); ++i)
+		pthread_join(threads[i], NULL);
+
+	size_t n = THREAD_COUNT * ITEMS_PER_THREAD;
+
+	B_CHECK(consumed_sum.load() == n * (n - 1) / 2);
+}
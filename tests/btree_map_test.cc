@@ -0,0 +1,216 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/btree_map.h>
+
+#include "test_case.h"
+
+template class b::btree_map<int, int>;
+
+typedef b::btree_map<int, int> int_map;
+
+B_TEST_CASE(construction)
+{
+	int_map m;
+
+	B_CHECK(m.is_empty());
+	B_CHECK(m.size() == 0);
+	B_CHECK(m.first() == NULL);
+	B_CHECK(m.begin() == m.end());
+
+	bool new_element;
+
+	b::kv_pair<int, int>* kv = m.insert(6, 6, &new_element);
+
+	B_CHECK(new_element == true);
+	B_CHECK(m.size() == 1);
+	B_CHECK(kv->key == 6);
+	B_CHECK(kv->value == 6);
+
+	int* v = m.find(6);
+
+	B_REQUIRE(v != NULL);
+	B_CHECK(*v == 6);
+
+	kv = m.insert(6, 7, &new_element);
+
+	B_CHECK(new_element == false);
+	B_CHECK(m.size() == 1);
+	B_CHECK(kv->key == 6);
+	B_CHECK(kv->value == 7);
+
+	kv->value = 8;
+	B_CHECK(*m.find(6) == 8);
+
+	B_CHECK(m.remove(6));
+	B_CHECK(!m.remove(6));
+	B_CHECK(!m.remove(10));
+	B_CHECK(m.is_empty());
+}
+
+// Checks that iteration in both directions visits exactly
+// the keys that are marked as present.
+static void check_contents(const int_map& m, const bool* present,
+	size_t key_range)
+{
+	int_map::const_iterator it = m.begin();
+
+	size_t count = 0;
+
+	for (size_t key = 0; key < key_range; ++key)
+		if (present[key])
+		{
+			B_REQUIRE(it != m.end());
+			B_CHECK(it->key == (int) key);
+			B_CHECK(it->value == (int) key * 10);
+
+			++it;
+			++count;
+		}
+
+	B_CHECK(it == m.end());
+	B_CHECK(m.size() == count);
+
+	if (count > 0)
+	{
+		B_CHECK(m.first()->key == m.begin()->key);
+
+		it = m.lower_bound(m.last()->key);
+
+		for (size_t key = key_range; key-- > 0; )
+			if (present[key])
+			{
+				B_REQUIRE(it != m.end());
+				B_CHECK(it->key == (int) key);
+
+				--it;
+			}
+
+		B_CHECK(it == m.end());
+	}
+}
+
+B_TEST_CASE(random_operations)
+{
+	// Enough keys for a tree of three levels.
+	const size_t key_range = 5000;
+
+	bool present[key_range];
+
+	for (size_t key = 0; key < key_range; ++key)
+		present[key] = false;
+
+	int_map m;
+
+	b::pseudorandom prng(3);
+
+	for (int round = 0; round < 4; ++round)
+	{
+		// Insertions prevail in even rounds,
+		// removals in odd rounds.
+		size_t insert_share = round % 2 == 0 ? 3 : 1;
+
+		for (int i = 0; i < 20000; ++i)
+		{
+			int key = (int) prng.next(key_range);
+
+			if (prng.next(4) < insert_share)
+			{
+				bool new_element;
+
+				m.insert(key, key * 10, &new_element);
+
+				B_CHECK(new_element == !present[key]);
+
+				present[key] = true;
+			}
+			else
+			{
+				B_CHECK(m.remove(key) == present[key]);
+
+				present[key] = false;
+			}
+		}
+
+		check_contents(m, present, key_range);
+
+		for (size_t key = 0; key < key_range; ++key)
+		{
+			int* value = m.find((int) key);
+
+			B_CHECK(present[key] ? value != NULL &&
+				*value == (int) key * 10 : value == NULL);
+		}
+	}
+
+	for (size_t key = 0; key < key_range; ++key)
+		m.remove((int) key);
+
+	B_CHECK(m.is_empty());
+	B_CHECK(m.first() == NULL);
+}
+
+B_TEST_CASE(assign_sorted)
+{
+	const size_t key_range = 3000;
+
+	b::array<b::kv_pair<int, int> > sorted;
+	bool present[key_range];
+
+	for (size_t key = 0; key < key_range; ++key)
+		if ((present[key] = key % 3 != 0))
+			sorted.append(b::kv_pair<int, int>(
+				(int) key, (int) key * 10));
+
+	int_map m;
+
+	m.insert(-1, -1);
+
+	m.assign_sorted(sorted.data(), sorted.length());
+
+	check_contents(m, present, key_range);
+
+	// The bulk-loaded tree must support updates.
+	for (size_t key = 0; key < key_range; key += 3)
+	{
+		m.insert((int) key, (int) key * 10);
+		present[key] = true;
+	}
+
+	for (size_t key = 1; key < key_range; key += 2)
+	{
+		B_CHECK(m.remove((int) key));
+		present[key] = false;
+	}
+
+	check_contents(m, present, key_range);
+
+	int_map::const_iterator it = m.lower_bound(1001);
+
+	B_REQUIRE(it != m.end());
+	B_CHECK(it->key == 1002);
+
+	B_CHECK(m.lower_bound((int) key_range) == m.end());
+}
+
+B_TEST_CASE(string_keys)
+{
+	b::btree_map<b::string, int> m;
+
+	for (int i = 0; i < 1000; ++i)
+		m.insert(b::string::formatted("key%04d", i), i);
+
+	for (int i = 0; i < 1000; i += 2)
+		B_CHECK(m.remove(b::string::formatted("key%04d", i)));
+
+	B_CHECK(m.size() == 500);
+
+	int expected = 1;
+
+	for (b::btree_map<b::string, int>::const_iterator it = m.begin();
+			it != m.end(); ++it, expected += 2)
+		B_CHECK(it->value == expected);
+
+	B_CHECK(*m.find(b::string::formatted("key%04d", 999)) == 999);
+}
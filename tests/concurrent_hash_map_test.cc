@@ -0,0 +1,221 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/concurrent_hash_map.h>
+#include <b/shared_object.h>
+
+#include "test_case.h"
+
+#include <pthread.h>
+
+template class b::concurrent_hash_map<b::string, int>;
+
+static b::string_view sv(const char* s)
+{
+	return b::string_view(s, b::calc_length(s));
+}
+
+static b::string str(const char* s)
+{
+	return b::string(s, b::calc_length(s));
+}
+
+static b::string key_for(int i)
+{
+	return b::string::formatted("key%d", i);
+}
+
+B_TEST_CASE(basic_operations)
+{
+	b::concurrent_hash_map<b::string, int> map(4);
+
+	B_CHECK(map.stripe_count() == 4);
+	B_CHECK(map.size() == 0);
+
+	int value = -1;
+
+	B_CHECK(!map.find(sv("one"), &value));
+	B_CHECK(value == -1);
+
+	B_CHECK(map.insert(str("one"), 1));
+	B_CHECK(map.insert(str("two"), 2));
+	B_CHECK(!map.insert(str("one"), 11));
+	B_CHECK(!map.try_insert(str("two"), 22));
+	B_CHECK(map.try_insert(str("three"), 3));
+
+	B_CHECK(map.size() == 3);
+
+	B_CHECK(map.find(sv("one"), &value) && value == 11);
+	B_CHECK(map.find(str("two"), &value) && value == 2);
+	B_CHECK(map.contains(sv("three")));
+
+	B_CHECK(map.remove(sv("two")));
+	B_CHECK(!map.remove(sv("two")));
+	B_CHECK(!map.contains(sv("two")));
+	B_CHECK(map.size() == 2);
+
+	map.clear();
+
+	B_CHECK(map.size() == 0);
+	B_CHECK(!map.contains(sv("one")));
+
+	B_CHECK(map.insert(str("one"), 1));
+	B_CHECK(map.size() == 1);
+}
+
+B_TEST_CASE(growth)
+{
+	b::concurrent_hash_map<b::string, int> map(2);
+
+	for (int i = 0; i < 1000; ++i)
+		B_CHECK(map.insert(key_for(i), i));
+
+	B_CHECK(map.size() == 1000);
+
+	bool all_found = true;
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		int value;
+
+		if (!map.find(key_for(i), &value) || value != i)
+			all_found = false;
+	}
+
+	B_CHECK(all_found);
+
+	for (int i = 0; i < 1000; i += 2)
+		B_CHECK(map.remove(key_for(i)));
+
+	B_CHECK(map.size() == 500);
+	B_CHECK(!map.contains(key_for(10)));
+	B_CHECK(map.contains(key_for(11)));
+}
+
+class entry : public b::shared_object
+{
+public:
+	explicit entry(int n) : id(n)
+	{
+		instance_count.fetch_add(1);
+	}
+
+	virtual ~entry()
+	{
+		instance_count.fetch_sub(1);
+	}
+
+	const int id;
+
+	static b::atomic_value<int> instance_count;
+};
+
+b::atomic_value<int> entry::instance_count;
+
+typedef b::concurrent_hash_map<b::string, b::ref<entry> > entry_map;
+
+B_TEST_CASE(shared_values)
+{
+	{
+		entry_map map;
+
+		map.insert(str("a"), new entry(1));
+		map.insert(str("b"), new entry(2));
+
+		B_CHECK(entry::instance_count.load() == 2);
+
+		b::ref<entry> a;
+
+		B_CHECK(map.find(sv("a"), &a) && a->id == 1);
+
+		// The removed value lives on while there
+		// are references to it.
+		map.remove(sv("a"));
+
+		B_CHECK(entry::instance_count.load() == 2);
+		B_CHECK(a->id == 1);
+
+		a = NULL;
+
+		B_CHECK(entry::instance_count.load() == 1);
+
+		map.insert(str("b"), new entry(3));
+
+		B_CHECK(entry::instance_count.load() == 1);
+	}
+
+	B_CHECK(entry::instance_count.load() == 0);
+}
+
+#define KEY_COUNT 64
+#define READER_COUNT 4
+#define WRITER_ITERATIONS 2000
+#define READER_ITERATIONS 20000
+
+static entry_map shared_map(8);
+static b::string keys[KEY_COUNT];
+static b::atomic_value<size_t> mismatches;
+
+// Replaces and removes elements while the readers look them up.
+static void* write(void*)
+{
+	for (int i = 0; i < WRITER_ITERATIONS; ++i)
+	{
+		int k = i % KEY_COUNT;
+
+		if (i % 3 == 0)
+			shared_map.remove(keys[k]);
+		else
+			shared_map.insert(keys[k], new entry(k));
+	}
+
+	return NULL;
+}
+
+static void* read(void* arg)
+{
+	size_t first_key = (size_t) arg;
+
+	for (size_t i = 0; i < READER_ITERATIONS; ++i)
+	{
+		size_t k = (first_key + i) % KEY_COUNT;
+
+		b::ref<entry> value;
+
+		if (shared_map.find(b::string_view(keys[k]), &value) &&
+				value->id != (int) k)
+			mismatches.fetch_add(1);
+	}
+
+	return NULL;
+}
+
+B_TEST_CASE(concurrent_readers_and_writer)
+{
+	for (int k = 0; k < KEY_COUNT; ++k)
+	{
+		keys[k] = key_for(k);
+		shared_map.insert(keys[k], new entry(k));
+	}
+
+	pthread_t writer;
+	pthread_t readers[READER_COUNT];
+
+	B_REQUIRE(pthread_create(&writer, NULL, write, NULL) == 0);
+
+	for (size_t i = 0; i < READER_COUNT; ++i)
+		B_REQUIRE(pthread_create(readers + i, NULL,
+			read, (void*) (i * 7)) == 0);
+
+	pthread_join(writer, NULL);
+
+	for (size_t i = 0; i < READER_COUNT; ++i)
+		pthread_join(readers[i], NULL);
+
+	B_CHECK(mismatches.load() == 0);
+
+	shared_map.clear();
+
+	B_CHECK(entry::instance_count.load() == 0);
+}
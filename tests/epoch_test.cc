@@ -0,0 +1,233 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/epoch.h>
+#include <b/shared_object.h>
+
+#include "test_case.h"
+
+#include <sched.h>
+
+static size_t freed_count;
+
+static void count_freed(void*)
+{
+	++freed_count;
+}
+
+B_TEST_CASE(nesting)
+{
+	b::epoch_domain domain;
+
+	B_CHECK(!domain.in_critical_section());
+
+	domain.enter();
+	domain.enter();
+
+	B_CHECK(domain.in_critical_section());
+
+	domain.exit();
+
+	B_CHECK(domain.in_critical_section());
+
+	domain.exit();
+
+	B_CHECK(!domain.in_critical_section());
+
+	{
+		b::epoch_guard guard(domain);
+
+		B_CHECK(domain.in_critical_section());
+	}
+
+	B_CHECK(!domain.in_critical_section());
+}
+
+B_TEST_CASE(deferred_free)
+{
+	freed_count = 0;
+
+	{
+		b::epoch_domain domain;
+
+		int block;
+
+		domain.enter();
+
+		size_t epoch = domain.epoch();
+
+		domain.retire(&block, count_freed);
+
+		// The calling thread itself may still be using the
+		// retired block, so the epoch cannot advance twice.
+		for (int i = 0; i < 5; ++i)
+			B_CHECK(domain.collect() == 1U);
+
+		B_CHECK(domain.epoch() == epoch + 1);
+		B_CHECK(freed_count == 0U);
+
+		domain.exit();
+
+		B_CHECK(domain.collect() == 0U);
+
+		B_CHECK(domain.epoch() == epoch + 2);
+		B_CHECK(freed_count == 1U);
+
+		domain.retire(&block, count_freed);
+	}
+
+	// The destructor frees the remaining blocks.
+	B_CHECK(freed_count == 2U);
+}
+
+#define READER_COUNT 3
+#define VERSION_COUNT 20000
+#define MAGIC 0x5EED
+
+struct version
+{
+	int magic;
+	int number;
+};
+
+static void free_version(void* block)
+{
+	version* v = static_cast<version*>(block);
+
+	v->magic = 0;
+
+	delete v;
+}
+
+static b::epoch_domain* shared_domain;
+static b::atomic_value<version*> current_version;
+static b::atomic_value<int> readers_running;
+static b::atomic_value<int> damaged_reads;
+
+static void* read_versions(void*)
+{
+	int last_number = -1;
+
+	while (last_number < VERSION_COUNT - 1)
+	{
+		b::epoch_guard guard(*shared_domain);
+
+		version* v = current_version.load(b::memory_order_acquire);
+
+		if (v->magic != MAGIC || v->number < last_number)
+			damaged_reads.fetch_add(1, b::memory_order_relaxed);
+
+		last_number = v->number;
+
+		sched_yield();
+	}
+
+	readers_running.fetch_sub(1, b::memory_order_release);
+
+	return NULL;
+}
+
+B_TEST_CASE(concurrent_readers)
+{
+	b::epoch_domain domain;
+
+	shared_domain = &domain;
+
+	version* v = new version;
+
+	v->magic = MAGIC;
+	v->number = 0;
+
+	current_version.store(v, b::memory_order_release);
+	readers_running.store(READER_COUNT, b::memory_order_relaxed);
+
+	pthread_t readers[READER_COUNT];
+
+	for (size_t i = 0; i < READER_COUNT; ++i)
+		B_REQUIRE(pthread_create(readers + i, NULL,
+			read_versions, NULL) == 0);
+
+	for (int number = 1; number < VERSION_COUNT; ++number)
+	{
+		v = new version;
+
+		v->magic = MAGIC;
+		v->number = number;
+
+		domain.retire(current_version.exchange(v,
+			b::memory_order_acq_rel), free_version);
+	}
+
+	for (size_t i = 0; i < READER_COUNT; ++i)
+		pthread_join(readers[i], NULL);
+
+	B_CHECK(readers_running.load(b::memory_order_acquire) == 0);
+	B_CHECK(damaged_reads.load(b::memory_order_relaxed) == 0);
+
+	// Without readers, two collections free everything.
+	domain.collect();
+	B_CHECK(domain.collect() == 0U);
+
+	free_version(current_version.load(b::memory_order_relaxed));
+}
+
+class reclaimed : public b::epoch_reclaimed<b::shared_object>
+{
+public:
+	reclaimed()
+	{
+		++instance_count;
+	}
+
+	virtual ~reclaimed()
+	{
+		--instance_count;
+	}
+
+	static int instance_count;
+};
+
+int reclaimed::instance_count = 0;
+
+B_TEST_CASE(epoch_reclaimed_object)
+{
+	b::epoch_domain& domain = b::epoch_domain::global();
+
+	{
+		b::epoch_guard guard(domain);
+
+		reclaimed* raw_pointer;
+
+		{
+			b::ref<reclaimed> obj = new reclaimed;
+
+			raw_pointer = obj;
+		}
+
+		// The object outlives its last reference
+		// while the critical section lasts.
+		domain.collect();
+
+		B_CHECK(reclaimed::instance_count == 1);
+		B_CHECK(raw_pointer != NULL);
+	}
+
+	domain.collect();
+	domain.collect();
+
+	B_CHECK(reclaimed::instance_count == 0);
+}
+
+// Released after main() returns, when the static objects
+// of the library may already have been destroyed.
+static b::ref<reclaimed> outliving_main;
+
+B_TEST_CASE(reference_outliving_main)
+{
+	int instance_count = reclaimed::instance_count;
+
+	outliving_main = new reclaimed;
+
+	B_CHECK(reclaimed::instance_count == instance_count + 1);
+}
@@ -0,0 +1,82 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/eytzinger_array.h>
+
+#include "test_case.h"
+
+template class b::eytzinger_array<int>;
+
+B_TEST_CASE(empty)
+{
+	b::eytzinger_array<int> empty;
+
+	B_CHECK(empty.is_empty());
+	B_CHECK(empty.length() == 0);
+	B_CHECK(empty.find_lower_bound(1) == NULL);
+	B_CHECK(!empty.contains(1));
+
+	const int key = 1;
+	const int* result = &key;
+
+	empty.find_lower_bound(&key, 1, &result);
+
+	B_CHECK(result == NULL);
+}
+
+B_TEST_CASE(find_lower_bound)
+{
+	int sorted[100];
+
+	for (int i = 0; i < (int) B_COUNTOF(sorted); ++i)
+		sorted[i] = i * 2;
+
+	// Cover complete and incomplete trees.
+	for (size_t count = 1; count <= B_COUNTOF(sorted); ++count)
+	{
+		b::eytzinger_array<int> table(sorted, count);
+
+		B_REQUIRE(table.length() == count);
+
+		for (int value = -1; value <= (int) count * 2; ++value)
+		{
+			const int* element = table.find_lower_bound(value);
+
+			if (value > sorted[count - 1])
+				B_CHECK(element == NULL);
+			else
+			{
+				B_REQUIRE(element != NULL);
+				B_CHECK(*element == value + (value & 1));
+			}
+
+			B_CHECK(table.contains(value) ==
+				(value >= 0 && value % 2 == 0 &&
+					value < (int) count * 2));
+		}
+	}
+}
+
+B_TEST_CASE(batch)
+{
+	b::array<int> sorted;
+
+	for (int i = 0; i < 1000; ++i)
+		sorted.append(i * 10);
+
+	b::eytzinger_array<int> table(sorted);
+
+	int keys[B_LOWER_BOUND_BATCH_SIZE * 2 + 3];
+	const int* results[B_COUNTOF(keys)];
+
+	b::pseudorandom prng(11);
+
+	for (size_t i = 0; i < B_COUNTOF(keys); ++i)
+		keys[i] = (int) prng.next(10100) - 50;
+
+	table.find_lower_bound(keys, B_COUNTOF(keys), results);
+
+	for (size_t i = 0; i < B_COUNTOF(keys); ++i)
+		B_CHECK(results[i] == table.find_lower_bound(keys[i]));
+}
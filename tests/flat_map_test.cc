@@ -0,0 +1,76 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/flat_map.h>
+
+#include "test_case.h"
+
+template class b::flat_map<int, int>;
+
+typedef b::flat_map<int, int> int_map;
+
+B_TEST_CASE(construction)
+{
+	int_map m;
+
+	B_CHECK(m.is_empty());
+	B_CHECK(m.size() == 0);
+
+	bool new_element;
+
+	b::kv_pair<int, int>* kv = m.insert(6, 6, &new_element);
+
+	B_CHECK(new_element == true);
+	B_CHECK(m.size() == 1);
+	B_CHECK(kv->key == 6);
+	B_CHECK(kv->value == 6);
+
+	int_map::search_result sr = m.search(6);
+
+	B_REQUIRE(sr.match() != NULL);
+	B_CHECK(sr.match()->value == 6);
+
+	int* v = m.find(6);
+
+	B_REQUIRE(v != NULL);
+	B_CHECK(*v == 6);
+
+	kv = m.insert(6, 7, &new_element);
+
+	B_CHECK(new_element == false);
+	B_CHECK(m.size() == 1);
+	B_CHECK(kv->key == 6);
+	B_CHECK(kv->value == 7);
+
+	kv->value = 8;
+	B_CHECK(*m.find(6) == 8);
+
+	B_CHECK(m.remove(6));
+	B_CHECK(!m.remove(6));
+	B_CHECK(!m.remove(10));
+}
+
+B_TEST_CASE(assign)
+{
+	typedef b::kv_pair<int, int> kv;
+
+	// The last of the duplicate keys wins.
+	const kv pairs[] = {kv(3, 30), kv(1, 10), kv(3, 31), kv(2, 20)};
+
+	int_map m;
+
+	m.assign(pairs, B_COUNTOF(pairs));
+
+	B_REQUIRE(m.size() == 3);
+
+	B_CHECK(*m.find(1) == 10);
+	B_CHECK(*m.find(2) == 20);
+	B_CHECK(*m.find(3) == 31);
+	B_CHECK(m.find(4) == NULL);
+
+	int key = 1;
+
+	for (int_map::const_iterator it = m.begin(); it != m.end(); ++it)
+		B_CHECK(it->key == key++);
+}
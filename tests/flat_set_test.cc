@@ -0,0 +1,129 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/flat_set.h>
+
+#include "test_case.h"
+
+template class b::flat_set<int>;
+
+typedef b::flat_set<int> int_set;
+
+B_TEST_CASE(construction)
+{
+	int_set s;
+
+	B_CHECK(s.is_empty());
+	B_CHECK(s.size() == 0);
+	B_CHECK(s.first() == NULL);
+
+	bool new_element;
+
+	int* v = s.insert(6, &new_element);
+
+	B_CHECK(new_element == true);
+	B_CHECK(s.size() == 1);
+	B_CHECK(*v == 6);
+
+	int_set::search_result sr = s.search(6);
+
+	v = sr.match();
+
+	B_REQUIRE(v != NULL);
+	B_CHECK(*v == 6);
+
+	v = s.find(6);
+
+	B_REQUIRE(v != NULL);
+	B_CHECK(*v == 6);
+
+	v = s.insert(6, &new_element);
+
+	B_CHECK(new_element == false);
+	B_CHECK(s.size() == 1);
+	B_CHECK(*v == 6);
+
+	sr = s.search(10);
+
+	B_REQUIRE(sr.match() == NULL);
+	B_CHECK(*s.insert_new(10, sr) == 10);
+
+	sr = s.search(2);
+
+	B_REQUIRE(sr.match() == NULL);
+	B_CHECK(*s.insert_new(2, sr) == 2);
+
+	B_CHECK(s.size() == 3);
+	B_CHECK(*s.first() == 2);
+	B_CHECK(*s.last() == 10);
+
+	B_CHECK(s.remove(10));
+	B_CHECK(!s.remove(10));
+	B_CHECK(!s.remove(11));
+	B_CHECK(s.find(10) == NULL);
+}
+
+B_TEST_CASE(iteration)
+{
+	int_set s;
+
+	B_CHECK(*s.insert(20) == 20);
+	B_CHECK(*s.insert(40) == 40);
+	B_CHECK(*s.insert(20) == 20);
+	B_CHECK(*s.insert(30) == 30);
+	B_CHECK(*s.insert(10) == 10);
+
+	int* element = s.first();
+
+	for (int v = 10; v <= 40; v += 10)
+	{
+		B_CHECK(*element == v);
+
+		element = s.next(element);
+	}
+
+	B_CHECK(element == NULL);
+
+	element = s.last();
+
+	for (int v = 40; v >= 10; v -= 10)
+	{
+		B_CHECK(*element == v);
+
+		element = s.prev(element);
+	}
+
+	B_CHECK(element == NULL);
+
+	int expected = 10;
+
+	for (int_set::const_iterator it = s.begin(); it != s.end(); ++it)
+	{
+		B_CHECK(*it == expected);
+
+		expected += 10;
+	}
+}
+
+B_TEST_CASE(assign)
+{
+	static const int values[] = {5, 3, 9, 3, 1, 9, 7, 5};
+
+	int_set s;
+
+	s.insert(100);
+
+	s.assign(values, B_COUNTOF(values));
+
+	B_REQUIRE(s.size() == 5);
+
+	for (int i = 0; i < 5; ++i)
+		B_CHECK(s.data()[i] == i * 2 + 1);
+
+	B_CHECK(s.find(100) == NULL);
+
+	s.assign(values, 0);
+
+	B_CHECK(s.is_empty());
+}
@@ -111,6 +111,53 @@ B_TEST_CASE(shuffle)
 		B_CHECK(numbers[i] == i);
 }
 
+B_TEST_CASE(lower_bound)
+{
+	// Every other number with duplicates: 0 0 2 2 4 4 ...
+	int table[50];
+
+	for (int i = 0; i < (int) B_COUNTOF(table); ++i)
+		table[i] = i & ~1;
+
+	for (size_t count = 0; count <= B_COUNTOF(table); ++count)
+		for (int value = -1; value <= (int) count + 1; ++value)
+		{
+			const int* expected =
+				b::find_lower_bound(table, count, value);
+
+			B_CHECK(b::find_lower_bound_branchless(table,
+				count, value) == expected);
+		}
+}
+
+B_TEST_CASE(lower_bound_batch)
+{
+	int table[1000];
+
+	for (int i = 0; i < (int) B_COUNTOF(table); ++i)
+		table[i] = i * 3;
+
+	// More keys than fit in one batch, including keys
+	// that precede and follow all table elements.
+	int keys[B_LOWER_BOUND_BATCH_SIZE * 3 + 5];
+	size_t positions[B_COUNTOF(keys)];
+
+	b::pseudorandom prng(7);
+
+	for (size_t i = 0; i < B_COUNTOF(keys); ++i)
+		keys[i] = (int) prng.next(3100) - 50;
+
+	for (size_t count = 0; count <= B_COUNTOF(table); count += 111)
+	{
+		b::find_lower_bound_batch(table, count,
+			keys, B_COUNTOF(keys), positions);
+
+		for (size_t i = 0; i < B_COUNTOF(keys); ++i)
+			B_CHECK(positions[i] == (size_t) (b::find_lower_bound(
+				table, count, keys[i]) - table));
+	}
+}
+
 B_STRING_LITERAL(dot_dir, ".");
 
 B_STRING_LITERAL(test_dir, "b_test_dir");
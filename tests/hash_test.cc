@@ -0,0 +1,120 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/string.h>
+#include <b/set.h>
+
+#include "test_case.h"
+
+B_TEST_CASE(hash_bytes)
+{
+	static const char data[] =
+		"0123456789abcdefghijklmnopqrstuvwxyz"
+		"0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+	// Hashes of all prefixes must be distinct; this covers
+	// all code paths for short and long inputs.
+	b::set<size_t> hash_values;
+
+	for (size_t length = 0; length < sizeof(data); ++length)
+	{
+		size_t hash_value = b::hash_bytes(data, length);
+
+		B_CHECK(hash_value == b::hash_bytes(data, length));
+		B_CHECK(hash_values.insert(hash_value));
+	}
+
+	// A single bit flip must change the hash value.
+	char copy[sizeof(data)];
+
+	b::memory::copy(copy, data, sizeof(data));
+	copy[50] ^= 1;
+
+	B_CHECK(b::hash_bytes(copy, sizeof(data)) !=
+		b::hash_bytes(data, sizeof(data)));
+}
+
+B_TEST_CASE(string_and_view_hashes)
+{
+	b::string str(B_STRING_VIEW("The quick brown fox"));
+
+	B_CHECK(b::hash(str) == b::hash(str.substr(0, str.length())));
+	B_CHECK(b::hash(str) == b::hash(B_STRING_VIEW("The quick brown fox")));
+
+	static const wchar_t wide_chars[] = L"wide";
+
+	b::wstring wstr(wide_chars, B_COUNTOF(wide_chars) - 1);
+
+	B_CHECK(b::hash(wstr) ==
+		b::hash(b::wstring_view(wide_chars, B_COUNTOF(wide_chars) - 1)));
+
+	B_CHECK(b::hash(b::string()) == b::hash(b::string_view()));
+
+	B_STRING_LITERAL(literal, "literal");
+
+	B_CHECK(b::hash(literal) == b::hash(B_STRING_VIEW("literal")));
+	B_CHECK(b::hash(literal) == b::hash(literal));
+}
+
+static bool hash_is_current(const b::string& str)
+{
+	return str.hash() == b::hash(str.substr(0, str.length()));
+}
+
+B_TEST_CASE(hash_invalidation)
+{
+	b::string str(B_STRING_VIEW("abcdef"));
+
+	str.reserve(100);
+
+	size_t original_hash = str.hash();
+
+	// Copies share the buffer and its cached hash value.
+	b::string copy(str);
+
+	B_CHECK(copy.hash() == original_hash);
+
+	str.append('g');
+	B_CHECK(hash_is_current(str));
+	B_CHECK(copy.hash() == original_hash);
+
+	str.hash();
+	str.replace(0, 'x', 1);
+	B_CHECK(hash_is_current(str));
+
+	str.hash();
+	str.insert(1, 'y');
+	B_CHECK(hash_is_current(str));
+
+	str.hash();
+	str.remove(0);
+	B_CHECK(hash_is_current(str));
+
+	str.hash();
+	str.truncate(3);
+	B_CHECK(hash_is_current(str));
+
+	str.hash();
+	str[0] = 'z';
+	B_CHECK(hash_is_current(str));
+
+	str.hash();
+	str.lock()[1] = 'z';
+	str.unlock();
+	B_CHECK(hash_is_current(str));
+
+	str.hash();
+	str.assign(B_STRING_VIEW("abc"));
+	B_CHECK(hash_is_current(str));
+
+	str.hash();
+	str.trim_left(B_STRING_VIEW("a"));
+	B_CHECK(hash_is_current(str));
+
+	str.hash();
+	str.empty();
+	B_CHECK(hash_is_current(str));
+
+	B_CHECK(copy.hash() == original_hash);
+}
@@ -25,3 +25,74 @@ B_TEST_CASE(heapsort)
 		prev_value = data[i];
 	}
 }
+
+template <class T>
+static bool is_binary_heap(const T* data, size_t size)
+{
+	for (size_t i = 1; i < size; ++i)
+		if (data[i >> 1] < data[i])
+			return false;
+
+	return true;
+}
+
+B_TEST_CASE(make_heap)
+{
+	b::pseudorandom rand(321);
+
+	for (size_t size = 0; size < 50; ++size)
+	{
+		int data[50];
+
+		for (size_t i = 0; i < size; ++i)
+			data[i] = (int) rand.next(20);
+
+		b::make_heap(data, size);
+
+		B_CHECK(is_binary_heap(data, size));
+	}
+}
+
+template <size_t D, class T>
+static bool is_dary_heap(const T* data, size_t size)
+{
+	for (size_t i = 1; i < size; ++i)
+		if (data[(i - 1) / D] < data[i])
+			return false;
+
+	return true;
+}
+
+B_TEST_CASE(dary_heap)
+{
+	b::pseudorandom rand(456);
+
+	int data[1000];
+
+	for (size_t i = 0; i < B_COUNTOF(data); ++i)
+	{
+		data[i] = (int) rand.next(500);
+
+		b::push_into_dary_heap<4>(data, i + 1);
+	}
+
+	B_REQUIRE(is_dary_heap<4>(data, B_COUNTOF(data)));
+
+	for (size_t size = B_COUNTOF(data); size > 1; --size)
+	{
+		b::pop_from_dary_heap<4>(data, size);
+
+		B_CHECK(!(data[size - 1] < data[0]));
+	}
+
+	// The array is now sorted in ascending order.
+	for (size_t i = 1; i < B_COUNTOF(data); ++i)
+		B_CHECK(!(data[i] < data[i - 1]));
+
+	for (size_t i = 0; i < B_COUNTOF(data); ++i)
+		data[i] = (int) rand.next(500);
+
+	b::make_dary_heap<3>(data, B_COUNTOF(data));
+
+	B_CHECK(is_dary_heap<3>(data, B_COUNTOF(data)));
+}
@@ -0,0 +1,215 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/lock_free_list.h>
+#include <b/node_access_via_cast.h>
+
+#include "test_case.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+class work_item;
+
+class stack_node : public b::concurrent_list_node<work_item>
+{
+};
+
+class queue_node : public b::concurrent_list_node<work_item>
+{
+};
+
+// An element that can be in a stack and a queue at the same time.
+class work_item : public stack_node, public queue_node
+{
+public:
+	size_t producer;
+	size_t sequence;
+};
+
+typedef b::lock_free_stack<b::node_access_via_cast<stack_node> > item_stack;
+typedef b::intrusive_mpsc_queue<
+	b::node_access_via_cast<queue_node> > item_queue;
+
+template class b::lock_free_stack<b::node_access_via_cast<stack_node> >;
+template class b::intrusive_mpsc_queue<b::node_access_via_cast<queue_node> >;
+
+B_TEST_CASE(stack)
+{
+	item_stack stack;
+
+	B_CHECK(stack.is_empty());
+	B_CHECK(stack.pop() == NULL);
+
+	work_item items[3];
+
+	for (size_t i = 0; i < B_COUNTOF(items); ++i)
+		stack.push(items + i);
+
+	B_CHECK(!stack.is_empty());
+	B_CHECK(stack.pop() == items + 2);
+
+	stack.push(items + 2);
+
+	work_item* item = stack.pop_all();
+
+	B_CHECK(stack.is_empty());
+
+	for (size_t i = B_COUNTOF(items); i-- > 0; )
+	{
+		B_CHECK(item == items + i);
+		item = item_stack::next(item);
+	}
+
+	B_CHECK(item == NULL);
+	B_CHECK(stack.pop_all() == NULL);
+}
+
+B_TEST_CASE(queue)
+{
+	item_queue queue;
+
+	B_CHECK(queue.pop() == NULL);
+
+	work_item items[4];
+
+	queue.push(items);
+
+	B_CHECK(queue.pop() == items);
+	B_CHECK(queue.pop() == NULL);
+
+	for (size_t i = 0; i < B_COUNTOF(items); ++i)
+		queue.push(items + i);
+
+	// The same element can be in a stack at the same time.
+	item_stack stack;
+
+	stack.push(items + 1);
+
+	for (size_t i = 0; i < B_COUNTOF(items); ++i)
+		B_CHECK(queue.pop() == items + i);
+
+	B_CHECK(queue.pop() == NULL);
+	B_CHECK(stack.pop() == items + 1);
+}
+
+#define THREAD_COUNT 4
+#define ITEMS_PER_THREAD 1000
+#define ROUNDS 20000
+
+static item_stack shared_stack;
+
+// Pops elements and pushes them back, which makes the same
+// elements appear at the top repeatedly.
+static void* juggle(void*)
+{
+	for (size_t i = 0; i < ROUNDS; ++i)
+	{
+		work_item* first = shared_stack.pop();
+		work_item* second = shared_stack.pop();
+
+		if (first != NULL)
+			shared_stack.push(first);
+
+		if (second != NULL)
+			shared_stack.push(second);
+	}
+
+	return NULL;
+}
+
+B_TEST_CASE(concurrent_stack)
+{
+	static work_item items[THREAD_COUNT * ITEMS_PER_THREAD];
+
+	for (size_t i = 0; i < B_COUNTOF(items); ++i)
+		shared_stack.push(items + i);
+
+	pthread_t threads[THREAD_COUNT];
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		B_REQUIRE(pthread_create(threads + i, NULL,
+			juggle, NULL) == 0);
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		pthread_join(threads[i], NULL);
+
+	// No element is lost or duplicated.
+	static bool seen[B_COUNTOF(items)];
+
+	size_t count = 0;
+	bool unique = true;
+
+	for (work_item* item = shared_stack.pop_all(); item != NULL;
+			item = item_stack::next(item), ++count)
+	{
+		size_t index = (size_t) (item - items);
+
+		if (index >= B_COUNTOF(items) || seen[index])
+		{
+			unique = false;
+			break;
+		}
+
+		seen[index] = true;
+	}
+
+	B_CHECK(unique);
+	B_CHECK(count == B_COUNTOF(items));
+}
+
+static item_queue shared_queue;
+static work_item queued_items[THREAD_COUNT][ITEMS_PER_THREAD];
+
+static void* produce(void* arg)
+{
+	size_t producer = (size_t) arg;
+
+	for (size_t i = 0; i < ITEMS_PER_THREAD; ++i)
+	{
+		work_item* item = &queued_items[producer][i];
+
+		item->producer = producer;
+		item->sequence = i;
+
+		shared_queue.push(item);
+	}
+
+	return NULL;
+}
+
+B_TEST_CASE(concurrent_queue)
+{
+	pthread_t threads[THREAD_COUNT];
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		B_REQUIRE(pthread_create(threads + i, NULL,
+			produce, (void*) i) == 0);
+
+	size_t next_sequence[THREAD_COUNT] = {0};
+	bool in_order = true;
+
+	for (size_t received = 0; received < THREAD_COUNT * ITEMS_PER_THREAD; )
+	{
+		work_item* item = shared_queue.pop();
+
+		if (item == NULL)
+		{
+			sched_yield();
+			continue;
+		}
+
+		// The elements of each producer arrive in order.
+		if (item->sequence != next_sequence[item->producer]++)
+			in_order = false;
+
+		++received;
+	}
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		pthread_join(threads[i], NULL);
+
+	B_CHECK(in_order);
+	B_CHECK(shared_queue.pop() == NULL);
+}
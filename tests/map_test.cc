@@ -50,3 +50,36 @@ B_TEST_CASE(construction)
 	B_CHECK(!m.remove(6));
 	B_CHECK(!m.remove(10));
 }
+
+B_TEST_CASE(insert_range)
+{
+	typedef b::map<int, int> int_map;
+	typedef b::kv_pair<int, int> kv;
+
+	int_map m;
+
+	m.insert(2, 0);
+
+	// Both new duplicates and existing keys are
+	// overwritten by the later values.
+	const kv pairs[] = {kv(3, 30), kv(2, 20), kv(1, 10), kv(3, 31)};
+
+	m.insert_range(pairs, B_COUNTOF(pairs));
+
+	B_REQUIRE(m.size() == 3);
+
+	B_CHECK(*m.find(1) == 10);
+	B_CHECK(*m.find(2) == 20);
+	B_CHECK(*m.find(3) == 31);
+
+	int_map other;
+
+	other.insert(3, 0);
+	other.insert(4, 40);
+
+	m.unite(other);
+
+	B_REQUIRE(m.size() == 4);
+	B_CHECK(*m.find(3) == 31);
+	B_CHECK(*m.find(4) == 40);
+}
@@ -3,9 +3,12 @@
 // See the file LICENSE for the license terms.
 
 #include <b/memory.h>
+#include <b/string_stream.h>
 
 #include "test_case.h"
 
+#include <pthread.h>
+
 B_TEST_CASE(size_alignment)
 {
 	B_CHECK(b::memory::align((size_t) 6, 4) == (size_t) 8);
@@ -20,3 +23,237 @@ B_TEST_CASE(pointer_alignment)
 	B_CHECK(b::memory::align((void*) 0, 16) == (void*) 0);
 	B_CHECK(b::memory::align((void*) 1, 32) == (void*) 32);
 }
+
+static size_t live_chunks(size_t size)
+{
+	return b::memory::fixed_stats(
+		(size - 1) / B_FIXED_ALLOC_GRANULARITY).live;
+}
+
+#define CHUNK_SIZE 40
+#define CHUNK_COUNT 1000
+
+B_TEST_CASE(fixed_alloc)
+{
+	B_CHECK(b::memory::fixed_size_class_count() ==
+		B_MAX_FIXED_ALLOC / B_FIXED_ALLOC_GRANULARITY);
+
+	size_t initial_live = live_chunks(CHUNK_SIZE);
+
+	void* chunks[CHUNK_COUNT];
+
+	for (size_t i = 0; i < CHUNK_COUNT; ++i)
+	{
+		chunks[i] = b::memory::fixed_alloc(CHUNK_SIZE);
+
+		B_CHECK(b::memory::align(chunks[i],
+			B_FIXED_ALLOC_GRANULARITY) == chunks[i]);
+
+		b::memory::fill(chunks[i], CHUNK_SIZE, (char) i);
+	}
+
+	for (size_t i = 0; i < CHUNK_COUNT; ++i)
+		B_CHECK(((char*) chunks[i])[CHUNK_SIZE - 1] == (char) i);
+
+	b::fixed_alloc_stats stats = b::memory::fixed_stats(
+		(CHUNK_SIZE - 1) / B_FIXED_ALLOC_GRANULARITY);
+
+	B_CHECK(stats.chunk_size == 48U);
+	B_CHECK(stats.live == initial_live + CHUNK_COUNT);
+	B_CHECK(stats.peak >= stats.live + stats.cached);
+
+	for (size_t i = 0; i < CHUNK_COUNT; ++i)
+		b::memory::fixed_free(chunks[i], CHUNK_SIZE);
+
+	B_CHECK(live_chunks(CHUNK_SIZE) == initial_live);
+
+	// A freed chunk is reused.
+	void* chunk = b::memory::fixed_alloc(CHUNK_SIZE);
+
+	b::memory::fixed_free(chunk, CHUNK_SIZE);
+
+	B_CHECK(b::memory::fixed_alloc(CHUNK_SIZE) == chunk);
+
+	b::memory::fixed_free(chunk, CHUNK_SIZE);
+
+	// Large blocks bypass the slabs.
+	chunk = b::memory::fixed_alloc(B_MAX_FIXED_ALLOC + 1);
+
+	b::memory::fixed_free(chunk, B_MAX_FIXED_ALLOC + 1);
+}
+
+static void* free_chunks(void* arg)
+{
+	void** chunks = (void**) arg;
+
+	for (size_t i = 0; i < CHUNK_COUNT; ++i)
+		b::memory::fixed_free(chunks[i], CHUNK_SIZE);
+
+	return NULL;
+}
+
+static void* alloc_chunks(void* arg)
+{
+	void** chunks = (void**) arg;
+
+	for (size_t i = 0; i < CHUNK_COUNT; ++i)
+		chunks[i] = b::memory::fixed_alloc(CHUNK_SIZE);
+
+	return NULL;
+}
+
+B_TEST_CASE(cross_thread_free)
+{
+	size_t initial_live = live_chunks(CHUNK_SIZE);
+
+	void* chunks[CHUNK_COUNT];
+
+	// Chunks allocated here and freed by another thread
+	// come back when this thread runs out of free chunks.
+	alloc_chunks(chunks);
+
+	pthread_t thread;
+
+	B_REQUIRE(pthread_create(&thread, NULL, free_chunks, chunks) == 0);
+	pthread_join(thread, NULL);
+
+	B_CHECK(live_chunks(CHUNK_SIZE) == initial_live + CHUNK_COUNT);
+
+	b::memory::trim_fixed_caches();
+
+	B_CHECK(live_chunks(CHUNK_SIZE) == initial_live);
+
+	// Chunks of an exited thread are freed here and
+	// collected when the caches are trimmed.
+	B_REQUIRE(pthread_create(&thread, NULL, alloc_chunks, chunks) == 0);
+	pthread_join(thread, NULL);
+
+	free_chunks(chunks);
+
+	b::memory::trim_fixed_caches();
+
+	B_CHECK(live_chunks(CHUNK_SIZE) == initial_live);
+}
+
+#define EARLY_CHUNK_COUNT 10
+
+// Allocates chunks before main(), possibly before the
+// static objects of the library are initialized.
+static struct early_chunks
+{
+	early_chunks()
+	{
+		for (size_t i = 0; i < EARLY_CHUNK_COUNT; ++i)
+			chunks[i] = b::memory::fixed_alloc(CHUNK_SIZE);
+	}
+
+	void* chunks[EARLY_CHUNK_COUNT];
+} early_chunks;
+
+B_TEST_CASE(static_constructor_fixed_alloc)
+{
+	b::fixed_alloc_stats stats = b::memory::fixed_stats(
+		(CHUNK_SIZE - 1) / B_FIXED_ALLOC_GRANULARITY);
+
+	B_CHECK(stats.live >= EARLY_CHUNK_COUNT);
+	B_CHECK(stats.peak >= stats.live + stats.cached);
+
+	for (size_t i = 0; i < EARLY_CHUNK_COUNT; ++i)
+		b::memory::fixed_free(early_chunks.chunks[i], CHUNK_SIZE);
+
+	B_CHECK(live_chunks(CHUNK_SIZE) == stats.live - EARLY_CHUNK_COUNT);
+
+	b::memory::trim_fixed_caches();
+
+	stats = b::memory::fixed_stats(
+		(CHUNK_SIZE - 1) / B_FIXED_ALLOC_GRANULARITY);
+
+	B_CHECK(stats.peak >= stats.live + stats.cached);
+}
+
+#define BLOCK_SIZE 1000
+#define BLOCK_COUNT (B_ALLOC_SAMPLE_INTERVAL * 2)
+
+B_TEST_CASE(allocation_tracking)
+{
+	b::allocation_counters before = b::memory::allocation_totals();
+	b::allocation_counters class_before =
+		b::memory::allocations_by_size(10);
+
+	void* blocks[BLOCK_COUNT];
+
+	for (size_t i = 0; i < BLOCK_COUNT; ++i)
+		blocks[i] = b::memory::alloc(BLOCK_SIZE);
+
+	b::allocation_counters during = b::memory::allocation_totals();
+	b::allocation_counters class_during =
+		b::memory::allocations_by_size(10);
+
+	b::allocation_site sites[B_ALLOC_MAX_SITES + 1];
+
+	size_t site_count = b::memory::allocation_sites(sites,
+		B_COUNTOF(sites));
+
+	size_t sampled_live_bytes = 0;
+
+	for (size_t i = 0; i < site_count; ++i)
+		sampled_live_bytes += sites[i].live_bytes;
+
+	for (size_t i = 0; i < BLOCK_COUNT; ++i)
+		b::memory::free(blocks[i]);
+
+	b::allocation_counters after = b::memory::allocation_totals();
+
+#if defined(B_ALLOC_TRACKING)
+	B_CHECK(during.allocations == before.allocations + BLOCK_COUNT);
+	B_CHECK(during.live_blocks == before.live_blocks + BLOCK_COUNT);
+	B_CHECK(during.live_bytes ==
+		before.live_bytes + BLOCK_COUNT * BLOCK_SIZE);
+	B_CHECK(during.peak_bytes >= during.live_bytes);
+
+	// Blocks of 1000 bytes belong to the class of up to 1024.
+	B_CHECK(class_during.allocations ==
+		class_before.allocations + BLOCK_COUNT);
+
+	// Exactly two of the allocations have been sampled.
+	B_CHECK(site_count > 0);
+	B_CHECK(sampled_live_bytes >= 2 * BLOCK_SIZE * B_ALLOC_SAMPLE_INTERVAL);
+
+	B_CHECK(after.live_blocks == before.live_blocks);
+	B_CHECK(after.live_bytes == before.live_bytes);
+	B_CHECK(after.peak_bytes == during.peak_bytes);
+#else
+	B_CHECK(before.allocations == 0U && class_before.allocations == 0U);
+	B_CHECK(during.allocations == 0U && class_during.allocations == 0U);
+	B_CHECK(site_count == 0U && sampled_live_bytes == 0U);
+	B_CHECK(after.peak_bytes == 0U);
+#endif /* defined(B_ALLOC_TRACKING) */
+
+	b::ref<b::string_stream> report = new b::string_stream;
+
+	b::memory::dump_allocations(report);
+
+	B_CHECK(!report->str().is_empty());
+}
+
+// Allocates a block before main(), possibly before the
+// static objects of the library are initialized.
+static void* early_block = b::memory::alloc(BLOCK_SIZE);
+
+B_TEST_CASE(static_constructor_alloc)
+{
+	b::allocation_counters before = b::memory::allocation_totals();
+
+	b::memory::free(early_block);
+
+	b::allocation_counters after = b::memory::allocation_totals();
+
+#if defined(B_ALLOC_TRACKING)
+	B_CHECK(before.live_blocks >= 1U);
+	B_CHECK(before.live_bytes >= BLOCK_SIZE);
+	B_CHECK(after.live_blocks == before.live_blocks - 1);
+	B_CHECK(after.live_bytes == before.live_bytes - BLOCK_SIZE);
+#else
+	B_CHECK(before.live_blocks == 0U && after.live_blocks == 0U);
+#endif /* defined(B_ALLOC_TRACKING) */
+}
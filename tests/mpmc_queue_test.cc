@@ -0,0 +1,150 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/mpmc_queue.h>
+#include <b/object.h>
+#include <b/ref.h>
+
+#include "test_case.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+template class b::mpmc_queue<int>;
+
+B_TEST_CASE(single_thread)
+{
+	b::mpmc_queue<int> queue(5);
+
+	B_CHECK(queue.capacity() == 8);
+
+	int value;
+
+	B_CHECK(!queue.try_pop(&value));
+
+	for (int i = 0; i < 8; ++i)
+		B_CHECK(queue.try_push(i));
+
+	B_CHECK(!queue.try_push(8));
+
+	for (int i = 0; i < 8; ++i)
+	{
+		B_REQUIRE(queue.try_pop(&value));
+		B_CHECK(value == i);
+	}
+
+	B_CHECK(!queue.try_pop(&value));
+
+	static const int batch[] = {1, 2, 3, 4, 5, 6};
+
+	B_CHECK(queue.try_push(batch, B_COUNTOF(batch)) == 6);
+	B_CHECK(queue.try_push(batch, B_COUNTOF(batch)) == 2);
+
+	int popped[10];
+
+	B_CHECK(queue.try_pop(popped, B_COUNTOF(popped)) == 8);
+	B_CHECK(popped[5] == 6 && popped[6] == 1 && popped[7] == 2);
+}
+
+static int live_items = 0;
+
+class work_item : public b::object
+{
+public:
+	work_item()
+	{
+		++live_items;
+	}
+
+	virtual ~work_item()
+	{
+		--live_items;
+	}
+};
+
+B_TEST_CASE(references)
+{
+	{
+		b::mpmc_queue<b::ref<work_item> > queue(4);
+
+		B_CHECK(queue.try_push(new work_item));
+		B_CHECK(queue.try_push(new work_item));
+		B_CHECK(live_items == 2);
+
+		b::ref<work_item> item;
+
+		B_CHECK(queue.try_pop(&item));
+
+		item = NULL;
+
+		// The queue does not hold on to popped elements.
+		B_CHECK(live_items == 1);
+	}
+
+	// The destructor releases the remaining elements.
+	B_CHECK(live_items == 0);
+}
+
+#define THREAD_COUNT 4
+#define ITEMS_PER_THREAD 20000
+
+static b::mpmc_queue<size_t>* shared_queue;
+static b::atomic_value<size_t> consumed_sum;
+static b::atomic_value<size_t> consumed_count;
+
+static void* produce(void* arg)
+{
+	size_t first = (size_t) arg * ITEMS_PER_THREAD;
+
+	for (size_t i = first; i < first + ITEMS_PER_THREAD; ++i)
+		while (!shared_queue->try_push(i))
+			sched_yield();
+
+	return NULL;
+}
+
+static void* consume(void*)
+{
+	size_t sum = 0;
+
+	for (size_t i = 0; i < ITEMS_PER_THREAD; ++i)
+	{
+		size_t value;
+
+		while (!shared_queue->try_pop(&value))
+			sched_yield();
+
+		sum += value;
+	}
+
+	consumed_sum.fetch_add(sum);
+	consumed_count.fetch_add(ITEMS_PER_THREAD);
+
+	return NULL;
+}
+
+B_TEST_CASE(concurrent_producers_and_consumers)
+{
+	b::mpmc_queue<size_t> queue(64);
+
+	shared_queue = &queue;
+
+	pthread_t threads[THREAD_COUNT * 2];
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+	{
+		B_REQUIRE(pthread_create(threads + i * 2, NULL,
+			produce, (void*) i) == 0);
+		B_REQUIRE(pthread_create(threads + i * 2 + 1, NULL,
+			consume, NULL) == 0);
+	}
+
+	for (size_t i = 0; i < B_COUNTOF(threads); ++i)
+		pthread_join(threads[i], NULL);
+
+	size_t n = THREAD_COUNT * ITEMS_PER_THREAD;
+
+	B_CHECK(consumed_count.load() == n);
+	B_CHECK(consumed_sum.load() == n * (n - 1) / 2);
+}
@@ -0,0 +1,203 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/mutex.h>
+
+#include "test_case.h"
+
+#include <sched.h>
+
+#define THREAD_COUNT 4
+#define ITERATIONS 20000
+
+B_TEST_CASE(try_lock)
+{
+	b::mutex m;
+
+	B_CHECK(m.try_lock());
+	B_CHECK(!m.try_lock());
+
+	m.unlock();
+
+	{
+		b::mutex_lock lock(m);
+
+		B_CHECK(!m.try_lock());
+	}
+
+	B_CHECK(m.try_lock());
+
+	m.unlock();
+}
+
+static b::mutex counter_mutex;
+static size_t counter;
+
+static void* increment(void*)
+{
+	for (size_t i = 0; i < ITERATIONS; ++i)
+	{
+		b::mutex_lock lock(counter_mutex);
+
+		// Non-atomic read-modify-write that
+		// yields the processor in the middle.
+		size_t value = counter;
+
+		if (i % 64 == 0)
+			sched_yield();
+
+		counter = value + 1;
+	}
+
+	return NULL;
+}
+
+B_TEST_CASE(mutual_exclusion)
+{
+	counter_mutex.reset_stats();
+
+	pthread_t threads[THREAD_COUNT];
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		B_REQUIRE(pthread_create(threads + i, NULL,
+			increment, NULL) == 0);
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		pthread_join(threads[i], NULL);
+
+	B_CHECK(counter == THREAD_COUNT * ITERATIONS);
+
+	b::lock_stats stats = counter_mutex.stats();
+
+#if defined(B_LOCK_STATS)
+	B_CHECK(stats.acquisitions == THREAD_COUNT * ITERATIONS);
+	B_CHECK(stats.contended_acquisitions <= stats.acquisitions);
+#else
+	B_CHECK(stats.acquisitions == 0);
+#endif /* defined(B_LOCK_STATS) */
+
+	counter_mutex.reset_stats();
+
+	B_CHECK(counter_mutex.stats().acquisitions == 0);
+}
+
+static b::mutex flag_mutex;
+static b::condition flag_condition;
+static bool flag;
+
+static void* raise_flag(void*)
+{
+	b::mutex_lock lock(flag_mutex);
+
+	flag = true;
+
+	flag_condition.signal();
+
+	return NULL;
+}
+
+B_TEST_CASE(condition)
+{
+	pthread_t thread;
+
+	{
+		b::mutex_lock lock(flag_mutex);
+
+		B_REQUIRE(pthread_create(&thread, NULL,
+			raise_flag, NULL) == 0);
+
+		while (!flag)
+			flag_condition.wait(flag_mutex);
+	}
+
+	pthread_join(thread, NULL);
+
+	B_CHECK(flag);
+}
+
+B_TEST_CASE(shared_try_lock)
+{
+	b::shared_mutex m;
+
+	B_CHECK(m.try_lock_shared());
+	B_CHECK(m.try_lock_shared());
+	B_CHECK(!m.try_lock());
+
+	m.unlock_shared();
+	m.unlock_shared();
+
+	{
+		b::write_lock lock(m);
+
+		B_CHECK(!m.try_lock_shared());
+		B_CHECK(!m.try_lock());
+	}
+
+	{
+		b::read_lock lock(m);
+
+		B_CHECK(!m.try_lock());
+	}
+
+	B_CHECK(m.try_lock());
+
+	m.unlock();
+}
+
+static b::shared_mutex table_mutex;
+
+// Two halves of a table that writers keep equal.
+static size_t table[2];
+
+static b::atomic_value<size_t> inconsistent_reads;
+
+static void* read_and_write(void* arg)
+{
+	size_t thread_index = (size_t) arg;
+
+	for (size_t i = 0; i < ITERATIONS; ++i)
+		if ((i + thread_index) % 8 == 0)
+		{
+			b::write_lock lock(table_mutex);
+
+			size_t value = table[0] + 1;
+
+			table[0] = value;
+
+			if (i % 64 == 0)
+				sched_yield();
+
+			table[1] = value;
+		}
+		else
+		{
+			b::read_lock lock(table_mutex);
+
+			if (table[0] != table[1])
+				inconsistent_reads.fetch_add(1);
+		}
+
+	return NULL;
+}
+
+B_TEST_CASE(readers_and_writers)
+{
+	pthread_t threads[THREAD_COUNT];
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		B_REQUIRE(pthread_create(threads + i, NULL,
+			read_and_write, (void*) i) == 0);
+
+	for (size_t i = 0; i < THREAD_COUNT; ++i)
+		pthread_join(threads[i], NULL);
+
+	B_CHECK(inconsistent_reads.load() == 0);
+	B_CHECK(table[0] == THREAD_COUNT * ITERATIONS / 8);
+	B_CHECK(table[1] == table[0]);
+
+#if defined(B_LOCK_STATS)
+	B_CHECK(table_mutex.stats().acquisitions ==
+		THREAD_COUNT * ITERATIONS);
+#endif /* defined(B_LOCK_STATS) */
+}
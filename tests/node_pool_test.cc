@@ -0,0 +1,86 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/node_pool.h>
+
+#include "test_case.h"
+
+B_TEST_CASE(node_size)
+{
+	b::node_pool tiny(1);
+
+	B_CHECK(tiny.node_size() == sizeof(void*));
+
+	b::node_pool odd(sizeof(void*) * 3 + 1);
+
+	B_CHECK(odd.node_size() == sizeof(void*) * 4);
+}
+
+B_TEST_CASE(reuse)
+{
+	b::node_pool pool(24);
+
+	B_CHECK(pool.available() == 0);
+
+	void* first = pool.allocate_node();
+	void* second = pool.allocate_node();
+
+	B_CHECK(first != second);
+	B_CHECK(pool.available() == B_NODE_POOL_MIN_SLAB_NODES - 2);
+
+	pool.deallocate_node(first);
+
+	B_CHECK(pool.allocate_node() == first);
+
+	pool.deallocate(second, 24);
+
+	B_CHECK(pool.allocate(24) == second);
+}
+
+B_TEST_CASE(growth)
+{
+	b::node_pool pool(sizeof(size_t));
+
+	size_t* nodes[1000];
+
+	for (size_t i = 0; i < B_COUNTOF(nodes); ++i)
+	{
+		nodes[i] = static_cast<size_t*>(pool.allocate_node());
+		*nodes[i] = i;
+	}
+
+	for (size_t i = 0; i < B_COUNTOF(nodes); ++i)
+		B_CHECK(*nodes[i] == i);
+
+	for (size_t i = 0; i < B_COUNTOF(nodes); ++i)
+		pool.deallocate_node(nodes[i]);
+
+	B_CHECK(pool.available() >= B_COUNTOF(nodes));
+
+	pool.clear();
+
+	B_CHECK(pool.available() == 0);
+}
+
+B_TEST_CASE(reserve)
+{
+	b::node_pool pool(32);
+
+	pool.allocate_node();
+
+	size_t available = pool.available();
+
+	pool.reserve(available);
+
+	B_CHECK(pool.available() == available);
+
+	pool.reserve(100);
+
+	B_CHECK(pool.available() == 100);
+
+	for (int i = 0; i < 100; ++i)
+		pool.allocate_node();
+
+	B_CHECK(pool.available() == 0);
+}
@@ -3,9 +3,12 @@
 // See the file LICENSE for the license terms.
 
 #include <b/object.h>
+#include <b/shared_object.h>
 
 #include "test_case.h"
 
+#include <pthread.h>
+
 class base : public b::object
 {
 public:
@@ -207,3 +210,54 @@ B_TEST_CASE(multiple_inheritance)
 
 	B_CHECK(computer_controlled_pawn::number_of_pawns == 0U);
 }
+
+class shared : public b::shared_object
+{
+public:
+	shared()
+	{
+		++instance_count;
+	}
+
+	virtual ~shared()
+	{
+		--instance_count;
+	}
+
+	static int instance_count;
+};
+
+int shared::instance_count = 0;
+
+static void* copy_references(void* arg)
+{
+	b::ref<shared>* original = static_cast<b::ref<shared>*>(arg);
+
+	for (int i = 0; i < 10000; ++i)
+	{
+		b::ref<shared> copy(*original);
+		b::ref<shared> another_copy = copy;
+	}
+
+	return NULL;
+}
+
+B_TEST_CASE(shared_object)
+{
+	{
+		b::ref<shared> s = new shared;
+
+		pthread_t threads[4];
+
+		for (size_t i = 0; i < B_COUNTOF(threads); ++i)
+			B_REQUIRE(pthread_create(threads + i, NULL,
+				copy_references, &s) == 0);
+
+		for (size_t i = 0; i < B_COUNTOF(threads); ++i)
+			pthread_join(threads[i], NULL);
+
+		B_CHECK(shared::instance_count == 1);
+	}
+
+	B_CHECK(shared::instance_count == 0);
+}
@@ -0,0 +1,145 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/order_statistic_tree.h>
+#include <b/map.h>
+#include <b/pseudorandom.h>
+
+#include "test_case.h"
+
+template class b::set<int, b::order_statistic_tree_base>;
+template class b::map<int, int, b::order_statistic_tree_base>;
+
+typedef b::set<int, b::order_statistic_tree_base> int_set;
+
+// Checks rank() and select() of 's' against the plain tree,
+// which answers them by walking the elements.
+static bool check_order(const int_set& s, const b::set<int>& reference)
+{
+	if (s.size() != reference.size())
+		return false;
+
+	size_t index = 0;
+
+	for (const int* value = reference.first(); value != NULL;
+			value = reference.next(value), ++index)
+	{
+		const int* selected = s.select(index);
+
+		if (selected == NULL || *selected != *value)
+			return false;
+
+		if (s.rank(*value) != index || s.rank(*value + 1) != index + 1)
+			return false;
+	}
+
+	return s.select(index) == NULL && s.rank(-1) == 0;
+}
+
+B_TEST_CASE(empty_tree)
+{
+	int_set s;
+
+	B_CHECK(s.select(0) == NULL);
+	B_CHECK(s.rank(0) == 0);
+}
+
+B_TEST_CASE(random_updates)
+{
+	b::pseudorandom prng(10);
+
+	int_set s;
+	b::set<int> reference;
+
+	for (int i = 0; i < 500; ++i)
+	{
+		// Keys are even so that the key next to
+		// each of them is never in the set.
+		int value = (int) prng.next(200) * 2;
+
+		if (prng.next(3) == 0)
+			B_CHECK(s.remove(value) == reference.remove(value));
+		else
+		{
+			s.insert(value);
+			reference.insert(value);
+		}
+
+		if (i % 50 == 0)
+			B_REQUIRE(check_order(s, reference));
+	}
+
+	B_REQUIRE(check_order(s, reference));
+
+	while (!s.is_empty())
+	{
+		int value = *s.select(prng.next(s.size()));
+
+		B_CHECK(s.remove(value));
+		B_CHECK(reference.remove(value));
+	}
+
+	B_CHECK(check_order(s, reference));
+}
+
+B_TEST_CASE(bulk_operations)
+{
+	b::array<int> sorted;
+
+	for (int i = 0; i < 100; ++i)
+		sorted.append(i * 2);
+
+	int_set s;
+	b::set<int> reference;
+
+	s.assign_sorted(sorted.data(), sorted.length());
+	reference.assign_sorted(sorted.data(), sorted.length());
+
+	B_REQUIRE(check_order(s, reference));
+	B_CHECK(*s.select(50) == 100);
+	B_CHECK(s.rank(101) == 51);
+
+	static const int more[] = {300, 6, 1000, 51};
+
+	s.insert_range(more, B_COUNTOF(more));
+	reference.insert_range(more, B_COUNTOF(more));
+
+	B_REQUIRE(check_order(s, reference));
+
+	int_set removed;
+
+	for (int i = 0; i < 50; ++i)
+		removed.insert(i * 4);
+
+	s.subtract(removed);
+
+	for (int i = 0; i < 50; ++i)
+		reference.remove(i * 4);
+
+	B_CHECK(check_order(s, reference));
+}
+
+B_TEST_CASE(map_rank_and_select)
+{
+	typedef b::map<int, int, b::order_statistic_tree_base> int_map;
+
+	int_map m;
+
+	for (int i = 9; i >= 0; --i)
+		m.insert(i * 10, i);
+
+	for (size_t i = 0; i < 10; ++i)
+	{
+		b::kv_pair<int, int>* element = m.select(i);
+
+		B_REQUIRE(element != NULL);
+		B_CHECK(element->key == (int) i * 10);
+		B_CHECK(element->value == (int) i);
+		B_CHECK(m.rank((int) i * 10) == i);
+	}
+
+	B_CHECK(m.remove(30));
+	B_CHECK(m.select(3)->key == 40);
+	B_CHECK(m.rank(35) == 3);
+}
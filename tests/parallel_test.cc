@@ -0,0 +1,233 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/parallel.h>
+#include <b/custom_exception.h>
+
+#include "test_case.h"
+
+static b::array<int> random_numbers(size_t count, size_t limit)
+{
+	b::pseudorandom prng(1);
+
+	b::array<int> numbers;
+
+	numbers.alloc_and_copy(count);
+
+	for (size_t i = 0; i < count; ++i)
+		numbers.append((int) prng.next(limit));
+
+	return numbers;
+}
+
+static void double_value(int& value)
+{
+	value *= 2;
+}
+
+B_TEST_CASE(for_each)
+{
+	b::thread_pool pool(4);
+
+	b::array<int> numbers = random_numbers(100000, 1000);
+	b::array<int> copy(numbers);
+
+	b::parallel_for_each(&pool, numbers, double_value, 100);
+
+	// The buffer shared with 'copy' must have been isolated.
+	for (size_t i = 0; i < numbers.length(); ++i)
+		B_REQUIRE(numbers[i] == copy[i] * 2);
+}
+
+static void check_value(const int& value)
+{
+	if (value < 0)
+		throw b::custom_exception("negative value");
+}
+
+B_TEST_CASE(for_each_exception)
+{
+	b::thread_pool pool(4);
+
+	b::array<int> numbers = random_numbers(100000, 1000);
+
+	// The first element is processed by the calling thread,
+	// which must wait for the scheduled halves when the
+	// exception unwinds the stack.
+	numbers[0] = -1;
+
+	bool caught = false;
+
+	try
+	{
+		b::parallel_for_each(&pool, numbers.slice(0, numbers.length()),
+			check_value, 100);
+	}
+	catch (b::runtime_exception&)
+	{
+		caught = true;
+	}
+
+	B_CHECK(caught);
+}
+
+static long square(const int& value)
+{
+	return (long) value * value;
+}
+
+static long add(long sum, const int& value)
+{
+	return sum + value;
+}
+
+static long combine(long lhs, long rhs)
+{
+	return lhs + rhs;
+}
+
+B_TEST_CASE(transform_and_reduce)
+{
+	b::thread_pool pool(4);
+
+	b::array<int> numbers = random_numbers(100000, 1000);
+
+	b::array<long> squares(numbers.length(), 0);
+
+	b::parallel_transform(&pool, numbers, squares.lock(), square, 1000);
+	squares.unlock();
+
+	long expected_sum = 0;
+
+	for (size_t i = 0; i < numbers.length(); ++i)
+	{
+		B_REQUIRE(squares[i] == square(numbers[i]));
+		expected_sum += numbers[i];
+	}
+
+	B_CHECK(b::parallel_reduce(&pool, numbers, 0L, add, combine) ==
+		expected_sum);
+
+	B_CHECK(b::parallel_reduce(&pool, numbers.slice(0, 0), 0L,
+		add, combine) == 0);
+}
+
+static int compare_descending(const int& lhs, const int& rhs)
+{
+	return b::compare(rhs, lhs);
+}
+
+B_TEST_CASE(sort)
+{
+	static const size_t concurrency[] = {1, 3, 4};
+	static const size_t sizes[] = {0, 10, 20000, 300001};
+
+	for (size_t c = 0; c < B_COUNTOF(concurrency); ++c)
+	{
+		b::thread_pool pool(concurrency[c]);
+
+		for (size_t s = 0; s < B_COUNTOF(sizes); ++s)
+		{
+			b::array<int> numbers = random_numbers(sizes[s], 100000);
+			b::array<int> expected(numbers);
+
+			expected.sort(b::compare<int>);
+
+			b::parallel_sort(&pool, numbers);
+
+			for (size_t i = 0; i < numbers.length(); ++i)
+				B_REQUIRE(numbers[i] == expected[i]);
+
+			b::parallel_sort(&pool, numbers, compare_descending);
+
+			for (size_t i = 1; i < numbers.length(); ++i)
+				B_REQUIRE(numbers[i - 1] >= numbers[i]);
+		}
+	}
+}
+
+B_TEST_CASE(sort_strings)
+{
+	b::thread_pool pool(4);
+
+	b::array<int> numbers = random_numbers(50000, 1000000);
+
+	b::array<b::string> strings;
+
+	for (size_t i = 0; i < numbers.length(); ++i)
+		strings.append(b::string::formatted("%d", numbers[i]));
+
+	b::parallel_sort(&pool, strings);
+
+	for (size_t i = 1; i < strings.length(); ++i)
+		B_REQUIRE(!(strings[i] < strings[i - 1]));
+}
+
+B_TEST_CASE(sort_shared_strings)
+{
+	b::thread_pool pool(4);
+
+	b::string values[4];
+
+	for (size_t j = 0; j < 4; ++j)
+		values[j] = b::string::formatted("value %d", (int) (3 - j));
+
+	// All copies of a value share its buffer.
+	b::array<b::string> strings;
+
+	b::array<int> numbers = random_numbers(100000, 4);
+
+	for (size_t i = 0; i < numbers.length(); ++i)
+		strings.append(values[numbers[i]]);
+
+	b::parallel_sort(&pool, strings);
+
+	size_t counts[4] = {0, 0, 0, 0};
+
+	for (size_t i = 0; i < strings.length(); ++i)
+	{
+		if (i > 0)
+			B_REQUIRE(!(strings[i] < strings[i - 1]));
+
+		for (size_t j = 0; j < 4; ++j)
+			if (strings[i] == values[j])
+				++counts[j];
+	}
+
+	for (size_t j = 0; j < 4; ++j)
+	{
+		size_t expected = 0;
+
+		for (size_t i = 0; i < numbers.length(); ++i)
+			if (numbers[i] == (int) j)
+				++expected;
+
+		B_CHECK(counts[j] == expected);
+	}
+}
+
+B_TEST_CASE(lower_bound)
+{
+	b::thread_pool pool(4);
+
+	b::array<int> table = random_numbers(10000, 50000);
+
+	table.sort(b::compare<int>);
+
+	b::array<int> keys = random_numbers(20000, 60000);
+
+	b::array<size_t> positions(keys.length(), 0);
+
+	b::parallel_find_lower_bound(&pool, table, keys, positions.lock());
+	positions.unlock();
+
+	for (size_t i = 0; i < keys.length(); ++i)
+	{
+		size_t pos = positions[i];
+
+		B_REQUIRE(pos <= table.length());
+		B_REQUIRE(pos == table.length() || !(table[pos] < keys[i]));
+		B_REQUIRE(pos == 0 || table[pos - 1] < keys[i]);
+	}
+}
@@ -35,3 +35,81 @@ B_TEST_CASE(push_pop)
 
 	B_CHECK(pq.is_empty());
 }
+
+B_TEST_CASE(push_all)
+{
+	b::priority_queue<int, 4> pq;
+
+	static const int initial[] = {5, 1, 9};
+	static const int more[] = {7, 3, 8, 2, 6, 4, 0};
+
+	pq.push_all(initial, B_COUNTOF(initial));
+	pq.push_all(more, B_COUNTOF(more));
+	pq.push_all(initial, 1);
+
+	B_CHECK(pq.length() == 11);
+	B_CHECK(pq.top() == 9);
+
+	B_CHECK(pq.pop() == 9);
+	B_CHECK(pq.pop() == 8);
+	B_CHECK(pq.pop() == 7);
+	B_CHECK(pq.pop() == 6);
+	B_CHECK(pq.pop() == 5);
+	B_CHECK(pq.pop() == 5);
+	B_CHECK(pq.pop() == 4);
+}
+
+B_TEST_CASE(indexed_priority_queue)
+{
+	b::indexed_priority_queue<int> pq;
+
+	b::indexed_priority_queue<int>::handle handles[100];
+
+	for (int i = 0; i < 100; ++i)
+		handles[i] = pq.push(i);
+
+	B_CHECK(pq.length() == 100);
+	B_CHECK(pq.top() == 99);
+	B_CHECK(pq.top_handle() == handles[99]);
+
+	// Increase a key.
+	pq.update(handles[10], 1000);
+	B_CHECK(pq.top_handle() == handles[10]);
+	B_CHECK(pq.get(handles[10]) == 1000);
+
+	// Decrease a key.
+	pq.update(handles[10], -1);
+	B_CHECK(pq.top() == 99);
+
+	pq.erase(handles[99]);
+	B_CHECK(!pq.contains(handles[99]));
+	B_CHECK(pq.top() == 98);
+
+	for (int i = 0; i < 50; ++i)
+		pq.erase(handles[i * 2]);
+
+	B_CHECK(pq.length() == 49);
+
+	// Handles of removed elements are reused.
+	b::indexed_priority_queue<int>::handle h = pq.push(500);
+
+	B_CHECK(h < 100);
+	B_CHECK(pq.get(h) == 500);
+
+	B_CHECK(pq.pop() == 500);
+	B_CHECK(!pq.contains(h));
+
+	int prev = pq.pop();
+
+	B_CHECK(prev == 97);
+
+	while (!pq.is_empty())
+	{
+		int next = pq.pop();
+
+		B_CHECK(next < prev);
+		B_CHECK(next % 2 == 1);
+
+		prev = next;
+	}
+}
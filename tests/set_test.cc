@@ -3,6 +3,7 @@
 // See the file LICENSE for the license terms.
 
 #include <b/set.h>
+#include <b/arena.h>
 
 #include "test_case.h"
 
@@ -85,3 +86,224 @@ B_TEST_CASE(iteration)
 
 	B_CHECK(element == NULL);
 }
+
+// Checks that the set contains exactly the numbers
+// in the 'expected' array in ascending order.
+static bool equals(const int_set& s, const int* expected, size_t count)
+{
+	if (s.size() != count)
+		return false;
+
+	for (int_set::const_iterator it = s.begin(); it != s.end(); ++it)
+		if (*it != *expected++)
+			return false;
+
+	return true;
+}
+
+B_TEST_CASE(assign_sorted)
+{
+	static const int sorted[] = {1, 3, 5, 7, 9, 11, 13};
+
+	int_set s;
+
+	s.insert(4);
+
+	s.assign_sorted(sorted, B_COUNTOF(sorted));
+
+	B_CHECK(equals(s, sorted, B_COUNTOF(sorted)));
+	B_CHECK(s.find(4) == NULL);
+	B_CHECK(*s.last() == 13);
+
+	// The rebuilt tree supports the regular operations.
+	s.insert(4);
+	B_CHECK(s.remove(7));
+	B_CHECK(s.remove(1));
+
+	static const int updated[] = {3, 4, 5, 9, 11, 13};
+
+	B_CHECK(equals(s, updated, B_COUNTOF(updated)));
+
+	s.assign_sorted(sorted, 0);
+
+	B_CHECK(s.is_empty());
+	B_CHECK(s.first() == NULL);
+}
+
+B_TEST_CASE(insert_range)
+{
+	int_set s;
+
+	s.insert(5);
+	s.insert(1);
+
+	int* five = s.find(5);
+
+	static const int values[] = {9, 5, 3, 9, 7, 0};
+
+	s.insert_range(values, B_COUNTOF(values));
+
+	static const int expected[] = {0, 1, 3, 5, 7, 9};
+
+	B_CHECK(equals(s, expected, B_COUNTOF(expected)));
+
+	// Existing elements keep their addresses.
+	B_CHECK(s.find(5) == five);
+}
+
+B_TEST_CASE(set_operations)
+{
+	static const int odd[] = {1, 3, 5, 7, 9};
+	static const int small[] = {1, 2, 3, 4, 5};
+
+	int_set lhs;
+	int_set rhs;
+
+	rhs.assign_sorted(small, B_COUNTOF(small));
+
+	lhs.assign_sorted(odd, B_COUNTOF(odd));
+	lhs.unite(rhs);
+
+	static const int union_result[] = {1, 2, 3, 4, 5, 7, 9};
+
+	B_CHECK(equals(lhs, union_result, B_COUNTOF(union_result)));
+
+	lhs.assign_sorted(odd, B_COUNTOF(odd));
+	lhs.intersect(rhs);
+
+	static const int intersection[] = {1, 3, 5};
+
+	B_CHECK(equals(lhs, intersection, B_COUNTOF(intersection)));
+
+	lhs.assign_sorted(odd, B_COUNTOF(odd));
+	lhs.subtract(rhs);
+
+	static const int difference[] = {7, 9};
+
+	B_CHECK(equals(lhs, difference, B_COUNTOF(difference)));
+
+	lhs.subtract(lhs);
+
+	B_CHECK(lhs.is_empty());
+
+	lhs.unite(rhs);
+	lhs.unite(lhs);
+	lhs.intersect(lhs);
+
+	B_CHECK(equals(lhs, small, B_COUNTOF(small)));
+}
+
+B_TEST_CASE(rank_and_select)
+{
+	static const int values[] = {8, 2, 10, 4, 6};
+
+	int_set s;
+
+	for (size_t i = 0; i < B_COUNTOF(values); ++i)
+		s.insert(values[i]);
+
+	for (size_t i = 0; i < B_COUNTOF(values); ++i)
+	{
+		int* value = s.select(i);
+
+		B_REQUIRE(value != NULL);
+		B_CHECK(*value == (int) (i + 1) * 2);
+		B_CHECK(s.rank(*value) == i);
+		B_CHECK(s.rank(*value - 1) == i);
+	}
+
+	B_CHECK(s.select(B_COUNTOF(values)) == NULL);
+	B_CHECK(s.rank(11) == B_COUNTOF(values));
+	B_CHECK(s.rank(0) == 0);
+}
+
+B_TEST_CASE(clear_and_reserve)
+{
+	int_set s;
+
+	s.reserve(100);
+
+	for (int i = 0; i < 100; ++i)
+		s.insert(i);
+
+	B_CHECK(s.size() == 100);
+
+	s.clear();
+
+	B_CHECK(s.is_empty());
+	B_CHECK(s.first() == NULL);
+	B_CHECK(s.find(50) == NULL);
+
+	// The container remains usable after clear().
+	s.insert(3);
+	s.insert(1);
+
+	static const int expected[] = {1, 3};
+
+	B_CHECK(equals(s, expected, B_COUNTOF(expected)));
+
+	b::arena a;
+
+	int_set arena_set(&a);
+
+	arena_set.reserve(10);
+	arena_set.insert(2);
+	arena_set.insert(1);
+	arena_set.clear();
+
+	B_CHECK(arena_set.is_empty());
+}
+
+static int instance_count = 0;
+
+struct counted
+{
+	counted(int v) : value(v)
+	{
+		++instance_count;
+	}
+
+	counted(const counted& source) : value(source.value)
+	{
+		++instance_count;
+	}
+
+	~counted()
+	{
+		--instance_count;
+	}
+
+	bool operator <(const counted& rhs) const
+	{
+		return value < rhs.value;
+	}
+
+	int value;
+};
+
+B_TEST_CASE(clear_destroys_elements)
+{
+	{
+		b::set<counted> s;
+
+		for (int i = 0; i < 50; ++i)
+			s.insert(counted(i));
+
+		B_CHECK(instance_count == 50);
+
+		B_CHECK(s.remove(counted(10)));
+
+		B_CHECK(instance_count == 49);
+
+		s.clear();
+
+		B_CHECK(instance_count == 0);
+
+		s.insert(counted(1));
+		s.insert(counted(2));
+
+		B_CHECK(instance_count == 2);
+	}
+
+	B_CHECK(instance_count == 0);
+}
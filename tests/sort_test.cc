@@ -0,0 +1,196 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/array.h>
+#include <b/string.h>
+
+#include "test_case.h"
+
+enum input_pattern
+{
+	random_values,
+	ascending,
+	descending,
+	few_unique,
+	organ_pipe,
+	sorted_with_noise,
+	pattern_count
+};
+
+static void generate(int* data, size_t count, input_pattern pattern,
+	b::pseudorandom& prng)
+{
+	for (size_t i = 0; i < count; ++i)
+		switch (pattern)
+		{
+		case random_values:
+			data[i] = (int) prng.next(1000000) - 500000;
+			break;
+		case ascending:
+			data[i] = (int) i;
+			break;
+		case descending:
+			data[i] = (int) (count - i);
+			break;
+		case few_unique:
+			data[i] = (int) prng.next(4);
+			break;
+		case organ_pipe:
+			data[i] = (int) (i < count / 2 ? i : count - i);
+			break;
+		default:
+			data[i] = prng.next(20) == 0 ?
+				(int) prng.next(count) : (int) i;
+		}
+}
+
+static bool is_sorted(const int* data, size_t count)
+{
+	for (size_t i = 1; i < count; ++i)
+		if (data[i] < data[i - 1])
+			return false;
+
+	return true;
+}
+
+static long checksum(const int* data, size_t count)
+{
+	long sum = 0;
+
+	for (size_t i = 0; i < count; ++i)
+		sum += data[i] * (long) (data[i] % 7 + 1);
+
+	return sum;
+}
+
+template <class T>
+static bool equal(const b::array<T>& lhs, const b::array<T>& rhs)
+{
+	return lhs.length() == rhs.length() &&
+		b::compare_arrays(lhs.data(), rhs.data(), lhs.length()) == 0;
+}
+
+B_TEST_CASE(sort_patterns)
+{
+	static const size_t sizes[] = {0, 1, 2, 3, 10, 23, 24, 25, 100,
+		129, 1000, 10000, 100000};
+
+	b::pseudorandom prng(10);
+
+	for (size_t s = 0; s < B_COUNTOF(sizes); ++s)
+	{
+		size_t count = sizes[s];
+
+		b::array<int> data(count, 0);
+
+		for (int p = 0; p < pattern_count; ++p)
+		{
+			generate(data.lock(), count, (input_pattern) p, prng);
+			data.unlock();
+
+			long sum = checksum(data.data(), count);
+
+			b::array<int> copy(data.data(), count);
+
+			b::sort(data.lock(), count);
+			data.unlock();
+
+			B_REQUIRE(is_sorted(data.data(), count));
+			B_REQUIRE(checksum(data.data(), count) == sum);
+
+			copy.stable_sort(b::compare<int>);
+
+			B_REQUIRE(equal(copy, data));
+		}
+	}
+}
+
+static int compare_descending(const int& lhs, const int& rhs)
+{
+	return b::compare(rhs, lhs);
+}
+
+B_TEST_CASE(custom_comparison)
+{
+	b::pseudorandom prng(20);
+
+	b::array<int> data(1000, 0);
+
+	generate(data.lock(), data.length(), random_values, prng);
+	data.unlock();
+
+	b::array<int> copy(data);
+
+	data.sort(compare_descending);
+
+	for (size_t i = 1; i < data.length(); ++i)
+		B_REQUIRE(data[i - 1] >= data[i]);
+
+	// The original array has not been affected.
+	B_CHECK(!equal(copy, data));
+
+	copy.stable_sort(compare_descending);
+
+	B_CHECK(equal(copy, data));
+}
+
+struct keyed_value
+{
+	int key;
+	size_t seq;
+
+	bool operator <(const keyed_value& rhs) const
+	{
+		return key < rhs.key;
+	}
+};
+
+B_TEST_CASE(stability)
+{
+	b::pseudorandom prng(30);
+
+	const size_t count = 5000;
+
+	b::array<keyed_value> data;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		keyed_value kv = {(int) prng.next(50), i};
+
+		data.append(kv);
+	}
+
+	b::stable_sort(data.lock(), data.length());
+	data.unlock();
+
+	for (size_t i = 1; i < count; ++i)
+	{
+		B_REQUIRE(data[i - 1].key <= data[i].key);
+
+		if (data[i - 1].key == data[i].key)
+			B_REQUIRE(data[i - 1].seq < data[i].seq);
+	}
+}
+
+B_TEST_CASE(sort_strings)
+{
+	b::pseudorandom prng(40);
+
+	b::array<b::string> strings;
+
+	for (int i = 0; i < 500; ++i)
+		strings.append(b::string::formatted("%d",
+			(int) prng.next(1000)));
+
+	b::array<b::string> copy(strings);
+
+	strings.sort(b::compare<b::string>);
+	b::stable_sort(copy.lock(), copy.length());
+	copy.unlock();
+
+	B_CHECK(equal(strings, copy));
+
+	for (size_t i = 1; i < strings.length(); ++i)
+		B_REQUIRE(!(strings[i] < strings[i - 1]));
+}
@@ -0,0 +1,114 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/spsc_queue.h>
+
+#include "test_case.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+template class b::spsc_queue<int>;
+
+B_TEST_CASE(single_thread)
+{
+	b::spsc_queue<int> queue(3);
+
+	B_CHECK(queue.capacity() == 4);
+
+	int value;
+
+	B_CHECK(!queue.try_pop(&value));
+
+	// Wrap around the ring buffer several times.
+	for (int i = 0; i < 10; ++i)
+	{
+		B_CHECK(queue.try_push(i));
+		B_CHECK(queue.try_push(i + 100));
+		B_REQUIRE(queue.try_pop(&value));
+		B_CHECK(value == i);
+		B_REQUIRE(queue.try_pop(&value));
+		B_CHECK(value == i + 100);
+	}
+
+	static const int batch[] = {1, 2, 3, 4, 5};
+
+	B_CHECK(queue.try_push(batch, B_COUNTOF(batch)) == 4);
+	B_CHECK(!queue.try_push(6));
+
+	int popped[3];
+
+	B_CHECK(queue.try_pop(popped, B_COUNTOF(popped)) == 3);
+	B_CHECK(popped[0] == 1 && popped[2] == 3);
+
+	B_CHECK(queue.try_push(batch, B_COUNTOF(batch)) == 3);
+
+	B_CHECK(queue.try_pop(popped, B_COUNTOF(popped)) == 3);
+	B_CHECK(popped[0] == 4 && popped[1] == 1 && popped[2] == 2);
+
+	B_CHECK(queue.try_pop(popped, B_COUNTOF(popped)) == 1);
+	B_CHECK(popped[0] == 3);
+}
+
+#define ITEM_COUNT 100000
+#define BATCH_SIZE 7
+
+static b::spsc_queue<size_t>* shared_queue;
+
+static void* produce(void*)
+{
+	size_t batch[BATCH_SIZE];
+
+	for (size_t next = 0; next < ITEM_COUNT; )
+	{
+		size_t count = 0;
+
+		while (count < BATCH_SIZE && next + count < ITEM_COUNT)
+		{
+			batch[count] = next + count;
+			++count;
+		}
+
+		size_t pushed = shared_queue->try_push(batch, count);
+
+		if (pushed == 0)
+			sched_yield();
+
+		next += pushed;
+	}
+
+	return NULL;
+}
+
+B_TEST_CASE(producer_and_consumer)
+{
+	b::spsc_queue<size_t> queue(16);
+
+	shared_queue = &queue;
+
+	pthread_t producer;
+
+	B_REQUIRE(pthread_create(&producer, NULL, produce, NULL) == 0);
+
+	size_t expected = 0;
+	bool in_order = true;
+
+	while (expected < ITEM_COUNT)
+	{
+		size_t values[5];
+
+		size_t count = queue.try_pop(values, B_COUNTOF(values));
+
+		if (count == 0)
+			sched_yield();
+
+		for (size_t i = 0; i < count; ++i)
+			if (values[i] != expected++)
+				in_order = false;
+	}
+
+	pthread_join(producer, NULL);
+
+	B_CHECK(in_order);
+}
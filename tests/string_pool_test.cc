@@ -0,0 +1,143 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/string_pool.h>
+#include <b/array.h>
+#include <b/map.h>
+
+#include "test_case.h"
+
+B_TEST_CASE(interning)
+{
+	b::string_pool pool;
+
+	b::atom hello = pool.intern(B_STRING_VIEW("hello"));
+	b::atom world = pool.intern(B_STRING_VIEW("world"));
+
+	B_CHECK(hello != world);
+	B_CHECK(hello.str() == "hello");
+	B_CHECK(world.length() == 5);
+	B_CHECK(b::calc_length(world.data()) == 5);
+
+	b::string copy(B_STRING_VIEW("hel"));
+	copy.append(B_STRING_VIEW("lo"));
+
+	b::atom another_hello = pool.intern(copy);
+
+	B_CHECK(another_hello == hello);
+	B_CHECK(another_hello.data() == hello.data());
+	B_CHECK(another_hello.hash() == hello.hash());
+
+	B_CHECK(pool.size() == 2);
+
+	b::atom found;
+
+	B_CHECK(pool.find(B_STRING_VIEW("world"), &found));
+	B_CHECK(found == world);
+	B_CHECK(!pool.find(B_STRING_VIEW("missing"), &found));
+	B_CHECK(pool.size() == 2);
+}
+
+B_TEST_CASE(empty_string)
+{
+	b::string_pool pool;
+
+	b::atom empty = pool.intern(b::string_view());
+
+	B_CHECK(empty == b::atom());
+	B_CHECK(empty.is_empty());
+	B_CHECK(*empty.data() == '\0');
+	B_CHECK(empty.hash() == 0);
+	B_CHECK(pool.size() == 0);
+}
+
+B_TEST_CASE(many_strings)
+{
+	b::string_pool pool;
+
+	b::array<b::atom> atoms;
+
+	for (int i = 0; i < 5000; ++i)
+		atoms.append(pool.intern(b::string::formatted("key%d", i)));
+
+	B_REQUIRE(pool.size() == 5000);
+
+	for (int i = 0; i < 5000; ++i)
+		B_CHECK(pool.intern(b::string::formatted("key%d", i)) ==
+			atoms[i]);
+
+	// A string longer than an arena block.
+	b::string long_string;
+	long_string.assign(100000, 'x');
+
+	b::atom long_atom = pool.intern(long_string);
+
+	B_CHECK(long_atom.str() == long_string);
+	B_CHECK(pool.intern(B_STRING_VIEW("key0")) == atoms[0]);
+
+	b::string_pool_stats stats = pool.stats();
+
+	B_CHECK(stats.string_count == 5001);
+	B_CHECK(stats.string_bytes >= 100000);
+	B_CHECK(stats.arena_bytes >= stats.string_bytes);
+	B_CHECK(stats.table_bytes > 0);
+}
+
+B_TEST_CASE(atom_map_keys)
+{
+	b::string_pool pool;
+
+	b::map<b::atom, int> counts;
+
+	static const char* const words[] = {"a", "b", "a", "c", "a", "b"};
+
+	for (size_t i = 0; i < B_COUNTOF(words); ++i)
+	{
+		b::atom word = pool.intern(b::string_view(words[i],
+			b::calc_length(words[i])));
+
+		int* count = counts.find(word);
+
+		if (count != NULL)
+			++*count;
+		else
+			counts.insert(word, 1);
+	}
+
+	B_CHECK(counts.size() == 3);
+	B_CHECK(*counts.find(pool.intern(B_STRING_VIEW("a"))) == 3);
+	B_CHECK(*counts.find(pool.intern(B_STRING_VIEW("b"))) == 2);
+}
+
+static b::concurrent_string_pool shared_pool;
+
+static void* intern_keys(void* result)
+{
+	b::atom* atoms = (b::atom*) result;
+
+	for (int i = 0; i < 1000; ++i)
+		atoms[i] = shared_pool.intern(b::string::formatted("key%d", i));
+
+	return NULL;
+}
+
+B_TEST_CASE(concurrent_interning)
+{
+	static b::atom atoms[4][1000];
+
+	pthread_t threads[4];
+
+	for (int t = 0; t < 4; ++t)
+		B_REQUIRE(pthread_create(&threads[t], NULL,
+			intern_keys, atoms[t]) == 0);
+
+	for (int t = 0; t < 4; ++t)
+		pthread_join(threads[t], NULL);
+
+	B_CHECK(shared_pool.size() == 1000);
+
+	for (int t = 1; t < 4; ++t)
+		for (int i = 0; i < 1000; ++i)
+			B_CHECK(atoms[t][i] == atoms[0][i]);
+}
@@ -0,0 +1,122 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/string_tokenizer.h>
+
+#include "test_case.h"
+
+B_TEST_CASE(char_set)
+{
+	b::char_set empty_set;
+
+	B_CHECK(!empty_set.contains('a'));
+	B_CHECK(!empty_set.contains('\0'));
+
+	b::char_set set(B_STRING_VIEW(" \t,\xff"));
+
+	B_CHECK(set.contains(' '));
+	B_CHECK(set.contains('\t'));
+	B_CHECK(set.contains(','));
+	B_CHECK(set.contains('\xff'));
+	B_CHECK(!set.contains('a'));
+	B_CHECK(!set.contains('\xfe'));
+
+	static const wchar_t wide_chars[] = L"\x3000;";
+
+	b::wchar_set wide_set(b::wstring_view(wide_chars,
+		B_COUNTOF(wide_chars) - 1));
+
+	B_CHECK(wide_set.contains(L'\x3000'));
+	B_CHECK(wide_set.contains(L';'));
+	B_CHECK(!wide_set.contains(L'\x3001'));
+	B_CHECK(!wide_set.contains(L' '));
+}
+
+B_TEST_CASE(single_delimiter)
+{
+	b::string_tokenizer tokenizer(B_STRING_VIEW("one,,two,"),
+		B_STRING_VIEW(","));
+
+	b::string_view token;
+
+	B_REQUIRE(tokenizer.next(&token));
+	B_CHECK(token == "one");
+	B_CHECK(tokenizer.remainder() == ",two,");
+
+	B_REQUIRE(tokenizer.next(&token));
+	B_CHECK(token.is_empty());
+
+	B_REQUIRE(tokenizer.next(&token));
+	B_CHECK(token == "two");
+
+	B_REQUIRE(tokenizer.next(&token));
+	B_CHECK(token.is_empty());
+
+	B_CHECK(!tokenizer.next(&token));
+	B_CHECK(!tokenizer.next(&token));
+	B_CHECK(tokenizer.remainder().is_empty());
+
+	b::string_tokenizer empty_input(b::string_view(), B_STRING_VIEW(","));
+
+	B_REQUIRE(empty_input.next(&token));
+	B_CHECK(token.is_empty());
+	B_CHECK(!empty_input.next(&token));
+}
+
+B_TEST_CASE(multiple_delimiters)
+{
+	B_STRING_LITERAL(log_line, "  2020-01-01 12:00:00\tINFO  ready ");
+
+	b::string_tokenizer tokenizer(log_line, B_STRING_VIEW(" \t"), true);
+
+	static const char* const expected[] =
+	{
+		"2020-01-01", "12:00:00", "INFO", "ready"
+	};
+
+	b::string_view token;
+
+	for (size_t i = 0; i < B_COUNTOF(expected); ++i)
+	{
+		B_REQUIRE(tokenizer.next(&token));
+		B_CHECK(token == expected[i]);
+	}
+
+	B_CHECK(!tokenizer.next(&token));
+
+	b::string_tokenizer only_delimiters(B_STRING_VIEW(" \t "),
+		B_STRING_VIEW(" \t"), true);
+
+	B_CHECK(!only_delimiters.next(&token));
+
+	b::string_tokenizer no_delimiters(B_STRING_VIEW("word"),
+		B_STRING_VIEW(" \t"));
+
+	B_REQUIRE(no_delimiters.next(&token));
+	B_CHECK(token == "word");
+	B_CHECK(!no_delimiters.next(&token));
+}
+
+B_TEST_CASE(wide_chars)
+{
+	static const wchar_t input[] = L"a\x3000" L"b;c";
+	static const wchar_t delimiters[] = L";\x3000";
+
+	b::wstring_tokenizer tokenizer(
+		b::wstring_view(input, B_COUNTOF(input) - 1),
+		b::wstring_view(delimiters, B_COUNTOF(delimiters) - 1));
+
+	b::wstring_view token;
+
+	B_REQUIRE(tokenizer.next(&token));
+	B_CHECK(token == L"a");
+
+	B_REQUIRE(tokenizer.next(&token));
+	B_CHECK(token == L"b");
+
+	B_REQUIRE(tokenizer.next(&token));
+	B_CHECK(token == L"c");
+
+	B_CHECK(!tokenizer.next(&token));
+}
@@ -0,0 +1,167 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/thread_pool.h>
+
+#include "test_case.h"
+
+class counting_task : public b::task
+{
+public:
+	counting_task() : counter(NULL)
+	{
+	}
+
+	virtual void run()
+	{
+		++*counter;
+	}
+
+	b::atomic* counter;
+};
+
+B_TEST_CASE(task_group)
+{
+	b::thread_pool pool(4);
+
+	B_CHECK(pool.concurrency() == 4);
+
+	b::atomic counter;
+	counter = 0;
+
+	counting_task tasks[1000];
+
+	{
+		b::task_group group(&pool);
+
+		for (size_t i = 0; i < B_COUNTOF(tasks); ++i)
+		{
+			tasks[i].counter = &counter;
+			group.run(tasks + i);
+		}
+
+		group.wait();
+
+		B_CHECK(counter == 1000);
+
+		// Reuse the group.
+		for (size_t i = 0; i < 10; ++i)
+			group.run(tasks + i);
+	}
+
+	// The destructor of the group has waited for the tasks.
+	B_CHECK(counter == 1010);
+}
+
+// Computes Fibonacci numbers by spawning a task for each
+// recursive call, which exercises nested task groups and
+// work stealing.
+class fibonacci_task : public b::task
+{
+public:
+	fibonacci_task(b::thread_pool* p, int arg) : pool(p), n(arg), result(0)
+	{
+	}
+
+	virtual void run()
+	{
+		if (n < 2)
+			result = n;
+		else
+		{
+			fibonacci_task t1(pool, n - 1);
+			fibonacci_task t2(pool, n - 2);
+
+			b::task_group group(pool);
+
+			group.run(&t1);
+			t2.run();
+			group.wait();
+
+			result = t1.result + t2.result;
+		}
+	}
+
+	b::thread_pool* pool;
+	int n;
+	int result;
+};
+
+B_TEST_CASE(nested_groups)
+{
+	static const size_t concurrency[] = {1, 2, 8};
+
+	for (size_t i = 0; i < B_COUNTOF(concurrency); ++i)
+	{
+		b::thread_pool pool(concurrency[i]);
+
+		fibonacci_task fib(&pool, 20);
+
+		b::task_group group(&pool);
+
+		group.run(&fib);
+		group.wait();
+
+		B_CHECK(fib.result == 6765);
+	}
+}
+
+struct increment
+{
+	b::atomic* counter;
+
+	void operator()() const
+	{
+		++*counter;
+	}
+};
+
+B_TEST_CASE(spawn_and_stats)
+{
+	b::thread_pool pool(3);
+
+	B_CHECK(pool.worker_count() == 2);
+
+	b::atomic counter;
+	counter = 0;
+
+	increment function = {&counter};
+
+	{
+		b::task_group group(&pool);
+
+		for (size_t i = 0; i < 1000; ++i)
+			group.spawn(function);
+	}
+
+	B_CHECK(counter == 1000);
+
+	// The tasks were submitted by a thread that is not a worker,
+	// so the workers took them from the shared queue rather than
+	// stole them from each other.
+	size_t executed_by_workers = 0;
+
+	for (size_t i = 0; i < pool.worker_count(); ++i)
+	{
+		b::thread_pool::worker_stats stats = pool.stats(i);
+
+		B_CHECK(stats.steals == 0);
+
+		executed_by_workers += stats.tasks_executed;
+	}
+
+	B_CHECK(executed_by_workers <= 1000);
+
+	pool.reset_stats();
+
+	for (size_t i = 0; i < pool.worker_count(); ++i)
+		B_CHECK(pool.stats(i).tasks_executed == 0);
+}
+
+B_TEST_CASE(default_concurrency)
+{
+	b::thread_pool pool;
+
+	B_CHECK(pool.concurrency() >= 1);
+}
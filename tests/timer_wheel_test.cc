@@ -0,0 +1,205 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/timer_wheel.h>
+#include <b/node_access_via_cast.h>
+#include <b/pseudorandom.h>
+
+#include "test_case.h"
+
+struct test_timer : public b::timer_wheel_node<test_timer>
+{
+	bool fired;
+};
+
+typedef b::node_access_via_cast<b::timer_wheel_node<test_timer> >
+	test_timer_access;
+
+typedef b::timer_wheel<test_timer_access> test_timer_wheel;
+
+static void mark_fired(test_timer_wheel::list_type* expired)
+{
+	test_timer* timer = expired->first();
+
+	while (timer != NULL)
+	{
+		timer->fired = true;
+		timer = test_timer_wheel::list_type::next(timer);
+	}
+
+	expired->empty();
+}
+
+B_TEST_CASE(expiry_times)
+{
+	static const size_t expiry_times[] =
+	{
+		1, 5, 63, 64, 65, 4095, 4096, 4097, 300000, 262144
+	};
+
+	test_timer timers[B_COUNTOF(expiry_times)];
+
+	test_timer_wheel wheel;
+
+	for (size_t i = 0; i < B_COUNTOF(expiry_times); ++i)
+	{
+		timers[i].fired = false;
+		wheel.schedule(timers + i, expiry_times[i]);
+		B_CHECK(timers[i].is_scheduled());
+		B_CHECK(timers[i].expiry() == expiry_times[i]);
+	}
+
+	B_CHECK(wheel.length() == B_COUNTOF(expiry_times));
+
+	test_timer_wheel::list_type expired;
+
+	// Advance one tick at a time and check that each
+	// timer fires exactly when it is due.
+	for (size_t now = 1; now <= 300000; ++now)
+	{
+		wheel.advance(now, &expired);
+
+		mark_fired(&expired);
+
+		for (size_t i = 0; i < B_COUNTOF(expiry_times); ++i)
+			B_REQUIRE(timers[i].fired == (expiry_times[i] <= now));
+	}
+
+	B_CHECK(wheel.is_empty());
+	B_CHECK(!timers[0].is_scheduled());
+}
+
+B_TEST_CASE(expiry_order)
+{
+	test_timer timers[5];
+
+	test_timer_wheel wheel(1000);
+
+	wheel.schedule(timers + 0, 5000);
+	wheel.schedule(timers + 1, 1001);
+	wheel.schedule(timers + 2, 70000);
+	wheel.schedule(timers + 3, 1064);
+	wheel.schedule(timers + 4, 5000);
+
+	size_t event_time;
+
+	B_REQUIRE(wheel.next_event_time(&event_time));
+	B_CHECK(event_time == 1001);
+
+	test_timer_wheel::list_type expired;
+
+	// A single jump must produce the timers in
+	// the order of their expiry.
+	wheel.advance(1000000, &expired);
+
+	B_CHECK(wheel.current_time() == 1000000);
+	B_CHECK(wheel.is_empty());
+	B_CHECK(!wheel.next_event_time(&event_time));
+
+	static const size_t expected_order[] = {1, 3, 0, 4, 2};
+
+	test_timer* timer = expired.first();
+
+	for (size_t i = 0; i < B_COUNTOF(expected_order); ++i)
+	{
+		B_REQUIRE(timer == timers + expected_order[i]);
+		timer = test_timer_wheel::list_type::next(timer);
+	}
+
+	B_CHECK(timer == NULL);
+}
+
+B_TEST_CASE(cancel_and_reschedule)
+{
+	test_timer timers[3];
+
+	test_timer_wheel wheel;
+
+	wheel.schedule(timers + 0, 10);
+	wheel.schedule(timers + 1, 10);
+	wheel.schedule(timers + 2, 100000);
+
+	wheel.cancel(timers + 0);
+	B_CHECK(!timers[0].is_scheduled());
+
+	// Reschedule a scheduled timer.
+	wheel.schedule(timers + 2, 20);
+
+	B_CHECK(wheel.length() == 2);
+
+	test_timer_wheel::list_type expired;
+
+	wheel.advance(15, &expired);
+	B_CHECK(expired.first() == timers + 1 && expired.last() == timers + 1);
+	expired.empty();
+
+	// Expiry times in the past are moved to the next tick.
+	wheel.schedule(timers + 0, 3);
+
+	wheel.advance(15, &expired);
+	B_CHECK(expired.is_empty());
+
+	wheel.advance(16, &expired);
+	B_CHECK(expired.first() == timers + 0 && expired.last() == timers + 0);
+	expired.empty();
+
+	wheel.advance(20, &expired);
+	B_CHECK(expired.first() == timers + 2 && expired.last() == timers + 2);
+
+	B_CHECK(wheel.is_empty());
+}
+
+B_TEST_CASE(random_timers)
+{
+	const size_t timer_count = 2000;
+
+	test_timer timers[timer_count];
+
+	b::pseudorandom rand(1);
+
+	// Start close to a boundary of every level.
+	size_t start_time = ~(size_t) 0 >> 8 << 4;
+
+	test_timer_wheel wheel(start_time);
+
+	for (size_t i = 0; i < timer_count; ++i)
+	{
+		timers[i].fired = false;
+		wheel.schedule(timers + i, start_time + 1 +
+			rand.next(1 << (rand.next(20) + 1)));
+	}
+
+	// Cancel every tenth timer.
+	for (size_t i = 0; i < timer_count; i += 10)
+		wheel.cancel(timers + i);
+
+	test_timer_wheel::list_type expired;
+
+	size_t now = start_time;
+
+	while (!wheel.is_empty())
+	{
+		now += rand.next(5000);
+
+		wheel.advance(now, &expired);
+
+		size_t last_expiry = 0;
+
+		for (test_timer* timer = expired.first(); timer != NULL;
+				timer = test_timer_wheel::list_type::next(timer))
+		{
+			B_REQUIRE(timer->expiry() >= last_expiry);
+			last_expiry = timer->expiry();
+		}
+
+		mark_fired(&expired);
+
+		for (size_t i = 0; i < timer_count; ++i)
+			if (i % 10 != 0)
+				B_REQUIRE(timers[i].fired ==
+					(timers[i].expiry() <= now));
+			else
+				B_REQUIRE(!timers[i].fired);
+	}
+}
@@ -0,0 +1,84 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/string.h>
+
+#include "test_case.h"
+
+// "Mixed ASCII, Кириллица, 漢字 and 😀" in UTF-8.
+static const char mixed_utf8[] =
+	"Mixed ASCII, "
+	"\xD0\x9A\xD0\xB8\xD1\x80\xD0\xB8\xD0\xBB\xD0\xBB\xD0\xB8\xD1\x86"
+	"\xD0\xB0, \xE6\xBC\xA2\xE5\xAD\x97 and \xF0\x9F\x98\x80";
+
+static const wchar_t mixed_wide[] =
+	L"Mixed ASCII, "
+	L"\x041A\x0438\x0440\x0438\x043B\x043B\x0438\x0446\x0430, "
+	L"\x6F22\x5B57 and "
+#if WCHAR_MAX > 0xFFFF
+	L"\x1F600";
+#else
+	L"\xD83D\xDE00";
+#endif
+
+B_TEST_CASE(round_trip)
+{
+	b::string_view utf8(mixed_utf8, B_COUNTOF(mixed_utf8) - 1);
+	b::wstring_view wide(mixed_wide, B_COUNTOF(mixed_wide) - 1);
+
+	b::wstring decoded = b::utf8_to_wstring(utf8);
+
+	B_CHECK(decoded == wide);
+
+	B_CHECK(b::wstring_to_utf8(decoded) == utf8);
+
+	B_CHECK(b::utf8_to_wstring(b::string_view()).is_empty());
+	B_CHECK(b::wstring_to_utf8(b::wstring_view()).is_empty());
+}
+
+B_TEST_CASE(long_ascii_run)
+{
+	b::string ascii(100, 'a');
+
+	ascii.append("\xC3\xA9", 2);
+
+	b::wstring decoded = b::utf8_to_wstring(ascii);
+
+	B_REQUIRE(decoded.length() == 101);
+	B_CHECK(decoded[99] == L'a');
+	B_CHECK(decoded[100] == L'\x00E9');
+}
+
+B_TEST_CASE(malformed_input)
+{
+	wchar_t buffer[16];
+
+	// Overlong encoding of '/', truncated sequence,
+	// encoded surrogate, and a stray continuation byte.
+	static const char malformed[] =
+		"\xC0\xAF" "a" "\xE6\xBC" "b" "\xED\xA0\x80" "c" "\x80";
+
+	B_CHECK(b::utf8_to_wchar(buffer, malformed,
+		B_COUNTOF(malformed) - 1, true) == (size_t) -1);
+
+	size_t length = b::utf8_to_wchar(buffer, malformed,
+		B_COUNTOF(malformed) - 1);
+
+	static const wchar_t expected[] =
+		L"\xFFFD\xFFFD" L"a" L"\xFFFD" L"b"
+		L"\xFFFD\xFFFD\xFFFD" L"c" L"\xFFFD";
+
+	B_REQUIRE(length == B_COUNTOF(expected) - 1);
+	B_CHECK(b::compare_arrays(buffer, expected, length) == 0);
+
+	char utf8[8];
+
+	static const wchar_t lone_surrogate[] = {0xDC00, L'x'};
+
+	B_CHECK(b::wchar_to_utf8(utf8, lone_surrogate, 2, true) ==
+		(size_t) -1);
+
+	B_REQUIRE(b::wchar_to_utf8(utf8, lone_surrogate, 2) == 4);
+	B_CHECK(b::compare_arrays(utf8, "\xEF\xBF\xBDx", 4) == 0);
+}
@@ -0,0 +1,111 @@
+// This file is part of the B library, which is released under the MIT license.
+// Copyright (C) 2002-2007, 2016-2020 Damon Revoe <him@revl.org>
+// See the file LICENSE for the license terms.
+
+#include <b/work_stealing_deque.h>
+
+#include "test_case.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+template class b::work_stealing_deque<size_t>;
+template class b::work_stealing_deque<int*>;
+
+B_TEST_CASE(owner_and_thief_ends)
+{
+	b::work_stealing_deque<size_t> deque(4);
+
+	size_t value;
+
+	B_CHECK(deque.is_empty());
+	B_CHECK(!deque.pop_back(&value));
+	B_CHECK(!deque.steal(&value));
+
+	// Push enough elements to make the deque grow twice.
+	for (size_t i = 0; i < 16; ++i)
+		deque.push_back(i);
+
+	B_CHECK(!deque.is_empty());
+
+	B_CHECK(deque.pop_back(&value) && value == 15);
+	B_CHECK(deque.steal(&value) && value == 0);
+	B_CHECK(deque.steal(&value) && value == 1);
+	B_CHECK(deque.pop_back(&value) && value == 14);
+
+	for (size_t i = 13; i >= 2; --i)
+		B_CHECK(deque.pop_back(&value) && value == i);
+
+	B_CHECK(deque.is_empty());
+	B_CHECK(!deque.pop_back(&value));
+	B_CHECK(!deque.steal(&value));
+
+	deque.push_back(42);
+
+	B_CHECK(deque.steal(&value) && value == 42);
+	B_CHECK(!deque.pop_back(&value));
+}
+
+#define THIEF_COUNT 3
+#define ELEMENT_COUNT 100000
+
+static b::work_stealing_deque<size_t> shared_deque(2);
+static b::atomic_value<size_t> taken_count;
+static b::atomic_value<int> seen[ELEMENT_COUNT];
+
+static void take(size_t value)
+{
+	seen[value].fetch_add(1, b::memory_order_relaxed);
+	taken_count.fetch_add(1, b::memory_order_relaxed);
+}
+
+static void* steal(void*)
+{
+	size_t value;
+
+	while (taken_count.load(b::memory_order_relaxed) < ELEMENT_COUNT)
+		if (shared_deque.steal(&value))
+			take(value);
+		else
+			sched_yield();
+
+	return NULL;
+}
+
+B_TEST_CASE(concurrent_steals)
+{
+	pthread_t threads[THIEF_COUNT];
+
+	for (size_t i = 0; i < THIEF_COUNT; ++i)
+		B_REQUIRE(pthread_create(threads + i, NULL,
+			steal, NULL) == 0);
+
+	// The owner pushes elements in batches and takes some of
+	// them back, which makes it race with the thieves for the
+	// last elements.
+	size_t value;
+
+	for (size_t i = 0; i < ELEMENT_COUNT; ++i)
+	{
+		shared_deque.push_back(i);
+
+		if (i % 3 == 2 && shared_deque.pop_back(&value))
+			take(value);
+	}
+
+	while (shared_deque.pop_back(&value))
+		take(value);
+
+	for (size_t i = 0; i < THIEF_COUNT; ++i)
+		pthread_join(threads[i], NULL);
+
+	B_CHECK(taken_count.load() == ELEMENT_COUNT);
+
+	bool each_once = true;
+
+	for (size_t i = 0; i < ELEMENT_COUNT; ++i)
+		if (seen[i].load(b::memory_order_relaxed) != 1)
+			each_once = false;
+
+	B_CHECK(each_once);
+}